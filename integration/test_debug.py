@@ -79,3 +79,27 @@ class TestFtDebugCommand(ValkeySearchTestCaseDebugMode):
         assert byref[6] == {'Count': 10, 'Bytes': 140, 'AvgSize': b'14', 'Allocated': 320, 'AvgAllocated': b'32', 'Utilization': 43}
         assert bysize[-12] == {'Count': 10, 'Bytes': 120, 'AvgSize': b'12', 'Allocated': 280, 'AvgAllocated': b'28', 'Utilization': 42}
         assert bysize[14] == {'Count': 10, 'Bytes': 140, 'AvgSize': b'14', 'Allocated': 320, 'AvgAllocated': b'32', 'Utilization': 43}
+
+    def test_QueryPlanner(self):
+        client: Valkey = self.server.get_new_client()
+        to_map = lambda row: {row[i].decode(): row[i + 1] for i in range(0, len(row), 2)}
+        assert client.execute_command("FT._DEBUG QUERY_PLANNER RESET") == b"OK"
+        hnsw_index = Index("hnsw", [Vector("v", 3, type="HNSW"), Numeric("n")])
+        hnsw_index.create(client, wait_for_backfill=True)
+        hnsw_index.load_data(client, 100)
+        client.execute_command(
+            "FT.SEARCH", "hnsw", "@n:[0 5]=>[KNN 3 @v $v]",
+            "PARAMS", "2", "v", float_to_bytes([0.0, 0.0, 0.0]), "NOCONTENT",
+        )
+        planner = to_map(client.execute_command("FT._DEBUG QUERY_PLANNER"))
+        assert planner["cost_model_enabled"] == 1
+        assert len(planner["recent_plans"]) == 1
+        plan = to_map(planner["recent_plans"][0])
+        assert plan["index"] == b"hnsw"
+        assert plan["plan"] in (b"prefilter", b"inline")
+        assert plan["index_size"] == 100
+        assert plan["completed"] == 1
+        assert planner["prefilter_samples"] + planner["inline_samples"] == 1
+        assert client.execute_command("FT._DEBUG QUERY_PLANNER RESET") == b"OK"
+        planner = to_map(client.execute_command("FT._DEBUG QUERY_PLANNER"))
+        assert planner["recent_plans"] == []
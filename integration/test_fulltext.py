@@ -2354,7 +2354,10 @@ class TestFullText(ValkeySearchTestCaseDebugMode):
         import struct
         client: Valkey = self.server.get_new_client()
         client.execute_command("CONFIG SET search.info-developer-visible yes")
-        
+        # Validate the threshold ratio alone, the cost model would pre-filter
+        # the small "twodocs" space of the boundary case.
+        client.execute_command("CONFIG SET search.query-planner-cost-model no")
+
         # Create index with text + HNSW vector (threshold logic only applies to HNSW, not FLAT)
         client.execute_command(
             "FT.CREATE", "idx", "ON", "HASH", "SCHEMA",
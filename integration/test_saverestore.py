@@ -122,6 +122,7 @@ def do_save_restore_test(test, index: Index, expected_writes: List[int], expecte
         i["search_rdb_load_sections_skipped"],
         i["search_rdb_load_keys"],
         i["search_rdb_load_mutation_entries"],
+        i["search_rdb_load_restored_keys"],
      ]
     assert reads == expected_reads
     '''
@@ -140,9 +141,9 @@ class TestSaveRestore_v1_v1(ValkeySearchTestCaseDebugMode):
         args["search.rdb_read_v2"] = "no"
         return args
     @pytest.mark.parametrize("parameters", [
-        [index, [4, 0, 0], [4, 0, 0, 0]],
-        [vector_only_index, [2, 0, 0], [2, 0, 0, 0]],
-        [non_vector_index, [2, 0, 0], [2, 0, 0, 0]],
+        [index, [4, 0, 0], [4, 0, 0, 0, 0]],
+        [vector_only_index, [2, 0, 0], [2, 0, 0, 0, 0]],
+        [non_vector_index, [2, 0, 0], [2, 0, 0, 0, 0]],
         ])
     def test_saverestore_v1_v1(self, parameters):
         do_save_restore_test(self, parameters[0], parameters[1], parameters[2])
@@ -154,9 +155,9 @@ class TestSaveRestore_v1_v2(ValkeySearchTestCaseDebugMode):
         return args
 
     @pytest.mark.parametrize("parameters", [
-        [index, [4, 0, 0], [4, 0, 0, 0]],
-        [vector_only_index, [2, 0, 0], [2, 0, 0, 0]],
-        [non_vector_index, [2, 0, 0], [2, 0, 0, 0]],
+        [index, [4, 0, 0], [4, 0, 0, 0, 0]],
+        [vector_only_index, [2, 0, 0], [2, 0, 0, 0, 0]],
+        [non_vector_index, [2, 0, 0], [2, 0, 0, 0, 0]],
         ])
     def test_saverestore_v1_v2(self, parameters):
         do_save_restore_test(self, parameters[0], parameters[1], parameters[2])
@@ -168,9 +169,9 @@ class TestSaveRestore_v2_v1(ValkeySearchTestCaseDebugMode):
         return args
 
     @pytest.mark.parametrize("parameters", [
-        [index, [5, KEY_COUNT, 0], [5, 1, 0, 0]],
-        [vector_only_index, [3, KEY_COUNT, 0], [3, 1, 0, 0]],
-        [non_vector_index, [3, KEY_COUNT, 0], [3, 1, 0, 0]],
+        [index, [8, KEY_COUNT, 0], [8, 1, 0, 0, 0]],
+        [vector_only_index, [4, KEY_COUNT, 0], [4, 1, 0, 0, 0]],
+        [non_vector_index, [6, KEY_COUNT, 0], [6, 1, 0, 0, 0]],
         ])
     def test_saverestore_v2_v1(self, parameters):
         do_save_restore_test(self, parameters[0], parameters[1], parameters[2])
@@ -182,9 +183,9 @@ class TestSaveRestore_v2_v2(ValkeySearchTestCaseDebugMode):
         return args
 
     @pytest.mark.parametrize("parameters", [
-        [index, [5, KEY_COUNT, 0], [5, 0, KEY_COUNT, 0]],
-        [vector_only_index, [3, KEY_COUNT, 0], [3, 0, KEY_COUNT, 0]],
-        [non_vector_index, [3, KEY_COUNT, 0], [3, 0, KEY_COUNT, 0]],
+        [index, [8, KEY_COUNT, 0], [8, 0, KEY_COUNT, 0, KEY_COUNT]],
+        [vector_only_index, [4, KEY_COUNT, 0], [4, 0, KEY_COUNT, 0, KEY_COUNT]],
+        [non_vector_index, [6, KEY_COUNT, 0], [6, 0, KEY_COUNT, 0, KEY_COUNT]],
         ])
     def test_saverestore_v2_v2(self, parameters):
         do_save_restore_test(self, parameters[0], parameters[1], parameters[2])
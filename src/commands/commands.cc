@@ -199,6 +199,7 @@ absl::Status QueryCommand::Execute(ValkeyModuleCtx *ctx,
         parameters->index_fingerprint_version.set_version(
             parameters->index_schema->GetVersion());
       }
+      parameters->PrepareFanout();
 
       return query::fanout::PerformSearchFanoutAsync(
           ctx, search_targets,
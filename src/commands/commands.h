@@ -107,6 +107,10 @@ struct QueryCommand : public query::SearchParameters {
   //
   virtual bool RequiresCompleteResults() const = 0;
   //
+  // Executed on Main Thread before the query is fanned out to the shards
+  //
+  virtual void PrepareFanout() {}
+  //
   // Called when query completes.
   //
   void QueryCompleteBackground(std::unique_ptr<SearchParameters> self) override;
@@ -16,6 +16,7 @@
 #include "src/index_schema.h"
 #include "src/indexes/index_base.h"
 #include "src/metrics.h"
+#include "src/query/partial_aggregate.h"
 #include "src/query/response_generator.h"
 #include "vmsdk/src/info.h"
 
@@ -206,29 +207,8 @@ absl::StatusOr<std::pair<size_t, size_t>> ProcessNeighborsForProcessing(
 absl::StatusOr<expr::Value> ProcessFieldValue(
     std::string_view value, indexes::IndexerType indexer_type,
     data_model::AttributeDataType data_type) {
-  switch (indexer_type) {
-    case indexes::IndexerType::kNumeric: {
-      auto numeric_value = vmsdk::To<double>(value);
-      if (numeric_value.ok()) {
-        return expr::Value(numeric_value.value());
-      } else {
-        // Return error status to indicate field should be skipped
-        return absl::InvalidArgumentError("Invalid numeric value");
-      }
-    }
-    default:
-      if (data_type ==
-          data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH) {
-        return expr::Value(value);
-      } else {
-        auto v = vmsdk::JsonUnquote(value);
-        if (v) {
-          return expr::Value(std::move(*v));
-        } else {
-          return absl::InvalidArgumentError("Failed to unquote JSON value");
-        }
-      }
-  }
+  return query::ContentToValue(
+      value, indexer_type == indexes::IndexerType::kNumeric, data_type);
 }
 
 // Create records from neighbors and populate their fields
@@ -307,11 +287,24 @@ absl::Status CreateRecordsFromNeighbors(
   return absl::OkStatus();
 }
 
-// Execute all aggregation stages on the record set
+// Create the records of the groups merged from the shards
+void CreateRecordsFromPartialGroups(
+    const query::PartialAggregator &partial_groups,
+    AggregateParameters &parameters, RecordSet &records) {
+  const auto &group_by = dynamic_cast<const GroupBy &>(*parameters.stages_[0]);
+  partial_groups.ForEachGroup([&](absl::Span<const expr::Value> keys,
+                                  absl::Span<const expr::Value> results) {
+    records.push_back(group_by.MakeGroupRecord(
+        parameters.record_indexes_by_alias_.size(), keys, results));
+  });
+}
+
+// Execute the aggregation stages, starting at `first_stage`, on the record
+// set
 absl::Status ExecuteAggregationStages(AggregateParameters &parameters,
-                                      RecordSet &records) {
+                                      RecordSet &records, size_t first_stage) {
   agg_input_records.Increment(records.size());
-  for (auto &stage : parameters.stages_) {
+  for (auto &stage : parameters.stages_ | std::views::drop(first_stage)) {
     // Check for timeout
     if (parameters.cancellation_token->IsCancelled() ||
         // Testing purpose only
@@ -366,21 +359,31 @@ absl::Status GenerateResponse(ValkeyModuleCtx *ctx,
   return absl::OkStatus();
 }
 
-absl::Status SendReplyInner(ValkeyModuleCtx *ctx,
-                            std::vector<indexes::Neighbor> &neighbors,
+absl::Status SendReplyInner(ValkeyModuleCtx *ctx, query::SearchResult &result,
                             AggregateParameters &parameters) {
-  // 1. Process query setup and get key/score indices
-  VMSDK_ASSIGN_OR_RETURN(
-      auto indices, ProcessNeighborsForProcessing(ctx, neighbors, parameters));
-  auto [key_index, scores_index] = indices;
-
-  // 2. Create records from neighbors
   RecordSet records(&parameters);
-  VMSDK_RETURN_IF_ERROR(CreateRecordsFromNeighbors(
-      neighbors, parameters, key_index, scores_index, records));
+  size_t first_stage = 0;
+  if (result.partial_groups) {
+    // 1-2. The shards already ran the leading GROUPBY, create its output
+    // records from the merged groups
+    CreateRecordsFromPartialGroups(*result.partial_groups, parameters,
+                                   records);
+    first_stage = 1;
+  } else {
+    // 1. Process query setup and get key/score indices
+    VMSDK_ASSIGN_OR_RETURN(
+        auto indices,
+        ProcessNeighborsForProcessing(ctx, result.neighbors, parameters));
+    auto [key_index, scores_index] = indices;
+
+    // 2. Create records from neighbors
+    VMSDK_RETURN_IF_ERROR(CreateRecordsFromNeighbors(
+        result.neighbors, parameters, key_index, scores_index, records));
+  }
 
   // 3. Execute aggregation stages
-  VMSDK_RETURN_IF_ERROR(ExecuteAggregationStages(parameters, records));
+  VMSDK_RETURN_IF_ERROR(
+      ExecuteAggregationStages(parameters, records, first_stage));
 
   // 4. Generate the response
   VMSDK_RETURN_IF_ERROR(GenerateResponse(ctx, parameters, records));
@@ -409,9 +412,62 @@ query::SerializationRange AggregateParameters::GetSerializationRange() const {
   return query::SerializationRange::All();
 }
 
+std::optional<coordinator::PartialAggregate>
+AggregateParameters::MakePartialAggregate() const {
+  if (IsVectorQuery() || stages_.empty()) {
+    return std::nullopt;
+  }
+  const auto *group_by = dynamic_cast<const GroupBy *>(stages_[0].get());
+  if (group_by == nullptr) {
+    return std::nullopt;
+  }
+  // With LOAD *, JSON documents are fetched whole rather than per attribute.
+  if (loadall_ && index_schema->GetAttributeDataType().ToProto() ==
+                      data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_JSON) {
+    return std::nullopt;
+  }
+  // The key and the score aren't attribute contents, only group and reduce
+  // on attributes.
+  auto is_content = [](const Attribute &attribute) {
+    return attribute.record_index_ > 1;
+  };
+  coordinator::PartialAggregate plan;
+  for (const auto &info : record_info_by_index_) {
+    auto *field = plan.add_fields();
+    field->set_identifier(info.identifier_);
+    field->set_alias(info.alias_);
+    field->set_numeric(info.data_type_ == indexes::IndexerType::kNumeric);
+  }
+  for (const auto &group : group_by->groups_) {
+    if (!is_content(*group)) {
+      return std::nullopt;
+    }
+    plan.add_group_by(group->record_index_);
+  }
+  for (const auto &reducer : group_by->reducers_) {
+    auto *partial = plan.add_reducers();
+    partial->set_name(reducer.info_->name_);
+    if (reducer.args_.empty()) {
+      continue;
+    }
+    const auto *attribute = dynamic_cast<const Attribute *>(
+        reducer.args_[0]->AsAttributeReference());
+    if (reducer.args_.size() > 1 || attribute == nullptr ||
+        !is_content(*attribute)) {
+      return std::nullopt;
+    }
+    partial->set_field(attribute->record_index_);
+  }
+  return plan;
+}
+
+void AggregateParameters::PrepareFanout() {
+  partial_aggregate = MakePartialAggregate();
+}
+
 void AggregateParameters::SendReply(ValkeyModuleCtx *ctx,
                                     query::SearchResult &result) {
-  auto status = SendReplyInner(ctx, result.neighbors, *this);
+  auto status = SendReplyInner(ctx, result, *this);
   if (!status.ok()) {
     ++Metrics::GetStats().query_failed_requests_cnt;
     ValkeyModule_ReplyWithError(ctx, status.message().data());
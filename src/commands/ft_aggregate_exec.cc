@@ -7,10 +7,12 @@
 #include "src/commands/ft_aggregate_exec.h"
 
 #include <algorithm>
-#include <queue>
+#include <numeric>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 #include "src/commands/ft_aggregate_parser.h"
 #include "vmsdk/src/info.h"
 
@@ -37,12 +39,55 @@ namespace aggregate {
 
 expr::Value Attribute::GetValue(expr::Expression::EvalContext& ctx,
                                 const expr::Expression::Record& record) const {
-  auto rec = reinterpret_cast<const Record&>(record);
+  const auto& rec = reinterpret_cast<const Record&>(record);
   return rec.fields_.at(record_index_);
 };
 
+void Attribute::GetValues(
+    expr::Expression::EvalContext& ctx,
+    absl::Span<const expr::Expression::Record* const> records,
+    absl::Span<expr::Value> values) const {
+  for (size_t i = 0; i < records.size(); ++i) {
+    values[i] =
+        reinterpret_cast<const Record*>(records[i])->fields_.at(record_index_);
+  }
+}
+
 expr::Expression::EvalContext ctx;
 
+namespace {
+
+// The APPLY, FILTER, SORTBY and GROUPBY stages evaluate their expressions a
+// batch of records at a time, so that each expression node runs over a column
+// of values that stays in cache.
+constexpr size_t kBatchSize = 1024;
+
+using Rows = absl::Span<const expr::Expression::Record* const>;
+
+// Calls `fn(begin, rows)` for consecutive batches of records, where `rows`
+// are the records [begin, begin + rows.size()).
+template <typename Fn>
+void ForEachBatch(const RecordSet& records, Fn&& fn) {
+  std::vector<const expr::Expression::Record*> rows;
+  rows.reserve(std::min(kBatchSize, records.size()));
+  for (size_t begin = 0; begin < records.size(); begin += kBatchSize) {
+    rows.clear();
+    for (size_t i = begin; i < std::min(begin + kBatchSize, records.size());
+         ++i) {
+      rows.push_back(records[i].get());
+    }
+    fn(begin, Rows(rows));
+  }
+}
+
+// A column of values for each of `count` expressions, kBatchSize rows each.
+std::vector<std::vector<expr::Value>> MakeColumns(size_t count) {
+  return std::vector<std::vector<expr::Value>>(
+      count, std::vector<expr::Value>(kBatchSize));
+}
+
+}  // namespace
+
 std::ostream& operator<<(std::ostream& os, const RecordSet& rs) {
   os << "<RecordSet> " << rs.size() << "\n";
   for (size_t i = 0; i < rs.size(); ++i) {
@@ -103,9 +148,14 @@ absl::Status Apply::Execute(RecordSet& records) const {
   DBG << "Executing APPLY with expr: " << *expr_ << "\n";
   agg_apply_stages.Increment();
   agg_apply_records.Increment(records.size());
-  for (auto& r : records) {
-    SetField(*r, *name_, expr_->Evaluate(ctx, *r));
-  }
+  std::vector<expr::Value> results(std::min(kBatchSize, records.size()));
+  ForEachBatch(records, [&](size_t begin, Rows rows) {
+    auto batch = absl::MakeSpan(results).subspan(0, rows.size());
+    expr_->EvaluateBatch(ctx, rows, batch);
+    for (size_t i = 0; i < rows.size(); ++i) {
+      SetField(*records[begin + i], *name_, std::move(batch[i]));
+    }
+  });
   return absl::OkStatus();
 }
 
@@ -113,35 +163,44 @@ absl::Status Filter::Execute(RecordSet& records) const {
   DBG << "Executing FILTER with expr: " << *expr_ << "\n";
   agg_filter_stages.Increment();
   agg_filter_input_records.Increment(records.size());
-  RecordSet filtered(records.agg_params_);
-  while (!records.empty()) {
-    auto r = records.pop_front();
-    auto result = expr_->Evaluate(ctx, *r);
-    if (result.IsTrue()) {
-      filtered.push_back(std::move(r));
+  // Selection vector of the records that pass the filter.
+  std::vector<size_t> selection;
+  std::vector<expr::Value> results(std::min(kBatchSize, records.size()));
+  ForEachBatch(records, [&](size_t begin, Rows rows) {
+    auto batch = absl::MakeSpan(results).subspan(0, rows.size());
+    expr_->EvaluateBatch(ctx, rows, batch);
+    for (size_t i = 0; i < rows.size(); ++i) {
+      if (batch[i].IsTrue()) {
+        selection.push_back(begin + i);
+      }
     }
+  });
+  RecordSet filtered(records.agg_params_);
+  for (auto i : selection) {
+    filtered.push_back(std::move(records[i]));
   }
   records.swap(filtered);
   agg_filter_output_records.Increment(records.size());
   return absl::OkStatus();
 }
 
-template <typename T>
+// Orders record positions by the sort keys, which are evaluated once per
+// record into `columns_` rather than on every comparison.
 struct SortFunctor {
   const absl::InlinedVector<SortBy::SortKey, 4>* sortkeys_;
-  bool operator()(const T& l, const T& r) const {
-    for (auto& sk : *sortkeys_) {
-      auto lvalue = sk.expr_->Evaluate(ctx, *l);
-      auto rvalue = sk.expr_->Evaluate(ctx, *r);
-      auto cmp = expr::Compare(lvalue, rvalue);
+  const std::vector<std::vector<expr::Value>>* columns_;
+  bool operator()(size_t l, size_t r) const {
+    for (size_t k = 0; k < sortkeys_->size(); ++k) {
+      const auto& column = (*columns_)[k];
+      auto cmp = expr::Compare(column[l], column[r]);
       switch (cmp) {
         case expr::Ordering::kEQUAL:
         case expr::Ordering::kUNORDERED:
           continue;
         case expr::Ordering::kLESS:
-          return sk.direction_ == SortBy::Direction::kASC;
+          return (*sortkeys_)[k].direction_ == SortBy::Direction::kASC;
         case expr::Ordering::kGREATER:
-          return sk.direction_ == SortBy::Direction::kDESC;
+          return (*sortkeys_)[k].direction_ == SortBy::Direction::kDESC;
       }
     }
     return false;
@@ -152,28 +211,29 @@ absl::Status SortBy::Execute(RecordSet& records) const {
   DBG << "Executing SORTBY with sortkeys: " << sortkeys_.size() << "\n";
   agg_sort_by_stages.Increment();
   agg_sort_by_records.Increment(records.size());
-  if (records.size() > max_) {
-    // Sadly std::priority_queue can't operate on unique_ptr's. so we need an
-    // extra copy
-    SortFunctor<Record*> sorter{&sortkeys_};
-    std::priority_queue<Record*, std::vector<Record*>, SortFunctor<Record*>>
-        heap(sorter);
-    for (auto i = 0; i < max_; ++i) {
-      heap.push(records.pop_front().release());
-    }
-    while (!records.empty()) {
-      heap.push(records.pop_front().release());
-      auto top = RecordPtr(heap.top());  // no leak....
-      heap.pop();
-    }
-    while (!heap.empty()) {
-      records.emplace_front(RecordPtr(heap.top()));
-      heap.pop();
+  std::vector<std::vector<expr::Value>> columns(
+      sortkeys_.size(), std::vector<expr::Value>(records.size()));
+  ForEachBatch(records, [&](size_t begin, Rows rows) {
+    for (size_t k = 0; k < sortkeys_.size(); ++k) {
+      sortkeys_[k].expr_->EvaluateBatch(
+          ctx, rows, absl::MakeSpan(columns[k]).subspan(begin, rows.size()));
     }
+  });
+  std::vector<size_t> order(records.size());
+  std::iota(order.begin(), order.end(), 0);
+  SortFunctor sorter{&sortkeys_, &columns};
+  if (records.size() > max_) {
+    std::partial_sort(order.begin(), order.begin() + max_, order.end(),
+                      sorter);
+    order.resize(max_);
   } else {
-    SortFunctor<RecordPtr> sorter{&sortkeys_};
-    std::stable_sort(records.begin(), records.end(), sorter);
+    std::stable_sort(order.begin(), order.end(), sorter);
+  }
+  RecordSet sorted(records.agg_params_);
+  for (auto i : order) {
+    sorted.push_back(std::move(records[i]));
   }
+  records.swap(sorted);
   return absl::OkStatus();
 }
 
@@ -186,47 +246,63 @@ absl::Status GroupBy::Execute(RecordSet& records) const {
   size_t record_field_count = 0;
   agg_group_by_stages.Increment();
   agg_group_by_input_records.Increment(records.size());
-  while (!records.empty()) {
-    auto record = records.pop_front();
-    if (record_field_count == 0) {
-      record_field_count = record->fields_.size();
-    } else {
-      CHECK(record_field_count == record->fields_.size());
-    }
-    GroupKey k;
-    // todo: How do we handle keys that have a missing attribute in the key??
-    // Skip them?
-    for (auto& g : groups_) {
-      k.keys_.emplace_back(g->GetValue(ctx, *record));
+  auto key_columns = MakeColumns(groups_.size());
+  std::vector<std::vector<std::vector<expr::Value>>> arg_columns;
+  for (auto& reducer : reducers_) {
+    arg_columns.emplace_back(MakeColumns(reducer.args_.size()));
+  }
+  ForEachBatch(records, [&](size_t begin, Rows rows) {
+    for (size_t g = 0; g < groups_.size(); ++g) {
+      groups_[g]->GetValues(
+          ctx, rows, absl::MakeSpan(key_columns[g]).subspan(0, rows.size()));
     }
-    DBG << "Record: " << *record << " GroupKey: " << k << "\n";
-    auto [group_it, inserted] = groups.try_emplace(std::move(k));
-    if (inserted) {
-      DBG << "Was inserted, now have " << groups.size() << " groups\n";
-      for (auto& reducer : reducers_) {
-        group_it->second.emplace_back(reducer.info_->make_instance());
+    for (size_t i = 0; i < reducers_.size(); ++i) {
+      for (size_t a = 0; a < reducers_[i].args_.size(); ++a) {
+        reducers_[i].args_[a]->EvaluateBatch(
+            ctx, rows,
+            absl::MakeSpan(arg_columns[i][a]).subspan(0, rows.size()));
       }
     }
-    for (auto i = 0; i < reducers_.size(); ++i) {
-      absl::InlinedVector<expr::Value, 4> args;
-      for (auto& nargs : reducers_[i].args_) {
-        args.emplace_back(nargs->Evaluate(ctx, *record));
+    for (size_t row = 0; row < rows.size(); ++row) {
+      const auto& record = *records[begin + row];
+      if (record_field_count == 0) {
+        record_field_count = record.fields_.size();
+      } else {
+        CHECK(record_field_count == record.fields_.size());
+      }
+      GroupKey k;
+      // todo: How do we handle keys that have a missing attribute in the key??
+      // Skip them?
+      for (auto& column : key_columns) {
+        k.keys_.emplace_back(std::move(column[row]));
+      }
+      DBG << "Record: " << record << " GroupKey: " << k << "\n";
+      auto [group_it, inserted] = groups.try_emplace(std::move(k));
+      if (inserted) {
+        DBG << "Was inserted, now have " << groups.size() << " groups\n";
+        for (auto& reducer : reducers_) {
+          group_it->second.emplace_back(reducer.info_->make_instance());
+        }
+      }
+      for (auto i = 0; i < reducers_.size(); ++i) {
+        absl::InlinedVector<expr::Value, 4> args;
+        for (auto& column : arg_columns[i]) {
+          args.emplace_back(std::move(column[row]));
+        }
+        group_it->second[i]->ProcessRecord(args);
       }
-      group_it->second[i]->ProcessRecord(args);
     }
-  }
+  });
+  records.clear();
   for (auto& group : groups) {
     DBG << "Making record for group " << group.first << "\n";
-    RecordPtr record = std::make_unique<Record>(record_field_count);
-    CHECK(groups_.size() == group.first.keys_.size());
-    for (auto i = 0; i < groups_.size(); ++i) {
-      SetField(*record, *groups_[i], group.first.keys_[i]);
-    }
     CHECK(reducers_.size() == group.second.size());
-    agg_reducer_stages.Increment(reducers_.size());
-    for (auto i = 0; i < reducers_.size(); ++i) {
-      SetField(*record, *reducers_[i].output_, group.second[i]->GetResult());
+    absl::InlinedVector<expr::Value, 4> results;
+    for (auto& reducer : group.second) {
+      results.emplace_back(reducer->GetResult());
     }
+    auto record =
+        MakeGroupRecord(record_field_count, group.first.keys_, results);
     DBG << "Record (" << records.size() << ") is : " << *record << "\n";
     records.push_back(std::move(record));
   }
@@ -234,6 +310,22 @@ absl::Status GroupBy::Execute(RecordSet& records) const {
   return absl::OkStatus();
 }
 
+RecordPtr GroupBy::MakeGroupRecord(
+    size_t field_count, absl::Span<const expr::Value> keys,
+    absl::Span<const expr::Value> results) const {
+  RecordPtr record = std::make_unique<Record>(field_count);
+  CHECK(groups_.size() == keys.size());
+  for (auto i = 0; i < groups_.size(); ++i) {
+    SetField(*record, *groups_[i], keys[i]);
+  }
+  CHECK(reducers_.size() == results.size());
+  agg_reducer_stages.Increment(reducers_.size());
+  for (auto i = 0; i < reducers_.size(); ++i) {
+    SetField(*record, *reducers_[i].output_, results[i]);
+  }
+  return record;
+}
+
 class Count : public GroupBy::ReducerInstance {
   size_t count_{0};
   void ProcessRecord(absl::InlinedVector<expr::Value, 4>& values) override {
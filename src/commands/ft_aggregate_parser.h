@@ -45,6 +45,10 @@ struct AggregateParameters : public expr::Expression::CompileContext,
   AggregateParameters(int db_num) : QueryCommand(db_num){};
   absl::Status ParseCommand(vmsdk::ArgsIterator& itr) override;
   void SendReply(ValkeyModuleCtx* ctx, query::SearchResult& result) override;
+  void PrepareFanout() override;
+  // Returns the plan for the shards to evaluate a leading GROUPBY, or
+  // std::nullopt when it must run on the coordinator.
+  std::optional<coordinator::PartialAggregate> MakePartialAggregate() const;
   bool loadall_{false};
   std::vector<std::string> loads_;
   bool load_key{false};
@@ -169,6 +173,9 @@ struct Attribute : expr::Expression::AttributeReference {
   void Dump(std::ostream& os) const override { os << name_; }
   expr::Value GetValue(expr::Expression::EvalContext& ctx,
                        const expr::Expression::Record& record) const override;
+  void GetValues(expr::Expression::EvalContext& ctx,
+                 absl::Span<const expr::Expression::Record* const> records,
+                 absl::Span<expr::Value> values) const override;
 };
 
 class Limit : public Stage {
@@ -254,6 +261,11 @@ class GroupBy : public Stage {
   absl::InlinedVector<std::unique_ptr<Attribute>, 4> groups_;
   absl::InlinedVector<Reducer, 4> reducers_;
 
+  // Makes the output record of a group from its keys and reducer results.
+  std::unique_ptr<Record> MakeGroupRecord(
+      size_t field_count, absl::Span<const expr::Value> keys,
+      absl::Span<const expr::Value> results) const;
+
   void Dump(std::ostream& os) const override {
     os << "GROUPBY ";
     for (auto& g : groups_) {
@@ -42,9 +42,14 @@ constexpr absl::string_view kBlockSizeParam{"BLOCK_SIZE"};
 constexpr absl::string_view kMParam{"M"};
 constexpr absl::string_view kEfConstructionParam{"EF_CONSTRUCTION"};
 constexpr absl::string_view kEfRuntimeParam{"EF_RUNTIME"};
+constexpr absl::string_view kNlistParam{"NLIST"};
+constexpr absl::string_view kPqMParam{"PQ_M"};
+constexpr absl::string_view kNprobeParam{"NPROBE"};
 constexpr absl::string_view kDimensionsParam{"DIM"};
 constexpr absl::string_view kDistanceMetricParam{"DISTANCE_METRIC"};
 constexpr absl::string_view kDataTypeParam{"TYPE"};
+constexpr absl::string_view kQuantizeParam{"QUANTIZE"};
+constexpr absl::string_view kRerankParam{"RERANK"};
 constexpr absl::string_view kPrefixParam{"PREFIX"};
 constexpr absl::string_view kFilterParam{"FILTER"};
 constexpr absl::string_view kLanguageParam{"LANGUAGE"};
@@ -68,6 +73,8 @@ constexpr int kMaxDimensionsCount{64000};
 constexpr int kMaxM{2000000};
 constexpr int kMaxEfConstruction{1000000};
 constexpr int kMaxEfRuntime{1000000};
+constexpr int kMaxNlist{65536};
+constexpr int kMaxRerankFactor{100};
 constexpr int kMaxPrefixesCount{16};
 constexpr int kMaxTagFieldLen{10000};
 constexpr int kMaxNumericFieldLen{256};
@@ -313,6 +320,12 @@ vmsdk::KeyValueParser<HNSWParameters> CreateHNSWParser() {
                                              *indexes::kDistanceMetricByStr));
   parser.AddParamParser(kInitialCapParam,
                         GENERATE_VALUE_PARSER(HNSWParameters, initial_cap));
+  parser.AddParamParser(
+      kQuantizeParam,
+      GENERATE_ENUM_PARSER(HNSWParameters, quantization,
+                           *indexes::kVectorQuantizationByStr));
+  parser.AddParamParser(kRerankParam,
+                        GENERATE_VALUE_PARSER(HNSWParameters, rerank_factor));
   parser.AddParamParser(kMParam, GENERATE_VALUE_PARSER(HNSWParameters, m));
   parser.AddParamParser(kEfConstructionParam,
                         GENERATE_VALUE_PARSER(HNSWParameters, ef_construction));
@@ -332,10 +345,35 @@ vmsdk::KeyValueParser<FlatParameters> CreateFlatParamParser() {
                                              *indexes::kDistanceMetricByStr));
   parser.AddParamParser(kInitialCapParam,
                         GENERATE_VALUE_PARSER(FlatParameters, initial_cap));
+  parser.AddParamParser(
+      kQuantizeParam,
+      GENERATE_ENUM_PARSER(FlatParameters, quantization,
+                           *indexes::kVectorQuantizationByStr));
+  parser.AddParamParser(kRerankParam,
+                        GENERATE_VALUE_PARSER(FlatParameters, rerank_factor));
   parser.AddParamParser(kBlockSizeParam,
                         GENERATE_VALUE_PARSER(FlatParameters, block_size));
   return parser;
 }
+vmsdk::KeyValueParser<IVFPQParameters> CreateIVFPQParamParser() {
+  vmsdk::KeyValueParser<IVFPQParameters> parser;
+  parser.AddParamParser(kDimensionsParam,
+                        GENERATE_VALUE_PARSER(IVFPQParameters, dimensions));
+  parser.AddParamParser(kDataTypeParam,
+                        GENERATE_ENUM_PARSER(IVFPQParameters, vector_data_type,
+                                             *indexes::kVectorDataTypeByStr));
+  parser.AddParamParser(kDistanceMetricParam,
+                        GENERATE_ENUM_PARSER(IVFPQParameters, distance_metric,
+                                             *indexes::kDistanceMetricByStr));
+  parser.AddParamParser(kInitialCapParam,
+                        GENERATE_VALUE_PARSER(IVFPQParameters, initial_cap));
+  parser.AddParamParser(kNlistParam,
+                        GENERATE_VALUE_PARSER(IVFPQParameters, nlist));
+  parser.AddParamParser(kPqMParam, GENERATE_VALUE_PARSER(IVFPQParameters, pq_m));
+  parser.AddParamParser(kNprobeParam,
+                        GENERATE_VALUE_PARSER(IVFPQParameters, nprobe));
+  return parser;
+}
 absl::Status ParseVector(vmsdk::ArgsIterator &itr,
                          data_model::Index &index_proto) {
   absl::string_view algo_str;
@@ -359,6 +397,12 @@ absl::Status ParseVector(vmsdk::ArgsIterator &itr,
     VMSDK_RETURN_IF_ERROR(parser.Parse(parameters, vector_itr));
     VMSDK_RETURN_IF_ERROR(parameters.Verify());
     index_proto.set_allocated_vector_index(parameters.ToProto().release());
+  } else if (algo == data_model::VectorIndex::kIvfPqAlgorithm) {
+    static auto parser = CreateIVFPQParamParser();
+    IVFPQParameters parameters;
+    VMSDK_RETURN_IF_ERROR(parser.Parse(parameters, vector_itr));
+    VMSDK_RETURN_IF_ERROR(parameters.Verify());
+    index_proto.set_allocated_vector_index(parameters.ToProto().release());
   } else {
     static auto parser = CreateFlatParamParser();
     FlatParameters parameters;
@@ -764,6 +808,8 @@ std::unique_ptr<data_model::VectorIndex> FTCreateVectorParameters::ToProto()
   vector_index_proto->set_distance_metric(distance_metric);
   vector_index_proto->set_vector_data_type(vector_data_type);
   vector_index_proto->set_initial_cap(initial_cap);
+  vector_index_proto->set_quantization(quantization);
+  vector_index_proto->set_rerank_factor(rerank_factor);
   return vector_index_proto;
 }
 absl::Status FTCreateVectorParameters::Verify() const {
@@ -788,6 +834,19 @@ absl::Status FTCreateVectorParameters::Verify() const {
   if (distance_metric == default_values.distance_metric) {
     return absl::InvalidArgumentError("Missing DISTANCE_METRIC parameter.");
   }
+  VMSDK_RETURN_IF_ERROR(vmsdk::VerifyRange(rerank_factor, 0, kMaxRerankFactor))
+      << kRerankParam << " must be a non-negative integer that cannot exceed "
+      << kMaxRerankFactor << ".";
+  if (rerank_factor > 0 && quantization == default_values.quantization) {
+    return absl::InvalidArgumentError(
+        absl::StrCat(kRerankParam, " requires the ", kQuantizeParam,
+                     " parameter."));
+  }
+  if (quantization != default_values.quantization &&
+      vector_data_type != data_model::VECTOR_DATA_TYPE_FLOAT32) {
+    return absl::InvalidArgumentError(
+        absl::StrCat(kQuantizeParam, " requires FLOAT32 vectors."));
+  }
   return absl::OkStatus();
 }
 std::unique_ptr<data_model::VectorIndex> HNSWParameters::ToProto() const {
@@ -830,6 +889,36 @@ std::unique_ptr<data_model::VectorIndex> FlatParameters::ToProto() const {
       flat_algorithm_proto.release());
   return vector_index_proto;
 }
+std::unique_ptr<data_model::VectorIndex> IVFPQParameters::ToProto() const {
+  auto vector_index_proto = FTCreateVectorParameters::ToProto();
+  auto ivf_pq_algorithm_proto = std::make_unique<data_model::IVFPQAlgorithm>();
+  ivf_pq_algorithm_proto->set_nlist(nlist);
+  ivf_pq_algorithm_proto->set_pq_m(pq_m);
+  ivf_pq_algorithm_proto->set_nprobe(nprobe);
+  vector_index_proto->set_allocated_ivf_pq_algorithm(
+      ivf_pq_algorithm_proto.release());
+  return vector_index_proto;
+}
+absl::Status IVFPQParameters::Verify() const {
+  VMSDK_RETURN_IF_ERROR(FTCreateVectorParameters::Verify());
+  if (vector_data_type != data_model::VECTOR_DATA_TYPE_FLOAT32) {
+    return absl::InvalidArgumentError("IVF_PQ requires FLOAT32 vectors.");
+  }
+  VMSDK_RETURN_IF_ERROR(vmsdk::VerifyRange(nlist, 1, kMaxNlist))
+      << kNlistParam
+      << " must be a positive integer greater than 0 and cannot exceed "
+      << kMaxNlist << ".";
+  VMSDK_RETURN_IF_ERROR(vmsdk::VerifyRange(nprobe, 1, nlist))
+      << kNprobeParam
+      << " must be a positive integer greater than 0 and cannot exceed "
+      << kNlistParam << ".";
+  if (pq_m < 0 || pq_m > dimensions.value() ||
+      (pq_m > 0 && dimensions.value() % pq_m != 0)) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        kPqMParam, " must be a positive divisor of the dimensions."));
+  }
+  return absl::OkStatus();
+}
 
 namespace options {
 
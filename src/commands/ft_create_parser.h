@@ -49,6 +49,11 @@ struct FTCreateVectorParameters {
   data_model::VectorDataType vector_data_type{
       data_model::VectorDataType::VECTOR_DATA_TYPE_UNSPECIFIED};
   int initial_cap{kDefaultInitialCap};
+  data_model::VectorQuantization quantization{
+      data_model::VectorQuantization::VECTOR_QUANTIZATION_NONE};
+  // Candidates fetched per neighbor and reranked with the full precision
+  // vectors. Only valid for quantized indexes, zero disables reranking.
+  int rerank_factor{0};
   absl::Status Verify() const;
   std::unique_ptr<data_model::VectorIndex> ToProto() const;
 };
@@ -74,6 +79,8 @@ constexpr int kDefaultBlockSize{1024};
 constexpr int kDefaultM{16};
 constexpr int kDefaultEFConstruction{200};
 constexpr int kDefaultEFRuntime{10};
+constexpr int kDefaultNlist{256};
+constexpr int kDefaultNprobe{8};
 
 namespace options {
 
@@ -125,6 +132,19 @@ struct FlatParameters : public FTCreateVectorParameters {
   std::unique_ptr<data_model::VectorIndex> ToProto() const;
 };
 
+struct IVFPQParameters : public FTCreateVectorParameters {
+  // Number of inverted lists the coarse quantizer partitions the vectors into.
+  int nlist{kDefaultNlist};
+  // Number of product quantizer subspaces, which must divide the dimensions.
+  // Zero picks a default from the dimensions.
+  int pq_m{0};
+  // Number of lists probed by a query, unless overridden by NPROBE at query
+  // time.
+  int nprobe{kDefaultNprobe};
+  absl::Status Verify() const;
+  std::unique_ptr<data_model::VectorIndex> ToProto() const;
+};
+
 absl::StatusOr<data_model::IndexSchema> ParseFTCreateArgs(
     ValkeyModuleCtx* ctx, ValkeyModuleString** argv, int argc);
 }  // namespace valkey_search
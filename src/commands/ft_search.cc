@@ -25,8 +25,8 @@
 #include "src/indexes/vector_base.h"
 #include "src/metrics.h"
 #include "src/query/response_generator.h"
+#include "src/query/scorer.h"
 #include "src/query/search.h"
-#include "value.h"
 #include "vmsdk/src/managed_pointers.h"
 #include "vmsdk/src/type_conversions.h"
 #include "vmsdk/src/valkey_module_api/valkey_module.h"
@@ -49,17 +49,34 @@ void ReplyAvailNeighbors(ValkeyModuleCtx *ctx,
   }
 }
 
+// Replies with the relevance score of a non-vector query neighbor.
+void ReplyRelevance(ValkeyModuleCtx *ctx, const indexes::Neighbor &neighbor) {
+  auto score_value = absl::StrFormat(
+      "%.12g", query::Scorer::FromDistance(neighbor.distance));
+  ValkeyModule_ReplyWithString(
+      ctx, vmsdk::MakeUniqueValkeyString(score_value).get());
+}
+
+bool RepliesWithScores(const SearchCommand &command) {
+  return command.with_scores && command.IsNonVectorQuery();
+}
+
 void SendReplyNoContent(ValkeyModuleCtx *ctx,
                         const query::SearchResult &search_result,
-                        const query::SearchParameters &parameters) {
+                        const SearchCommand &command) {
   const auto &neighbors = search_result.neighbors;
-  auto range = search_result.GetSerializationRange(parameters);
+  auto range = search_result.GetSerializationRange(command);
+  const bool with_scores = RepliesWithScores(command);
 
-  ValkeyModule_ReplyWithArray(ctx, range.count() + 1);
-  ReplyAvailNeighbors(ctx, search_result, parameters);
+  ValkeyModule_ReplyWithArray(ctx,
+                              (with_scores ? 2 : 1) * range.count() + 1);
+  ReplyAvailNeighbors(ctx, search_result, command);
   for (auto i = range.start_index; i < range.end_index; ++i) {
     ValkeyModule_ReplyWithString(
         ctx, vmsdk::MakeUniqueValkeyString(*neighbors[i].external_id).get());
+    if (with_scores) {
+      ReplyRelevance(ctx, neighbors[i]);
+    }
   }
 }
 
@@ -140,8 +157,10 @@ void SerializeNonVectorNeighbors(ValkeyModuleCtx *ctx,
   auto range = search_result.GetSerializationRange(command);
 
   // When with_sort_keys is true, we add an extra element per result (the sort
-  // key)
-  size_t elements_per_result = command.with_sort_keys ? 3 : 2;
+  // key), and likewise for the score when with_scores is true.
+  const bool with_scores = RepliesWithScores(command);
+  size_t elements_per_result =
+      2 + (command.with_sort_keys ? 1 : 0) + (with_scores ? 1 : 0);
   ValkeyModule_ReplyWithArray(ctx, elements_per_result * range.count() + 1);
   ReplyAvailNeighbors(ctx, search_result, command);
   for (size_t i = range.start_index; i < range.end_index; ++i) {
@@ -149,6 +168,10 @@ void SerializeNonVectorNeighbors(ValkeyModuleCtx *ctx,
     ValkeyModule_ReplyWithString(
         ctx, vmsdk::MakeUniqueValkeyString(*neighbors[i].external_id).get());
 
+    if (with_scores) {
+      ReplyRelevance(ctx, neighbors[i]);
+    }
+
     // Sort key value (prefixed with #) when WITHSORTKEYS is specified
     if (command.with_sort_keys) {
       std::string sort_key_value = GetSortKeyValue(neighbors[i], command);
@@ -191,61 +214,8 @@ void ApplySorting(std::vector<indexes::Neighbor> &neighbors,
     return;
   }
 
-  auto sortby = parameters.sortby.value();
-
-  // Check if field is a declared numeric attribute
-  auto index_result = parameters.index_schema->GetIndex(sortby.field);
-  bool is_numeric =
-      index_result.ok() &&
-      index_result.value()->GetIndexerType() == indexes::IndexerType::kNumeric;
-  auto compare = [&](const indexes::Neighbor &a,
-                     const indexes::Neighbor &b) -> bool {
-    if (!a.attribute_contents.has_value() ||
-        !b.attribute_contents.has_value()) {
-      return false;
-    }
-
-    auto it_a = a.attribute_contents->find(sortby.field);
-    auto it_b = b.attribute_contents->find(sortby.field);
-
-    if (it_a == a.attribute_contents->end()) {
-      return false;
-    }
-    if (it_b == b.attribute_contents->end()) {
-      return true;
-    }
-
-    auto str_a = vmsdk::ToStringView(it_a->second.value.get());
-    auto str_b = vmsdk::ToStringView(it_b->second.value.get());
-
-    expr::Value val_a, val_b;
-    if (is_numeric) {
-      auto num_a = vmsdk::To<double>(str_a).value_or(0.0);
-      auto num_b = vmsdk::To<double>(str_b).value_or(0.0);
-      val_a = expr::Value(num_a);
-      val_b = expr::Value(num_b);
-    } else {
-      val_a = expr::Value(str_a);
-      val_b = expr::Value(str_b);
-    }
-
-    auto cmp = expr::Compare(val_a, val_b);
-    if (cmp == expr::Ordering::kLESS) {
-      return sortby.order == query::SortOrder::kAscending;
-    }
-    if (cmp == expr::Ordering::kGREATER) {
-      return sortby.order == query::SortOrder::kDescending;
-    }
-    return false;
-  };
-
-  auto amountToKeep = parameters.limit.first_index + parameters.limit.number;
-  if (amountToKeep >= neighbors.size()) {
-    std::stable_sort(neighbors.begin(), neighbors.end(), compare);
-  } else {
-    std::partial_sort(neighbors.begin(), neighbors.begin() + amountToKeep,
-                      neighbors.end(), compare);
-  }
+  query::SortNeighbors(neighbors, *parameters.sortby, parameters,
+                       parameters.limit.first_index + parameters.limit.number);
 }
 
 // Check for scenarios that require sending an early reply.
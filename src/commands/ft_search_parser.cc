@@ -69,6 +69,10 @@ absl::Status Verify(query::SearchParameters &parameters) {
              "exceed "
           << max_ef_runtime_value << ".";
     }
+    if (parameters.nprobe.has_value() && parameters.nprobe.value() == 0) {
+      return absl::InvalidArgumentError(
+          "`NPROBE` must be a positive integer greater than 0.");
+    }
     auto max_knn_value = options::GetMaxKnn().GetValue();
     VMSDK_RETURN_IF_ERROR(vmsdk::VerifyRange(parameters.k, 1, max_knn_value))
         << "KNN parameter must be a positive integer greater than 0 and cannot "
@@ -164,6 +168,23 @@ std::unique_ptr<vmsdk::ParamParser<SearchCommand>> ConstructSortByParser() {
         return absl::OkStatus();
       });
 }
+std::unique_ptr<vmsdk::ParamParser<SearchCommand>> ConstructScorerParser() {
+  return std::make_unique<vmsdk::ParamParser<SearchCommand>>(
+      [](SearchCommand &parameters, vmsdk::ArgsIterator &itr) -> absl::Status {
+        vmsdk::UniqueValkeyString name;
+        VMSDK_RETURN_IF_ERROR(vmsdk::ParseParamValue(itr, name));
+        absl::string_view name_str = vmsdk::ToStringView(name.get());
+        if (absl::EqualsIgnoreCase(name_str, "BM25")) {
+          parameters.scorer = query::ScorerType::kBM25;
+        } else if (absl::EqualsIgnoreCase(name_str, "TFIDF")) {
+          parameters.scorer = query::ScorerType::kTFIDF;
+        } else {
+          return absl::InvalidArgumentError(
+              absl::StrCat("Unknown scorer `", name_str, "`"));
+        }
+        return absl::OkStatus();
+      });
+}
 std::unique_ptr<vmsdk::ParamParser<SearchCommand>> ConstructReturnParser() {
   return std::make_unique<vmsdk::ParamParser<SearchCommand>>(
       [](SearchCommand &parameters, vmsdk::ArgsIterator &itr) -> absl::Status {
@@ -226,6 +247,9 @@ vmsdk::KeyValueParser<SearchCommand> CreateSearchParser() {
                         GENERATE_FLAG_PARSER(SearchCommand, no_content));
   parser.AddParamParser(query::kWithSortKeysParam,
                         GENERATE_FLAG_PARSER(SearchCommand, with_sort_keys));
+  parser.AddParamParser(query::kWithScoresParam,
+                        GENERATE_FLAG_PARSER(SearchCommand, with_scores));
+  parser.AddParamParser(query::kScorerParam, ConstructScorerParser());
   parser.AddParamParser(query::kReturnParam, ConstructReturnParser());
   parser.AddParamParser(query::kSortByParam, ConstructSortByParser());
   parser.AddParamParser(query::kParamsParam, ConstructParamsParser());
@@ -251,6 +275,9 @@ absl::Status SearchCommand::PostParseQueryString() {
     VMSDK_RETURN_IF_ERROR(index_schema->GetIdentifier(sortby->field).status());
     sortby_parameter = sortby;
   }
+  if (with_scores && !scorer.has_value()) {
+    scorer = query::ScorerType::kBM25;
+  }
 
   return absl::OkStatus();
 }
@@ -270,6 +297,10 @@ absl::Status VerifyQueryString(query::SearchParameters &parameters) {
              "exceed "
           << max_ef_runtime_value << ".";
     }
+    if (parameters.nprobe.has_value() && parameters.nprobe.value() == 0) {
+      return absl::InvalidArgumentError(
+          "`NPROBE` must be a positive integer greater than 0.");
+    }
     auto max_knn_value = options::GetMaxKnn().GetValue();
     VMSDK_RETURN_IF_ERROR(vmsdk::VerifyRange(parameters.k, 1, max_knn_value))
         << "KNN parameter must be a positive integer greater than 0 and cannot "
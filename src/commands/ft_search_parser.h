@@ -38,6 +38,8 @@ struct SearchCommand : public QueryCommand {
 
   std::optional<query::SortByParameter> sortby;
   bool with_sort_keys{false};
+  // Reply with the score of every key, implies the BM25 scorer.
+  bool with_scores{false};
 };
 
 }  // namespace valkey_search
@@ -22,6 +22,7 @@
 #include "src/indexes/index_base.h"
 #include "src/indexes/numeric.h"
 #include "src/indexes/tag.h"
+#include "src/query/partial_aggregate.h"
 #include "src/query/predicate.h"
 #include "src/query/search.h"
 #include "src/schema_manager.h"
@@ -233,6 +234,9 @@ absl::Status GRPCSearchRequestToParameters(
   parameters->dialect = request.dialect();
   parameters->k = request.k();
   parameters->ef = request.ef();
+  if (request.has_nprobe()) {
+    parameters->nprobe = request.nprobe();
+  }
   parameters->limit = query::LimitParameter{request.limit().first_index(),
                                             request.limit().number()};
   parameters->no_content = request.no_content();
@@ -255,6 +259,16 @@ absl::Status GRPCSearchRequestToParameters(
   parameters->filter_parse_results.query_operations =
       static_cast<QueryOperations>(request.query_operations());
   parameters->sortby_parameter = SortByFromGRPC(request);
+  if (request.has_scorer()) {
+    parameters->scorer = request.scorer() == coordinator::SCORER_TFIDF
+                             ? query::ScorerType::kTFIDF
+                             : query::ScorerType::kBM25;
+  }
+  if (request.has_partial_aggregate()) {
+    VMSDK_RETURN_IF_ERROR(
+        query::PartialAggregator::Validate(request.partial_aggregate()));
+    parameters->partial_aggregate = request.partial_aggregate();
+  }
   return absl::OkStatus();
 }
 
@@ -385,6 +399,9 @@ std::unique_ptr<SearchIndexPartitionRequest> ParametersToGRPCSearchRequest(
   if (parameters.ef.has_value()) {
     request->set_ef(parameters.ef.value());
   }
+  if (parameters.nprobe.has_value()) {
+    request->set_nprobe(parameters.nprobe.value());
+  }
   request->mutable_limit()->set_first_index(parameters.limit.first_index);
   request->mutable_limit()->set_number(parameters.limit.number);
   request->set_timeout_ms(parameters.timeout_ms);
@@ -412,6 +429,14 @@ std::unique_ptr<SearchIndexPartitionRequest> ParametersToGRPCSearchRequest(
   request->set_query_operations(
       static_cast<uint64_t>(parameters.filter_parse_results.query_operations));
   SortByToGRPC(parameters.sortby_parameter, request.get());
+  if (parameters.scorer.has_value()) {
+    request->set_scorer(*parameters.scorer == query::ScorerType::kTFIDF
+                            ? coordinator::SCORER_TFIDF
+                            : coordinator::SCORER_BM25);
+  }
+  if (parameters.partial_aggregate.has_value()) {
+    *request->mutable_partial_aggregate() = *parameters.partial_aggregate;
+  }
   return request;
 }
 
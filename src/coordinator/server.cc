@@ -32,6 +32,8 @@
 #include "src/index_schema.h"
 #include "src/indexes/vector_base.h"
 #include "src/metrics.h"
+#include "src/query/partial_aggregate.h"
+#include "src/query/response_generator.h"
 #include "src/query/search.h"
 #include "src/schema_manager.h"
 #include "src/valkey_search.h"
@@ -147,7 +149,22 @@ class RemoteResponderSearch : public query::SearchParameters {
       RecordSearchMetrics(true, std::move(latency_sample));
       return;
     }
-    SerializeNeighbors(response, search_result.neighbors);
+    if (partial_aggregate.has_value()) {
+      query::PartialAggregator aggregator(
+          *partial_aggregate, index_schema->GetAttributeDataType().ToProto());
+      for (const auto& neighbor : search_result.neighbors) {
+        aggregator.Add(neighbor);
+      }
+      aggregator.Serialize(response->mutable_partial_groups());
+    } else {
+      if (query::SortsShardResults(*this)) {
+        // Only the top of every shard can make it into the reply, the
+        // coordinator merges the sorted runs of the shards.
+        query::KeepSortedTop(search_result.neighbors, *this);
+        response->set_sorted(true);
+      }
+      SerializeNeighbors(response, search_result.neighbors);
+    }
     response->set_total_count(search_result.total_count);
     reactor->Finish(grpc::Status::OK);
     RecordSearchMetrics(false, std::move(latency_sample));
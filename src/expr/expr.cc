@@ -6,13 +6,16 @@
 
 #include "src/expr/expr.h"
 
+#include <algorithm>
 #include <ctime>
 #include <map>
 #include <memory>
 #include <optional>
 #include <utility>
+#include <vector>
 
 #include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "src/utils/scanner.h"
 #include "vmsdk/src/status/status_macros.h"
 #include "vmsdk/src/valkey_module_api/valkey_module.h"
@@ -25,12 +28,24 @@ namespace expr {
 
 using ExprPtr = std::unique_ptr<Expression>;
 
+void Expression::EvaluateBatch(EvalContext& ctx,
+                               absl::Span<const Record* const> records,
+                               absl::Span<Value> results) const {
+  for (size_t i = 0; i < records.size(); ++i) {
+    results[i] = Evaluate(ctx, *records[i]);
+  }
+}
+
 struct Constant : Expression {
   Constant(std::string constant) : constant_(std::move(constant)) {}
   Constant(double constant) : constant_(constant) {}
   Value Evaluate(EvalContext& ctx, const Record& record) const override {
     return constant_;
   }
+  void EvaluateBatch(EvalContext& ctx, absl::Span<const Record* const> records,
+                     absl::Span<Value> results) const override {
+    std::fill(results.begin(), results.end(), constant_);
+  }
   void Dump(std::ostream& os) const override {
     os << "Constant(" << constant_ << ")";
   }
@@ -45,6 +60,10 @@ struct Parameter : Expression {
   Value Evaluate(EvalContext& ctx, const Record& record) const override {
     return value_;
   }
+  void EvaluateBatch(EvalContext& ctx, absl::Span<const Record* const> records,
+                     absl::Span<Value> results) const override {
+    std::fill(results.begin(), results.end(), value_);
+  }
   void Dump(std::ostream& os) const override {
     os << "$" << name_ << "(" << value_ << ")";
   }
@@ -61,7 +80,14 @@ struct AttributeValue : Expression {
   Value Evaluate(EvalContext& ctx, const Record& record) const override {
     return ref_->GetValue(ctx, record);
   }
+  void EvaluateBatch(EvalContext& ctx, absl::Span<const Record* const> records,
+                     absl::Span<Value> results) const override {
+    ref_->GetValues(ctx, records, results);
+  }
   void Dump(std::ostream& os) const override { os << '@' << identifier_; }
+  const AttributeReference* AsAttributeReference() const override {
+    return ref_.get();
+  }
 
  private:
   std::string identifier_;
@@ -71,11 +97,13 @@ struct AttributeValue : Expression {
 struct Not : Expression {
   Not(ExprPtr&& p) : expr_(std::move(p)) {}
   Value Evaluate(EvalContext& ctx, const Record& record) const override {
-    auto Primary = expr_->Evaluate(ctx, record).AsBool();
-    if (Primary) {
-      return Value(!*Primary);
-    } else {
-      return Value{};
+    return Negate(expr_->Evaluate(ctx, record));
+  }
+  void EvaluateBatch(EvalContext& ctx, absl::Span<const Record* const> records,
+                     absl::Span<Value> results) const override {
+    expr_->EvaluateBatch(ctx, records, results);
+    for (auto& result : results) {
+      result = Negate(result);
     }
   }
   void Dump(std::ostream& os) const override {
@@ -84,6 +112,14 @@ struct Not : Expression {
   }
 
  private:
+  static Value Negate(const Value& value) {
+    auto Primary = value.AsBool();
+    if (Primary) {
+      return Value(!*Primary);
+    } else {
+      return Value{};
+    }
+  }
   ExprPtr expr_;
 };
 
@@ -261,6 +297,15 @@ struct Dyadic : Expression {
     auto rvalue = rexpr_->Evaluate(ctx, record);
     return (*func_)(lvalue, rvalue);
   }
+  void EvaluateBatch(EvalContext& ctx, absl::Span<const Record* const> records,
+                     absl::Span<Value> results) const override {
+    std::vector<Value> rvalues(records.size());
+    lexpr_->EvaluateBatch(ctx, records, results);
+    rexpr_->EvaluateBatch(ctx, records, absl::MakeSpan(rvalues));
+    for (size_t i = 0; i < results.size(); ++i) {
+      results[i] = (*func_)(results[i], rvalues[i]);
+    }
+  }
   void Dump(std::ostream& os) const override {
     os << '(';
     lexpr_->Dump(os);
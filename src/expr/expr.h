@@ -9,6 +9,7 @@
 
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "src/expr/value.h"
 
 namespace valkey_search {
@@ -43,6 +44,14 @@ class Expression {
    public:
     virtual ~AttributeReference() = default;
     virtual Value GetValue(EvalContext& ctx, const Record& record) const = 0;
+    // Fetches the value of the attribute for a batch of records.
+    virtual void GetValues(EvalContext& ctx,
+                           absl::Span<const Record* const> records,
+                           absl::Span<Value> values) const {
+      for (size_t i = 0; i < records.size(); ++i) {
+        values[i] = GetValue(ctx, *records[i]);
+      }
+    }
     virtual void Dump(std::ostream& os) const = 0;
     friend std::ostream& operator<<(std::ostream& os,
                                     const AttributeReference* p) {
@@ -66,7 +75,22 @@ class Expression {
   static absl::StatusOr<std::unique_ptr<Expression>> Compile(
       CompileContext& ctx, absl::string_view s);
   virtual Value Evaluate(EvalContext& ctx, const Record& record) const = 0;
+  //
+  // Evaluates the expression for a batch of records into `results`, which is
+  // the size of `records`. Each node of the AST is evaluated for the whole
+  // batch before its parent, so the per-record cost is a tight loop rather
+  // than a walk of the tree.
+  //
+  virtual void EvaluateBatch(EvalContext& ctx,
+                             absl::Span<const Record* const> records,
+                             absl::Span<Value> results) const;
   virtual void Dump(std::ostream& os) const = 0;
+  //
+  // The attribute when the expression is nothing but a reference to one.
+  //
+  virtual const AttributeReference* AsAttributeReference() const {
+    return nullptr;
+  }
 
   friend std::ostream& operator<<(std::ostream& os, const Expression& e) {
     e.Dump(os);
@@ -12,6 +12,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <string>
@@ -29,6 +30,7 @@
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
 #include "absl/time/time.h"
 #include "google/protobuf/repeated_ptr_field.h"
 #include "src/attribute.h"
@@ -40,6 +42,7 @@
 #include "src/indexes/text.h"
 #include "src/indexes/vector_base.h"
 #include "src/indexes/vector_flat.h"
+#include "src/indexes/vector_ivf_pq.h"
 #include "src/indexes/vector_hnsw.h"
 #include "src/keyspace_event_manager.h"
 #include "src/metrics.h"
@@ -76,6 +79,27 @@ constexpr size_t kMaxTextFieldsCount{64};
 
 LogLevel GetLogSeverity(bool ok) { return ok ? DEBUG : WARNING; }
 
+bool IsVectorIndex(std::shared_ptr<indexes::IndexBase> index) {
+  return index->GetIndexerType() == indexes::IndexerType::kVector ||
+         index->GetIndexerType() == indexes::IndexerType::kHNSW ||
+         index->GetIndexerType() == indexes::IndexerType::kFlat ||
+         index->GetIndexerType() == indexes::IndexerType::kIVFPQ;
+}
+
+// Text attributes are indexed by the text index schema one key at a time, the
+// other indexes accept the records of many keys at once.
+bool IsBatchableIndex(std::shared_ptr<indexes::IndexBase> index) {
+  return IsVectorIndex(index) ||
+         index->GetIndexerType() == indexes::IndexerType::kNumeric ||
+         index->GetIndexerType() == indexes::IndexerType::kTag;
+}
+
+// Indexes whose records are saved to the RDB by SaveRecords.
+bool HasSavedRecords(std::shared_ptr<indexes::IndexBase> index) {
+  return index->GetIndexerType() == indexes::IndexerType::kNumeric ||
+         index->GetIndexerType() == indexes::IndexerType::kTag;
+}
+
 //
 // Controls and stats for V2 RDB file
 //
@@ -85,6 +109,10 @@ static auto config_rdb_read_v2 =
     vmsdk::config::BooleanBuilder("rdb-read-v2", true).Dev().Build();
 static auto config_rdb_validate_on_write =
     vmsdk::config::BooleanBuilder("rdb-validate-on-write", false).Dev().Build();
+static auto config_rdb_save_index_records =
+    vmsdk::config::BooleanBuilder("rdb-save-index-records", true).Dev().Build();
+static auto config_rdb_parallel_load =
+    vmsdk::config::BooleanBuilder("rdb-parallel-load", true).Dev().Build();
 
 namespace options {
 const vmsdk::config::Boolean &GetRdbWriteV2() {
@@ -110,8 +138,20 @@ static bool RDBValidateOnWrite() {
       .GetValue();
 }
 
+static bool RDBSaveIndexRecords() {
+  return dynamic_cast<vmsdk::config::Boolean &>(*config_rdb_save_index_records)
+      .GetValue();
+}
+
+static bool RDBParallelLoad() {
+  return dynamic_cast<vmsdk::config::Boolean &>(*config_rdb_parallel_load)
+      .GetValue();
+}
+
 DEV_INTEGER_COUNTER(rdb_stats, rdb_save_keys);
 DEV_INTEGER_COUNTER(rdb_stats, rdb_load_keys);
+DEV_INTEGER_COUNTER(rdb_stats, rdb_load_restored_keys);
+DEV_INTEGER_COUNTER(rdb_stats, rdb_load_parallel_sections);
 DEV_INTEGER_COUNTER(rdb_stats, rdb_save_sections);
 DEV_INTEGER_COUNTER(rdb_stats, rdb_load_sections);
 DEV_INTEGER_COUNTER(rdb_stats, rdb_load_sections_skipped);
@@ -133,17 +173,22 @@ IndexSchema::BackfillJob::BackfillJob(ValkeyModuleCtx *ctx,
       << vmsdk::config::RedactIfNeeded(name) << " (size: " << db_size << ")";
 }
 
-absl::StatusOr<std::shared_ptr<indexes::IndexBase>> IndexFactory(
+// Creates the index of `attribute`, loading its contents from `iter` if
+// provided. Vector indexes only read the index schema, so that their contents
+// can be loaded off the main thread.
+absl::StatusOr<std::shared_ptr<indexes::IndexBase>> CreateIndex(
     ValkeyModuleCtx *ctx, IndexSchema *index_schema,
     const data_model::Attribute &attribute,
     std::optional<SupplementalContentChunkIter> iter) {
   const auto &index = attribute.index();
   switch (index.index_type_case()) {
     case data_model::Index::IndexTypeCase::kTagIndex: {
-      return std::make_shared<indexes::Tag>(index.tag_index());
+      return std::make_shared<indexes::Tag>(index.tag_index(),
+                                            index_schema->GetDocIdMap());
     }
     case data_model::Index::IndexTypeCase::kNumericIndex: {
-      return std::make_shared<indexes::Numeric>(index.numeric_index());
+      return std::make_shared<indexes::Numeric>(index.numeric_index(),
+                                                index_schema->GetDocIdMap());
     }
     case data_model::Index::IndexTypeCase::kTextIndex: {
       // Create the TextIndexSchema if this is the first Text index we're seeing
@@ -157,7 +202,11 @@ absl::StatusOr<std::shared_ptr<indexes::IndexBase>> IndexFactory(
       switch (index.vector_index().algorithm_case()) {
         case data_model::VectorIndex::kHnswAlgorithm: {
           switch (index.vector_index().vector_data_type()) {
-            case data_model::VECTOR_DATA_TYPE_FLOAT32: {
+            // The template argument is the distance type, the element type
+            // is handled by the space of the index.
+            case data_model::VECTOR_DATA_TYPE_FLOAT32:
+            case data_model::VECTOR_DATA_TYPE_FLOAT16:
+            case data_model::VECTOR_DATA_TYPE_BFLOAT16: {
               VMSDK_ASSIGN_OR_RETURN(
                   auto index,
                   (iter.has_value())
@@ -168,8 +217,6 @@ absl::StatusOr<std::shared_ptr<indexes::IndexBase>> IndexFactory(
                       : indexes::VectorHNSW<float>::Create(
                             index.vector_index(), attribute.identifier(),
                             index_schema->GetAttributeDataType().ToProto()));
-              index_schema->SubscribeToVectorExternalizer(
-                  attribute.identifier(), index.get());
               return index;
             }
             default: {
@@ -180,7 +227,9 @@ absl::StatusOr<std::shared_ptr<indexes::IndexBase>> IndexFactory(
         }
         case data_model::VectorIndex::kFlatAlgorithm: {
           switch (index.vector_index().vector_data_type()) {
-            case data_model::VECTOR_DATA_TYPE_FLOAT32: {
+            case data_model::VECTOR_DATA_TYPE_FLOAT32:
+            case data_model::VECTOR_DATA_TYPE_FLOAT16:
+            case data_model::VECTOR_DATA_TYPE_BFLOAT16: {
               // TODO: Create an empty index in case of an error
               // loading the index contents from RDB.
               VMSDK_ASSIGN_OR_RETURN(
@@ -193,8 +242,6 @@ absl::StatusOr<std::shared_ptr<indexes::IndexBase>> IndexFactory(
                       : indexes::VectorFlat<float>::Create(
                             index.vector_index(), attribute.identifier(),
                             index_schema->GetAttributeDataType().ToProto()));
-              index_schema->SubscribeToVectorExternalizer(
-                  attribute.identifier(), index.get());
               return index;
             }
             default: {
@@ -203,6 +250,23 @@ absl::StatusOr<std::shared_ptr<indexes::IndexBase>> IndexFactory(
             }
           }
         }
+        case data_model::VectorIndex::kIvfPqAlgorithm: {
+          if (index.vector_index().vector_data_type() !=
+              data_model::VECTOR_DATA_TYPE_FLOAT32) {
+            return absl::InvalidArgumentError("Unsupported vector data type.");
+          }
+          VMSDK_ASSIGN_OR_RETURN(
+              auto index,
+              (iter.has_value())
+                  ? indexes::VectorIVFPQ<float>::LoadFromRDB(
+                        ctx, &index_schema->GetAttributeDataType(),
+                        index.vector_index(), attribute.identifier(),
+                        std::move(*iter))
+                  : indexes::VectorIVFPQ<float>::Create(
+                        index.vector_index(), attribute.identifier(),
+                        index_schema->GetAttributeDataType().ToProto()));
+          return index;
+        }
         default: {
           return absl::InvalidArgumentError("Unsupported algorithm.");
         }
@@ -215,6 +279,31 @@ absl::StatusOr<std::shared_ptr<indexes::IndexBase>> IndexFactory(
   }
 }
 
+// Quantized HNSW and flat indexes only hold the vectors stored in the
+// keyspace when reranking is enabled, IVFPQ indexes always hold them.
+void MaybeSubscribeToVectorExternalizer(
+    IndexSchema *index_schema, const data_model::Attribute &attribute,
+    const std::shared_ptr<indexes::IndexBase> &index) {
+  if (!IsVectorIndex(index)) {
+    return;
+  }
+  auto vector_index = dynamic_cast<indexes::VectorBase *>(index.get());
+  if (vector_index->HasFullPrecisionValues()) {
+    index_schema->SubscribeToVectorExternalizer(attribute.identifier(),
+                                                vector_index);
+  }
+}
+
+absl::StatusOr<std::shared_ptr<indexes::IndexBase>> IndexFactory(
+    ValkeyModuleCtx *ctx, IndexSchema *index_schema,
+    const data_model::Attribute &attribute,
+    std::optional<SupplementalContentChunkIter> iter) {
+  VMSDK_ASSIGN_OR_RETURN(
+      auto index, CreateIndex(ctx, index_schema, attribute, std::move(iter)));
+  MaybeSubscribeToVectorExternalizer(index_schema, attribute, index);
+  return index;
+}
+
 absl::StatusOr<std::shared_ptr<IndexSchema>> IndexSchema::Create(
     ValkeyModuleCtx *ctx, const data_model::IndexSchema &index_schema_proto,
     vmsdk::ThreadPool *mutations_thread_pool, bool skip_attributes,
@@ -258,6 +347,11 @@ absl::StatusOr<std::shared_ptr<IndexSchema>> IndexSchema::Create(
           res->AddIndex(attribute.alias(), attribute.identifier(), index));
     }
   }
+  if (reload && !skip_attributes) {
+    // The index contents were not loaded from the RDB, so the HNSW graphs are
+    // built from scratch by the backfill.
+    res->SetHNSWIndexesBuilding(ctx, true);
+  }
   if (!reload && index_schema_proto.skip_initial_scan()) {
     // Creating a new Index with SkipInitialScan. Mark the backfill as done
     // since we are skipping it.
@@ -299,7 +393,8 @@ IndexSchema::IndexSchema(ValkeyModuleCtx *ctx,
                          ? index_schema_proto.min_stem_size()
                          : 4),
       mutations_thread_pool_(mutations_thread_pool),
-      time_sliced_mutex_(CreateMrmwMutexOptions()) {
+      time_sliced_mutex_(CreateMrmwMutexOptions()),
+      time_slice_controller_(CreateMrmwMutexOptions()) {
   ValkeyModule_SelectDb(detached_ctx_.get(), db_num_);
   if (index_schema_proto.subscribed_key_prefixes().empty()) {
     subscribed_key_prefixes_.push_back("");
@@ -513,10 +608,17 @@ void TrackResults(
 void IndexSchema::OnKeyspaceNotification(ValkeyModuleCtx *ctx, int type,
                                          const char *event,
                                          ValkeyModuleString *key) {
+  KeyspaceDocument document(ctx, key);
+  OnKeyspaceNotification(ctx, type, event, document);
+}
+
+void IndexSchema::OnKeyspaceNotification(ValkeyModuleCtx *ctx, int type,
+                                         const char *event,
+                                         KeyspaceDocument &document) {
   if (ABSL_PREDICT_FALSE(!IsInCurrentDB(ctx))) {
     return;
   }
-  ProcessKeyspaceNotification(ctx, key, false);
+  ProcessKeyspaceNotification(ctx, document, false);
 }
 
 bool AddAttributeData(IndexSchema::MutatedAttributes &mutated_attributes,
@@ -541,22 +643,34 @@ bool AddAttributeData(IndexSchema::MutatedAttributes &mutated_attributes,
   return true;
 }
 
-void IndexSchema::ProcessKeyspaceNotification(ValkeyModuleCtx *ctx,
-                                              ValkeyModuleString *key,
-                                              bool from_backfill) {
-  auto key_cstr = vmsdk::ToStringView(key);
-  if (key_cstr.empty()) {
+void IndexSchema::ProcessKeyspaceNotification(
+    ValkeyModuleCtx *ctx, KeyspaceDocument &document, bool from_backfill,
+    const absl::flat_hash_set<std::string> *indexed_attributes) {
+  if (document.GetKeyView().empty()) {
     return;
   }
-  auto key_obj = vmsdk::MakeUniqueValkeyOpenKey(
-      ctx, key, VALKEYMODULE_OPEN_KEY_NOEFFECTS | VALKEYMODULE_READ);
+  // The key is opened and interned once for all the schemas notified of it.
+  ValkeyModuleKey *key_obj = document.GetOpenKey();
   // Fail fast if the key type does not match the data type.
-  if (key_obj && !GetAttributeDataType().IsProperType(key_obj.get())) {
+  if (key_obj && !GetAttributeDataType().IsProperType(key_obj)) {
     return;
   }
   MutatedAttributes mutated_attributes;
   bool added = false;
-  auto interned_key = StringInternStore::Intern(key_cstr);
+  const auto &interned_key = document.GetInternedKey();
+  // Fetch the records of all the attributes at once, a single scan of the key
+  // is cheaper than many lookups for wide schemas.
+  auto &fetched_records = fetched_records_.Get();
+  fetched_records.clear();
+  if (key_obj) {
+    for (const auto &attribute_itr : attributes_) {
+      ++fetched_records[attribute_itr.second.GetIdentifier()].uses;
+    }
+    document.GetRecords(
+        *attribute_data_type_,
+        attributes_.size() >= options::GetHashScanMinAttributes().GetValue(),
+        fetched_records);
+  }
   for (const auto &attribute_itr : attributes_) {
     auto &attribute = attribute_itr.second;
     if (!key_obj) {
@@ -565,10 +679,14 @@ void IndexSchema::ProcessKeyspaceNotification(ValkeyModuleCtx *ctx,
           nullptr, indexes::DeletionType::kRecord};
       continue;
     }
-    bool is_module_owned;
-    vmsdk::UniqueValkeyString record = VectorExternalizer::Instance().GetRecord(
-        ctx, attribute_data_type_.get(), key_obj.get(), key_cstr,
-        attribute.GetIdentifier(), is_module_owned);
+    auto &fetched = fetched_records[attribute.GetIdentifier()];
+    bool is_module_owned = fetched.is_module_owned;
+    // Attributes indexing the same identifier get their own copy.
+    vmsdk::UniqueValkeyString record =
+        --fetched.uses == 0 || !fetched.record
+            ? std::move(fetched.record)
+            : vmsdk::MakeUniqueValkeyString(
+                  vmsdk::ToStringView(fetched.record.get()));
     // Early return on record not found just if the record not tracked.
     // Otherwise, it will be processed as a delete
     if (!record && !attribute.GetIndex()->IsTracked(interned_key) &&
@@ -584,6 +702,10 @@ void IndexSchema::ProcessKeyspaceNotification(ValkeyModuleCtx *ctx,
     if (AddAttributeData(mutated_attributes, attribute, *attribute_data_type_,
                          std::move(record))) {
       added = true;
+      if (indexed_attributes &&
+          indexed_attributes->contains(attribute_itr.first)) {
+        mutated_attributes[attribute_itr.first].indexed = true;
+      }
     }
   }
   if (added) {
@@ -612,7 +734,8 @@ void IndexSchema::ProcessKeyspaceNotification(ValkeyModuleCtx *ctx,
 
 void IndexSchema::SyncProcessMutation(ValkeyModuleCtx *ctx,
                                       MutatedAttributes &mutated_attributes,
-                                      const Key &key) {
+                                      const Key &key,
+                                      RecordBatches *record_batches) {
   if (text_index_schema_) {
     // Always clean up indexed words from all text attributes of the key up
     // front
@@ -628,9 +751,13 @@ void IndexSchema::SyncProcessMutation(ValkeyModuleCtx *ctx,
         indexes::DeletionType::kNone) {
       all_deletes = false;
     }
+    if (attribute_data_itr.second.indexed) {
+      continue;
+    }
     ProcessAttributeMutation(ctx, itr->second, key,
                              std::move(attribute_data_itr.second.data),
-                             attribute_data_itr.second.deletion_type);
+                             attribute_data_itr.second.deletion_type,
+                             record_batches);
   }
   if (all_deletes) {
     // If all attributes are deletes, we can remove the key from the tracked
@@ -647,7 +774,8 @@ void IndexSchema::SyncProcessMutation(ValkeyModuleCtx *ctx,
 
 void IndexSchema::ProcessAttributeMutation(
     ValkeyModuleCtx *ctx, const Attribute &attribute, const Key &key,
-    vmsdk::UniqueValkeyString data, indexes::DeletionType deletion_type) {
+    vmsdk::UniqueValkeyString data, indexes::DeletionType deletion_type,
+    RecordBatches *record_batches) {
   auto index = attribute.GetIndex();
   if (data) {
     DCHECK(deletion_type == indexes::DeletionType::kNone);
@@ -660,32 +788,14 @@ void IndexSchema::ProcessAttributeMutation(
       }
       return;
     }
-    auto res = index->AddRecord(key, data_view);
-    TrackResults(ctx, res, "Add", stats_.subscription_add);
-
-    if (res.ok() && res.value()) {
-      ++Metrics::GetStats().time_slice_upserts;
-      // Track field type counters
-      switch (index->GetIndexerType()) {
-        case indexes::IndexerType::kVector:
-        case indexes::IndexerType::kHNSW:
-        case indexes::IndexerType::kFlat:
-          Metrics::GetStats().ingest_field_vector++;
-          break;
-        case indexes::IndexerType::kNumeric:
-          Metrics::GetStats().ingest_field_numeric++;
-          break;
-        case indexes::IndexerType::kTag:
-          Metrics::GetStats().ingest_field_tag++;
-          break;
-        case indexes::IndexerType::kText:
-          Metrics::GetStats().ingest_field_text++;
-          break;
-        default:
-          // Shouldn't happen
-          break;
-      }
+    if (record_batches && IsBatchableIndex(index)) {
+      auto &batch = (*record_batches)[attribute.GetIdentifier()];
+      batch.index = index;
+      batch.records.push_back({.key = key, .record = data_view});
+      batch.data.push_back(std::move(data));
+      return;
     }
+    TrackAddResult(ctx, *index, index->AddRecord(key, data_view));
     return;
   }
 
@@ -696,6 +806,48 @@ void IndexSchema::ProcessAttributeMutation(
   }
 }
 
+void IndexSchema::TrackAddResult(ValkeyModuleCtx *ctx,
+                                 const indexes::IndexBase &index,
+                                 const absl::StatusOr<bool> &res) {
+  TrackResults(ctx, res, "Add", stats_.subscription_add);
+
+  if (res.ok() && res.value()) {
+    ++Metrics::GetStats().time_slice_upserts;
+    // Track field type counters
+    switch (index.GetIndexerType()) {
+      case indexes::IndexerType::kVector:
+      case indexes::IndexerType::kHNSW:
+      case indexes::IndexerType::kFlat:
+      case indexes::IndexerType::kIVFPQ:
+        Metrics::GetStats().ingest_field_vector++;
+        break;
+      case indexes::IndexerType::kNumeric:
+        Metrics::GetStats().ingest_field_numeric++;
+        break;
+      case indexes::IndexerType::kTag:
+        Metrics::GetStats().ingest_field_tag++;
+        break;
+      case indexes::IndexerType::kText:
+        Metrics::GetStats().ingest_field_text++;
+        break;
+      default:
+        // Shouldn't happen
+        break;
+    }
+  }
+}
+
+void IndexSchema::ApplyRecordBatches(ValkeyModuleCtx *ctx,
+                                     RecordBatches &record_batches) {
+  for (auto &[identifier, batch] : record_batches) {
+    auto results = batch.index->AddRecords(batch.records);
+    for (const auto &res : results) {
+      TrackAddResult(ctx, *batch.index, res);
+    }
+  }
+  record_batches.clear();
+}
+
 std::unique_ptr<vmsdk::StopWatch> CreateQueueDelayCapturer() {
   std::unique_ptr<vmsdk::StopWatch> ret;
   thread_local int cnt{0};
@@ -889,10 +1041,183 @@ void IndexSchema::ProcessMutation(ValkeyModuleCtx *ctx,
     // of a multi exec command.
     return;
   }
-  const vmsdk::ThreadPool::Priority priority =
-      from_backfill ? vmsdk::ThreadPool::Priority::kLow
-                    : vmsdk::ThreadPool::Priority::kHigh;
-  ScheduleMutation(from_backfill, interned_key, priority, nullptr);
+  if (ABSL_PREDICT_FALSE(from_backfill)) {
+    // Backfilled keys are indexed in batches, see ScheduleBackfillBatch.
+    auto &backfill_batch = backfill_batch_.Get();
+    backfill_batch.push_back(interned_key);
+    if (backfill_batch.size() >=
+        options::GetBackfillMutationBatchSize().GetValue()) {
+      ScheduleBackfillBatch();
+    }
+    return;
+  }
+  EnqueuePendingMutation(ctx, interned_key);
+}
+
+void IndexSchema::EnqueuePendingMutation(ValkeyModuleCtx *ctx,
+                                         const Key &key) {
+  {
+    absl::MutexLock lock(&stats_.mutex_);
+    ++stats_.mutation_queue_size_;
+  }
+  {
+    absl::MutexLock lock(&pending_mutations_mutex_);
+    pending_mutations_.push_back(PendingMutation{
+        .key = key, .delay_capturer = CreateQueueDelayCapturer()});
+    // Running drains pick the key up, so that keys queued during a burst are
+    // indexed in groups rather than by a task each.
+    if (active_mutation_drains_ >= mutations_thread_pool_->Size()) {
+      return;
+    }
+    ++active_mutation_drains_;
+  }
+  if (ABSL_PREDICT_TRUE(SchedulePendingMutationsDrain())) {
+    return;
+  }
+  {
+    absl::MutexLock lock(&pending_mutations_mutex_);
+    --active_mutation_drains_;
+    // A drain that was already running may have taken the key.
+    auto itr = std::find_if(
+        pending_mutations_.rbegin(), pending_mutations_.rend(),
+        [&key](const PendingMutation &pending) { return pending.key == key; });
+    if (itr == pending_mutations_.rend()) {
+      return;
+    }
+    pending_mutations_.erase(std::next(itr).base());
+  }
+  // Otherwise the key is indexed inline rather than left pending until an
+  // unrelated mutation schedules a drain.
+  ProcessMutationBatch(ctx, {key});
+  absl::MutexLock lock(&stats_.mutex_);
+  --stats_.mutation_queue_size_;
+}
+
+bool IndexSchema::SchedulePendingMutationsDrain() {
+  return mutations_thread_pool_->Schedule(
+      [weak_index_schema = GetWeakPtr(), ctx = detached_ctx_.get()]() {
+        PAUSEPOINT("block_mutation_queue");
+        auto index_schema = weak_index_schema.lock();
+        // index_schema will be nullptr if the index schema has already been
+        // destructed
+        if (ABSL_PREDICT_FALSE(!index_schema)) {
+          return;
+        }
+        index_schema->DrainPendingMutations(ctx);
+      },
+      vmsdk::ThreadPool::Priority::kHigh);
+}
+
+void IndexSchema::DrainPendingMutations(ValkeyModuleCtx *ctx) {
+  std::vector<Key> keys;
+  std::unique_ptr<vmsdk::StopWatch> delay_capturer;
+  {
+    absl::MutexLock lock(&pending_mutations_mutex_);
+    const size_t batch_size =
+        std::min<size_t>(pending_mutations_.size(),
+                         options::GetMutationGroupCommitSize().GetValue());
+    if (batch_size == 0) {
+      --active_mutation_drains_;
+      return;
+    }
+    keys.reserve(batch_size);
+    for (size_t i = 0; i < batch_size; ++i) {
+      auto &pending = pending_mutations_.front();
+      if (!delay_capturer) {
+        delay_capturer = std::move(pending.delay_capturer);
+      }
+      keys.push_back(std::move(pending.key));
+      pending_mutations_.pop_front();
+    }
+  }
+  ProcessMutationBatch(ctx, keys);
+  {
+    absl::MutexLock lock(&stats_.mutex_);
+    stats_.mutation_queue_size_ -= keys.size();
+    if (ABSL_PREDICT_FALSE(delay_capturer)) {
+      stats_.mutations_queue_delay_ = delay_capturer->Duration();
+    }
+  }
+  {
+    absl::MutexLock lock(&pending_mutations_mutex_);
+    if (pending_mutations_.empty()) {
+      --active_mutation_drains_;
+      return;
+    }
+  }
+  // Go through the queue again rather than looping, so that the other tasks
+  // of the pool aren't starved by a long burst.
+  if (ABSL_PREDICT_FALSE(!SchedulePendingMutationsDrain())) {
+    absl::MutexLock lock(&pending_mutations_mutex_);
+    --active_mutation_drains_;
+  }
+}
+
+void IndexSchema::ScheduleBackfillBatch() {
+  auto &backfill_batch = backfill_batch_.Get();
+  if (backfill_batch.empty()) {
+    return;
+  }
+  {
+    absl::MutexLock lock(&stats_.mutex_);
+    stats_.mutation_queue_size_ += backfill_batch.size();
+    stats_.backfill_inqueue_tasks += backfill_batch.size();
+  }
+  mutations_thread_pool_->Schedule(
+      [weak_index_schema = GetWeakPtr(), ctx = detached_ctx_.get(),
+       delay_capturer = CreateQueueDelayCapturer(),
+       keys = std::exchange(backfill_batch, {})]() mutable {
+        PAUSEPOINT("block_mutation_queue");
+        auto index_schema = weak_index_schema.lock();
+        // index_schema will be nullptr if the index schema has already been
+        // destructed
+        if (ABSL_PREDICT_FALSE(!index_schema)) {
+          return;
+        }
+        index_schema->ProcessBackfillBatchAsync(ctx, keys,
+                                                delay_capturer.get());
+      },
+      vmsdk::ThreadPool::Priority::kLow);
+}
+
+void IndexSchema::ProcessMutationBatch(ValkeyModuleCtx *ctx,
+                                       const std::vector<Key> &keys) {
+  PAUSEPOINT("mutation_processing");
+  vmsdk::WriterMutexLock lock(&time_sliced_mutex_);
+  // Records added to the indexes are collected across the batch and added
+  // together, so that locking, id assignment and index growth are amortized.
+  RecordBatches record_batches;
+  std::vector<Key> consumed_keys;
+  consumed_keys.reserve(keys.size());
+  for (const auto &key : keys) {
+    auto mutation_record = ConsumeTrackedMutatedAttribute(key, true);
+    if (!mutation_record.has_value()) {
+      continue;
+    }
+    SyncProcessMutation(ctx, mutation_record.value(), key, &record_batches);
+    consumed_keys.push_back(key);
+  }
+  ApplyRecordBatches(ctx, record_batches);
+  // Mutations tracked while the batch was processed are applied on top of the
+  // batch, one key at a time.
+  for (const auto &key : consumed_keys) {
+    while (auto mutation_record = ConsumeTrackedMutatedAttribute(key, false)) {
+      SyncProcessMutation(ctx, mutation_record.value(), key);
+    }
+  }
+}
+
+void IndexSchema::ProcessBackfillBatchAsync(ValkeyModuleCtx *ctx,
+                                            const std::vector<Key> &keys,
+                                            vmsdk::StopWatch *delay_capturer) {
+  ProcessMutationBatch(ctx, keys);
+
+  absl::MutexLock lock(&stats_.mutex_);
+  stats_.mutation_queue_size_ -= keys.size();
+  stats_.backfill_inqueue_tasks -= keys.size();
+  if (ABSL_PREDICT_FALSE(delay_capturer)) {
+    stats_.mutations_queue_delay_ = delay_capturer->Duration();
+  }
 }
 
 void IndexSchema::ProcessSingleMutationAsync(ValkeyModuleCtx *ctx,
@@ -933,7 +1258,8 @@ void IndexSchema::BackfillScanCallback(ValkeyModuleCtx *ctx,
                   [&key_cstr](const auto &key_prefix) {
                     return key_cstr.starts_with(key_prefix);
                   })) {
-    index_schema->ProcessKeyspaceNotification(ctx, keyname, true);
+    KeyspaceDocument document(ctx, keyname);
+    index_schema->ProcessKeyspaceNotification(ctx, document, true);
   }
 }
 
@@ -943,6 +1269,13 @@ uint32_t IndexSchema::PerformBackfill(ValkeyModuleCtx *ctx,
                                       uint32_t batch_size) {
   auto &backfill_job = backfill_job_.Get();
   if (!backfill_job.has_value() || backfill_job->IsScanDone()) {
+    if (ABSL_PREDICT_FALSE(hnsw_build_in_progress_.Get())) {
+      if (IsBackfillInProgress()) {
+        UpdateHNSWBuildProgress();
+      } else {
+        SetHNSWIndexesBuilding(ctx, false);
+      }
+    }
     return 0;
   }
 
@@ -965,6 +1298,7 @@ uint32_t IndexSchema::PerformBackfill(ValkeyModuleCtx *ctx,
     auto ctx_flags = ValkeyModule_GetContextFlags(ctx);
     if (ctx_flags & VALKEYMODULE_CTX_FLAGS_OOM) {
       backfill_job->paused_by_oom = true;
+      ScheduleBackfillBatch();
       return 0;
     }
 
@@ -983,12 +1317,53 @@ uint32_t IndexSchema::PerformBackfill(ValkeyModuleCtx *ctx,
           << absl::FormatDuration(backfill_job->stopwatch.Duration());
       uint32_t res = current_scan_count - start_scan_count;
       backfill_job->MarkScanAsDone();
+      ScheduleBackfillBatch();
       return res;
     }
   }
+  if (ABSL_PREDICT_FALSE(hnsw_build_in_progress_.Get())) {
+    UpdateHNSWBuildProgress();
+  }
+  ScheduleBackfillBatch();
   return current_scan_count - start_scan_count;
 }
 
+void IndexSchema::SetHNSWIndexesBuilding(ValkeyModuleCtx *ctx,
+                                         bool building) {
+  bool has_hnsw_index = false;
+  for (const auto &[_, attribute] : attributes_) {
+    auto index = attribute.GetIndex();
+    if (index->GetIndexerType() != indexes::IndexerType::kHNSW) {
+      continue;
+    }
+    auto hnsw_index = dynamic_cast<indexes::VectorHNSW<float> *>(index.get());
+    hnsw_index->SetBuilding(building);
+    hnsw_index->SetBuildProgress(building ? 0 : 1);
+    has_hnsw_index = true;
+  }
+  if (!has_hnsw_index) {
+    return;
+  }
+  hnsw_build_in_progress_.Get() = building;
+  VMSDK_LOG(NOTICE, ctx) << (building ? "Building" : "Finished building")
+                         << " the HNSW indexes of index schema "
+                         << vmsdk::config::RedactIfNeeded(name_);
+}
+
+void IndexSchema::UpdateHNSWBuildProgress() {
+  // The graphs are built from the keys processed by the backfill, which
+  // excludes the keys whose mutations are still queued.
+  const float progress = GetBackfillPercent();
+  for (const auto &[_, attribute] : attributes_) {
+    auto index = attribute.GetIndex();
+    if (index->GetIndexerType() != indexes::IndexerType::kHNSW) {
+      continue;
+    }
+    dynamic_cast<indexes::VectorHNSW<float> *>(index.get())
+        ->SetBuildProgress(progress);
+  }
+}
+
 float IndexSchema::GetBackfillPercent() const {
   const auto &backfill_job = backfill_job_.Get();
   if (!IsBackfillInProgress() || (backfill_job->db_size == 0)) {
@@ -1052,7 +1427,8 @@ int IndexSchema::GetVectorAttributeCount() const {
                          auto type = attr.second.GetIndex()->GetIndexerType();
                          return type == indexes::IndexerType::kVector ||
                                 type == indexes::IndexerType::kHNSW ||
-                                type == indexes::IndexerType::kFlat;
+                                type == indexes::IndexerType::kFlat ||
+                                type == indexes::IndexerType::kIVFPQ;
                        });
 }
 
@@ -1175,12 +1551,6 @@ void IndexSchema::RespondWithInfo(ValkeyModuleCtx *ctx) const {
   }
 }
 
-bool IsVectorIndex(std::shared_ptr<indexes::IndexBase> index) {
-  return index->GetIndexerType() == indexes::IndexerType::kVector ||
-         index->GetIndexerType() == indexes::IndexerType::kHNSW ||
-         index->GetIndexerType() == indexes::IndexerType::kFlat;
-}
-
 std::unique_ptr<data_model::IndexSchema> IndexSchema::ToProto() const {
   auto index_schema_proto = std::make_unique<data_model::IndexSchema>();
   index_schema_proto->set_name(this->name_);
@@ -1248,15 +1618,24 @@ absl::Status IndexSchema::RDBSave(SafeRDB *rdb) const {
   rdb_section->set_allocated_index_schema_contents(
       index_schema_proto.release());
 
+  const bool save_records = ShouldSaveIndexRecords();
+  // Keys are read again on load to rebuild the text index, which also
+  // restores their attribute infos.
+  const bool save_key_info = save_records && !text_index_schema_;
   size_t supplemental_count =
       GetAttributeCount() +
       std::count_if(attributes_.begin(), attributes_.end(),
-                    [](const auto &attribute) {
-                      return IsVectorIndex(attribute.second.GetIndex());
+                    [&](const auto &attribute) {
+                      auto index = attribute.second.GetIndex();
+                      return IsVectorIndex(index) ||
+                             (save_records && HasSavedRecords(index));
                     });
   if (RDBWriteV2()) {
     supplemental_count += 1;  // For Index Extension
   }
+  if (save_key_info) {
+    supplemental_count += 1;  // For Key Info
+  }
   rdb_section->set_supplemental_count(supplemental_count);
 
   auto rdb_section_string = rdb_section->SerializeAsString();
@@ -1268,6 +1647,13 @@ absl::Status IndexSchema::RDBSave(SafeRDB *rdb) const {
   VMSDK_LOG(NOTICE, nullptr)
       << "Starting to save " << attributes_.size() << " attributes.";
 
+  // The saved records and key infos must match the key list and the mutation
+  // queue of the index extension. A forked child has the mutation threads
+  // suspended, otherwise they are kept from indexing until the save is done.
+  std::optional<vmsdk::ReaderMutexLock> records_lock;
+  if (save_records && !is_bgsave) {
+    records_lock.emplace(&time_sliced_mutex_);
+  }
   for (auto &attribute : attributes_) {
     VMSDK_LOG(DEBUG, nullptr)
         << "Starting to save attribute: "
@@ -1298,6 +1684,24 @@ absl::Status IndexSchema::RDBSave(SafeRDB *rdb) const {
                           dynamic_cast<const indexes::VectorBase *>(
                               attribute.second.GetIndex().get()))));
     }
+
+    if (save_records && HasSavedRecords(attribute.second.GetIndex())) {
+      VMSDK_RETURN_IF_ERROR(SaveSupplementalSection(
+          rdb, data_model::SUPPLEMENTAL_CONTENT_INDEX_RECORDS,
+          [&](auto &header) {
+            header.mutable_index_records_header()->set_allocated_attribute(
+                attribute.second.ToProto().release());
+          },
+          std::bind_front(&indexes::IndexBase::SaveRecords,
+                          attribute.second.GetIndex())));
+    }
+  }
+
+  if (save_key_info) {
+    VMSDK_RETURN_IF_ERROR(SaveSupplementalSection(
+        rdb, data_model::SUPPLEMENTAL_CONTENT_KEY_INFO,
+        [&](auto &header) { header.mutable_key_info_header(); },
+        std::bind_front(&IndexSchema::SaveKeyInfo, this)));
   }
 
   if (RDBWriteV2()) {
@@ -1317,6 +1721,133 @@ absl::Status IndexSchema::RDBSave(SafeRDB *rdb) const {
   return absl::OkStatus();
 }
 
+bool IndexSchema::ShouldSaveIndexRecords() const {
+  // Keys left to the backfill aren't in the mutation queue.
+  return RDBWriteV2() && RDBSaveIndexRecords() && !IsBackfillInProgress();
+}
+
+absl::Status IndexSchema::SaveKeyInfo(RDBChunkOutputStream output) const {
+  RDBBufferedOutputStream out(output);
+  // Positions are saved along with the aliases, they may differ on load.
+  std::vector<absl::string_view> aliases(attributes_indexed_data_size_.size());
+  for (const auto &[alias, attribute] : attributes_) {
+    aliases[attribute.GetPosition()] = alias;
+  }
+  VMSDK_RETURN_IF_ERROR(out.SaveObject(aliases.size()));
+  for (auto alias : aliases) {
+    VMSDK_RETURN_IF_ERROR(out.SaveString(alias));
+  }
+  // Keys are in the order of the key list of SaveIndexExtension.
+  VMSDK_RETURN_IF_ERROR(out.SaveObject(db_key_info_.Get().size()));
+  for (const auto &[_, db_key_info] : db_key_info_.Get()) {
+    const auto &attr_info_vec = db_key_info.attr_info_vec_;
+    VMSDK_RETURN_IF_ERROR(
+        out.SaveObject(static_cast<uint16_t>(attr_info_vec.size())));
+    for (const auto &attr_info : attr_info_vec) {
+      VMSDK_RETURN_IF_ERROR(out.SaveObject(attr_info.GetPosition()));
+      VMSDK_RETURN_IF_ERROR(out.SaveObject(attr_info.GetSize()));
+    }
+  }
+  return out.Flush();
+}
+
+absl::Status IndexSchema::LoadKeyInfo(RDBChunkInputStream input) {
+  RDBBufferedInputStream in(input);
+  VMSDK_ASSIGN_OR_RETURN(auto attribute_count, in.LoadObject<size_t>());
+  // Current position of each saved one, unset if the alias is unknown.
+  std::vector<std::optional<uint16_t>> positions;
+  for (size_t i = 0; i < attribute_count; ++i) {
+    VMSDK_ASSIGN_OR_RETURN(auto alias, in.LoadString());
+    auto position = GetAttributePositionByAlias(alias);
+    positions.push_back(position.ok() ? std::optional<uint16_t>(*position)
+                                      : std::nullopt);
+  }
+  bool usable = true;
+  SavedKeyInfo key_info;
+  VMSDK_ASSIGN_OR_RETURN(auto key_count, in.LoadObject<size_t>());
+  key_info.attribute_counts.reserve(key_count);
+  for (size_t i = 0; i < key_count; ++i) {
+    VMSDK_ASSIGN_OR_RETURN(auto count, in.LoadObject<uint16_t>());
+    key_info.attribute_counts.push_back(count);
+    for (uint16_t j = 0; j < count; ++j) {
+      VMSDK_ASSIGN_OR_RETURN(auto position, in.LoadObject<uint16_t>());
+      VMSDK_ASSIGN_OR_RETURN(auto size, in.LoadObject<uint64_t>());
+      if (position >= positions.size() || !positions[position]) {
+        usable = false;
+        continue;
+      }
+      key_info.attribute_infos.emplace_back(*positions[position], size);
+    }
+  }
+  if (!in.AtEnd()) {
+    return absl::InternalError("Unexpected content after the key info");
+  }
+  if (usable) {
+    loaded_key_info_ = std::move(key_info);
+  } else {
+    VMSDK_LOG(NOTICE, nullptr) << "Key info references unknown attributes, "
+                                  "keys will be re-indexed";
+  }
+  return absl::OkStatus();
+}
+
+bool IndexSchema::CanRestoreIndexedKeys(size_t key_count) const {
+  if (!loaded_key_info_ ||
+      loaded_key_info_->attribute_counts.size() != key_count ||
+      text_index_schema_) {
+    return false;
+  }
+  // Vector indexes are always loaded along with their tracked keys.
+  return std::ranges::all_of(attributes_, [this](const auto &attribute) {
+    return IsVectorIndex(attribute.second.GetIndex()) ||
+           restored_attributes_.contains(attribute.first);
+  });
+}
+
+absl::Status IndexSchema::RestoreIndexedKeys(ValkeyModuleCtx *ctx,
+                                             RDBChunkInputStream &input,
+                                             size_t key_count) {
+  const auto &key_info = *loaded_key_info_;
+  auto &dbkeyinfo_map = db_key_info_.Get();
+  dbkeyinfo_map.reserve(dbkeyinfo_map.size() + key_count);
+  // Clients are served between batches, like between the keys re-indexed
+  // one at a time.
+  constexpr size_t kRestoreBatchSize = 1000;
+  size_t info_pos = 0;
+  for (size_t i = 0; i < key_count;) {
+    {
+      vmsdk::WriterMutexLock lock(&time_sliced_mutex_);
+      absl::MutexLock records_lock(&mutated_records_mutex_);
+      for (size_t end = std::min(key_count, i + kRestoreBatchSize); i < end;
+           ++i) {
+        VMSDK_ASSIGN_OR_RETURN(auto keyname_str, input.LoadString());
+        auto key = StringInternStore::Intern(keyname_str);
+        MutationSequenceNumber this_mutation =
+            ++schema_mutation_sequence_number_;
+        auto &dbkeyinfo = dbkeyinfo_map[key];
+        dbkeyinfo.mutation_sequence_number_ = this_mutation;
+        auto &attr_info_vec = dbkeyinfo.GetAttributeInfoVec();
+        attr_info_vec.clear();
+        for (uint16_t j = 0; j < key_info.attribute_counts[i]; ++j) {
+          const auto &attr_info = key_info.attribute_infos[info_pos++];
+          attributes_indexed_data_size_[attr_info.GetPosition()] +=
+              attr_info.GetSize();
+          attr_info_vec.push_back(attr_info);
+        }
+        // Keys whose fields were all deleted are only known to the DB.
+        if (!attr_info_vec.empty()) {
+          index_key_info_[key].mutation_sequence_number_ = this_mutation;
+        }
+      }
+    }
+    stats_.document_cnt = dbkeyinfo_map.size();
+    Metrics::GetStats().rdb_restore_current_index_keys_loaded = i;
+    ValkeyModule_Yield(ctx, VALKEYMODULE_YIELD_FLAG_CLIENTS, nullptr);
+  }
+  rdb_load_restored_keys.Increment(key_count);
+  return absl::OkStatus();
+}
+
 absl::Status IndexSchema::ValidateIndex() const {
   absl::Status status = absl::OkStatus();
   //
@@ -1475,7 +2006,18 @@ absl::Status IndexSchema::LoadIndexExtension(ValkeyModuleCtx *ctx,
   size_t keys_since_last_check = 0;
   size_t current_queue_size = 0;
 
-  for (size_t i = 0; i < key_count; ++i) {
+  // Keys whose records were loaded by the indexes are restored without
+  // being read, only the keys of the mutation queue are re-indexed. With text
+  // attributes the keys are read to rebuild the text index, the indexes
+  // loaded with their records are left as is.
+  size_t restored_keys = 0;
+  if (CanRestoreIndexedKeys(key_count)) {
+    VMSDK_LOG(NOTICE, ctx) << "Restoring keys from the saved index records";
+    VMSDK_RETURN_IF_ERROR(RestoreIndexedKeys(ctx, input, key_count));
+    restored_keys = key_count;
+  }
+  loaded_key_info_.reset();
+  for (size_t i = restored_keys; i < key_count; ++i) {
     // Batch queue size checks to reduce mutex lock overhead
     // Only check every kQueueCheckBatchSize keys, or when queue was recently
     // full
@@ -1501,7 +2043,8 @@ absl::Status IndexSchema::LoadIndexExtension(ValkeyModuleCtx *ctx,
 
     VMSDK_ASSIGN_OR_RETURN(auto keyname_str, input.LoadString());
     auto keyname = vmsdk::MakeUniqueValkeyString(keyname_str);
-    ProcessKeyspaceNotification(ctx, keyname.get(), false);
+    KeyspaceDocument document(ctx, keyname.get());
+    ProcessKeyspaceNotification(ctx, document, false, &restored_attributes_);
     ValkeyModule_Yield(ctx, VALKEYMODULE_YIELD_FLAG_CLIENTS, nullptr);
     keys_since_last_check++;
 
@@ -1530,8 +2073,10 @@ absl::Status IndexSchema::LoadIndexExtension(ValkeyModuleCtx *ctx,
                              input.LoadObject<bool>());
 
       auto keyname = vmsdk::MakeUniqueValkeyString(keyname_str);
-      ProcessKeyspaceNotification(ctx, keyname.get(), from_backfill);
+      KeyspaceDocument document(ctx, keyname.get());
+      ProcessKeyspaceNotification(ctx, document, from_backfill);
     }
+    ScheduleBackfillBatch();
     VMSDK_ASSIGN_OR_RETURN(size_t multi_count, input.LoadObject<size_t>());
     rdb_load_multi_exec_entries.Increment(multi_count);
     VMSDK_LOG(NOTICE, ctx) << "Loading Multi/Exec Entries, entries = "
@@ -1550,6 +2095,265 @@ absl::Status IndexSchema::LoadIndexExtension(ValkeyModuleCtx *ctx,
   return status;
 }
 
+// The sections of an attribute are streamed by the main thread to a single
+// task, which decodes them in order while they are read, so that the decoding
+// overlaps the reading of the RDB and attributes are decoded in parallel.
+// Reading the keyspace and adding the indexes to the index schema are left to
+// the main thread, see Join.
+class IndexSchema::ParallelAttributeLoader {
+ public:
+  ParallelAttributeLoader(IndexSchema *index_schema,
+                          vmsdk::ThreadPool *thread_pool)
+      : index_schema_(index_schema), thread_pool_(thread_pool) {}
+  // The tasks reference the pending attributes and the index schema.
+  ~ParallelAttributeLoader() {
+    CompleteCurrent();
+    WaitForTasks();
+  }
+
+  absl::Status AddIndexContent(ValkeyModuleCtx *ctx,
+                               const data_model::Attribute &attribute,
+                               SupplementalContentIter &supplemental_iter);
+  // The sections are only streamed if they follow the index content of their
+  // attribute, otherwise false is returned and the caller loads them in place
+  // after a Join.
+  absl::StatusOr<bool> AddKeyToIdMap(
+      absl::string_view alias, SupplementalContentIter &supplemental_iter);
+  absl::StatusOr<bool> AddIndexRecords(
+      absl::string_view alias, SupplementalContentIter &supplemental_iter);
+  // Waits for the pending attributes to be decoded and adds them to the index
+  // schema, in their RDB order.
+  absl::Status Join(ValkeyModuleCtx *ctx);
+
+ private:
+  struct Section {
+    data_model::SupplementalContentType type;
+    ReadAheadSafeRDB chunks{kMaxReadAheadBytes};
+  };
+  struct PendingAttribute {
+    data_model::Attribute attribute;
+    std::shared_ptr<indexes::IndexBase> index;
+    bool has_key_to_id_map = false;
+    bool has_index_records = false;
+    // Whether the decoding task is on the thread pool, otherwise it runs on
+    // the main thread once all the sections are read.
+    bool scheduled = false;
+    absl::Status status;
+    absl::Notification decoded;
+
+    absl::Mutex mutex;
+    std::vector<std::unique_ptr<Section>> sections ABSL_GUARDED_BY(mutex);
+    size_t next_section ABSL_GUARDED_BY(mutex) = 0;
+    // No more sections will be added.
+    bool complete ABSL_GUARDED_BY(mutex) = false;
+    // The task is done, the sections added from then on are dropped.
+    bool stopped ABSL_GUARDED_BY(mutex) = false;
+
+    bool HasNextSection() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex) {
+      return next_section < sections.size() || complete;
+    }
+  };
+
+  // Bounds the chunks read ahead of the decoding of a section.
+  static constexpr size_t kMaxReadAheadBytes = 16 * 1024 * 1024;
+
+  bool IsCurrent(absl::string_view alias) const {
+    return current_ && current_->attribute.alias() == alias;
+  }
+  absl::Status StreamSection(data_model::SupplementalContentType type,
+                             SupplementalContentIter &supplemental_iter);
+  static Section *NextSection(PendingAttribute &pending);
+  absl::Status DecodeSection(PendingAttribute &pending,
+                             Section &section) const;
+  absl::Status Decode(PendingAttribute &pending) const;
+  void DecodeAndNotify(PendingAttribute *pending) const;
+  void CompleteCurrent();
+  void WaitForTasks();
+
+  IndexSchema *index_schema_;
+  vmsdk::ThreadPool *thread_pool_;
+  // The attribute whose sections are being read, completed once a section of
+  // another attribute shows up.
+  std::unique_ptr<PendingAttribute> current_;
+  std::vector<std::unique_ptr<PendingAttribute>> completed_;
+};
+
+absl::Status IndexSchema::ParallelAttributeLoader::AddIndexContent(
+    ValkeyModuleCtx *ctx, const data_model::Attribute &attribute,
+    SupplementalContentIter &supplemental_iter) {
+  CompleteCurrent();
+  current_ = std::make_unique<PendingAttribute>();
+  current_->attribute = attribute;
+  if (!attribute.index().has_vector_index()) {
+    // Tag and numeric indexes have no content, text indexes are created along
+    // with the text index schema.
+    VMSDK_ASSIGN_OR_RETURN(current_->index,
+                           CreateIndex(ctx, index_schema_, attribute,
+                                       supplemental_iter.IterateChunks()));
+  }
+  auto pending = current_.get();
+  pending->scheduled = thread_pool_->Schedule(
+      [this, pending]() { DecodeAndNotify(pending); },
+      vmsdk::ThreadPool::Priority::kHigh);
+  if (!attribute.index().has_vector_index()) {
+    return absl::OkStatus();
+  }
+  return StreamSection(data_model::SUPPLEMENTAL_CONTENT_INDEX_CONTENT,
+                       supplemental_iter);
+}
+
+absl::StatusOr<bool> IndexSchema::ParallelAttributeLoader::AddKeyToIdMap(
+    absl::string_view alias, SupplementalContentIter &supplemental_iter) {
+  if (!IsCurrent(alias) || current_->has_key_to_id_map) {
+    return false;
+  }
+  current_->has_key_to_id_map = true;
+  VMSDK_RETURN_IF_ERROR(StreamSection(
+      data_model::SUPPLEMENTAL_CONTENT_KEY_TO_ID_MAP, supplemental_iter));
+  return true;
+}
+
+absl::StatusOr<bool> IndexSchema::ParallelAttributeLoader::AddIndexRecords(
+    absl::string_view alias, SupplementalContentIter &supplemental_iter) {
+  if (!IsCurrent(alias) || current_->has_index_records) {
+    return false;
+  }
+  current_->has_index_records = true;
+  VMSDK_RETURN_IF_ERROR(StreamSection(
+      data_model::SUPPLEMENTAL_CONTENT_INDEX_RECORDS, supplemental_iter));
+  return true;
+}
+
+absl::Status IndexSchema::ParallelAttributeLoader::StreamSection(
+    data_model::SupplementalContentType type,
+    SupplementalContentIter &supplemental_iter) {
+  auto section = std::make_unique<Section>();
+  section->type = type;
+  auto &chunks = section->chunks;
+  {
+    absl::MutexLock lock(&current_->mutex);
+    if (current_->stopped) {
+      chunks.StopDecoding();
+    }
+    current_->sections.push_back(std::move(section));
+  }
+  rdb_load_parallel_sections.Increment();
+  return supplemental_iter.ReadAheadChunks(chunks);
+}
+
+IndexSchema::ParallelAttributeLoader::Section *
+IndexSchema::ParallelAttributeLoader::NextSection(PendingAttribute &pending) {
+  absl::MutexLock lock(&pending.mutex);
+  pending.mutex.Await(
+      absl::Condition(&pending, &PendingAttribute::HasNextSection));
+  if (pending.next_section == pending.sections.size()) {
+    return nullptr;
+  }
+  return pending.sections[pending.next_section++].get();
+}
+
+absl::Status IndexSchema::ParallelAttributeLoader::DecodeSection(
+    PendingAttribute &pending, Section &section) const {
+  switch (section.type) {
+    case data_model::SUPPLEMENTAL_CONTENT_INDEX_CONTENT: {
+      VMSDK_ASSIGN_OR_RETURN(
+          pending.index,
+          CreateIndex(nullptr, index_schema_, pending.attribute,
+                      SupplementalContentChunkIter(&section.chunks)));
+      return absl::OkStatus();
+    }
+    case data_model::SUPPLEMENTAL_CONTENT_KEY_TO_ID_MAP: {
+      if (!IsVectorIndex(pending.index)) {
+        return absl::InternalError(
+            "Key to ID mapping found for non vector index ");
+      }
+      auto vector_index =
+          dynamic_cast<indexes::VectorBase *>(pending.index.get());
+      return vector_index->LoadKeyToIdMap(
+          SupplementalContentChunkIter(&section.chunks));
+    }
+    case data_model::SUPPLEMENTAL_CONTENT_INDEX_RECORDS:
+      return pending.index->LoadRecords(
+          RDBChunkInputStream(SupplementalContentChunkIter(&section.chunks)));
+    default:
+      return absl::InternalError("Unexpected attribute section");
+  }
+}
+
+absl::Status IndexSchema::ParallelAttributeLoader::Decode(
+    PendingAttribute &pending) const {
+  while (auto section = NextSection(pending)) {
+    auto status = DecodeSection(pending, *section);
+    // Lets the main thread read past what is left of the section.
+    section->chunks.StopDecoding();
+    VMSDK_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
+void IndexSchema::ParallelAttributeLoader::DecodeAndNotify(
+    PendingAttribute *pending) const {
+  pending->status = Decode(*pending);
+  {
+    absl::MutexLock lock(&pending->mutex);
+    pending->stopped = true;
+    for (size_t i = pending->next_section; i < pending->sections.size(); ++i) {
+      pending->sections[i]->chunks.StopDecoding();
+    }
+  }
+  pending->decoded.Notify();
+}
+
+void IndexSchema::ParallelAttributeLoader::CompleteCurrent() {
+  if (!current_) {
+    return;
+  }
+  auto pending = current_.get();
+  {
+    absl::MutexLock lock(&pending->mutex);
+    pending->complete = true;
+  }
+  completed_.push_back(std::move(current_));
+  if (!pending->scheduled) {
+    DecodeAndNotify(pending);
+  }
+}
+
+void IndexSchema::ParallelAttributeLoader::WaitForTasks() {
+  for (const auto &pending : completed_) {
+    pending->decoded.WaitForNotification();
+  }
+}
+
+absl::Status IndexSchema::ParallelAttributeLoader::Join(ValkeyModuleCtx *ctx) {
+  CompleteCurrent();
+  WaitForTasks();
+  auto completed = std::move(completed_);
+  completed_.clear();
+  for (const auto &pending : completed) {
+    VMSDK_RETURN_IF_ERROR(pending->status);
+    const auto &attribute = pending->attribute;
+    MaybeSubscribeToVectorExternalizer(index_schema_, attribute,
+                                       pending->index);
+    if (pending->has_key_to_id_map) {
+      dynamic_cast<indexes::VectorBase *>(pending->index.get())
+          ->ExternalizeTrackedKeys(ctx, &index_schema_->GetAttributeDataType());
+    }
+    VMSDK_RETURN_IF_ERROR(index_schema_->AddIndex(
+        attribute.alias(), attribute.identifier(), pending->index));
+    if (pending->has_index_records) {
+      index_schema_->restored_attributes_.insert(attribute.alias());
+    }
+  }
+  return absl::OkStatus();
+}
+
+static bool IsAttributeSection(data_model::SupplementalContentType type) {
+  return type == data_model::SUPPLEMENTAL_CONTENT_INDEX_CONTENT ||
+         type == data_model::SUPPLEMENTAL_CONTENT_KEY_TO_ID_MAP ||
+         type == data_model::SUPPLEMENTAL_CONTENT_INDEX_RECORDS;
+}
+
 // We need to iterate over the chunks to consume them
 static absl::Status SkipSupplementalContent(
     SupplementalContentIter &supplemental_iter, std::string_view reason) {
@@ -1587,6 +2391,15 @@ absl::StatusOr<std::shared_ptr<IndexSchema>> IndexSchema::LoadFromRDB(
       IndexSchema::Create(ctx, *index_schema_proto, mutations_thread_pool,
                           !load_attributes_on_create, true));
 
+  // The attributes are decoded on the mutation threads unless they are
+  // unavailable, e.g. suspended.
+  std::optional<ParallelAttributeLoader> parallel_loader;
+  if (!skip_loading_index_data && RDBParallelLoad() &&
+      mutations_thread_pool != nullptr && mutations_thread_pool->Size() > 0 &&
+      !mutations_thread_pool->IsSuspended()) {
+    parallel_loader.emplace(index_schema.get(), mutations_thread_pool);
+  }
+
   // Supplemental content will include indices and any content for them
   while (supplemental_iter.HasNext()) {
     rdb_load_sections.Increment();
@@ -1595,6 +2408,11 @@ absl::StatusOr<std::shared_ptr<IndexSchema>> IndexSchema::LoadFromRDB(
       VMSDK_RETURN_IF_ERROR(
           SkipSupplementalContent(supplemental_iter, "due to configuration"));
     } else {
+      // The other sections rely on the attributes being added.
+      if (parallel_loader &&
+          !IsAttributeSection(supplemental_content->type())) {
+        VMSDK_RETURN_IF_ERROR(parallel_loader->Join(ctx));
+      }
       switch (supplemental_content->type()) {
         case data_model::SupplementalContentType::
             SUPPLEMENTAL_CONTENT_INDEX_CONTENT: {
@@ -1603,6 +2421,11 @@ absl::StatusOr<std::shared_ptr<IndexSchema>> IndexSchema::LoadFromRDB(
           VMSDK_LOG(DEBUG, nullptr)
               << "Loading Index Content for attribute: "
               << vmsdk::config::RedactIfNeeded(attribute.alias());
+          if (parallel_loader) {
+            VMSDK_RETURN_IF_ERROR(parallel_loader->AddIndexContent(
+                ctx, attribute, supplemental_iter));
+            break;
+          }
           VMSDK_ASSIGN_OR_RETURN(
               std::shared_ptr<indexes::IndexBase> index,
               IndexFactory(ctx, index_schema.get(), attribute,
@@ -1618,6 +2441,15 @@ absl::StatusOr<std::shared_ptr<IndexSchema>> IndexSchema::LoadFromRDB(
           VMSDK_LOG(DEBUG, nullptr)
               << "Loading Key to ID Map Content for attribute: "
               << vmsdk::config::RedactIfNeeded(attribute.alias());
+          if (parallel_loader) {
+            VMSDK_ASSIGN_OR_RETURN(
+                bool read_ahead, parallel_loader->AddKeyToIdMap(
+                                     attribute.alias(), supplemental_iter));
+            if (read_ahead) {
+              break;
+            }
+            VMSDK_RETURN_IF_ERROR(parallel_loader->Join(ctx));
+          }
           VMSDK_ASSIGN_OR_RETURN(
               auto index, index_schema->GetIndex(attribute.alias()),
               _ << "Key to ID mapping found before index definition.");
@@ -1631,6 +2463,37 @@ absl::StatusOr<std::shared_ptr<IndexSchema>> IndexSchema::LoadFromRDB(
               supplemental_iter.IterateChunks()));
           break;
         }
+        case data_model::SupplementalContentType::
+            SUPPLEMENTAL_CONTENT_INDEX_RECORDS: {
+          auto &attribute =
+              supplemental_content->index_records_header().attribute();
+          VMSDK_LOG(DEBUG, nullptr)
+              << "Loading Index Records for attribute: "
+              << vmsdk::config::RedactIfNeeded(attribute.alias());
+          if (parallel_loader) {
+            VMSDK_ASSIGN_OR_RETURN(
+                bool read_ahead, parallel_loader->AddIndexRecords(
+                                     attribute.alias(), supplemental_iter));
+            if (read_ahead) {
+              break;
+            }
+            VMSDK_RETURN_IF_ERROR(parallel_loader->Join(ctx));
+          }
+          VMSDK_ASSIGN_OR_RETURN(
+              auto index, index_schema->GetIndex(attribute.alias()),
+              _ << "Index records found before index definition.");
+          VMSDK_RETURN_IF_ERROR(index->LoadRecords(
+              RDBChunkInputStream(supplemental_iter.IterateChunks())));
+          index_schema->restored_attributes_.insert(attribute.alias());
+          break;
+        }
+        case data_model::SupplementalContentType::
+            SUPPLEMENTAL_CONTENT_KEY_INFO: {
+          VMSDK_LOG(DEBUG, nullptr) << "Loading Key Info";
+          VMSDK_RETURN_IF_ERROR(index_schema->LoadKeyInfo(
+              RDBChunkInputStream(supplemental_iter.IterateChunks())));
+          break;
+        }
         case data_model::SupplementalContentType::
             SUPPLEMENTAL_CONTENT_INDEX_EXTENSION: {
           VMSDK_LOG(DEBUG, nullptr) << "Loading Mutation Queue";
@@ -1664,6 +2527,9 @@ absl::StatusOr<std::shared_ptr<IndexSchema>> IndexSchema::LoadFromRDB(
       }
     }
   }
+  if (parallel_loader) {
+    VMSDK_RETURN_IF_ERROR(parallel_loader->Join(ctx));
+  }
   VMSDK_LOG(NOTICE, ctx) << "Loaded index schema with "
                          << index_schema->GetAttributeCount() << " attributes";
   return index_schema;
@@ -1769,6 +2635,7 @@ void IndexSchema::OnLoadingEnded(ValkeyModuleCtx *ctx) {
     auto interned_key = StringInternStore::Intern(key);
     ProcessMutation(ctx, attributes, interned_key, true, true);
   }
+  ScheduleBackfillBatch();
   VMSDK_LOG(NOTICE, ctx) << "Scanned index schema "
                          << vmsdk::config::RedactIfNeeded(name_)
                          << " for stale entries in "
@@ -1834,7 +2701,7 @@ size_t IndexSchema::ComputeWeightedBufferSize(
   size_t total = 0;
   for (const auto &[alias, attr_data] : attributes) {
     size_t data_size = 0;
-    if (attr_data.data.get() != nullptr) {
+    if (attr_data.data.get() != nullptr && !attr_data.indexed) {
       data_size = vmsdk::ToStringView(attr_data.data.get()).length();
     }
     uint32_t weight = 0;
@@ -1980,11 +2847,12 @@ void IndexSchema::VectorExternalizer(const Key &key,
   if (record) {
     std::optional<float> magnitude;
     auto vector_str = vmsdk::ToStringView(record.get());
-    Key interned_vector = it->second->InternVector(vector_str, magnitude);
+    Key interned_vector =
+        it->second->InternExternalizedVector(vector_str, magnitude);
     if (interned_vector) {
       VectorExternalizer::Instance().Externalize(
           key, attribute_identifier, attribute_data_type_->ToProto(),
-          interned_vector, magnitude);
+          interned_vector, magnitude, it->second->GetVectorDataType());
     }
     return;
   }
@@ -1992,6 +2860,70 @@ void IndexSchema::VectorExternalizer(const Key &key,
                                         attribute_data_type_->ToProto());
 }
 
+void IndexSchema::PopulateSnapshotMutationSequenceNumbers(
+    std::vector<indexes::Neighbor> &neighbors) const {
+  absl::ReaderMutexLock lock(&mutated_records_mutex_);
+  size_t kept = 0;
+  for (auto &neighbor : neighbors) {
+    auto itr = index_key_info_.find(neighbor.external_id);
+    if (itr == index_key_info_.end()) {
+      continue;
+    }
+    neighbor.sequence_number = itr->second.mutation_sequence_number_;
+    if (&neighbors[kept] != &neighbor) {
+      neighbors[kept] = std::move(neighbor);
+    }
+    ++kept;
+  }
+  neighbors.erase(neighbors.begin() + kept, neighbors.end());
+}
+
+void IndexSchema::AdaptTimeSlices() {
+  uint64_t mutation_queue_size;
+  {
+    absl::MutexLock lock(&stats_.mutex_);
+    mutation_queue_size = stats_.mutation_queue_size_;
+  }
+  // The average time the read locks of the index acquired since the last
+  // update waited for a read phase.
+  const auto &wait_stats = time_sliced_mutex_.GetWaitStats(
+      vmsdk::TimeSlicedMRMWMutex::Mode::kLockRead);
+  const uint64_t read_locks = wait_stats.locks;
+  const uint64_t read_wait_microseconds = wait_stats.wait_microseconds;
+  double read_wait_ms = 0;
+  if (read_locks > last_read_locks_) {
+    read_wait_ms =
+        static_cast<double>(read_wait_microseconds -
+                            last_read_wait_microseconds_) /
+        1000 / (read_locks - last_read_locks_);
+  }
+  last_read_locks_ = read_locks;
+  last_read_wait_microseconds_ = read_wait_microseconds;
+  const double read_pressure =
+      read_wait_ms / options::GetTimeSliceReadWaitTarget().GetValue();
+  const double write_pressure =
+      static_cast<double>(mutation_queue_size) /
+      options::GetTimeSliceMutationQueueTarget().GetValue();
+  time_slice_controller_.Update(time_sliced_mutex_, read_pressure,
+                                write_pressure);
+}
+
+void IndexSchema::ResetTimeSlices() {
+  time_slice_controller_.Reset(time_sliced_mutex_);
+}
+
+std::string IndexSchema::GetTimeSliceStatsString() const {
+  using Mode = vmsdk::TimeSlicedMRMWMutex::Mode;
+  const auto &mutex = time_sliced_mutex_;
+  return absl::StrCat(
+      "switches=", mutex.GetSwitchCount(), ",read_quota_us=",
+      absl::ToInt64Microseconds(mutex.GetTimeQuota(Mode::kLockRead)),
+      ",write_quota_us=",
+      absl::ToInt64Microseconds(mutex.GetTimeQuota(Mode::kLockWrite)), ",",
+      mutex.GetPhaseStats(Mode::kLockRead).ToString("read_"), ",",
+      mutex.GetPhaseStats(Mode::kLockWrite).ToString("write_"));
+}
+
 IndexSchema::InfoIndexPartitionData IndexSchema::Stats::GetStats() const {
   absl::MutexLock lock(&mutex_);
   return InfoIndexPartitionData{
@@ -2050,13 +2982,22 @@ absl::StatusOr<vmsdk::ValkeyVersion> IndexSchema::GetMinVersion(
         "calculation");
   }
   bool has_text_index = false;
+  bool has_extended_vector_index = false;
   for (const auto &attr : unpacked->attributes()) {
     if (attr.index().has_text_index()) {
       has_text_index = true;
-      break;
+    }
+    if (attr.index().has_vector_index()) {
+      const auto &vector_index = attr.index().vector_index();
+      if (vector_index.quantization() != data_model::VECTOR_QUANTIZATION_NONE ||
+          vector_index.vector_data_type() !=
+              data_model::VECTOR_DATA_TYPE_FLOAT32 ||
+          vector_index.has_ivf_pq_algorithm()) {
+        has_extended_vector_index = true;
+      }
     }
   }
-  if (has_text_index) {
+  if (has_text_index || has_extended_vector_index) {
     return kRelease12;
   } else if (unpacked->has_db_num() && unpacked->db_num() != 0) {
     return kRelease11;
@@ -11,6 +11,7 @@
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <optional>
 #include <string>
@@ -18,6 +19,7 @@
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
@@ -33,7 +35,9 @@
 #include "src/indexes/vector_base.h"
 #include "src/keyspace_event_manager.h"
 #include "src/rdb_serialization.h"
+#include "src/utils/doc_id_map.h"
 #include "src/utils/string_interning.h"
+#include "src/vector_externalizer.h"
 #include "vmsdk/src/blocked_client.h"
 #include "vmsdk/src/command_parser.h"
 #include "vmsdk/src/managed_pointers.h"
@@ -167,11 +171,14 @@ class IndexSchema : public KeyspaceEventSubscription,
 
   void CreateTextIndexSchema() {
     text_index_schema_ = std::make_shared<indexes::text::TextIndexSchema>(
-        language_, punctuation_, with_offsets_, stop_words_, min_stem_size_);
+        language_, punctuation_, with_offsets_, stop_words_, min_stem_size_,
+        doc_id_map_);
   }
   std::shared_ptr<indexes::text::TextIndexSchema> GetTextIndexSchema() const {
     return text_index_schema_;
   }
+  // Document ids shared by the tag, numeric and text indexes of the schema.
+  std::shared_ptr<DocIdMap> GetDocIdMap() const { return doc_id_map_; }
   inline uint64_t GetFingerprint() const { return fingerprint_; }
   inline uint32_t GetVersion() const { return version_; }
 
@@ -182,6 +189,8 @@ class IndexSchema : public KeyspaceEventSubscription,
 
   void OnKeyspaceNotification(ValkeyModuleCtx *ctx, int type, const char *event,
                               ValkeyModuleString *key) override;
+  void OnKeyspaceNotification(ValkeyModuleCtx *ctx, int type, const char *event,
+                              KeyspaceDocument &document) override;
 
   uint32_t PerformBackfill(ValkeyModuleCtx *ctx, uint32_t batch_size);
 
@@ -229,6 +238,9 @@ class IndexSchema : public KeyspaceEventSubscription,
     struct AttributeData {
       vmsdk::UniqueValkeyString data;
       indexes::DeletionType deletion_type{indexes::DeletionType::kNone};
+      // The index already holds `data`, e.g. it was loaded with its records,
+      // so only the key bookkeeping is updated.
+      bool indexed{false};
     };
     std::optional<absl::flat_hash_map<std::string, AttributeData>> attributes;
     std::vector<vmsdk::BlockedClient> blocked_clients;
@@ -245,6 +257,13 @@ class IndexSchema : public KeyspaceEventSubscription,
   vmsdk::TimeSlicedMRMWMutex &GetTimeSlicedMutex() {
     return time_sliced_mutex_;
   }
+  // Adapts the time quotas of the index to the time its readers wait for a
+  // read phase and to its mutation queue, relative to the configured targets.
+  void AdaptTimeSlices();
+  // Restores the default time quotas.
+  void ResetTimeSlices();
+  // Switch count, time quotas and phase statistics of the time sliced mutex.
+  std::string GetTimeSliceStatsString() const;
   void MarkAsDestructing();
   void ProcessMultiQueue();
   void SubscribeToVectorExternalizer(absl::string_view attribute_identifier,
@@ -276,7 +295,8 @@ class IndexSchema : public KeyspaceEventSubscription,
   // REQUIRES: time_sliced_mutex_ held in read phase
   void PopulateIndexMutationSequenceNumbers(
       std::vector<indexes::Neighbor> &neighbors) const
-      ABSL_SHARED_LOCKS_REQUIRED(time_sliced_mutex_) {
+      ABSL_SHARED_LOCKS_REQUIRED(time_sliced_mutex_)
+          ABSL_NO_THREAD_SAFETY_ANALYSIS {
     for (auto &n : neighbors) {
       auto itr = index_key_info_.find(n.external_id);
       CHECK(itr != index_key_info_.end())
@@ -286,6 +306,13 @@ class IndexSchema : public KeyspaceEventSubscription,
     }
   }
 
+  // Same as PopulateIndexMutationSequenceNumbers for the results of a
+  // snapshot search, which runs outside of the read phase. Neighbors whose key
+  // was removed from the index in the meantime are dropped.
+  void PopulateSnapshotMutationSequenceNumbers(
+      std::vector<indexes::Neighbor> &neighbors) const
+      ABSL_LOCKS_EXCLUDED(mutated_records_mutex_);
+
   MutationSequenceNumber GetDbMutationSequenceNumber(const Key &key) const {
     vmsdk::VerifyMainThread();
     auto itr = db_key_info_.Get().find(key);
@@ -297,13 +324,15 @@ class IndexSchema : public KeyspaceEventSubscription,
   // Accessor for global key map (for negation queries)
   // REQUIRES: time_sliced_mutex_ held in read phase
   const IndexKeyInfoMap &GetIndexKeyInfo() const
-      ABSL_SHARED_LOCKS_REQUIRED(time_sliced_mutex_) {
+      ABSL_SHARED_LOCKS_REQUIRED(time_sliced_mutex_)
+          ABSL_NO_THREAD_SAFETY_ANALYSIS {
     return index_key_info_;
   }
 
   // REQUIRES: time_sliced_mutex_ held in read phase
   size_t GetIndexKeyInfoSize() const
-      ABSL_SHARED_LOCKS_REQUIRED(time_sliced_mutex_) {
+      ABSL_SHARED_LOCKS_REQUIRED(time_sliced_mutex_)
+          ABSL_NO_THREAD_SAFETY_ANALYSIS {
     return index_key_info_.size();
   }
 
@@ -315,7 +344,9 @@ class IndexSchema : public KeyspaceEventSubscription,
   // Unit test only
   void SetIndexMutationSequenceNumber(const Key &key,
                                       MutationSequenceNumber sequence_number)
-      ABSL_EXCLUSIVE_LOCKS_REQUIRED(time_sliced_mutex_) {
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(time_sliced_mutex_)
+          ABSL_LOCKS_EXCLUDED(mutated_records_mutex_) {
+    absl::MutexLock lock(&mutated_records_mutex_);
     index_key_info_[key].mutation_sequence_number_ = sequence_number;
   }
 
@@ -388,6 +419,7 @@ class IndexSchema : public KeyspaceEventSubscription,
   std::vector<std::string> stop_words_;
   uint32_t min_stem_size_{4};
   std::shared_ptr<indexes::text::TextIndexSchema> text_index_schema_;
+  std::shared_ptr<DocIdMap> doc_id_map_{std::make_shared<DocIdMap>()};
   // Precomputed text field information for searches
   uint64_t all_text_field_mask_{0ULL};
   uint64_t suffix_text_field_mask_{0ULL};
@@ -395,6 +427,15 @@ class IndexSchema : public KeyspaceEventSubscription,
   absl::flat_hash_set<std::string> all_text_identifiers_;
   absl::flat_hash_set<std::string> suffix_text_identifiers_;
   bool loaded_v2_{false};
+  // Attribute infos of the keys of the index extension, in the order of its
+  // key list, and the aliases of the indexes restored from their records.
+  // Only used while loading.
+  struct SavedKeyInfo {
+    std::vector<uint16_t> attribute_counts;
+    std::vector<AttributeInfo> attribute_infos;
+  };
+  std::optional<SavedKeyInfo> loaded_key_info_;
+  absl::flat_hash_set<std::string> restored_attributes_;
   uint64_t fingerprint_{0};
   uint32_t version_{0};
   bool skip_initial_scan_{false};
@@ -411,10 +452,12 @@ class IndexSchema : public KeyspaceEventSubscription,
   vmsdk::MainThreadAccessGuard<absl::flat_hash_map<Key, DbKeyInfo>>
       db_key_info_;  // Mainthread.
 
-  // For proper sequencing and thread-safety, we separate reads/writes into
-  // the corresponding time slice mutex phases. Within the write phase,
-  // exclusion is provided by mutated_records_mutex_.
-  IndexKeyInfoMap index_key_info_ ABSL_GUARDED_BY(time_sliced_mutex_);
+  // Written in the write phase of time_sliced_mutex_ while holding
+  // mutated_records_mutex_. It is read either in the read phase, which
+  // excludes every writer, or under mutated_records_mutex_ by snapshot
+  // searches running outside of the read phase. The read phase accessors opt
+  // out of the analysis, which can't express the alternative.
+  IndexKeyInfoMap index_key_info_ ABSL_GUARDED_BY(mutated_records_mutex_);
 
   struct BackfillJob {
     BackfillJob() = delete;
@@ -441,8 +484,10 @@ class IndexSchema : public KeyspaceEventSubscription,
 
   mutable Stats stats_;
 
-  void ProcessKeyspaceNotification(ValkeyModuleCtx *ctx,
-                                   ValkeyModuleString *key, bool from_backfill);
+  // The indexes of `indexed_attributes` already hold the records of the key.
+  void ProcessKeyspaceNotification(
+      ValkeyModuleCtx *ctx, KeyspaceDocument &document, bool from_backfill,
+      const absl::flat_hash_set<std::string> *indexed_attributes = nullptr);
 
   void ProcessMutation(ValkeyModuleCtx *ctx,
                        MutatedAttributes &mutated_attributes,
@@ -451,17 +496,73 @@ class IndexSchema : public KeyspaceEventSubscription,
   bool ScheduleMutation(bool from_backfill, const Key &key,
                         vmsdk::ThreadPool::Priority priority,
                         absl::BlockingCounter *blocking_counter);
+  // Schedules the pending backfilled keys as a single mutation task.
+  void ScheduleBackfillBatch();
+  void ProcessBackfillBatchAsync(ValkeyModuleCtx *ctx,
+                                 const std::vector<Key> &keys,
+                                 vmsdk::StopWatch *delay_capturer);
+  // Queues a key for the group commit of the mutation tasks. A drain task is
+  // scheduled unless every mutation thread already runs one. The key is
+  // indexed inline if the drain can't be scheduled.
+  void EnqueuePendingMutation(ValkeyModuleCtx *ctx, const Key &key)
+      ABSL_LOCKS_EXCLUDED(pending_mutations_mutex_);
+  bool SchedulePendingMutationsDrain();
+  // Indexes up to mutation-group-commit-size pending keys, then reschedules
+  // itself while keys remain pending.
+  void DrainPendingMutations(ValkeyModuleCtx *ctx)
+      ABSL_LOCKS_EXCLUDED(pending_mutations_mutex_);
+  // Applies the tracked mutations of `keys` under a single write lock. The
+  // records added by the keys are applied to each index together.
+  void ProcessMutationBatch(ValkeyModuleCtx *ctx, const std::vector<Key> &keys);
+  // Starts or ends the build of the HNSW indexes by the backfill, see
+  // VectorHNSW::SetBuilding.
+  void SetHNSWIndexesBuilding(ValkeyModuleCtx *ctx, bool building);
+  // Sets the build progress of the building HNSW indexes, see
+  // VectorHNSW::SetBuildProgress.
+  void UpdateHNSWBuildProgress();
   void EnqueueMultiMutation(const Key &key);
   void DrainMutationQueue(ValkeyModuleCtx *ctx) const
       ABSL_LOCKS_EXCLUDED(mutated_records_mutex_);
+  // Whether RDBSave writes the records of the tag and numeric indexes. Unless
+  // there are text attributes, the attribute infos of the keys are saved as
+  // well, so that the load doesn't read the keys.
+  bool ShouldSaveIndexRecords() const;
+  absl::Status SaveKeyInfo(RDBChunkOutputStream output) const;
+  absl::Status LoadKeyInfo(RDBChunkInputStream input);
+  // Whether the `key_count` keys of the index extension are restored from the
+  // loaded key info rather than read, see RestoreIndexedKeys.
+  bool CanRestoreIndexedKeys(size_t key_count) const;
+  // Adds the keys of the index extension to the schema as UpdateDbInfoKey and
+  // the mutation threads would have, the indexes having loaded their records.
+  absl::Status RestoreIndexedKeys(ValkeyModuleCtx *ctx,
+                                  RDBChunkInputStream &input,
+                                  size_t key_count);
+  // Decodes the attribute sections of LoadFromRDB on the mutation threads.
+  class ParallelAttributeLoader;
+
+  // Records to add, grouped by attribute identifier.
+  struct RecordBatch {
+    std::shared_ptr<indexes::IndexBase> index;
+    std::vector<indexes::IndexBase::Record> records;
+    // Owns the data viewed by `records`.
+    std::vector<vmsdk::UniqueValkeyString> data;
+  };
+  using RecordBatches = absl::flat_hash_map<std::string, RecordBatch>;
 
+  // When `record_batches` is set, records added to vector, numeric and tag
+  // indexes are collected into it rather than added, see ApplyRecordBatches.
   void SyncProcessMutation(ValkeyModuleCtx *ctx,
                            MutatedAttributes &mutated_attributes,
-                           const Key &key);
+                           const Key &key,
+                           RecordBatches *record_batches = nullptr);
   void ProcessAttributeMutation(ValkeyModuleCtx *ctx,
                                 const Attribute &attribute, const Key &key,
                                 vmsdk::UniqueValkeyString data,
-                                indexes::DeletionType deletion_type);
+                                indexes::DeletionType deletion_type,
+                                RecordBatches *record_batches = nullptr);
+  void ApplyRecordBatches(ValkeyModuleCtx *ctx, RecordBatches &record_batches);
+  void TrackAddResult(ValkeyModuleCtx *ctx, const indexes::IndexBase &index,
+                      const absl::StatusOr<bool> &res);
   static void BackfillScanCallback(ValkeyModuleCtx *ctx,
                                    ValkeyModuleString *keyname,
                                    ValkeyModuleKey *key, void *privdata);
@@ -514,10 +615,36 @@ class IndexSchema : public KeyspaceEventSubscription,
       ValkeyModuleCtx *ctx, const MutatedAttributes &mutated_attributes,
       const Key &interned_key, bool from_backfill, bool is_delete);
   mutable vmsdk::TimeSlicedMRMWMutex time_sliced_mutex_;
+  // Only used from the main thread.
+  vmsdk::TimeSliceController time_slice_controller_;
+  // Read lock wait statistics of the time sliced mutex as of the last
+  // AdaptTimeSlices. Only used from the main thread.
+  uint64_t last_read_locks_{0};
+  uint64_t last_read_wait_microseconds_{0};
   vmsdk::MainThreadAccessGuard<std::deque<Key>> multi_mutations_keys_;
+  // Records of the key processed by ProcessKeyspaceNotification, kept to
+  // reuse its allocation.
+  vmsdk::MainThreadAccessGuard<VectorExternalizer::FetchedRecords>
+      fetched_records_;
+  // Backfilled keys waiting to be scheduled by ScheduleBackfillBatch.
+  vmsdk::MainThreadAccessGuard<std::vector<Key>> backfill_batch_;
+  struct PendingMutation {
+    Key key;
+    std::unique_ptr<vmsdk::StopWatch> delay_capturer;
+  };
+  absl::Mutex pending_mutations_mutex_;
+  // Keys waiting to be indexed by DrainPendingMutations.
+  std::deque<PendingMutation> pending_mutations_
+      ABSL_GUARDED_BY(pending_mutations_mutex_);
+  // Number of scheduled or running DrainPendingMutations tasks.
+  size_t active_mutation_drains_ ABSL_GUARDED_BY(pending_mutations_mutex_){0};
+  // Whether the HNSW indexes are built from scratch by the ongoing backfill.
+  vmsdk::MainThreadAccessGuard<bool> hnsw_build_in_progress_{false};
   vmsdk::MainThreadAccessGuard<bool> schedule_multi_exec_processing_{false};
 
   FRIEND_TEST(IndexSchemaRDBTest, SaveAndLoad);
+  FRIEND_TEST(IndexSchemaRDBTest, SaveAndLoadInParallel);
+  FRIEND_TEST(IndexSchemaRDBTest, SaveIndexRecordsWithTextAttributes);
   FRIEND_TEST(IndexSchemaRDBTest, ComprehensiveSkipLoadTest);
   FRIEND_TEST(IndexSchemaFriendTest, ConsistencyTest);
   FRIEND_TEST(IndexSchemaFriendTest, MutatedAttributes);
@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2025, valkey-search contributors
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD 3-Clause
+ */
+
+#include "src/indexes/doc_id_set_fetcher.h"
+
+#include <memory>
+
+#include "src/indexes/index_base.h"
+
+namespace valkey_search::indexes {
+
+std::unique_ptr<EntriesFetcherIteratorBase> DocIdSetFetcher::Begin() {
+  return std::make_unique<Iterator>(doc_id_map_, doc_ids_);
+}
+
+}  // namespace valkey_search::indexes
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2025, valkey-search contributors
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD 3-Clause
+ */
+
+#ifndef VALKEYSEARCH_SRC_INDEXES_DOC_ID_SET_FETCHER_H_
+#define VALKEYSEARCH_SRC_INDEXES_DOC_ID_SET_FETCHER_H_
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "src/indexes/index_base.h"
+#include "src/utils/doc_id_bitmap.h"
+#include "src/utils/doc_id_map.h"
+#include "src/utils/string_interning.h"
+
+namespace valkey_search::indexes {
+
+// Entries fetcher over a set of document ids, typically the result of
+// intersecting/merging the postings of several tag and numeric clauses. Keys
+// are resolved through the DocIdMap of the schema, so the fetcher is only
+// valid while the indexes are read-locked.
+class DocIdSetFetcher : public EntriesFetcherBase {
+ public:
+  DocIdSetFetcher(const DocIdMap& doc_id_map, DocIdBitmap doc_ids)
+      : doc_id_map_(doc_id_map), doc_ids_(std::move(doc_ids)) {}
+
+  size_t Size() const override { return doc_ids_.size(); }
+  std::unique_ptr<EntriesFetcherIteratorBase> Begin() override;
+
+ private:
+  class Iterator : public EntriesFetcherIteratorBase {
+   public:
+    Iterator(const DocIdMap& doc_id_map, const DocIdBitmap& doc_ids)
+        : doc_id_map_(doc_id_map),
+          iter_(doc_ids.begin()),
+          end_(doc_ids.end()) {}
+
+    bool Done() const override { return iter_ == end_; }
+    void Next() override { ++iter_; }
+    const InternedStringPtr& operator*() const override {
+      return doc_id_map_.GetKey(*iter_);
+    }
+
+   private:
+    const DocIdMap& doc_id_map_;
+    DocIdBitmap::const_iterator iter_;
+    DocIdBitmap::const_iterator end_;
+  };
+
+  const DocIdMap& doc_id_map_;
+  DocIdBitmap doc_ids_;
+};
+
+}  // namespace valkey_search::indexes
+
+#endif  // VALKEYSEARCH_SRC_INDEXES_DOC_ID_SET_FETCHER_H_
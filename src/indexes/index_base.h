@@ -8,23 +8,38 @@
 #ifndef VALKEYSEARCH_SRC_INDEXES_INDEX_BASE_H
 #define VALKEYSEARCH_SRC_INDEXES_INDEX_BASE_H
 
+#include <algorithm>
 #include <cstddef>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "absl/base/no_destructor.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/functional/any_invocable.h"
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "src/index_schema.pb.h"
 #include "src/rdb_serialization.h"
 #include "src/utils/string_interning.h"
 #include "vmsdk/src/managed_pointers.h"
+#include "vmsdk/src/status/status_macros.h"
 #include "vmsdk/src/valkey_module_api/valkey_module.h"
 
 namespace valkey_search::indexes {
-enum class IndexerType { kHNSW, kFlat, kNumeric, kTag, kVector, kNone, kText };
+enum class IndexerType {
+  kHNSW,
+  kFlat,
+  kNumeric,
+  kTag,
+  kVector,
+  kNone,
+  kText,
+  kIVFPQ
+};
 
 enum class DeletionType {
   kRecord,      // The record was deleted from the index.
@@ -48,6 +63,22 @@ class IndexBase {
   // failure.
   virtual absl::StatusOr<bool> AddRecord(const InternedStringPtr& key,
                                          absl::string_view data) = 0;
+  struct Record {
+    InternedStringPtr key;
+    absl::string_view record;
+  };
+  // Adds a batch of records, returning one result per record with the same
+  // semantics as AddRecord. Indexes override it to take their locks once for
+  // the whole batch.
+  virtual std::vector<absl::StatusOr<bool>> AddRecords(
+      absl::Span<const Record> records) {
+    std::vector<absl::StatusOr<bool>> results;
+    results.reserve(records.size());
+    for (const auto& record : records) {
+      results.push_back(AddRecord(record.key, record.record));
+    }
+    return results;
+  }
   virtual absl::StatusOr<bool> RemoveRecord(const InternedStringPtr& key,
                                             DeletionType deletion_type) = 0;
   virtual absl::StatusOr<bool> ModifyRecord(const InternedStringPtr& key,
@@ -55,6 +86,15 @@ class IndexBase {
   virtual int RespondWithInfo(ValkeyModuleCtx* ctx) const = 0;
   IndexerType GetIndexerType() const { return indexer_type_; }
   virtual absl::Status SaveIndex(RDBChunkOutputStream chunked_out) const = 0;
+  // Saves the tracked and untracked keys along with their records, so that
+  // LoadRecords restores the index without reading the keys again.
+  virtual absl::Status SaveRecords(RDBChunkOutputStream chunked_out) const {
+    return absl::UnimplementedError("Index records can't be saved");
+  }
+  // Must be called on an empty index.
+  virtual absl::Status LoadRecords(RDBChunkInputStream chunked_in) {
+    return absl::UnimplementedError("Index records can't be loaded");
+  }
 
   virtual std::unique_ptr<data_model::Index> ToProto() const = 0;
 
@@ -76,6 +116,66 @@ class IndexBase {
   /// Returns the mutation weight for this index type
   virtual uint32_t GetMutationWeight() const = 0;
 
+ protected:
+  // Number of saved records added to the index at once by LoadRecordsImpl.
+  static constexpr size_t kLoadRecordsBatchSize = 1024;
+
+  // Saves the keys of `tracked`, a map from the tracked keys to their info,
+  // each followed by what `save_value` writes of its info, then the keys of
+  // `untracked`.
+  template <typename TrackedMap, typename SaveValue>
+  static absl::Status SaveRecordsImpl(RDBChunkOutputStream chunked_out,
+                                      const TrackedMap& tracked,
+                                      const InternedStringSet& untracked,
+                                      SaveValue save_value) {
+    RDBBufferedOutputStream out(chunked_out);
+    VMSDK_RETURN_IF_ERROR(out.SaveObject(tracked.size()));
+    for (const auto& [key, info] : tracked) {
+      VMSDK_RETURN_IF_ERROR(out.SaveString(key->Str()));
+      VMSDK_RETURN_IF_ERROR(save_value(out, info));
+    }
+    VMSDK_RETURN_IF_ERROR(out.SaveObject(untracked.size()));
+    for (const auto& key : untracked) {
+      VMSDK_RETURN_IF_ERROR(out.SaveString(key->Str()));
+    }
+    return out.Flush();
+  }
+  // Loads the records saved by SaveRecordsImpl. The tracked keys are handed
+  // to `add_batch` by batches of kLoadRecordsBatchSize, along with the values
+  // read by `load_value`. The untracked keys are untracked.
+  template <typename Value>
+  absl::Status LoadRecordsImpl(
+      RDBChunkInputStream chunked_in,
+      absl::FunctionRef<absl::StatusOr<Value>(RDBBufferedInputStream&)>
+          load_value,
+      absl::FunctionRef<absl::Status(
+          std::vector<std::pair<InternedStringPtr, Value>>&)>
+          add_batch) {
+    RDBBufferedInputStream in(chunked_in);
+    VMSDK_ASSIGN_OR_RETURN(auto tracked_count, in.LoadObject<size_t>());
+    std::vector<std::pair<InternedStringPtr, Value>> batch;
+    for (size_t i = 0; i < tracked_count;) {
+      batch.clear();
+      for (size_t end = std::min(tracked_count, i + kLoadRecordsBatchSize);
+           i < end; ++i) {
+        VMSDK_ASSIGN_OR_RETURN(auto key, in.LoadString());
+        auto interned_key = StringInternStore::Intern(key);
+        VMSDK_ASSIGN_OR_RETURN(auto value, load_value(in));
+        batch.emplace_back(std::move(interned_key), std::move(value));
+      }
+      VMSDK_RETURN_IF_ERROR(add_batch(batch));
+    }
+    VMSDK_ASSIGN_OR_RETURN(auto untracked_count, in.LoadObject<size_t>());
+    for (size_t i = 0; i < untracked_count; ++i) {
+      VMSDK_ASSIGN_OR_RETURN(auto key, in.LoadString());
+      UnTrack(StringInternStore::Intern(key));
+    }
+    if (!in.AtEnd()) {
+      return absl::InternalError("Unexpected content after the index records");
+    }
+    return absl::OkStatus();
+  }
+
  private:
   IndexerType indexer_type_{IndexerType::kNone};
 };
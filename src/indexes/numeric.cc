@@ -7,13 +7,17 @@
 
 #include "src/indexes/numeric.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <limits>
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -21,10 +25,15 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "src/indexes/index_base.h"
 #include "src/query/predicate.h"
+#include "src/rdb_serialization.h"
+#include "src/utils/doc_id_bitmap.h"
+#include "src/utils/doc_id_map.h"
 #include "src/utils/string_interning.h"
 #include "src/valkey_search_options.h"
+#include "vmsdk/src/status/status_macros.h"
 #include "vmsdk/src/valkey_module_api/valkey_module.h"
 
 namespace valkey_search::indexes {
@@ -38,8 +47,9 @@ std::optional<double> ParseNumber(absl::string_view data) {
 }
 }  // namespace
 
-Numeric::Numeric(const data_model::NumericIndex& numeric_index_proto)
-    : IndexBase(IndexerType::kNumeric) {
+Numeric::Numeric(const data_model::NumericIndex& numeric_index_proto,
+                 std::shared_ptr<DocIdMap> doc_ids)
+    : IndexBase(IndexerType::kNumeric), doc_ids_(std::move(doc_ids)) {
   index_ = std::make_unique<BTreeNumericIndex>();
 }
 
@@ -47,6 +57,59 @@ absl::StatusOr<bool> Numeric::AddRecord(const InternedStringPtr& key,
                                         absl::string_view data) {
   auto value = ParseNumber(data);
   absl::MutexLock lock(&index_mutex_);
+  return AddRecordLocked(key, value);
+}
+
+std::vector<absl::StatusOr<bool>> Numeric::AddRecords(
+    absl::Span<const Record> records) {
+  // Parse outside of the lock and insert in value order, so that neighboring
+  // inserts land in the same leaves of the tree.
+  std::vector<std::optional<double>> values;
+  values.reserve(records.size());
+  std::vector<size_t> order(records.size());
+  for (size_t i = 0; i < records.size(); ++i) {
+    values.push_back(ParseNumber(records[i].record));
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return values[a] < values[b];
+  });
+  std::vector<absl::StatusOr<bool>> results(records.size());
+  absl::MutexLock lock(&index_mutex_);
+  for (auto i : order) {
+    results[i] = AddRecordLocked(records[i].key, values[i]);
+  }
+  return results;
+}
+
+absl::Status Numeric::SaveRecords(RDBChunkOutputStream chunked_out) const {
+  absl::MutexLock lock(&index_mutex_);
+  return SaveRecordsImpl(
+      std::move(chunked_out), tracked_keys_, untracked_keys_,
+      [](RDBBufferedOutputStream& out, double value) {
+        return out.SaveObject(value);
+      });
+}
+
+absl::Status Numeric::LoadRecords(RDBChunkInputStream chunked_in) {
+  return LoadRecordsImpl<double>(
+      std::move(chunked_in),
+      [](RDBBufferedInputStream& in) { return in.LoadObject<double>(); },
+      [this](auto& batch) {
+        // Like AddRecords, insert in value order.
+        std::stable_sort(
+            batch.begin(), batch.end(),
+            [](const auto& a, const auto& b) { return a.second < b.second; });
+        absl::MutexLock lock(&index_mutex_);
+        for (const auto& [key, value] : batch) {
+          VMSDK_RETURN_IF_ERROR(AddRecordLocked(key, value).status());
+        }
+        return absl::OkStatus();
+      });
+}
+
+absl::StatusOr<bool> Numeric::AddRecordLocked(
+    const InternedStringPtr& key, const std::optional<double>& value) {
   if (!value.has_value()) {
     untracked_keys_.insert(key);
     return false;
@@ -57,7 +120,7 @@ absl::StatusOr<bool> Numeric::AddRecord(const InternedStringPtr& key,
         absl::StrCat("Key `", key->Str(), "` already exists"));
   }
   untracked_keys_.erase(key);
-  index_->Add(key, *value);
+  index_->Add(doc_ids_->Acquire(key), *value);
   return true;
 }
 
@@ -76,7 +139,7 @@ absl::StatusOr<bool> Numeric::ModifyRecord(const InternedStringPtr& key,
         absl::StrCat("Key `", key->Str(), "` not found"));
   }
 
-  index_->Modify(it->first, it->second, *value);
+  index_->Modify(*doc_ids_->Find(key), it->second, *value);
   it->second = *value;
   return true;
 }
@@ -96,7 +159,9 @@ absl::StatusOr<bool> Numeric::RemoveRecord(const InternedStringPtr& key,
     return false;
   }
 
-  index_->Remove(it->first, it->second);
+  const DocId doc_id = *doc_ids_->Find(key);
+  index_->Remove(doc_id, it->second);
+  doc_ids_->Release(doc_id);
   tracked_keys_.erase(it);
   return true;
 }
@@ -131,6 +196,27 @@ const double* Numeric::GetValue(const InternedStringPtr& key) const {
   return nullptr;
 }
 
+void Numeric::ForEachDocIdByValue(bool ascending,
+                                  absl::FunctionRef<bool(DocId)> fn) const {
+  // Like GetValue, relies on the index not being mutated while the time
+  // sliced mutex is in a read mode.
+  auto visit = [&fn](auto begin, auto end) {
+    for (auto it = begin; it != end; ++it) {
+      for (DocId id : it->second) {
+        if (!fn(id)) {
+          return;
+        }
+      }
+    }
+  };
+  const auto& btree = index_->GetBtree();
+  if (ascending) {
+    visit(btree.begin(), btree.end());
+  } else {
+    visit(btree.rbegin(), btree.rend());
+  }
+}
+
 std::unique_ptr<Numeric::EntriesFetcher> Numeric::Search(
     const query::NumericPredicate& predicate, bool negate) const {
   EntriesRange entries_range;
@@ -153,8 +239,8 @@ std::unique_ptr<Numeric::EntriesFetcher> Numeric::Search(
     ;
     additional_entries_range.second = btree.end();
     return std::make_unique<Numeric::EntriesFetcher>(
-        entries_range, size + untracked_keys_.size(), additional_entries_range,
-        &untracked_keys_);
+        *doc_ids_, entries_range, size + untracked_keys_.size(),
+        additional_entries_range, &untracked_keys_);
   }
 
   entries_range.first = predicate.IsStartInclusive()
@@ -166,12 +252,13 @@ std::unique_ptr<Numeric::EntriesFetcher> Numeric::Search(
   size_t size = index_->GetCount(predicate.GetStart(), predicate.GetEnd(),
                                  predicate.IsStartInclusive(),
                                  predicate.IsEndInclusive());
-  return std::make_unique<Numeric::EntriesFetcher>(entries_range, size);
+  return std::make_unique<Numeric::EntriesFetcher>(*doc_ids_, entries_range,
+                                                   size);
 }
 
 bool Numeric::EntriesFetcherIterator::NextKeys(
     const Numeric::EntriesRange& range, BTreeNumericIndex::ConstIterator& iter,
-    std::optional<InternedStringSet::const_iterator>& keys_iter) {
+    std::optional<BucketIterator>& keys_iter) {
   while (iter != range.second) {
     if (!keys_iter.has_value()) {
       keys_iter = iter->second.begin();
@@ -188,10 +275,11 @@ bool Numeric::EntriesFetcherIterator::NextKeys(
 }
 
 Numeric::EntriesFetcherIterator::EntriesFetcherIterator(
-    const EntriesRange& entries_range,
+    const DocIdMap& doc_ids, const EntriesRange& entries_range,
     const std::optional<EntriesRange>& additional_entries_range,
     const InternedStringSet* untracked_keys)
-    : entries_range_(entries_range),
+    : doc_ids_(doc_ids),
+      entries_range_(entries_range),
       entries_iter_(entries_range_.first),
       additional_entries_range_(additional_entries_range),
       untracked_keys_(untracked_keys) {
@@ -231,13 +319,13 @@ void Numeric::EntriesFetcherIterator::Next() {
 const InternedStringPtr& Numeric::EntriesFetcherIterator::operator*() const {
   if (entries_iter_ != entries_range_.second) {
     DCHECK(entry_keys_iter_ != entries_iter_->second.end());
-    return *entry_keys_iter_.value();
+    return doc_ids_.GetKey(*entry_keys_iter_.value());
   }
   if (additional_entries_range_.has_value() &&
       additional_entries_iter_ != additional_entries_range_.value().second) {
     DCHECK(additional_entry_keys_iter_ !=
            additional_entries_iter_->second.end());
-    return *additional_entry_keys_iter_.value();
+    return doc_ids_.GetKey(*additional_entry_keys_iter_.value());
   }
   DCHECK(untracked_keys_ && untracked_keys_iter_.has_value() &&
          untracked_keys_iter_ != untracked_keys_->end());
@@ -246,9 +334,25 @@ const InternedStringPtr& Numeric::EntriesFetcherIterator::operator*() const {
 
 size_t Numeric::EntriesFetcher::Size() const { return size_; }
 
+DocIdBitmap Numeric::EntriesFetcher::GetDocIds() const {
+  // A range spans many small buckets, build the union once.
+  std::vector<DocId> doc_ids;
+  doc_ids.reserve(size_);
+  for (auto it = entries_range_.first; it != entries_range_.second; ++it) {
+    doc_ids.insert(doc_ids.end(), it->second.begin(), it->second.end());
+  }
+  if (additional_entries_range_.has_value()) {
+    for (auto it = additional_entries_range_->first;
+         it != additional_entries_range_->second; ++it) {
+      doc_ids.insert(doc_ids.end(), it->second.begin(), it->second.end());
+    }
+  }
+  return DocIdBitmap::FromIds(std::move(doc_ids));
+}
+
 std::unique_ptr<EntriesFetcherIteratorBase> Numeric::EntriesFetcher::Begin() {
   auto itr = std::make_unique<EntriesFetcherIterator>(
-      entries_range_, additional_entries_range_, untracked_keys_);
+      doc_ids_, entries_range_, additional_entries_range_, untracked_keys_);
   itr->Next();
   return itr;
 }
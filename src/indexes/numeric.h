@@ -12,20 +12,25 @@
 #include <memory>
 #include <optional>
 #include <utility>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/btree_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/functional/any_invocable.h"
+#include "absl/functional/function_ref.h"
 #include "absl/hash/hash.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "src/indexes/index_base.h"
 #include "src/query/predicate.h"
 #include "src/rdb_serialization.h"
+#include "src/utils/doc_id_bitmap.h"
+#include "src/utils/doc_id_map.h"
 #include "src/utils/segment_tree.h"
 #include "src/utils/string_interning.h"
 #include "vmsdk/src/valkey_module_api/valkey_module.h"
@@ -33,10 +38,11 @@
 namespace valkey_search::indexes {
 
 template <typename T, typename Hasher = absl::Hash<T>,
-          typename Equalizer = std::equal_to<T>>
+          typename Equalizer = std::equal_to<T>,
+          typename Set = absl::flat_hash_set<T, Hasher, Equalizer>>
 class BTreeNumeric {
  public:
-  using SetType = absl::flat_hash_set<T, Hasher, Equalizer>;
+  using SetType = Set;
   using ConstIterator =
       typename absl::btree_map<double, SetType>::const_iterator;
 
@@ -80,10 +86,15 @@ class BTreeNumeric {
 
 class Numeric : public IndexBase {
  public:
-  explicit Numeric(const data_model::NumericIndex& numeric_index_proto);
+  explicit Numeric(
+      const data_model::NumericIndex& numeric_index_proto,
+      std::shared_ptr<DocIdMap> doc_ids = std::make_shared<DocIdMap>());
   absl::StatusOr<bool> AddRecord(const InternedStringPtr& key,
                                  absl::string_view data) override
       ABSL_LOCKS_EXCLUDED(index_mutex_);
+  std::vector<absl::StatusOr<bool>> AddRecords(
+      absl::Span<const Record> records) override
+      ABSL_LOCKS_EXCLUDED(index_mutex_);
   absl::StatusOr<bool> RemoveRecord(
       const InternedStringPtr& key,
       DeletionType deletion_type = DeletionType::kNone) override
@@ -96,6 +107,10 @@ class Numeric : public IndexBase {
   absl::Status SaveIndex(RDBChunkOutputStream chunked_out) const override {
     return absl::OkStatus();
   }
+  absl::Status SaveRecords(RDBChunkOutputStream chunked_out) const override
+      ABSL_LOCKS_EXCLUDED(index_mutex_);
+  absl::Status LoadRecords(RDBChunkInputStream chunked_in) override
+      ABSL_LOCKS_EXCLUDED(index_mutex_);
 
   size_t GetTrackedKeyCount() const override ABSL_LOCKS_EXCLUDED(index_mutex_);
   size_t GetUnTrackedKeyCount() const override
@@ -120,13 +135,22 @@ class Numeric : public IndexBase {
 
   const double* GetValue(const InternedStringPtr& key) const
       ABSL_NO_THREAD_SAFETY_ANALYSIS;
-  using BTreeNumericIndex = BTreeNumeric<InternedStringPtr>;
+  // Calls `fn` with the ids of the tracked keys in value order until it
+  // returns false. Keys sharing a value are visited in id order.
+  void ForEachDocIdByValue(bool ascending,
+                           absl::FunctionRef<bool(DocId)> fn) const
+      ABSL_NO_THREAD_SAFETY_ANALYSIS;
+  const DocIdMap& GetDocIdMap() const { return *doc_ids_; }
+  // Buckets hold the ids of the keys, see DocIdMap.
+  using BTreeNumericIndex =
+      BTreeNumeric<DocId, absl::Hash<DocId>, std::equal_to<DocId>,
+                   DocIdBitmap>;
   using EntriesRange = std::pair<BTreeNumericIndex::ConstIterator,
                                  BTreeNumericIndex::ConstIterator>;
   class EntriesFetcherIterator : public EntriesFetcherIteratorBase {
    public:
     EntriesFetcherIterator(
-        const EntriesRange& entries_range,
+        const DocIdMap& doc_ids, const EntriesRange& entries_range,
         const std::optional<EntriesRange>& additional_entries_range,
         const InternedStringSet* untracked_keys);
     bool Done() const override;
@@ -134,17 +158,17 @@ class Numeric : public IndexBase {
     const InternedStringPtr& operator*() const override;
 
    private:
-    static bool NextKeys(
-        const Numeric::EntriesRange& range,
-        BTreeNumericIndex::ConstIterator& iter,
-        std::optional<InternedStringSet::const_iterator>& keys_iter);
+    using BucketIterator = BTreeNumericIndex::SetType::const_iterator;
+    static bool NextKeys(const Numeric::EntriesRange& range,
+                         BTreeNumericIndex::ConstIterator& iter,
+                         std::optional<BucketIterator>& keys_iter);
+    const DocIdMap& doc_ids_;
     const EntriesRange& entries_range_;
     BTreeNumericIndex::ConstIterator entries_iter_;
-    std::optional<InternedStringSet::const_iterator> entry_keys_iter_;
+    std::optional<BucketIterator> entry_keys_iter_;
     const std::optional<EntriesRange>& additional_entries_range_;
     BTreeNumericIndex::ConstIterator additional_entries_iter_;
-    std::optional<InternedStringSet::const_iterator>
-        additional_entry_keys_iter_;
+    std::optional<BucketIterator> additional_entry_keys_iter_;
     const InternedStringSet* untracked_keys_;
     std::optional<InternedStringSet::const_iterator> untracked_keys_iter_;
   };
@@ -152,17 +176,24 @@ class Numeric : public IndexBase {
   class EntriesFetcher : public EntriesFetcherBase {
    public:
     EntriesFetcher(
-        const EntriesRange& entries_range, size_t size,
+        const DocIdMap& doc_ids, const EntriesRange& entries_range,
+        size_t size,
         std::optional<EntriesRange> additional_entries_range = std::nullopt,
         const InternedStringSet* untracked_keys = nullptr)
-        : entries_range_(entries_range),
+        : doc_ids_(doc_ids),
+          entries_range_(entries_range),
           size_(size),
           additional_entries_range_(additional_entries_range),
           untracked_keys_(untracked_keys) {}
     size_t Size() const override;
     std::unique_ptr<EntriesFetcherIteratorBase> Begin() override;
+    const DocIdMap& GetDocIdMap() const { return doc_ids_; }
+    // Returns the ids of the keys in the fetched buckets. Untracked keys
+    // yielded by negated searches are not included.
+    DocIdBitmap GetDocIds() const;
 
    private:
+    const DocIdMap& doc_ids_;
     EntriesRange entries_range_;
     size_t size_{0};
     std::optional<EntriesRange> additional_entries_range_;
@@ -174,7 +205,13 @@ class Numeric : public IndexBase {
       bool negate) const ABSL_NO_THREAD_SAFETY_ANALYSIS;
 
  private:
+  absl::StatusOr<bool> AddRecordLocked(const InternedStringPtr& key,
+                                       const std::optional<double>& value)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(index_mutex_);
+
   mutable absl::Mutex index_mutex_;
+  std::shared_ptr<DocIdMap> doc_ids_;
+  // The ids of the keys are looked up in doc_ids_ rather than kept here.
   InternedStringHashMap<double> tracked_keys_ ABSL_GUARDED_BY(index_mutex_);
   // untracked keys is needed to support negate filtering
   InternedStringSet untracked_keys_ ABSL_GUARDED_BY(index_mutex_);
@@ -7,11 +7,13 @@
 
 #include "src/indexes/tag.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
@@ -21,11 +23,16 @@
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "src/indexes/index_base.h"
 #include "src/query/predicate.h"
+#include "src/rdb_serialization.h"
+#include "src/utils/doc_id_bitmap.h"
+#include "src/utils/doc_id_map.h"
 #include "src/utils/patricia_tree.h"
 #include "src/utils/string_interning.h"
 #include "src/valkey_search_options.h"
+#include "vmsdk/src/status/status_macros.h"
 #include "vmsdk/src/valkey_module_api/valkey_module.h"
 
 namespace valkey_search::indexes {
@@ -35,8 +42,10 @@ static bool IsValidPrefix(absl::string_view str) {
          str[str.length() - 2] != '*';
 }
 
-Tag::Tag(const data_model::TagIndex& tag_index_proto)
+Tag::Tag(const data_model::TagIndex& tag_index_proto,
+         std::shared_ptr<DocIdMap> doc_ids)
     : IndexBase(IndexerType::kTag),
+      doc_ids_(std::move(doc_ids)),
       separator_(tag_index_proto.separator()[0]),
       case_sensitive_(tag_index_proto.case_sensitive()),
       tree_(case_sensitive_) {}
@@ -46,20 +55,89 @@ absl::StatusOr<bool> Tag::AddRecord(const InternedStringPtr& key,
   auto interned_data = StringInternStore::Intern(data);
   auto parsed_tags = ParseRecordTags(*interned_data, separator_);
   absl::MutexLock lock(&index_mutex_);
+  return AddRecordLocked(key, std::move(interned_data),
+                         std::move(parsed_tags));
+}
+
+std::vector<absl::StatusOr<bool>> Tag::AddRecords(
+    absl::Span<const Record> records) {
+  // Intern and parse outside of the lock, and insert in tag string order so
+  // that consecutive inserts walk the same branches of the tree.
+  struct ParsedRecord {
+    InternedStringPtr interned_data;
+    absl::flat_hash_set<absl::string_view> parsed_tags;
+  };
+  std::vector<ParsedRecord> parsed;
+  parsed.reserve(records.size());
+  std::vector<size_t> order(records.size());
+  for (size_t i = 0; i < records.size(); ++i) {
+    auto interned_data = StringInternStore::Intern(records[i].record);
+    auto parsed_tags = ParseRecordTags(*interned_data, separator_);
+    parsed.push_back(ParsedRecord{.interned_data = std::move(interned_data),
+                                  .parsed_tags = std::move(parsed_tags)});
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return parsed[a].interned_data->Str() < parsed[b].interned_data->Str();
+  });
+  std::vector<absl::StatusOr<bool>> results(records.size());
+  absl::MutexLock lock(&index_mutex_);
+  for (auto i : order) {
+    results[i] =
+        AddRecordLocked(records[i].key, std::move(parsed[i].interned_data),
+                        std::move(parsed[i].parsed_tags));
+  }
+  return results;
+}
+
+absl::Status Tag::SaveRecords(RDBChunkOutputStream chunked_out) const {
+  absl::MutexLock lock(&index_mutex_);
+  return SaveRecordsImpl(
+      std::move(chunked_out), tracked_tags_by_keys_, untracked_keys_,
+      [](RDBBufferedOutputStream& out, const TagInfo& tag_info) {
+        return out.SaveString(tag_info.raw_tag_string->Str());
+      });
+}
+
+absl::Status Tag::LoadRecords(RDBChunkInputStream chunked_in) {
+  std::vector<Record> records;
+  return LoadRecordsImpl<InternedStringPtr>(
+      std::move(chunked_in),
+      [](RDBBufferedInputStream& in) -> absl::StatusOr<InternedStringPtr> {
+        VMSDK_ASSIGN_OR_RETURN(auto raw_tag_string, in.LoadString());
+        return StringInternStore::Intern(raw_tag_string);
+      },
+      [&](auto& batch) {
+        records.clear();
+        for (const auto& [key, raw_tag_string] : batch) {
+          records.push_back(
+              Record{.key = key, .record = raw_tag_string->Str()});
+        }
+        for (const auto& result : AddRecords(records)) {
+          VMSDK_RETURN_IF_ERROR(result.status());
+        }
+        return absl::OkStatus();
+      });
+}
+
+absl::StatusOr<bool> Tag::AddRecordLocked(
+    const InternedStringPtr& key, InternedStringPtr interned_data,
+    absl::flat_hash_set<absl::string_view> parsed_tags) {
   if (parsed_tags.empty()) {
     untracked_keys_.insert(key);
     return false;
   }
-  auto [_, succ] = tracked_tags_by_keys_.insert(
+  auto [it, succ] = tracked_tags_by_keys_.insert(
       {key, TagInfo{.raw_tag_string = std::move(interned_data),
-                    .tags = parsed_tags}});
+                    .tags = std::move(parsed_tags)}});
   if (!succ) {
     return absl::AlreadyExistsError(
         absl::StrCat("Key `", key->Str(), "` already exists"));
   }
   untracked_keys_.erase(key);
-  for (const auto& tag : parsed_tags) {
-    tree_.AddKeyValue(tag, key);
+  const DocId doc_id = doc_ids_->Acquire(key);
+  for (const auto& tag : it->second.tags) {
+    tree_.AddKeyValue(tag, doc_id);
   }
   return true;
 }
@@ -161,18 +239,19 @@ absl::StatusOr<bool> Tag::ModifyRecord(const InternedStringPtr& key,
         absl::StrCat("Key `", key->Str(), "` not found"));
   }
   auto& tag_info = it->second;
+  const DocId doc_id = *doc_ids_->Find(key);
 
   // insert new tags that are not present in the old tags.
   for (const auto& tag : new_parsed_tags) {
     if (!tag_info.tags.contains(tag)) {
-      tree_.AddKeyValue(tag, key);
+      tree_.AddKeyValue(tag, doc_id);
     }
   }
 
   // remove old tags that are not present in the new tags.
   for (const auto& tag : tag_info.tags) {
     if (!new_parsed_tags.contains(tag)) {
-      tree_.Remove(tag, key);
+      tree_.Remove(tag, doc_id);
     }
   }
 
@@ -195,10 +274,11 @@ absl::StatusOr<bool> Tag::RemoveRecord(const InternedStringPtr& key,
   if (it == tracked_tags_by_keys_.end()) {
     return false;
   }
-  auto& tag_info = it->second;
-  for (const auto& tag : tag_info.tags) {
-    tree_.Remove(tag, key);
+  const DocId doc_id = *doc_ids_->Find(key);
+  for (const auto& tag : it->second.tags) {
+    tree_.Remove(tag, doc_id);
   }
+  doc_ids_->Release(doc_id);
   tracked_tags_by_keys_.erase(it);
   return true;
 }
@@ -255,10 +335,11 @@ const absl::flat_hash_set<absl::string_view>* Tag::GetValue(
 }
 
 Tag::EntriesFetcherIterator::EntriesFetcherIterator(
-    const PatriciaTreeIndex& tree,
+    const DocIdMap& doc_ids, const PatriciaTreeIndex& tree,
     absl::flat_hash_set<PatriciaNodeIndex*>& entries,
     const InternedStringSet& untracked_keys, bool negate)
-    : tree_iter_(tree.RootIterator()),
+    : doc_ids_(doc_ids),
+      tree_iter_(tree.RootIterator()),
       entries_(entries),
       untracked_keys_(untracked_keys),
       negate_(negate) {}
@@ -325,7 +406,7 @@ const InternedStringPtr& Tag::EntriesFetcherIterator::operator*() const {
   if (negate_ && tree_iter_.Done()) {
     return *untracked_keys_iter_.value();
   }
-  return *next_iter_;
+  return doc_ids_.GetKey(*next_iter_);
 }
 
 // TODO: b/357027854 - Support Suffix/Infix Search
@@ -363,17 +444,30 @@ std::unique_ptr<Tag::EntriesFetcher> Tag::Search(
                : tracked_tags_by_keys_.size();
     size += untracked_keys_.size();
   }
-  return std::make_unique<Tag::EntriesFetcher>(tree_, entries, size, negate,
-                                               untracked_keys_);
+  return std::make_unique<Tag::EntriesFetcher>(*doc_ids_, tree_, entries, size,
+                                               negate, untracked_keys_);
 }
 
 std::unique_ptr<EntriesFetcherIteratorBase> Tag::EntriesFetcher::Begin() {
-  auto itr = std::make_unique<EntriesFetcherIterator>(tree_, entries_,
-                                                      untracked_keys_, negate_);
+  auto itr = std::make_unique<EntriesFetcherIterator>(
+      doc_ids_, tree_, entries_, untracked_keys_, negate_);
   itr->Next();
   return itr;
 }
 
+DocIdBitmap Tag::EntriesFetcher::GetDocIds() const {
+  DCHECK(!negate_);
+  // Prefix and suffix matches span many tags, build the union once.
+  std::vector<DocId> doc_ids;
+  doc_ids.reserve(size_);
+  for (const auto* node : entries_) {
+    if (node->value.has_value()) {
+      doc_ids.insert(doc_ids.end(), node->value->begin(), node->value->end());
+    }
+  }
+  return DocIdBitmap::FromIds(std::move(doc_ids));
+}
+
 size_t Tag::EntriesFetcher::Size() const { return size_; }
 
 size_t Tag::GetTrackedKeyCount() const {
@@ -8,9 +8,11 @@
 #ifndef VALKEYSEARCH_SRC_INDEXES_TAG_H_
 #define VALKEYSEARCH_SRC_INDEXES_TAG_H_
 #include <cstddef>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_set.h"
@@ -20,9 +22,12 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "src/indexes/index_base.h"
 #include "src/query/predicate.h"
 #include "src/rdb_serialization.h"
+#include "src/utils/doc_id_bitmap.h"
+#include "src/utils/doc_id_map.h"
 #include "src/utils/patricia_tree.h"
 #include "src/utils/string_interning.h"
 #include "vmsdk/src/valkey_module_api/valkey_module.h"
@@ -31,10 +36,15 @@ namespace valkey_search::indexes {
 
 class Tag : public IndexBase {
  public:
-  explicit Tag(const data_model::TagIndex& tag_index_proto);
+  explicit Tag(
+      const data_model::TagIndex& tag_index_proto,
+      std::shared_ptr<DocIdMap> doc_ids = std::make_shared<DocIdMap>());
   absl::StatusOr<bool> AddRecord(const InternedStringPtr& key,
                                  absl::string_view data) override
       ABSL_LOCKS_EXCLUDED(index_mutex_);
+  std::vector<absl::StatusOr<bool>> AddRecords(
+      absl::Span<const Record> records) override
+      ABSL_LOCKS_EXCLUDED(index_mutex_);
   absl::StatusOr<bool> RemoveRecord(
       const InternedStringPtr& key,
       DeletionType deletion_type = DeletionType::kNone) override
@@ -47,6 +57,10 @@ class Tag : public IndexBase {
   absl::Status SaveIndex(RDBChunkOutputStream chunked_out) const override {
     return absl::OkStatus();
   }
+  absl::Status SaveRecords(RDBChunkOutputStream chunked_out) const override
+      ABSL_LOCKS_EXCLUDED(index_mutex_);
+  absl::Status LoadRecords(RDBChunkInputStream chunked_in) override
+      ABSL_LOCKS_EXCLUDED(index_mutex_);
 
   size_t GetTrackedKeyCount() const override ABSL_LOCKS_EXCLUDED(index_mutex_);
   size_t GetUnTrackedKeyCount() const override
@@ -73,12 +87,15 @@ class Tag : public IndexBase {
   const absl::flat_hash_set<absl::string_view>* GetValue(
       const InternedStringPtr& key,
       bool& case_sensitive) const ABSL_NO_THREAD_SAFETY_ANALYSIS;
-  using PatriciaTreeIndex = PatriciaTree<InternedStringPtr>;
-  using PatriciaNodeIndex = PatriciaNode<InternedStringPtr>;
+  // Tree leaves hold the ids of the keys, see DocIdMap.
+  using PatriciaTreeIndex = PatriciaTree<DocId, absl::Hash<DocId>,
+                                         std::equal_to<DocId>, DocIdBitmap>;
+  using PatriciaNodeIndex = PatriciaTreeIndex::PatriciaNodeType;
 
   class EntriesFetcherIterator : public EntriesFetcherIteratorBase {
    public:
-    EntriesFetcherIterator(const PatriciaTreeIndex& tree,
+    EntriesFetcherIterator(const DocIdMap& doc_ids,
+                           const PatriciaTreeIndex& tree,
                            absl::flat_hash_set<PatriciaNodeIndex*>& entries,
                            const InternedStringSet& untracked_keys,
                            bool negate);
@@ -87,10 +104,11 @@ class Tag : public IndexBase {
     const InternedStringPtr& operator*() const override;
 
    private:
+    const DocIdMap& doc_ids_;
     PatriciaTreeIndex::PrefixSubTreeIterator tree_iter_;
     absl::flat_hash_set<PatriciaNodeIndex*>& entries_;
     PatriciaNodeIndex* next_node_{nullptr};
-    InternedStringSet::const_iterator next_iter_;
+    PatriciaTreeIndex::SetType::const_iterator next_iter_;
     const InternedStringSet& untracked_keys_;
     bool negate_;
     std::optional<InternedStringSet::const_iterator> untracked_keys_iter_;
@@ -99,18 +117,24 @@ class Tag : public IndexBase {
 
   class EntriesFetcher : public EntriesFetcherBase {
    public:
-    EntriesFetcher(const PatriciaTreeIndex& tree,
+    EntriesFetcher(const DocIdMap& doc_ids, const PatriciaTreeIndex& tree,
                    absl::flat_hash_set<PatriciaNodeIndex*> entries, size_t size,
                    bool negate, const InternedStringSet& untracked_keys)
-        : tree_(tree),
+        : doc_ids_(doc_ids),
+          tree_(tree),
           size_(size),
           entries_(entries),
           negate_(negate),
           untracked_keys_(untracked_keys){};
     size_t Size() const override;
     std::unique_ptr<EntriesFetcherIteratorBase> Begin() override;
+    const DocIdMap& GetDocIdMap() const { return doc_ids_; }
+    // Returns the ids of the keys having any of the matched tags. Only valid
+    // for non-negated searches and before iterating the fetcher.
+    DocIdBitmap GetDocIds() const;
 
    private:
+    const DocIdMap& doc_ids_;
     const PatriciaTreeIndex& tree_;
     size_t size_{0};
     absl::flat_hash_set<PatriciaNodeIndex*> entries_;
@@ -136,6 +160,12 @@ class Tag : public IndexBase {
     InternedStringPtr raw_tag_string;
     absl::flat_hash_set<absl::string_view> tags;
   };
+  absl::StatusOr<bool> AddRecordLocked(
+      const InternedStringPtr& key, InternedStringPtr interned_data,
+      absl::flat_hash_set<absl::string_view> parsed_tags)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(index_mutex_);
+
+  std::shared_ptr<DocIdMap> doc_ids_;
   // Map of tracked keys to their tags.
   InternedStringHashMap<TagInfo> tracked_tags_by_keys_
       ABSL_GUARDED_BY(index_mutex_);
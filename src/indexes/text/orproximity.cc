@@ -6,7 +6,7 @@ OrProximityIterator::OrProximityIterator(
     absl::InlinedVector<std::unique_ptr<TextIterator>,
                         kProximityTermsInlineCapacity>&& iters)
     : iters_(std::move(iters)),
-      current_key_(),
+      current_doc_id_(std::nullopt),
       current_position_(std::nullopt),
       current_field_mask_(0ULL),
       key_set_(),
@@ -33,14 +33,19 @@ bool OrProximityIterator::DoneKeys() const {
 }
 
 const Key& OrProximityIterator::CurrentKey() const {
-  CHECK(current_key_);
-  return current_key_;
+  CHECK(current_doc_id_.has_value());
+  return iters_[current_key_indices_.front()]->CurrentKey();
+}
+
+DocId OrProximityIterator::CurrentDocId() const {
+  CHECK(current_doc_id_.has_value());
+  return *current_doc_id_;
 }
 
 void OrProximityIterator::InsertValidKeyIterator(size_t idx) {
   auto& iter = iters_[idx];
   if (!iter->DoneKeys()) {
-    key_set_.emplace(iter->CurrentKey(), idx);
+    key_set_.emplace(iter->CurrentDocId(), idx);
   }
 }
 
@@ -51,18 +56,18 @@ bool OrProximityIterator::FindMinimumKey() {
     }
   }
   if (key_set_.empty()) {
-    current_key_ = nullptr;
+    current_doc_id_ = std::nullopt;
     current_position_ = std::nullopt;
     current_field_mask_ = 0ULL;
     return false;
   }
-  current_key_ = key_set_.begin()->first;
+  current_doc_id_ = key_set_.begin()->first;
   current_key_indices_.clear();
   // Collect all iterators with minimum key.
   // key_set_ is sorted, so all matching keys are consecutive
   // and we stop when we find a different key.
   for (auto it = key_set_.begin();
-       it != key_set_.end() && it->first == current_key_;) {
+       it != key_set_.end() && it->first == *current_doc_id_;) {
     current_key_indices_.push_back(it->second);
     it = key_set_.erase(it);
   }
@@ -73,7 +78,7 @@ bool OrProximityIterator::FindMinimumKey() {
 }
 
 bool OrProximityIterator::NextKey() {
-  if (current_key_) {
+  if (current_doc_id_.has_value()) {
     // Advance all iterators at current key
     for (size_t idx : current_key_indices_) {
       iters_[idx]->NextKey();
@@ -86,15 +91,15 @@ bool OrProximityIterator::NextKey() {
   return FindMinimumKey();
 }
 
-bool OrProximityIterator::SeekForwardKey(const Key& target_key) {
-  if (current_key_ && current_key_ >= target_key) {
+bool OrProximityIterator::SeekForwardKey(DocId target_doc_id) {
+  if (current_doc_id_.has_value() && *current_doc_id_ >= target_doc_id) {
     return true;
   }
-  // Clear set and seek all iterators to target_key or beyond.
+  // Clear set and seek all iterators to target_doc_id or beyond.
   key_set_.clear();
   for (size_t i = 0; i < iters_.size(); ++i) {
-    if (!iters_[i]->DoneKeys() && iters_[i]->CurrentKey() < target_key) {
-      iters_[i]->SeekForwardKey(target_key);
+    if (!iters_[i]->DoneKeys() && iters_[i]->CurrentDocId() < target_doc_id) {
+      iters_[i]->SeekForwardKey(target_doc_id);
     }
   }
   // Rebuild key set if needed or returns false if all are exhausted.
@@ -188,7 +193,7 @@ FieldMaskPredicate OrProximityIterator::CurrentFieldMask() const {
 }
 
 bool OrProximityIterator::IsIteratorValid() const {
-  return current_key_ && current_position_.has_value() &&
+  return current_doc_id_.has_value() && current_position_.has_value() &&
          current_field_mask_ != 0ULL;
 }
 
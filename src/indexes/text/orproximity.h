@@ -39,8 +39,9 @@ class OrProximityIterator : public TextIterator {
   // Key-level iteration
   bool DoneKeys() const override;
   const Key& CurrentKey() const override;
+  DocId CurrentDocId() const override;
   bool NextKey() override;
-  bool SeekForwardKey(const Key& target_key) override;
+  bool SeekForwardKey(DocId target_doc_id) override;
   // Position-level iteration
   bool DonePositions() const override;
   const PositionRange& CurrentPosition() const override;
@@ -53,13 +54,13 @@ class OrProximityIterator : public TextIterator {
   absl::InlinedVector<std::unique_ptr<TextIterator>,
                       kProximityTermsInlineCapacity>
       iters_;
-  Key current_key_;
+  std::optional<DocId> current_doc_id_;
   std::optional<PositionRange> current_position_;
   FieldMaskPredicate current_field_mask_;
   FieldMaskPredicate query_field_mask_;
 
   // Multiset for efficient key management
-  std::multiset<std::pair<Key, size_t>> key_set_;
+  std::multiset<std::pair<DocId, size_t>> key_set_;
   // Current iterators on same key
   absl::InlinedVector<size_t, kProximityTermsInlineCapacity>
       current_key_indices_;
@@ -55,14 +55,14 @@ unsigned int count_num_terms(const PositionMap& pos_map) {
   return num_terms;
 }
 
-void Postings::InsertKey(const Key& key, FlatPositionMap* flat_map) {
+void Postings::InsertKey(DocId doc_id, FlatPositionMap* flat_map) {
   // Insert FlatPositionMap pointer into map
-  key_to_positions_.emplace(key, flat_map);
+  key_to_positions_.emplace(doc_id, flat_map);
 }
 
 // Remove a document key and all its positions
-void Postings::RemoveKey(const Key& key, TextIndexMetadata* metadata) {
-  auto node = key_to_positions_.extract(key);
+void Postings::RemoveKey(DocId doc_id, TextIndexMetadata* metadata) {
+  auto node = key_to_positions_.extract(doc_id);
   if (node.empty()) return;
 
   FlatPositionMap* flat_map = node.mapped();
@@ -107,6 +107,7 @@ Postings* Postings::Defrag() { return this; }
 // Get a Key iterator
 Postings::KeyIterator Postings::GetKeyIterator() const {
   KeyIterator iterator;
+  iterator.doc_ids_ = doc_ids_;
   iterator.key_map_ = &key_to_positions_;
   iterator.current_ = iterator.key_map_->begin();
   iterator.end_ = iterator.key_map_->end();
@@ -146,17 +147,21 @@ bool Postings::KeyIterator::ContainsFields(uint64_t field_mask) const {
   return false;
 }
 
-bool Postings::KeyIterator::SkipForwardKey(const Key& key) {
+bool Postings::KeyIterator::SkipForwardKey(DocId doc_id) {
   CHECK(key_map_ != nullptr) << "KeyIterator is invalid";
 
   // Use lower_bound for efficient binary search since map is ordered
-  current_ = key_map_->lower_bound(key);
+  current_ = key_map_->lower_bound(doc_id);
 
   // Return true if we landed on exact key match
-  return (current_ != end_ && current_->first == key);
+  return (current_ != end_ && current_->first == doc_id);
 }
 
 const Key& Postings::KeyIterator::GetKey() const {
+  return doc_ids_->GetKey(GetDocId());
+}
+
+DocId Postings::KeyIterator::GetDocId() const {
   CHECK(key_map_ != nullptr && current_ != end_)
       << "KeyIterator is invalid or exhausted";
   return current_->first;
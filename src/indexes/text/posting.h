@@ -24,7 +24,10 @@ locking for mutation operations.
 
 Conceptually, this object holds an ordered list of Keys and for each Key there
 is an ordered list of Positions. Each position is tagged with a bitmask of
-fields.
+fields. Keys are held as their 32-bit document ids in the DocIdMap of the
+index schema, which orders them and resolves them back to keys. Holding ids
+rather than InternedStringPtrs halves the size of the entries and keeps
+iteration from touching the reference counts of the keys.
 
 A KeyIterator is provided to iterate over the keys within this object.
 A PositionIterator is provided to iterate over the positions of an individual
@@ -39,6 +42,8 @@ Key.
 
 #include "absl/container/btree_map.h"
 #include "src/indexes/text/flat_position_map.h"
+#include "src/utils/doc_id_bitmap.h"
+#include "src/utils/doc_id_map.h"
 #include "src/utils/string_interning.h"
 
 namespace valkey_search::indexes::text {
@@ -72,6 +77,8 @@ using PositionMap = absl::btree_map<Position, FieldMask>;
 struct Postings {
   struct KeyIterator;
 
+  // `doc_ids` resolves the ids of the keys and must outlive the object.
+  explicit Postings(const DocIdMap* doc_ids) : doc_ids_(doc_ids) {}
   // Destructor: clean up all FlatPositionMaps
   ~Postings();
 
@@ -79,10 +86,10 @@ struct Postings {
   bool IsEmpty() const;
 
   // Insert the key with FlatPositionMap
-  void InsertKey(const Key& key, FlatPositionMap* flat_map);
+  void InsertKey(DocId doc_id, FlatPositionMap* flat_map);
 
   // Remove a key and all positions for it
-  void RemoveKey(const Key& key, TextIndexMetadata* metadata);
+  void RemoveKey(DocId doc_id, TextIndexMetadata* metadata);
 
   // Total number of keys
   size_t GetKeyCount() const;
@@ -109,10 +116,11 @@ struct Postings {
 
     // Skip forward to next key that is equal to or greater than.
     // return true if it lands on an equal key, false otherwise.
-    bool SkipForwardKey(const Key& key);
+    bool SkipForwardKey(DocId doc_id);
 
     // Get Current key
     const Key& GetKey() const;
+    DocId GetDocId() const;
 
     // Check if word is present in any of the fields specified by field_mask for
     // current key
@@ -125,13 +133,15 @@ struct Postings {
     friend struct Postings;
 
     // Iterator state - pointer to key_to_positions map
-    const absl::btree_map<Key, FlatPositionMap*>* key_map_;
-    absl::btree_map<Key, FlatPositionMap*>::const_iterator current_;
-    absl::btree_map<Key, FlatPositionMap*>::const_iterator end_;
+    const DocIdMap* doc_ids_;
+    const absl::btree_map<DocId, FlatPositionMap*>* key_map_;
+    absl::btree_map<DocId, FlatPositionMap*>::const_iterator current_;
+    absl::btree_map<DocId, FlatPositionMap*>::const_iterator end_;
   };
 
  private:
-  absl::btree_map<Key, FlatPositionMap*> key_to_positions_;
+  const DocIdMap* doc_ids_;
+  absl::btree_map<DocId, FlatPositionMap*> key_to_positions_;
 };
 
 }  // namespace valkey_search::indexes::text
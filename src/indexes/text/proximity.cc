@@ -1,5 +1,7 @@
 #include "proximity.h"
 
+#include <algorithm>
+
 #include "vmsdk/src/module_config.h"
 
 namespace valkey_search::options {
@@ -73,8 +75,14 @@ bool ProximityIterator::DoneKeys() const {
 }
 
 const Key& ProximityIterator::CurrentKey() const {
-  CHECK(current_key_);
-  return current_key_;
+  CHECK(current_doc_id_.has_value());
+  // All the text iterators sit on the current key.
+  return iters_.front()->CurrentKey();
+}
+
+DocId ProximityIterator::CurrentDocId() const {
+  CHECK(current_doc_id_.has_value());
+  return *current_doc_id_;
 }
 
 bool ProximityIterator::NextKey() {
@@ -82,12 +90,12 @@ bool ProximityIterator::NextKey() {
   // sitting on the old key.
   auto advance = [&]() -> void {
     for (auto& iter : iters_) {
-      if (!iter->DoneKeys() && iter->CurrentKey() == current_key_) {
+      if (!iter->DoneKeys() && iter->CurrentDocId() == current_doc_id_) {
         iter->NextKey();
       }
     }
   };
-  if (current_key_) {
+  if (current_doc_id_.has_value()) {
     advance();
   }
   while (!DoneKeys()) {
@@ -108,44 +116,40 @@ bool ProximityIterator::NextKey() {
     // Otherwise, loop and try again.
     advance();
   }
-  current_key_ = nullptr;
+  current_doc_id_ = std::nullopt;
   return false;
 }
 
 bool ProximityIterator::FindCommonKey() {
   // 1) Validate children and compute min/max among current keys
-  Key min_key;
-  Key max_key;
+  DocId min_doc_id = iters_.front()->CurrentDocId();
+  DocId max_doc_id = min_doc_id;
   for (auto& iter : iters_) {
-    auto k = iter->CurrentKey();
-    if (!min_key || k < min_key) {
-      min_key = k;
-    }
-    if (!max_key || k > max_key) {
-      max_key = k;
-    }
+    DocId doc_id = iter->CurrentDocId();
+    min_doc_id = std::min(min_doc_id, doc_id);
+    max_doc_id = std::max(max_doc_id, doc_id);
   }
   // 2) If min == max, we found a common key
-  if (min_key == max_key) {
-    current_key_ = max_key;
+  if (min_doc_id == max_doc_id) {
+    current_doc_id_ = max_doc_id;
     return true;
   }
-  // 3) Advance all iterators that are strictly behind the current max_key
+  // 3) Advance all iterators that are strictly behind the current max key
   for (auto& iter : iters_) {
-    iter->SeekForwardKey(max_key);
+    iter->SeekForwardKey(max_doc_id);
   }
   return false;
 }
 
-bool ProximityIterator::SeekForwardKey(const Key& target_key) {
-  // If current key is already >= target_key, no need to seek
-  if (current_key_ && current_key_ >= target_key) {
+bool ProximityIterator::SeekForwardKey(DocId target_doc_id) {
+  // If current key is already >= target_doc_id, no need to seek
+  if (current_doc_id_.has_value() && *current_doc_id_ >= target_doc_id) {
     return true;
   }
-  // Skip all keys less than target_key for all iterators
+  // Skip all keys less than target_doc_id for all iterators
   for (auto& iter : iters_) {
-    if (!iter->DoneKeys() && iter->CurrentKey() < target_key) {
-      iter->SeekForwardKey(target_key);
+    if (!iter->DoneKeys() && iter->CurrentDocId() < target_doc_id) {
+      iter->SeekForwardKey(target_doc_id);
     }
   }
   // Find next valid key/position combination
@@ -161,12 +165,12 @@ bool ProximityIterator::SeekForwardKey(const Key& target_key) {
     }
     // Advance past current key and try again
     for (auto& iter : iters_) {
-      if (!iter->DoneKeys() && iter->CurrentKey() == current_key_) {
+      if (!iter->DoneKeys() && iter->CurrentDocId() == current_doc_id_) {
         iter->NextKey();
       }
     }
   }
-  current_key_ = nullptr;
+  current_doc_id_ = std::nullopt;
   return false;
 }
 
@@ -36,14 +36,19 @@ FieldMaskPredicate TermIterator::QueryFieldMask() const {
 }
 
 bool TermIterator::DoneKeys() const {
-  // O(1) check: current_key_ is nullified when FindMinimumValidKey exhausts all
-  // iterators.
-  return !current_key_;
+  // O(1) check: current_doc_id_ is reset when FindMinimumValidKey exhausts
+  // all iterators.
+  return !current_doc_id_.has_value();
 }
 
 const InternedStringPtr& TermIterator::CurrentKey() const {
-  CHECK(current_key_);
-  return current_key_;
+  CHECK(current_doc_id_.has_value());
+  return key_iterators_[current_key_indices_.front()].GetKey();
+}
+
+DocId TermIterator::CurrentDocId() const {
+  CHECK(current_doc_id_.has_value());
+  return *current_doc_id_;
 }
 
 // Helper function to advance key iterators and populate the heap with valid
@@ -60,7 +65,7 @@ void TermIterator::InsertValidKeyIterator(size_t idx) {
     key_iter.NextKey();
   }
   if (key_iter.IsValid()) {
-    key_set_.push_back_unsorted(key_iter.GetKey(), idx);
+    key_set_.push_back_unsorted(key_iter.GetDocId(), idx);
   }
 }
 
@@ -80,12 +85,12 @@ bool TermIterator::FindMinimumValidKey() {
   }
   // 2. Restore the min-heap property. O(K).
   key_set_.heapify();
-  current_key_ = key_set_.min().first;
+  current_doc_id_ = key_set_.min().first;
   current_key_indices_.clear();
   // 3. Extract all iterators that share this minimum key.
   // This physically removes them from the heap (making it "empty" if all
   // match).
-  while (!key_set_.empty() && key_set_.min().first == current_key_) {
+  while (!key_set_.empty() && key_set_.min().first == *current_doc_id_) {
     current_key_indices_.push_back(key_set_.min().second);
     key_set_.pop_min();  // O(log K)
   }
@@ -103,7 +108,7 @@ bool TermIterator::FindMinimumValidKey() {
 }
 
 bool TermIterator::NextKey() {
-  if (current_key_) {
+  if (current_doc_id_.has_value()) {
     // Advance all iterators that contributed to the current key.
     for (size_t idx : current_key_indices_) {
       key_iterators_[idx].NextKey();
@@ -114,19 +119,21 @@ bool TermIterator::NextKey() {
   return FindMinimumValidKey();
 }
 
-bool TermIterator::SeekForwardKey(const InternedStringPtr& target_key) {
-  if (current_key_ && current_key_ >= target_key) return true;
+bool TermIterator::SeekForwardKey(DocId target_doc_id) {
+  if (current_doc_id_.has_value() && *current_doc_id_ >= target_doc_id) {
+    return true;
+  }
   // Drain laggards from the heap that are behind the target.
-  while (!key_set_.empty() && key_set_.min().first < target_key) {
+  while (!key_set_.empty() && key_set_.min().first < target_doc_id) {
     size_t idx = key_set_.min().second;
     key_set_.pop_min();
-    key_iterators_[idx].SkipForwardKey(target_key);
+    key_iterators_[idx].SkipForwardKey(target_doc_id);
     InsertValidKeyIterator(idx);
   }
   // Update active indices that were already extracted from the heap.
-  if (current_key_) {
+  if (current_doc_id_.has_value()) {
     for (size_t idx : current_key_indices_) {
-      key_iterators_[idx].SkipForwardKey(target_key);
+      key_iterators_[idx].SkipForwardKey(target_doc_id);
       InsertValidKeyIterator(idx);
     }
     current_key_indices_.clear();
@@ -235,7 +242,7 @@ FieldMaskPredicate TermIterator::CurrentFieldMask() const {
 }
 
 void TermIterator::ClearKeyState() {
-  current_key_ = {};
+  current_doc_id_ = std::nullopt;
   key_set_.clear();
   current_key_indices_.clear();
   ClearPositionState();
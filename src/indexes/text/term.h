@@ -50,8 +50,9 @@ class TermIterator : public TextIterator {
   // Key-level iteration
   bool DoneKeys() const override;
   const Key& CurrentKey() const override;
+  DocId CurrentDocId() const override;
   bool NextKey() override;
-  bool SeekForwardKey(const Key& target_key) override;
+  bool SeekForwardKey(DocId target_doc_id) override;
   // Position-level iteration
   bool DonePositions() const override;
   const PositionRange& CurrentPosition() const override;
@@ -62,10 +63,10 @@ class TermIterator : public TextIterator {
   // and field.
   bool IsIteratorValid() const override {
     if (require_positions_) {
-      return current_key_ && current_position_.has_value() &&
+      return current_doc_id_.has_value() && current_position_.has_value() &&
              current_field_mask_ != 0ULL;
     }
-    return current_key_ ? true : false;
+    return current_doc_id_.has_value();
   }
   /* Implementation of APIs unique to TermIterator */
   // It is possible to implement a `CurrentKeyIterVecIdx` API that returns the
@@ -79,7 +80,7 @@ class TermIterator : public TextIterator {
       key_iterators_;
   absl::InlinedVector<PositionIterator, kWordExpansionInlineCapacity>
       pos_iterators_;
-  Key current_key_;
+  std::optional<DocId> current_doc_id_;
   std::optional<PositionRange> current_position_;
   FieldMaskPredicate current_field_mask_;
   const bool require_positions_;
@@ -87,7 +88,7 @@ class TermIterator : public TextIterator {
 
   // Pending queue: heap of valid iterators not currently being processed.
   // Provides O(1) access to the minimum key and O(log K) extraction.
-  valkey_search::InlinedPriorityQueue<std::pair<Key, size_t>,
+  valkey_search::InlinedPriorityQueue<std::pair<DocId, size_t>,
                                       kWordExpansionInlineCapacity>
       key_set_;
   // Pending queue: heap of valid iterators not currently being processed.
@@ -95,7 +96,7 @@ class TermIterator : public TextIterator {
   valkey_search::InlinedPriorityQueue<std::pair<uint32_t, size_t>,
                                       kWordExpansionInlineCapacity>
       pos_set_;
-  // Indices of iterators at current_key_ (active, not in key_set_)
+  // Indices of iterators at current_doc_id_ (active, not in key_set_)
   absl::InlinedVector<size_t, kWordExpansionInlineCapacity>
       current_key_indices_;
   // Indices of iterators at current_position_ (active, not in pos_set_)
@@ -36,27 +36,27 @@ static void FreeStemParentsCallback(void *target) {
 }
 
 InvasivePtr<Postings> AddKeyToPostings(InvasivePtr<Postings> existing_postings,
-                                       const InternedStringPtr &key,
-                                       FlatPositionMap *flat_map,
+                                       DocId doc_id, FlatPositionMap *flat_map,
+                                       const DocIdMap *doc_ids,
                                        TextIndexMetadata *metadata) {
   InvasivePtr<Postings> postings;
   if (existing_postings) {
     postings = existing_postings;
   } else {
     metadata->num_unique_terms++;
-    postings = InvasivePtr<Postings>::Make();
+    postings = InvasivePtr<Postings>::Make(doc_ids);
   }
 
-  postings->InsertKey(key, flat_map);
+  postings->InsertKey(doc_id, flat_map);
   return postings;
 }
 
 InvasivePtr<Postings> RemoveKeyFromPostings(
-    InvasivePtr<Postings> existing_postings, const InternedStringPtr &key,
+    InvasivePtr<Postings> existing_postings, DocId doc_id,
     TextIndexMetadata *metadata) {
   CHECK(existing_postings) << "Per-key tree became unaligned";
 
-  existing_postings->RemoveKey(key, metadata);
+  existing_postings->RemoveKey(doc_id, metadata);
 
   if (existing_postings->IsEmpty()) {
     metadata->num_unique_terms--;
@@ -140,8 +140,10 @@ TextIndexSchema::TextIndexSchema(data_model::Language language,
                                  const std::string &punctuation,
                                  bool with_offsets,
                                  const std::vector<std::string> &stop_words,
-                                 uint32_t min_stem_size)
-    : with_offsets_(with_offsets),
+                                 uint32_t min_stem_size,
+                                 std::shared_ptr<DocIdMap> doc_ids)
+    : doc_ids_(std::move(doc_ids)),
+      with_offsets_(with_offsets),
       lexer_(language, punctuation, stop_words),
       stem_tree_(FreeStemParentsCallback),
       min_stem_size_(min_stem_size),
@@ -212,6 +214,8 @@ void TextIndexSchema::CommitKeyData(const InternedStringPtr &key) {
   }
 
   TextIndex key_index{with_suffix_trie_};
+  uint32_t doc_length = 0;
+  const DocId doc_id = doc_ids_->Acquire(key);
 
   // Index the key's tokens
   for (auto &entry : token_positions) {
@@ -227,6 +231,7 @@ void TextIndexSchema::CommitKeyData(const InternedStringPtr &key) {
     metadata_.total_positions += pos_map.size();
     for (const auto &[_, field_mask] : pos_map) {
       metadata_.total_term_frequency += field_mask.CountSetFields();
+      doc_length += field_mask.CountSetFields();
     }
 
     // Create FlatPositionMap from PositionMap
@@ -247,8 +252,8 @@ void TextIndexSchema::CommitKeyData(const InternedStringPtr &key) {
       }
       bool is_new_word = !existing;
 
-      updated_target =
-          AddKeyToPostings(std::move(existing), key, flat_map, &metadata_);
+      updated_target = AddKeyToPostings(std::move(existing), doc_id, flat_map,
+                                        doc_ids_.get(), &metadata_);
 
       if (is_new_word) {
         absl::WriterMutexLock tree_lock(&text_index_mutex_);
@@ -280,6 +285,8 @@ void TextIndexSchema::CommitKeyData(const InternedStringPtr &key) {
   }
 
   // Map the key to the newly created per-key index
+  key_index.SetDocLength(doc_length);
+  key_index.SetDocId(doc_id);
   {
     std::lock_guard<std::mutex> per_key_guard(per_key_text_indexes_mutex_);
     per_key_text_indexes_.emplace(key, std::move(key_index));
@@ -318,8 +325,8 @@ void TextIndexSchema::DeleteKeyData(const InternedStringPtr &key) {
       }
 
       InvasivePtr<Postings> updated_target;
-      updated_target =
-          RemoveKeyFromPostings(std::move(existing), key, &metadata_);
+      updated_target = RemoveKeyFromPostings(std::move(existing),
+                                             key_index.GetDocId(), &metadata_);
 
       if (!updated_target) {
         absl::WriterMutexLock tree_lock(&text_index_mutex_);
@@ -332,6 +339,7 @@ void TextIndexSchema::DeleteKeyData(const InternedStringPtr &key) {
     }
     iter.Next();
   }
+  doc_ids_->Release(key_index.GetDocId());
 
   if (!empty_words.empty() && stem_text_field_mask_) {
     absl::WriterMutexLock stem_lock(&stem_tree_mutex_);
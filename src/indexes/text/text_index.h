@@ -11,6 +11,7 @@
 #include <atomic>
 #include <bitset>
 #include <cctype>
+#include <cstdint>
 #include <memory>
 #include <optional>
 
@@ -28,6 +29,7 @@
 #include "src/indexes/text/posting.h"
 #include "src/indexes/text/rax_target_mutex_pool.h"
 #include "src/indexes/text/rax_wrapper.h"
+#include "src/utils/doc_id_map.h"
 
 struct sb_stemmer;
 
@@ -81,16 +83,30 @@ class TextIndex {
       const std::optional<std::string> &reverse_word = std::nullopt,
       item_count_op op = NONE);
 
+  // Number of words of the key a per-key index belongs to, counted once per
+  // text field they occur in. Used to normalize relevance scores by length.
+  uint32_t GetDocLength() const { return doc_length_; }
+  void SetDocLength(uint32_t doc_length) { doc_length_ = doc_length; }
+
+  // Id of the key a per-key index belongs to, under which the key is held in
+  // the postings.
+  DocId GetDocId() const { return doc_id_; }
+  void SetDocId(DocId doc_id) { doc_id_ = doc_id; }
+
  private:
   Rax prefix_tree_;
   std::unique_ptr<Rax> suffix_tree_;
+  uint32_t doc_length_{0};
+  DocId doc_id_{0};
 };
 
 class TextIndexSchema {
  public:
-  TextIndexSchema(data_model::Language language, const std::string &punctuation,
-                  bool with_offsets, const std::vector<std::string> &stop_words,
-                  uint32_t min_stem_size);
+  TextIndexSchema(
+      data_model::Language language, const std::string &punctuation,
+      bool with_offsets, const std::vector<std::string> &stop_words,
+      uint32_t min_stem_size,
+      std::shared_ptr<DocIdMap> doc_ids = std::make_shared<DocIdMap>());
 
   absl::StatusOr<bool> StageAttributeData(const InternedStringPtr &key,
                                           absl::string_view data,
@@ -108,6 +124,9 @@ class TextIndexSchema {
   // Access to metadata for memory pool usage
   TextIndexMetadata &GetMetadata() { return metadata_; }
 
+  // Resolves the document ids held by the postings.
+  const DocIdMap &GetDocIdMap() const { return *doc_ids_; }
+
   // Access stem tree for word expansion during search
   const Rax &GetStemTree() const { return stem_tree_; }
 
@@ -138,6 +157,11 @@ class TextIndexSchema {
   // Each schema instance has its own metadata with memory pools
   TextIndexMetadata metadata_;
 
+  // Ids of the keys held by the postings. Every key with text data holds one
+  // reference to its id, acquired by CommitKeyData and released by
+  // DeleteKeyData.
+  std::shared_ptr<DocIdMap> doc_ids_;
+
   //
   // This is the main index of all Text fields in this index schema
   //
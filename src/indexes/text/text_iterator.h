@@ -9,6 +9,7 @@
 #define VALKEY_SEARCH_INDEXES_TEXT_ITERATOR_H_
 
 #include "src/indexes/text/posting.h"
+#include "src/utils/doc_id_bitmap.h"
 #include "src/utils/string_interning.h"
 
 namespace valkey_search::indexes::text {
@@ -55,6 +56,10 @@ class TextIterator {
   // Returns the current key.
   // ASSERT: !DoneKeys()
   virtual const Key& CurrentKey() const = 0;
+  // Returns the document id of the current key. Keys are iterated in the
+  // order of their ids.
+  // ASSERT: !DoneKeys()
+  virtual DocId CurrentDocId() const = 0;
   // Advances the key iteration until there is a match OR until we have
   // exhausted all keys. Returns true when there is a match wrt constraints
   // (e.g. field, position, inorder, slop, etc). Returns false otherwise. When
@@ -64,15 +69,15 @@ class TextIterator {
   // This API  resets the Positions.
   // ASSERT: !DoneKeys()
   virtual bool NextKey() = 0;
-  // Seeks forward to the first key >= target_key that matches all constraints.
-  // Returns true if such a key is found, false if no more matching keys exist.
-  // If current key is already >= target_key, returns true without changing
-  // state. This is intended to be used after a previous call to NextKey().
-  // Returns false if no key is found. In this case, the DoneKeys and
-  // DonePositions APIs will return true.
+  // Seeks forward to the first key with an id >= target_doc_id that matches
+  // all constraints. Returns true if such a key is found, false if no more
+  // matching keys exist. If current key is already >= target_doc_id, returns
+  // true without changing state. This is intended to be used after a previous
+  // call to NextKey(). Returns false if no key is found. In this case, the
+  // DoneKeys and DonePositions APIs will return true.
   // This API resets the Positions.
   // ASSERT: !DoneKeys().
-  virtual bool SeekForwardKey(const Key& target_key) = 0;
+  virtual bool SeekForwardKey(DocId target_doc_id) = 0;
 
   // Position-level iteration
   // Returns true if there is a match (i.e. `CurrentPosition()` is valid)
@@ -34,11 +34,14 @@
 #include "absl/strings/string_view.h"
 #include "absl/strings/strip.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "src/attribute_data_type.h"
 #include "src/index_schema.pb.h"
 #include "src/indexes/index_base.h"
 #include "src/indexes/numeric.h"
 #include "src/indexes/tag.h"
+#include "src/indexes/vector_data_type.h"
+#include "src/indexes/vector_quantization.h"
 #include "src/query/predicate.h"
 #include "src/rdb_serialization.h"
 #include "src/utils/string_interning.h"
@@ -60,8 +63,13 @@ namespace {
 
 template <typename T>
 std::unique_ptr<hnswlib::SpaceInterface<T>> CreateSpace(
-    int dimensions, valkey_search::data_model::DistanceMetric distance_metric) {
+    int dimensions, valkey_search::data_model::DistanceMetric distance_metric,
+    valkey_search::data_model::VectorDataType vector_data_type) {
   if constexpr (std::is_same_v<T, float>) {
+    if (indexes::IsHalfPrecision(vector_data_type)) {
+      return std::make_unique<indexes::HalfPrecisionSpace>(
+          dimensions, vector_data_type, distance_metric);
+    }
     if (distance_metric ==
             valkey_search::data_model::DistanceMetric::DISTANCE_METRIC_COSINE ||
         distance_metric ==
@@ -123,58 +131,134 @@ T CopyAndNormalizeEmbedding(T *dst, T *src, size_t size) {
   return magnitude;
 }
 
-std::vector<char> NormalizeEmbedding(absl::string_view record, size_t type_size,
-                                     float *magnitude) {
+std::vector<char> NormalizeEmbedding(
+    absl::string_view record, data_model::VectorDataType vector_data_type,
+    float *magnitude) {
   std::vector<char> ret(record.size());
-  if (type_size == sizeof(float)) {
-    float result = CopyAndNormalizeEmbedding(
+  float result;
+  if (IsHalfPrecision(vector_data_type)) {
+    // Normalize in float32 and round once when narrowing back.
+    auto values = HalfPrecisionToFloat(record, vector_data_type);
+    result = CopyAndNormalizeEmbedding(values.data(), values.data(),
+                                       values.size());
+    FloatToHalfPrecision(values.data(), values.size(), vector_data_type,
+                         ret.data());
+  } else {
+    CHECK_EQ(vector_data_type, data_model::VECTOR_DATA_TYPE_FLOAT32)
+        << "unsupported vector data type";
+    result = CopyAndNormalizeEmbedding(
         (float *)&ret[0], (float *)record.data(), ret.size() / sizeof(float));
-    if (magnitude) {
-      *magnitude = result;
-    }
-    return ret;
   }
-  CHECK(false) << "unsupported type size";
+  if (magnitude) {
+    *magnitude = result;
+  }
+  return ret;
 }
 
 template <typename T>
 void VectorBase::Init(int dimensions,
                       valkey_search::data_model::DistanceMetric distance_metric,
+                      data_model::VectorDataType vector_data_type,
+                      data_model::VectorQuantization quantization,
+                      uint32_t rerank_factor,
                       std::unique_ptr<hnswlib::SpaceInterface<T>> &space) {
-  space = CreateSpace<T>(dimensions, distance_metric);
+  space = CreateSpace<T>(dimensions, distance_metric, vector_data_type);
   distance_metric_ = distance_metric;
+  vector_data_type_ = vector_data_type;
+#ifndef SAN_BUILD
+  if (IsHalfPrecision(vector_data_type)) {
+    vector_allocator_ = CREATE_UNIQUE_PTR(
+        FixedSizeAllocator, dimensions * GetDataTypeSize() + 1, true);
+  }
+#endif  // !SAN_BUILD
   if (distance_metric ==
       valkey_search::data_model::DistanceMetric::DISTANCE_METRIC_COSINE) {
     normalize_ = true;
   }
+  if (quantization == data_model::VECTOR_QUANTIZATION_NONE) {
+    return;
+  }
+  if constexpr (std::is_same_v<T, float>) {
+    auto quantized_space =
+        QuantizedSpace::Create(quantization, dimensions, distance_metric);
+    CHECK(quantized_space) << "unsupported quantization";
+    quantized_space_ = quantized_space.get();
+    rerank_factor_ = rerank_factor;
+    if (rerank_factor_ > 0) {
+      // The full precision space is only used to rerank the candidates.
+      rerank_space_ = std::move(space);
+#ifndef SAN_BUILD
+      rerank_allocator_ = CREATE_UNIQUE_PTR(
+          FixedSizeAllocator, dimensions * sizeof(float) + 1, true);
+#endif  // !SAN_BUILD
+    }
+#ifndef SAN_BUILD
+    vector_allocator_ = CREATE_UNIQUE_PTR(
+        FixedSizeAllocator, quantized_space_->GetCodeSize() + 1, true);
+#endif  // !SAN_BUILD
+    space = std::move(quantized_space);
+  } else {
+    DCHECK(false) << "quantization requires FLOAT32 vectors";
+  }
 }
 
-InternedStringPtr VectorBase::InternVector(absl::string_view record,
-                                           std::optional<float> &magnitude) {
+bool VectorBase::NormalizeRecord(absl::string_view &record,
+                                 std::optional<float> &magnitude,
+                                 std::vector<char> &norm_record) const {
   if (!IsValidSizeVector(record)) {
-    return {};
+    return false;
   }
   if (normalize_) {
     magnitude = kDefaultMagnitude;
-    auto norm_record =
-        NormalizeEmbedding(record, GetDataTypeSize(), &magnitude.value());
-    return StringInternStore::Intern(
-        absl::string_view((const char *)norm_record.data(), norm_record.size()),
-        vector_allocator_.get());
+    norm_record =
+        NormalizeEmbedding(record, vector_data_type_, &magnitude.value());
+    record =
+        absl::string_view((const char *)norm_record.data(), norm_record.size());
   }
-  return StringInternStore::Intern(record, vector_allocator_.get());
+  return true;
+}
+
+InternedStringPtr VectorBase::InternVector(absl::string_view record,
+                                           std::optional<float> &magnitude,
+                                           InternedStringPtr *rerank_vector) {
+  std::vector<char> norm_record;
+  if (!NormalizeRecord(record, magnitude, norm_record)) {
+    return {};
+  }
+  if (!quantized_space_) {
+    return StringInternStore::Intern(record, vector_allocator_.get());
+  }
+  if (rerank_vector && rerank_factor_ > 0) {
+    *rerank_vector = StringInternStore::Intern(record, rerank_allocator_.get());
+  }
+  return StringInternStore::Intern(quantized_space_->Encode(record),
+                                   vector_allocator_.get());
+}
+
+InternedStringPtr VectorBase::InternExternalizedVector(
+    absl::string_view record, std::optional<float> &magnitude) {
+  if (!HasFullPrecisionValues()) {
+    return {};
+  }
+  std::vector<char> norm_record;
+  if (!NormalizeRecord(record, magnitude, norm_record)) {
+    return {};
+  }
+  return StringInternStore::Intern(
+      record, IsQuantized() ? rerank_allocator_.get() : vector_allocator_.get());
 }
 
 absl::StatusOr<bool> VectorBase::AddRecord(const InternedStringPtr &key,
                                            absl::string_view record) {
   std::optional<float> magnitude;
-  auto interned_vector = InternVector(record, magnitude);
+  InternedStringPtr rerank_vector;
+  auto interned_vector = InternVector(record, magnitude, &rerank_vector);
   if (!interned_vector) {
     return false;
   }
   VMSDK_ASSIGN_OR_RETURN(
-      auto internal_id,
-      TrackKey(key, magnitude.value_or(kDefaultMagnitude), interned_vector));
+      auto internal_id, TrackKey(key, magnitude.value_or(kDefaultMagnitude),
+                                 interned_vector, rerank_vector));
   absl::Status add_result = AddRecordImpl(internal_id, interned_vector->Str());
   if (!add_result.ok()) {
     auto untrack_result = UnTrackKey(key);
@@ -189,6 +273,83 @@ absl::StatusOr<bool> VectorBase::AddRecord(const InternedStringPtr &key,
   return true;
 }
 
+std::vector<absl::StatusOr<bool>> VectorBase::AddRecords(
+    absl::Span<const VectorRecord> records) {
+  std::vector<absl::StatusOr<bool>> results(records.size(), false);
+  struct PendingRecord {
+    size_t position;
+    std::optional<float> magnitude;
+    InternedStringPtr vector;
+    InternedStringPtr rerank_vector;
+    uint64_t internal_id;
+  };
+  std::vector<PendingRecord> pending;
+  pending.reserve(records.size());
+  for (size_t i = 0; i < records.size(); ++i) {
+    PendingRecord record{.position = i};
+    record.vector = InternVector(records[i].record, record.magnitude,
+                                 &record.rerank_vector);
+    if (record.vector) {
+      pending.push_back(std::move(record));
+    }
+  }
+  {
+    absl::WriterMutexLock lock(&key_to_metadata_mutex_);
+    size_t tracked = 0;
+    for (size_t i = 0; i < pending.size(); ++i) {
+      auto &record = pending[i];
+      auto internal_id = TrackKeyLocked(
+          records[record.position].key,
+          record.magnitude.value_or(kDefaultMagnitude), record.vector,
+          record.rerank_vector);
+      if (!internal_id.ok()) {
+        results[record.position] = internal_id.status();
+        continue;
+      }
+      record.internal_id = *internal_id;
+      if (tracked != i) {
+        pending[tracked] = std::move(record);
+      }
+      ++tracked;
+    }
+    pending.resize(tracked);
+  }
+  std::vector<PendingAdd> adds;
+  adds.reserve(pending.size());
+  for (const auto &record : pending) {
+    adds.push_back(
+        {.internal_id = record.internal_id, .record = record.vector->Str()});
+  }
+  auto reserve_result = ReserveImpl(adds.size());
+  if (reserve_result.ok()) {
+    AddRecordsImpl(absl::MakeSpan(adds));
+  }
+  for (size_t i = 0; i < pending.size(); ++i) {
+    const auto &key = records[pending[i].position].key;
+    absl::Status add_result =
+        reserve_result.ok() ? adds[i].status : reserve_result;
+    if (!add_result.ok()) {
+      auto untrack_result = UnTrackKey(key);
+      if (!untrack_result.ok()) {
+        VMSDK_LOG_EVERY_N_SEC(WARNING, nullptr, 1)
+            << "While processing error for AddRecords, encountered error in "
+               "UntrackKey: "
+            << untrack_result.status().message();
+      }
+      results[pending[i].position] = add_result;
+      continue;
+    }
+    results[pending[i].position] = true;
+  }
+  return results;
+}
+
+void VectorBase::AddRecordsImpl(absl::Span<PendingAdd> adds) {
+  for (auto &add : adds) {
+    add.status = AddRecordImpl(add.internal_id, add.record);
+  }
+}
+
 absl::StatusOr<uint64_t> VectorBase::GetInternalId(
     const InternedStringPtr &key) const {
   absl::ReaderMutexLock lock(&key_to_metadata_mutex_);
@@ -222,7 +383,8 @@ absl::StatusOr<bool> VectorBase::ModifyRecord(const InternedStringPtr &key,
   // VectorExternalizer tracks added entries. We need to untrack mutations which
   // are processed as modified records.
   std::optional<float> magnitude;
-  auto interned_vector = InternVector(record, magnitude);
+  InternedStringPtr rerank_vector;
+  auto interned_vector = InternVector(record, magnitude, &rerank_vector);
   if (!interned_vector) {
     [[maybe_unused]] auto res =
         RemoveRecord(key, indexes::DeletionType::kRecord);
@@ -231,7 +393,7 @@ absl::StatusOr<bool> VectorBase::ModifyRecord(const InternedStringPtr &key,
   VMSDK_ASSIGN_OR_RETURN(auto internal_id, GetInternalId(key));
   VMSDK_ASSIGN_OR_RETURN(
       bool res, UpdateMetadata(key, magnitude.value_or(kDefaultMagnitude),
-                               interned_vector));
+                               interned_vector, rerank_vector));
   if (!res) {
     return false;
   }
@@ -254,6 +416,8 @@ absl::StatusOr<std::vector<Neighbor>> VectorBase::CreateReply(
     std::priority_queue<std::pair<T, hnswlib::labeltype>> &knn_res) {
   std::vector<Neighbor> ret;
   ret.reserve(knn_res.size());
+  // Snapshot searches map the labels while the index is being mutated.
+  absl::ReaderMutexLock lock(&key_to_metadata_mutex_);
   while (!knn_res.empty()) {
     auto &ele = knn_res.top();
     auto vector_key = GetKeyDuringSearch(ele.second);
@@ -277,13 +441,26 @@ absl::StatusOr<std::vector<char>> VectorBase::GetValue(
     return absl::NotFoundError("Record was not found");
   }
   std::vector<char> result;
-  char *value = GetValueImpl(it->second.internal_id);
+  char *value;
+  if (IsQuantized()) {
+    auto rerank_it = rerank_vectors_.find(it->second.internal_id);
+    if (rerank_it == rerank_vectors_.end()) {
+      return absl::NotFoundError(
+          "Full precision vector is not retained by the quantized index");
+    }
+    value = (char *)rerank_it->second->Str().data();
+  } else {
+    value = GetValueImpl(it->second.internal_id);
+    if (value == nullptr) {
+      return absl::NotFoundError("Vector was not found");
+    }
+  }
   if (normalize_) {
     if (it->second.magnitude < 0) {
       return absl::InternalError("Magnitude is not initialized");
     }
     result = DenormalizeVector(absl::string_view(value, GetVectorDataSize()),
-                               GetDataTypeSize(), it->second.magnitude);
+                               vector_data_type_, it->second.magnitude);
   } else {
     result.assign(value, value + GetVectorDataSize());
   }
@@ -321,6 +498,7 @@ absl::StatusOr<std::optional<uint64_t>> VectorBase::UnTrackKey(
         "but in internal_by_key_");
   }
   key_by_internal_id_.erase(key_by_internal_id_it);
+  rerank_vectors_.erase(id);
   return id;
 }
 
@@ -331,13 +509,19 @@ char *VectorBase::TrackVector(uint64_t internal_id, char *vector, size_t len) {
   return (char *)interned_vector->Str().data();
 }
 
-absl::StatusOr<uint64_t> VectorBase::TrackKey(const InternedStringPtr &key,
-                                              float magnitude,
-                                              const InternedStringPtr &vector) {
+absl::StatusOr<uint64_t> VectorBase::TrackKey(
+    const InternedStringPtr &key, float magnitude,
+    const InternedStringPtr &vector, const InternedStringPtr &rerank_vector) {
+  absl::WriterMutexLock lock(&key_to_metadata_mutex_);
+  return TrackKeyLocked(key, magnitude, vector, rerank_vector);
+}
+
+absl::StatusOr<uint64_t> VectorBase::TrackKeyLocked(
+    const InternedStringPtr &key, float magnitude,
+    const InternedStringPtr &vector, const InternedStringPtr &rerank_vector) {
   if (key->Str().empty()) {
     return absl::InvalidArgumentError("key can't be empty");
   }
-  absl::WriterMutexLock lock(&key_to_metadata_mutex_);
   auto id = inc_id_++;
   auto [_, succ] = tracked_metadata_by_key_.insert(
       {key, {.internal_id = id, .magnitude = magnitude}});
@@ -348,6 +532,9 @@ absl::StatusOr<uint64_t> VectorBase::TrackKey(const InternedStringPtr &key,
   }
   TrackVector(id, vector);
   key_by_internal_id_.insert({id, key});
+  if (rerank_vector) {
+    rerank_vectors_[id] = rerank_vector;
+  }
   return id;
 }
 // Return an error if the key is empty or not being tracked.
@@ -355,7 +542,7 @@ absl::StatusOr<uint64_t> VectorBase::TrackKey(const InternedStringPtr &key,
 // Otherwise, track the new vector and return true.
 absl::StatusOr<bool> VectorBase::UpdateMetadata(
     const InternedStringPtr &key, float magnitude,
-    const InternedStringPtr &vector) {
+    const InternedStringPtr &vector, const InternedStringPtr &rerank_vector) {
   if (key->Str().empty()) {
     return absl::InvalidArgumentError("key can't be empty");
   }
@@ -369,6 +556,11 @@ absl::StatusOr<bool> VectorBase::UpdateMetadata(
     }
     it->second.magnitude = magnitude;
     internal_id = it->second.internal_id;
+    // Distinct vectors may share a code, so the full precision vector is
+    // updated even if the indexed code is unchanged.
+    if (rerank_vector) {
+      rerank_vectors_[internal_id] = rerank_vector;
+    }
   }
   if (IsVectorMatch(internal_id, vector)) {
     return false;
@@ -397,6 +589,16 @@ int VectorBase::RespondWithInfo(ValkeyModuleCtx *ctx) const {
         ctx, std::to_string(key_by_internal_id_.size()).c_str());
   }
   int array_len = 8;
+  if (quantized_space_) {
+    ValkeyModule_ReplyWithSimpleString(ctx, "quantization");
+    ValkeyModule_ReplyWithSimpleString(
+        ctx, LookupKeyByValue(*kVectorQuantizationByStr,
+                              quantized_space_->GetQuantization())
+                 .data());
+    ValkeyModule_ReplyWithSimpleString(ctx, "rerank_factor");
+    ValkeyModule_ReplyWithLongLong(ctx, rerank_factor_);
+    array_len += 4;
+  }
   array_len += RespondWithInfoImpl(ctx);
   ValkeyModule_ReplySetArrayLength(ctx, array_len);
 
@@ -416,6 +618,10 @@ absl::Status VectorBase::SaveTrackedKeys(
     metadata_pb.set_key(key->Str());
     metadata_pb.set_internal_id(metadata.internal_id);
     metadata_pb.set_magnitude(metadata.magnitude);
+    if (auto it = rerank_vectors_.find(metadata.internal_id);
+        it != rerank_vectors_.end()) {
+      metadata_pb.set_rerank_vector(it->second->Str());
+    }
     auto metadata_pb_str = metadata_pb.SerializeAsString();
     VMSDK_RETURN_IF_ERROR(
         chunked_out.SaveChunk(metadata_pb_str.data(), metadata_pb_str.size()))
@@ -442,17 +648,23 @@ void VectorBase::ExternalizeVector(ValkeyModuleCtx *ctx,
   std::optional<float> magnitude;
   auto interned_key = StringInternStore::Intern(key_cstr);
   auto interned_vector =
-      InternVector(vmsdk::ToStringView(record.get()), magnitude);
+      InternExternalizedVector(vmsdk::ToStringView(record.get()), magnitude);
   if (interned_vector) {
     VectorExternalizer::Instance().Externalize(
         interned_key, attribute_identifier, attribute_data_type->ToProto(),
-        interned_vector, magnitude);
+        interned_vector, magnitude, vector_data_type_);
   }
 }
 
 absl::Status VectorBase::LoadTrackedKeys(
     ValkeyModuleCtx *ctx, const AttributeDataType *attribute_data_type,
     SupplementalContentChunkIter &&iter) {
+  VMSDK_RETURN_IF_ERROR(LoadKeyToIdMap(std::move(iter)));
+  ExternalizeTrackedKeys(ctx, attribute_data_type);
+  return absl::OkStatus();
+}
+
+absl::Status VectorBase::LoadKeyToIdMap(SupplementalContentChunkIter &&iter) {
   absl::WriterMutexLock lock(&key_to_metadata_mutex_);
   while (iter.HasNext()) {
     VMSDK_ASSIGN_OR_RETURN(auto metadata_str, iter.Next(),
@@ -468,8 +680,11 @@ absl::Status VectorBase::LoadTrackedKeys(
           .magnitude = tracked_key_metadata.magnitude()}});
     key_by_internal_id_.insert(
         {tracked_key_metadata.internal_id(), interned_key});
-    ExternalizeVector(ctx, attribute_data_type, tracked_key_metadata.key(),
-                      attribute_identifier_);
+    if (rerank_factor_ > 0 && !tracked_key_metadata.rerank_vector().empty()) {
+      rerank_vectors_[tracked_key_metadata.internal_id()] =
+          StringInternStore::Intern(tracked_key_metadata.rerank_vector(),
+                                    rerank_allocator_.get());
+    }
   }
   // Use max label from label_lookup_
   inc_id_ = GetMaxInternalLabel();
@@ -477,6 +692,20 @@ absl::Status VectorBase::LoadTrackedKeys(
   return absl::OkStatus();
 }
 
+void VectorBase::ExternalizeTrackedKeys(
+    ValkeyModuleCtx *ctx, const AttributeDataType *attribute_data_type) {
+  absl::WriterMutexLock lock(&key_to_metadata_mutex_);
+  // Quantized indexes without reranking don't hold the vectors stored in the
+  // keyspace, so there is nothing to externalize.
+  if (!HasFullPrecisionValues()) {
+    return;
+  }
+  for (const auto &[key, _] : tracked_metadata_by_key_) {
+    ExternalizeVector(ctx, attribute_data_type, key->Str(),
+                      attribute_identifier_);
+  }
+}
+
 std::unique_ptr<data_model::Index> VectorBase::ToProto() const {
   absl::ReaderMutexLock lock(&key_to_metadata_mutex_);
   auto index_proto = std::make_unique<data_model::Index>();
@@ -485,6 +714,10 @@ std::unique_ptr<data_model::Index> VectorBase::ToProto() const {
   vector_index->set_distance_metric(distance_metric_);
   vector_index->set_dimension_count(dimensions_);
   vector_index->set_initial_cap(GetCapacity());
+  if (quantized_space_) {
+    vector_index->set_quantization(quantized_space_->GetQuantization());
+    vector_index->set_rerank_factor(rerank_factor_);
+  }
   ToProtoImpl(vector_index.get());
   index_proto->set_allocated_vector_index(vector_index.release());
   return index_proto;
@@ -501,6 +734,46 @@ VectorBase::ComputeDistanceFromRecord(const InternedStringPtr &key,
   return ComputeDistanceFromRecordImpl(internal_id, query);
 }
 
+absl::string_view VectorBase::EncodeQuery(absl::string_view query,
+                                          std::string &code) const {
+  if (!quantized_space_) {
+    return query;
+  }
+  code = quantized_space_->Encode(query);
+  return code;
+}
+
+uint64_t VectorBase::GetSearchCount(uint64_t count) const {
+  return rerank_factor_ > 0 ? count * rerank_factor_ : count;
+}
+
+void VectorBase::Rerank(
+    absl::string_view query, uint64_t count,
+    std::priority_queue<std::pair<float, hnswlib::labeltype>> &results) const {
+  if (rerank_factor_ == 0) {
+    return;
+  }
+  auto dist_func = rerank_space_->get_dist_func();
+  auto dist_func_param = rerank_space_->get_dist_func_param();
+  std::priority_queue<std::pair<float, hnswlib::labeltype>> reranked;
+  for (; !results.empty(); results.pop()) {
+    auto label = results.top().second;
+    auto it = rerank_vectors_.find(label);
+    if (it == rerank_vectors_.end()) {
+      continue;
+    }
+    float distance =
+        dist_func(query.data(), it->second->Str().data(), dist_func_param);
+    if (reranked.size() < count) {
+      reranked.emplace(distance, label);
+    } else if (distance < reranked.top().first) {
+      reranked.pop();
+      reranked.emplace(distance, label);
+    }
+  }
+  results = std::move(reranked);
+}
+
 bool VectorBase::AddPrefilteredKey(
     absl::string_view query, uint64_t count, const InternedStringPtr &key,
     std::priority_queue<std::pair<float, hnswlib::labeltype>> &results,
@@ -526,21 +799,27 @@ bool VectorBase::AddPrefilteredKey(
 
 vmsdk::UniqueValkeyString VectorBase::NormalizeStringRecord(
     vmsdk::UniqueValkeyString record) const {
-  CHECK_EQ(GetDataTypeSize(), sizeof(float));
   auto record_str = vmsdk::ToStringView(record.get());
   if (absl::ConsumePrefix(&record_str, "[")) {
     absl::ConsumeSuffix(&record_str, "]");
   }
   std::vector<std::string> float_strings =
       absl::StrSplit(record_str, ',', absl::SkipWhitespace());
-  std::string binary_string;
-  binary_string.reserve(float_strings.size() * sizeof(float));
+  std::vector<float> values;
+  values.reserve(float_strings.size());
   for (const auto &float_str : float_strings) {
     float value;
     if (!absl::SimpleAtof(float_str, &value)) {
       return nullptr;
     }
-    binary_string += std::string((char *)&value, sizeof(float));
+    values.push_back(value);
+  }
+  std::string binary_string(values.size() * GetDataTypeSize(), '\0');
+  if (IsHalfPrecision(vector_data_type_)) {
+    FloatToHalfPrecision(values.data(), values.size(), vector_data_type_,
+                         binary_string.data());
+  } else {
+    std::memcpy(binary_string.data(), values.data(), binary_string.size());
   }
   return vmsdk::MakeUniqueValkeyString(binary_string);
 }
@@ -580,6 +859,8 @@ absl::Status VectorBase::ForEachUnTrackedKey(
 
 template void VectorBase::Init<float>(
     int dimensions, data_model::DistanceMetric distance_metric,
+    data_model::VectorDataType vector_data_type,
+    data_model::VectorQuantization quantization, uint32_t rerank_factor,
     std::unique_ptr<hnswlib::SpaceInterface<float>> &space);
 
 template absl::StatusOr<std::vector<Neighbor>> VectorBase::CreateReply<float>(
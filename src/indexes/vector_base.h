@@ -27,9 +27,12 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "src/attribute_data_type.h"
 #include "src/index_schema.pb.h"
 #include "src/indexes/index_base.h"
+#include "src/indexes/vector_data_type.h"
+#include "src/indexes/vector_quantization.h"
 #include "src/query/predicate.h"
 #include "src/rdb_serialization.h"
 #include "src/utils/allocator.h"
@@ -45,8 +48,9 @@ enum class QueryOperations : uint64_t;
 
 namespace valkey_search::indexes {
 
-std::vector<char> NormalizeEmbedding(absl::string_view record, size_t type_size,
-                                     float* magnitude = nullptr);
+std::vector<char> NormalizeEmbedding(
+    absl::string_view record, data_model::VectorDataType vector_data_type,
+    float* magnitude = nullptr);
 
 struct Neighbor {
   InternedStringPtr external_id;
@@ -93,6 +97,7 @@ const absl::NoDestructor<absl::flat_hash_map<
     kVectorAlgoByStr({
         {"HNSW", data_model::VectorIndex::AlgorithmCase::kHnswAlgorithm},
         {"FLAT", data_model::VectorIndex::AlgorithmCase::kFlatAlgorithm},
+        {"IVF_PQ", data_model::VectorIndex::AlgorithmCase::kIvfPqAlgorithm},
     });
 
 const absl::NoDestructor<
@@ -104,7 +109,15 @@ const absl::NoDestructor<
 
 const absl::NoDestructor<
     absl::flat_hash_map<absl::string_view, data_model::VectorDataType>>
-    kVectorDataTypeByStr({{"FLOAT32", data_model::VECTOR_DATA_TYPE_FLOAT32}});
+    kVectorDataTypeByStr(
+        {{"FLOAT32", data_model::VECTOR_DATA_TYPE_FLOAT32},
+         {"FLOAT16", data_model::VECTOR_DATA_TYPE_FLOAT16},
+         {"BFLOAT16", data_model::VECTOR_DATA_TYPE_BFLOAT16}});
+
+const absl::NoDestructor<
+    absl::flat_hash_map<absl::string_view, data_model::VectorQuantization>>
+    kVectorQuantizationByStr({{"SQ8", data_model::VECTOR_QUANTIZATION_SQ8},
+                              {"BQ", data_model::VECTOR_QUANTIZATION_BQ}});
 
 template <typename V>
 absl::string_view LookupKeyByValue(
@@ -124,6 +137,12 @@ class VectorBase : public IndexBase, public hnswlib::VectorTracker {
   absl::StatusOr<bool> AddRecord(const InternedStringPtr& key,
                                  absl::string_view record) override
       ABSL_LOCKS_EXCLUDED(key_to_metadata_mutex_);
+  using VectorRecord = IndexBase::Record;
+  // Internal ids are assigned under a single acquisition of the key metadata
+  // lock and the index capacity is reserved once for the whole batch.
+  std::vector<absl::StatusOr<bool>> AddRecords(
+      absl::Span<const VectorRecord> records) override
+      ABSL_LOCKS_EXCLUDED(key_to_metadata_mutex_);
   absl::StatusOr<bool> RemoveRecord(const InternedStringPtr& key,
                                     indexes::DeletionType deletion_type =
                                         indexes::DeletionType::kNone) override
@@ -140,6 +159,14 @@ class VectorBase : public IndexBase, public hnswlib::VectorTracker {
   absl::Status LoadTrackedKeys(ValkeyModuleCtx* ctx,
                                const AttributeDataType* attribute_data_type,
                                SupplementalContentChunkIter&& iter);
+  // The two steps of LoadTrackedKeys. Loading the key to id map doesn't
+  // access the keyspace and may run off the main thread, externalizing the
+  // vectors of the tracked keys reads them from the keyspace.
+  absl::Status LoadKeyToIdMap(SupplementalContentChunkIter&& iter)
+      ABSL_LOCKS_EXCLUDED(key_to_metadata_mutex_);
+  void ExternalizeTrackedKeys(ValkeyModuleCtx* ctx,
+                              const AttributeDataType* attribute_data_type)
+      ABSL_LOCKS_EXCLUDED(key_to_metadata_mutex_);
 
   uint32_t GetMutationWeight() const override;
 
@@ -173,8 +200,39 @@ class VectorBase : public IndexBase, public hnswlib::VectorTracker {
       ABSL_NO_THREAD_SAFETY_ANALYSIS;
   int GetVectorDataSize() const { return GetDataTypeSize() * dimensions_; }
   char* TrackVector(uint64_t internal_id, char* vector, size_t len) override;
+  // Interns the vector as stored by the index: the (normalized) vector, or its
+  // code for quantized indexes. When reranking is enabled, the full precision
+  // vector is interned into `rerank_vector`.
   InternedStringPtr InternVector(absl::string_view record,
-                                 std::optional<float>& magnitude);
+                                 std::optional<float>& magnitude,
+                                 InternedStringPtr* rerank_vector = nullptr);
+  // Interns the full precision vector the index shares with the keyspace
+  // through the vector externalizer: the indexed vector, or the one kept for
+  // reranking by quantized indexes. Returns null if the index retains none.
+  InternedStringPtr InternExternalizedVector(absl::string_view record,
+                                             std::optional<float>& magnitude);
+  data_model::VectorDataType GetVectorDataType() const {
+    return vector_data_type_;
+  }
+  bool IsQuantized() const { return quantized_space_ != nullptr; }
+  // Whether GetValue can reconstruct the indexed vectors. Quantized indexes
+  // only retain full precision vectors when reranking is enabled.
+  bool HasFullPrecisionValues() const {
+    return !IsQuantized() || rerank_factor_ > 0;
+  }
+  // Returns `query` for full precision indexes. Quantized indexes encode it
+  // into `code` and return a view of it.
+  absl::string_view EncodeQuery(absl::string_view query,
+                                std::string& code) const;
+  // Number of candidates to fetch for `count` neighbors, accounting for the
+  // candidates dropped by Rerank.
+  uint64_t GetSearchCount(uint64_t count) const;
+  // Recomputes the distances of the quantized candidates in `results` from
+  // the full precision vectors and keeps the `count` closest ones. A no-op
+  // unless reranking is enabled.
+  void Rerank(absl::string_view query, uint64_t count,
+              std::priority_queue<std::pair<float, hnswlib::labeltype>>&
+                  results) const ABSL_NO_THREAD_SAFETY_ANALYSIS;
   virtual uint64_t GetMaxInternalLabel() const { return 0; }
   virtual size_t GetLabelCount() const { return 0; }
 
@@ -202,16 +260,33 @@ class VectorBase : public IndexBase, public hnswlib::VectorTracker {
   int RespondWithInfo(ValkeyModuleCtx* ctx) const override;
   template <typename T>
   void Init(int dimensions, data_model::DistanceMetric distance_metric,
+            data_model::VectorDataType vector_data_type,
+            data_model::VectorQuantization quantization,
+            uint32_t rerank_factor,
             std::unique_ptr<hnswlib::SpaceInterface<T>>& space);
   virtual absl::Status AddRecordImpl(uint64_t internal_id,
                                      absl::string_view record) = 0;
+  // Makes room for `count` more records ahead of a batch of AddRecordImpl
+  // calls, so that the index grows at most once per batch.
+  virtual absl::Status ReserveImpl(size_t count) { return absl::OkStatus(); }
+  // A tracked record of a batch, pending insertion by AddRecordsImpl.
+  struct PendingAdd {
+    uint64_t internal_id;
+    absl::string_view record;
+    absl::Status status;
+  };
+  // Inserts a batch of tracked records and sets the status of each. Calls
+  // AddRecordImpl for each record by default.
+  virtual void AddRecordsImpl(absl::Span<PendingAdd> adds);
 
   virtual absl::Status RemoveRecordImpl(uint64_t internal_id) = 0;
   virtual absl::Status ModifyRecordImpl(uint64_t internal_id,
                                         absl::string_view record) = 0;
   virtual int RespondWithInfoImpl(ValkeyModuleCtx* ctx) const = 0;
 
-  virtual size_t GetDataTypeSize() const = 0;
+  size_t GetDataTypeSize() const {
+    return GetVectorDataTypeSize(vector_data_type_);
+  }
   virtual void ToProtoImpl(
       data_model::VectorIndex* vector_index_proto) const = 0;
   virtual absl::Status SaveIndexImpl(
@@ -227,6 +302,11 @@ class VectorBase : public IndexBase, public hnswlib::VectorTracker {
   bool normalize_{false};
   data_model::AttributeDataType attribute_data_type_;
   data_model::DistanceMetric distance_metric_;
+  data_model::VectorDataType vector_data_type_{
+      data_model::VectorDataType::VECTOR_DATA_TYPE_FLOAT32};
+  // Owned by the space of the subclass, null for full precision indexes.
+  QuantizedSpace* quantized_space_{nullptr};
+  uint32_t rerank_factor_{0};
   virtual absl::StatusOr<std::pair<float, hnswlib::labeltype>>
   ComputeDistanceFromRecordImpl(uint64_t internal_id,
                                 absl::string_view query) const = 0;
@@ -239,20 +319,36 @@ class VectorBase : public IndexBase, public hnswlib::VectorTracker {
  private:
   absl::StatusOr<uint64_t> TrackKey(const InternedStringPtr& key,
                                     float magnitude,
-                                    const InternedStringPtr& vector)
+                                    const InternedStringPtr& vector,
+                                    const InternedStringPtr& rerank_vector)
       ABSL_LOCKS_EXCLUDED(key_to_metadata_mutex_);
+  absl::StatusOr<uint64_t> TrackKeyLocked(
+      const InternedStringPtr& key, float magnitude,
+      const InternedStringPtr& vector, const InternedStringPtr& rerank_vector)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(key_to_metadata_mutex_);
   absl::StatusOr<std::optional<uint64_t>> UnTrackKey(
       const InternedStringPtr& key) ABSL_LOCKS_EXCLUDED(key_to_metadata_mutex_);
   absl::StatusOr<bool> UpdateMetadata(const InternedStringPtr& key,
                                       float magnitude,
-                                      const InternedStringPtr& vector)
+                                      const InternedStringPtr& vector,
+                                      const InternedStringPtr& rerank_vector)
       ABSL_LOCKS_EXCLUDED(key_to_metadata_mutex_);
+  // Validates `record` and points it to its normalized copy in `norm_record`
+  // if the index normalizes vectors.
+  bool NormalizeRecord(absl::string_view& record,
+                       std::optional<float>& magnitude,
+                       std::vector<char>& norm_record) const;
   absl::StatusOr<uint64_t> GetInternalId(const InternedStringPtr& key) const
       ABSL_LOCKS_EXCLUDED(key_to_metadata_mutex_);
   absl::StatusOr<uint64_t> GetInternalIdDuringSearch(
       const InternedStringPtr& key) const ABSL_NO_THREAD_SAFETY_ANALYSIS;
   absl::flat_hash_map<uint64_t, InternedStringPtr> key_by_internal_id_
       ABSL_GUARDED_BY(key_to_metadata_mutex_);
+  // Full precision vectors of quantized indexes with reranking enabled,
+  // shared with the keyspace through the vector externalizer.
+  absl::flat_hash_map<uint64_t, InternedStringPtr> rerank_vectors_
+      ABSL_GUARDED_BY(key_to_metadata_mutex_);
+  std::unique_ptr<hnswlib::SpaceInterface<float>> rerank_space_;
   struct TrackedKeyMetadata {
     uint64_t internal_id;
     // If normalize_ is false, this will be -1.0f. Otherwise, it will be the
@@ -270,6 +366,7 @@ class VectorBase : public IndexBase, public hnswlib::VectorTracker {
   ComputeDistanceFromRecord(const InternedStringPtr& key,
                             absl::string_view query) const;
   UniqueFixedSizeAllocatorPtr vector_allocator_{nullptr, nullptr};
+  UniqueFixedSizeAllocatorPtr rerank_allocator_{nullptr, nullptr};
 };
 
 class PrefilterEvaluator : public query::Evaluator {
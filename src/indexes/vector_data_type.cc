@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2025, valkey-search contributors
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD 3-Clause
+ *
+ */
+
+#include "src/indexes/vector_data_type.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/strings/string_view.h"
+#include "src/index_schema.pb.h"
+#include "third_party/hnswlib/hnswlib.h"
+#include "third_party/simsimd/include/simsimd/simsimd.h"
+
+namespace valkey_search::indexes {
+
+namespace {
+
+inline size_t Dimensions(const void *dim_ptr) {
+  return *static_cast<const size_t *>(dim_ptr);
+}
+
+inline const simsimd_f16_t *AsF16(const void *vector) {
+  return static_cast<const simsimd_f16_t *>(vector);
+}
+
+inline const simsimd_bf16_t *AsBF16(const void *vector) {
+  return static_cast<const simsimd_bf16_t *>(vector);
+}
+
+float Float16L2Sqr(const void *a, const void *b, const void *dim_ptr) {
+  simsimd_distance_t distance;
+  simsimd_l2sq_f16(AsF16(a), AsF16(b), Dimensions(dim_ptr), &distance);
+  return distance;
+}
+
+float Float16InnerProductDistance(const void *a, const void *b,
+                                  const void *dim_ptr) {
+  simsimd_distance_t dot;
+  simsimd_dot_f16(AsF16(a), AsF16(b), Dimensions(dim_ptr), &dot);
+  return 1.0f - dot;
+}
+
+float BFloat16L2Sqr(const void *a, const void *b, const void *dim_ptr) {
+  simsimd_distance_t distance;
+  simsimd_l2sq_bf16(AsBF16(a), AsBF16(b), Dimensions(dim_ptr), &distance);
+  return distance;
+}
+
+float BFloat16InnerProductDistance(const void *a, const void *b,
+                                   const void *dim_ptr) {
+  simsimd_distance_t dot;
+  simsimd_dot_bf16(AsBF16(a), AsBF16(b), Dimensions(dim_ptr), &dot);
+  return 1.0f - dot;
+}
+
+hnswlib::DISTFUNC<float> GetHalfPrecisionDistFunc(
+    data_model::VectorDataType vector_data_type,
+    data_model::DistanceMetric distance_metric) {
+  bool inner_product =
+      distance_metric == data_model::DistanceMetric::DISTANCE_METRIC_IP ||
+      distance_metric == data_model::DistanceMetric::DISTANCE_METRIC_COSINE;
+  if (vector_data_type == data_model::VECTOR_DATA_TYPE_FLOAT16) {
+    return inner_product ? Float16InnerProductDistance : Float16L2Sqr;
+  }
+  CHECK_EQ(vector_data_type, data_model::VECTOR_DATA_TYPE_BFLOAT16);
+  return inner_product ? BFloat16InnerProductDistance : BFloat16L2Sqr;
+}
+
+// Rounds to the nearest BFLOAT16, ties to even. simsimd_compress_bf16
+// truncates, which biases normalized vectors towards zero.
+uint16_t RoundToBFloat16(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  bits += 0x7FFF + ((bits >> 16) & 1);
+  return static_cast<uint16_t>(bits >> 16);
+}
+
+}  // namespace
+
+size_t GetVectorDataTypeSize(data_model::VectorDataType vector_data_type) {
+  switch (vector_data_type) {
+    case data_model::VECTOR_DATA_TYPE_FLOAT16:
+    case data_model::VECTOR_DATA_TYPE_BFLOAT16:
+      return sizeof(uint16_t);
+    default:
+      return sizeof(float);
+  }
+}
+
+std::vector<float> HalfPrecisionToFloat(
+    absl::string_view record, data_model::VectorDataType vector_data_type) {
+  std::vector<float> result(record.size() / sizeof(uint16_t));
+  for (size_t i = 0; i < result.size(); ++i) {
+    uint16_t value;
+    std::memcpy(&value, record.data() + i * sizeof(uint16_t), sizeof(value));
+    result[i] = vector_data_type == data_model::VECTOR_DATA_TYPE_FLOAT16
+                    ? simsimd_uncompress_f16(value)
+                    : simsimd_uncompress_bf16(value);
+  }
+  return result;
+}
+
+void FloatToHalfPrecision(const float *src, size_t size,
+                          data_model::VectorDataType vector_data_type,
+                          char *dst) {
+  for (size_t i = 0; i < size; ++i) {
+    uint16_t value = vector_data_type == data_model::VECTOR_DATA_TYPE_FLOAT16
+                         ? simsimd_compress_f16(src[i])
+                         : RoundToBFloat16(src[i]);
+    std::memcpy(dst + i * sizeof(uint16_t), &value, sizeof(value));
+  }
+}
+
+HalfPrecisionSpace::HalfPrecisionSpace(
+    size_t dimensions, data_model::VectorDataType vector_data_type,
+    data_model::DistanceMetric distance_metric)
+    : dimensions_(dimensions),
+      data_size_(dimensions * GetVectorDataTypeSize(vector_data_type)),
+      dist_func_(GetHalfPrecisionDistFunc(vector_data_type, distance_metric)) {
+}
+
+}  // namespace valkey_search::indexes
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2025, valkey-search contributors
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD 3-Clause
+ *
+ */
+
+#ifndef VALKEYSEARCH_SRC_INDEXES_VECTOR_DATA_TYPE_H_
+#define VALKEYSEARCH_SRC_INDEXES_VECTOR_DATA_TYPE_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "src/index_schema.pb.h"
+#include "third_party/hnswlib/hnswlib.h"
+
+namespace valkey_search::indexes {
+
+// Size in bytes of a single vector element of the given type.
+size_t GetVectorDataTypeSize(data_model::VectorDataType vector_data_type);
+
+inline bool IsHalfPrecision(data_model::VectorDataType vector_data_type) {
+  return vector_data_type == data_model::VECTOR_DATA_TYPE_FLOAT16 ||
+         vector_data_type == data_model::VECTOR_DATA_TYPE_BFLOAT16;
+}
+
+// Widens a half precision vector to float32.
+std::vector<float> HalfPrecisionToFloat(
+    absl::string_view record, data_model::VectorDataType vector_data_type);
+
+// Narrows `size` float32 values into `dst`, which must hold `size` half
+// precision elements.
+void FloatToHalfPrecision(const float *src, size_t size,
+                          data_model::VectorDataType vector_data_type,
+                          char *dst);
+
+// hnswlib space over FLOAT16 or BFLOAT16 vectors. Distances are computed by the
+// simsimd half precision kernels, which accumulate in float32.
+class HalfPrecisionSpace : public hnswlib::SpaceInterface<float> {
+ public:
+  HalfPrecisionSpace(size_t dimensions,
+                     data_model::VectorDataType vector_data_type,
+                     data_model::DistanceMetric distance_metric);
+  ~HalfPrecisionSpace() override = default;
+
+  size_t get_data_size() override { return data_size_; }
+  hnswlib::DISTFUNC<float> get_dist_func() override { return dist_func_; }
+  void *get_dist_func_param() override { return &dimensions_; }
+
+ private:
+  size_t dimensions_;
+  size_t data_size_;
+  hnswlib::DISTFUNC<float> dist_func_;
+};
+
+}  // namespace valkey_search::indexes
+
+#endif  // VALKEYSEARCH_SRC_INDEXES_VECTOR_DATA_TYPE_H_
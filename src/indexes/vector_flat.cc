@@ -15,11 +15,13 @@
 #include <exception>
 #include <memory>
 #include <mutex>  // NOLINT(build/c++11)
+#include <optional>
 #include <queue>
+#include <stdexcept>
 #include <string>
 #include <string_view>
-#include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "absl/log/check.h"
 #include "absl/status/status.h"
@@ -35,8 +37,11 @@
 #include "src/rdb_serialization.h"
 #include "src/utils/cancel.h"
 #include "src/utils/string_interning.h"
+#include "src/valkey_search.h"
+#include "src/valkey_search_options.h"
 #include "vmsdk/src/log.h"
 #include "vmsdk/src/status/status_macros.h"
+#include "vmsdk/src/thread_pool.h"
 #include "vmsdk/src/valkey_module_api/valkey_module.h"
 
 // Note that the ordering matters here - we want to minimize the memory
@@ -61,7 +66,10 @@ absl::StatusOr<std::shared_ptr<VectorFlat<T>>> VectorFlat<T>::Create(
                           vector_index_proto.flat_algorithm().block_size(),
                           attribute_identifier, attribute_data_type));
     index->Init(vector_index_proto.dimension_count(),
-                vector_index_proto.distance_metric(), index->space_);
+                vector_index_proto.distance_metric(),
+                vector_index_proto.vector_data_type(),
+                vector_index_proto.quantization(),
+                vector_index_proto.rerank_factor(), index->space_);
     index->algo_ = std::make_unique<hnswlib::BruteforceSearch<T>>(
         index->space_.get(), vector_index_proto.initial_cap());
     return index;
@@ -109,7 +117,10 @@ absl::StatusOr<std::shared_ptr<VectorFlat<T>>> VectorFlat<T>::LoadFromRDB(
         vector_index_proto.flat_algorithm().block_size(), attribute_identifier,
         attribute_data_type->ToProto()));
     index->Init(vector_index_proto.dimension_count(),
-                vector_index_proto.distance_metric(), index->space_);
+                vector_index_proto.distance_metric(),
+                vector_index_proto.vector_data_type(),
+                vector_index_proto.quantization(),
+                vector_index_proto.rerank_factor(), index->space_);
     index->algo_ =
         std::make_unique<hnswlib::BruteforceSearch<T>>(index->space_.get());
     RDBChunkInputStream input(std::move(iter));
@@ -151,6 +162,32 @@ absl::Status VectorFlat<T>::ResizeIfFull() {
   return absl::OkStatus();
 }
 
+template <typename T>
+absl::Status VectorFlat<T>::ReserveImpl(size_t count) {
+  {
+    absl::ReaderMutexLock lock(&resize_mutex_);
+    if (algo_->cur_element_count_ + count <= GetCapacity()) {
+      return absl::OkStatus();
+    }
+  }
+  absl::WriterMutexLock lock(&resize_mutex_);
+  std::unique_lock<std::mutex> index_lock(algo_->index_lock);
+  const size_t capacity = GetCapacity();
+  const size_t required = algo_->cur_element_count_ + count;
+  if (required > capacity) {
+    const size_t block_size = std::max<size_t>(block_size_, 1);
+    const size_t new_capacity =
+        capacity +
+        (required - capacity + block_size - 1) / block_size * block_size;
+    VMSDK_LOG_EVERY_N_SEC(WARNING, nullptr, 1)
+        << "Resizing FLAT Index for a batch of " << count
+        << " records, current size: " << capacity
+        << ", new size: " << new_capacity;
+    algo_->resizeIndex(new_capacity);
+  }
+  return absl::OkStatus();
+}
+
 template <typename T>
 absl::Status VectorFlat<T>::AddRecordImpl(uint64_t internal_id,
                                           absl::string_view record) {
@@ -218,6 +255,95 @@ class CancelCondition : public hnswlib::BaseCancellationFunctor {
   cancel::Token &token_;
 };
 
+template <typename T>
+std::optional<std::priority_queue<std::pair<T, hnswlib::labeltype>>>
+VectorFlat<T>::ParallelSearchKnn(const T *query, uint64_t k,
+                                 hnswlib::BaseFilterFunctor *filter,
+                                 cancel::Token &cancellation_token) const {
+  using Results = std::priority_queue<std::pair<T, hnswlib::labeltype>>;
+  const size_t element_count = algo_->cur_element_count_;
+  const size_t parallelism = options::GetMaxSearchParallelism().GetValue();
+  auto reader_thread_pool = ValkeySearch::Instance().GetReaderThreadPool();
+  if (parallelism <= 1 || !reader_thread_pool ||
+      reader_thread_pool->Size() <= 1 || element_count <= kSearchMorselSize) {
+    return std::nullopt;
+  }
+  // Same scheme as the parallel HNSW build. The index is split into morsels
+  // of consecutive vectors, claimed by the calling thread and by helper tasks
+  // on the reader threads, each keeping its own top k which are then merged.
+  // The calling thread holds resize_mutex_ until every claimed morsel is
+  // scanned and never waits for a morsel that is not claimed yet, so the
+  // search completes even if the reader threads are busy. Helpers that start
+  // after the search completed find no morsel left and return without
+  // touching the search.
+  struct SearchState {
+    const hnswlib::BruteforceSearch<T> *algo;
+    const T *query;
+    uint64_t k;
+    hnswlib::BaseFilterFunctor *filter;
+    cancel::Token *cancellation_token;
+    size_t morsel_count;
+    std::atomic<size_t> next_morsel{0};
+    absl::Mutex mutex;
+    Results results ABSL_GUARDED_BY(mutex);
+    std::optional<std::string> error ABSL_GUARDED_BY(mutex);
+    size_t done_morsels ABSL_GUARDED_BY(mutex){0};
+    bool IsDone() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex) {
+      return done_morsels == morsel_count;
+    }
+  };
+  auto state = std::make_shared<SearchState>();
+  state->algo = algo_.get();
+  state->query = query;
+  state->k = k;
+  state->filter = filter;
+  state->cancellation_token = &cancellation_token;
+  state->morsel_count =
+      (element_count + kSearchMorselSize - 1) / kSearchMorselSize;
+  auto scan_morsels = [](SearchState &state) {
+    size_t morsel;
+    while ((morsel = state.next_morsel.fetch_add(1)) < state.morsel_count) {
+      const size_t begin = morsel * kSearchMorselSize;
+      Results morsel_results;
+      std::optional<std::string> error;
+      try {
+        CancelCondition canceler(*state.cancellation_token);
+        morsel_results = state.algo->searchKnnRange(
+            state.query, state.k, begin, begin + kSearchMorselSize,
+            state.filter, &canceler);
+      } catch (const std::exception &e) {
+        error = e.what();
+      }
+      absl::MutexLock lock(&state.mutex);
+      if (error.has_value()) {
+        state.error = std::move(error);
+      }
+      for (; !morsel_results.empty(); morsel_results.pop()) {
+        state.results.push(morsel_results.top());
+        if (state.results.size() > state.k) {
+          state.results.pop();
+        }
+      }
+      ++state.done_morsels;
+    }
+  };
+  const size_t helper_count =
+      std::min({parallelism - 1, reader_thread_pool->Size(),
+                state->morsel_count - 1});
+  for (size_t i = 0; i < helper_count; ++i) {
+    reader_thread_pool->Schedule(
+        [state, scan_morsels]() { scan_morsels(*state); },
+        vmsdk::ThreadPool::Priority::kHigh);
+  }
+  scan_morsels(*state);
+  absl::MutexLock lock(&state->mutex);
+  state->mutex.Await(absl::Condition(state.get(), &SearchState::IsDone));
+  if (state->error.has_value()) {
+    throw std::runtime_error(*state->error);
+  }
+  return std::move(state->results);
+}
+
 template <typename T>
 absl::StatusOr<std::vector<Neighbor>> VectorFlat<T>::Search(
     absl::string_view query, uint64_t count, cancel::Token &cancellation_token,
@@ -228,31 +354,35 @@ absl::StatusOr<std::vector<Neighbor>> VectorFlat<T>::Search(
         query.size(), ") does not match index's expected size (",
         dimensions_ * GetDataTypeSize(), ")."));
   }
-  auto perform_search = [this, count, &filter,
+  auto perform_search = [this, search_count = GetSearchCount(count), &filter,
                          &cancellation_token](absl::string_view query)
       -> absl::StatusOr<std::priority_queue<std::pair<T, hnswlib::labeltype>>> {
     absl::ReaderMutexLock lock(&resize_mutex_);
     try {
+      const uint64_t k = std::min(
+          search_count, static_cast<uint64_t>(algo_->cur_element_count_));
+      if (auto results = ParallelSearchKnn((T *)query.data(), k, filter.get(),
+                                           cancellation_token)) {
+        return std::move(*results);
+      }
       CancelCondition canceler(cancellation_token);
-      return algo_->searchKnn(
-          (T *)query.data(),
-          std::min(count, static_cast<uint64_t>(algo_->cur_element_count_)),
-          filter.get(), &canceler);
+      return algo_->searchKnn((T *)query.data(), k, filter.get(), &canceler);
     } catch (const std::exception &e) {
       Metrics::GetStats().flat_search_exceptions_cnt.fetch_add(
           1, std::memory_order_relaxed);
       return absl::InternalError(e.what());
     }
   };
+  std::vector<char> norm_record;
   if (normalize_) {
-    auto norm_record = NormalizeEmbedding(query, GetDataTypeSize());
-    VMSDK_ASSIGN_OR_RETURN(
-        auto search_result,
-        perform_search(absl::string_view((const char *)norm_record.data(),
-                                         norm_record.size())));
-    return CreateReply(search_result);
+    norm_record = NormalizeEmbedding(query, vector_data_type_);
+    query =
+        absl::string_view((const char *)norm_record.data(), norm_record.size());
   }
-  VMSDK_ASSIGN_OR_RETURN(auto search_result, perform_search(query));
+  std::string code;
+  VMSDK_ASSIGN_OR_RETURN(auto search_result,
+                         perform_search(EncodeQuery(query, code)));
+  Rerank(query, count, search_result);
   return CreateReply(search_result);
 }
 
@@ -276,14 +406,7 @@ VectorFlat<T>::ComputeDistanceFromRecordImpl(uint64_t internal_id,
 template <typename T>
 void VectorFlat<T>::ToProtoImpl(
     data_model::VectorIndex *vector_index_proto) const {
-  data_model::VectorDataType data_type;
-  if constexpr (std::is_same_v<T, float>) {
-    data_type = data_model::VectorDataType::VECTOR_DATA_TYPE_FLOAT32;
-  } else {
-    DCHECK(false) << "Unsupported type: " << typeid(T).name();
-    data_type = data_model::VectorDataType::VECTOR_DATA_TYPE_UNSPECIFIED;
-  }
-  vector_index_proto->set_vector_data_type(data_type);
+  vector_index_proto->set_vector_data_type(vector_data_type_);
 
   auto flat_algorithm_proto = std::make_unique<data_model::FlatAlgorithm>();
   flat_algorithm_proto->set_block_size(block_size_);
@@ -294,15 +417,8 @@ void VectorFlat<T>::ToProtoImpl(
 template <typename T>
 int VectorFlat<T>::RespondWithInfoImpl(ValkeyModuleCtx *ctx) const {
   ValkeyModule_ReplyWithSimpleString(ctx, "data_type");
-  if constexpr (std::is_same_v<T, float>) {
-    ValkeyModule_ReplyWithSimpleString(
-        ctx,
-        LookupKeyByValue(*kVectorDataTypeByStr,
-                         data_model::VectorDataType::VECTOR_DATA_TYPE_FLOAT32)
-            .data());
-  } else {
-    ValkeyModule_ReplyWithSimpleString(ctx, "UNKNOWN");
-  }
+  ValkeyModule_ReplyWithSimpleString(
+      ctx, LookupKeyByValue(*kVectorDataTypeByStr, vector_data_type_).data());
   ValkeyModule_ReplyWithSimpleString(ctx, "algorithm");
   ValkeyModule_ReplyWithArray(ctx, 4);
   ValkeyModule_ReplyWithSimpleString(ctx, "name");
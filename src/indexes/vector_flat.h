@@ -12,6 +12,8 @@
 #include <cstdint>
 #include <deque>
 #include <memory>
+#include <optional>
+#include <queue>
 #include <utility>
 
 #include "absl/base/thread_annotations.h"
@@ -31,6 +33,9 @@
 
 namespace valkey_search::indexes {
 
+// Number of vectors scanned at once by a thread of a parallel search.
+constexpr size_t kSearchMorselSize = 64 * 1024;
+
 template <typename T>
 class VectorFlat : public VectorBase {
  public:
@@ -45,7 +50,6 @@ class VectorFlat : public VectorBase {
       absl::string_view attribute_identifier,
       SupplementalContentChunkIter&& iter) ABSL_NO_THREAD_SAFETY_ANALYSIS;
   ~VectorFlat() override = default;
-  size_t GetDataTypeSize() const override { return sizeof(T); }
 
   const hnswlib::SpaceInterface<float>* GetSpace() const {
     return space_.get();
@@ -67,6 +71,8 @@ class VectorFlat : public VectorBase {
   absl::Status AddRecordImpl(uint64_t internal_id,
                              absl::string_view record) override
       ABSL_LOCKS_EXCLUDED(resize_mutex_);
+  absl::Status ReserveImpl(size_t count) override
+      ABSL_LOCKS_EXCLUDED(resize_mutex_);
 
   absl::Status RemoveRecordImpl(uint64_t internal_id) override
       ABSL_LOCKS_EXCLUDED(resize_mutex_);
@@ -95,6 +101,14 @@ class VectorFlat : public VectorBase {
   VectorFlat(int dimensions, data_model::DistanceMetric distance_metric,
              uint32_t block_size, absl::string_view attribute_identifier,
              data_model::AttributeDataType attribute_data_type);
+  // Splits the scan of the index across reader threads. Returns nullopt
+  // when the index is too small to be worth splitting or intra-query
+  // parallelism is disabled.
+  std::optional<std::priority_queue<std::pair<T, hnswlib::labeltype>>>
+  ParallelSearchKnn(const T* query, uint64_t k,
+                    hnswlib::BaseFilterFunctor* filter,
+                    cancel::Token& cancellation_token) const
+      ABSL_SHARED_LOCKS_REQUIRED(resize_mutex_);
   std::unique_ptr<hnswlib::BruteforceSearch<T>> algo_
       ABSL_GUARDED_BY(resize_mutex_);
   std::unique_ptr<hnswlib::SpaceInterface<T>> space_;
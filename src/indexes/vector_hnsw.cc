@@ -7,6 +7,7 @@
 
 #include "src/indexes/vector_hnsw.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
@@ -17,8 +18,8 @@
 #include <optional>
 #include <queue>
 #include <string>
-#include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/log/check.h"
@@ -26,9 +27,11 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "src/attribute_data_type.h"
 #include "src/indexes/index_base.h"
 #include "src/indexes/vector_base.h"
@@ -39,6 +42,7 @@
 #include "valkey_search_options.h"
 #include "vmsdk/src/log.h"
 #include "vmsdk/src/status/status_macros.h"
+#include "vmsdk/src/thread_pool.h"
 #include "vmsdk/src/utils.h"
 #include "vmsdk/src/valkey_module_api/valkey_module.h"
 
@@ -89,7 +93,10 @@ absl::StatusOr<std::shared_ptr<VectorHNSW<T>>> VectorHNSW<T>::Create(
         new VectorHNSW<T>(vector_index_proto.dimension_count(),
                           attribute_identifier, attribute_data_type));
     index->Init(vector_index_proto.dimension_count(),
-                vector_index_proto.distance_metric(), index->space_);
+                vector_index_proto.distance_metric(),
+                vector_index_proto.vector_data_type(),
+                vector_index_proto.quantization(),
+                vector_index_proto.rerank_factor(), index->space_);
     const auto &hnsw_proto = vector_index_proto.hnsw_algorithm();
     index->algo_ = std::make_unique<hnswlib::HierarchicalNSW<T>>(
         index->space_.get(), vector_index_proto.initial_cap(), hnsw_proto.m(),
@@ -124,8 +131,7 @@ bool VectorHNSW<T>::IsVectorMatch(uint64_t internal_id,
       return false;
     }
     char *data_ptrv = algo_->getDataByInternalId(*id);
-    size_t dim = *((size_t *)algo_->dist_func_param_);
-    absl::string_view record(data_ptrv, dim * sizeof(T));
+    absl::string_view record(data_ptrv, space_->get_data_size());
     return vector->Str() == record;
   }
 }
@@ -145,7 +151,10 @@ absl::StatusOr<std::shared_ptr<VectorHNSW<T>>> VectorHNSW<T>::LoadFromRDB(
         vector_index_proto.dimension_count(), attribute_identifier,
         attribute_data_type->ToProto()));
     index->Init(vector_index_proto.dimension_count(),
-                vector_index_proto.distance_metric(), index->space_);
+                vector_index_proto.distance_metric(),
+                vector_index_proto.vector_data_type(),
+                vector_index_proto.quantization(),
+                vector_index_proto.rerank_factor(), index->space_);
 
     index->algo_ =
         std::make_unique<hnswlib::HierarchicalNSW<T>>(index->space_.get());
@@ -200,18 +209,68 @@ absl::Status VectorHNSW<T>::AddRecordImpl(uint64_t internal_id,
   } while (true);
 }
 
+// Number of records of a batch claimed at once by a thread while building.
+constexpr size_t kBuildChunkSize = 16;
+
+template <typename T>
+void VectorHNSW<T>::AddRecordsImpl(absl::Span<PendingAdd> adds) {
+  // Batches are added by a writer thread, which takes its share of the
+  // chunks, so the helpers use the remaining writer threads. Queries keep the
+  // reader threads.
+  auto writer_thread_pool = ValkeySearch::Instance().GetWriterThreadPool();
+  if (!IsBuilding() || !writer_thread_pool ||
+      writer_thread_pool->Size() <= 1 || adds.size() <= kBuildChunkSize) {
+    VectorBase::AddRecordsImpl(adds);
+    return;
+  }
+  // The graph supports concurrent insertions, guarded by per-node locks. The
+  // batch is split into chunks which are claimed by the calling thread and by
+  // helper tasks on the writer threads. The calling thread never waits for a
+  // chunk that is not claimed yet, so the batch completes even if the other
+  // writer threads are busy. Helpers that start after the batch completed
+  // find no chunk left and return without touching the batch.
+  struct BuildState {
+    absl::Span<PendingAdd> adds;
+    size_t chunk_count;
+    std::atomic<size_t> next_chunk{0};
+    absl::Mutex mutex;
+    size_t done_chunks ABSL_GUARDED_BY(mutex){0};
+    bool IsDone() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex) {
+      return done_chunks == chunk_count;
+    }
+  };
+  auto state = std::make_shared<BuildState>();
+  state->adds = adds;
+  state->chunk_count = (adds.size() + kBuildChunkSize - 1) / kBuildChunkSize;
+  auto add_chunks = [this](BuildState &state) {
+    size_t chunk;
+    while ((chunk = state.next_chunk.fetch_add(1)) < state.chunk_count) {
+      auto chunk_adds = state.adds.subspan(chunk * kBuildChunkSize,
+                                           kBuildChunkSize);
+      for (auto &add : chunk_adds) {
+        add.status = AddRecordImpl(add.internal_id, add.record);
+      }
+      absl::MutexLock lock(&state.mutex);
+      ++state.done_chunks;
+    }
+  };
+  const size_t helper_count =
+      std::min(writer_thread_pool->Size() - 1, state->chunk_count - 1);
+  for (size_t i = 0; i < helper_count; ++i) {
+    writer_thread_pool->Schedule(
+        [state, add_chunks]() { add_chunks(*state); },
+        vmsdk::ThreadPool::Priority::kLow);
+  }
+  add_chunks(*state);
+  absl::MutexLock lock(&state->mutex);
+  state->mutex.Await(absl::Condition(state.get(), &BuildState::IsDone));
+}
+
 template <typename T>
 int VectorHNSW<T>::RespondWithInfoImpl(ValkeyModuleCtx *ctx) const {
   ValkeyModule_ReplyWithSimpleString(ctx, "data_type");
-  if constexpr (std::is_same_v<T, float>) {
-    ValkeyModule_ReplyWithSimpleString(
-        ctx,
-        LookupKeyByValue(*kVectorDataTypeByStr,
-                         data_model::VectorDataType::VECTOR_DATA_TYPE_FLOAT32)
-            .data());
-  } else {
-    ValkeyModule_ReplyWithSimpleString(ctx, "UNKNOWN");
-  }
+  ValkeyModule_ReplyWithSimpleString(
+      ctx, LookupKeyByValue(*kVectorDataTypeByStr, vector_data_type_).data());
   ValkeyModule_ReplyWithSimpleString(ctx, "algorithm");
   ValkeyModule_ReplyWithArray(ctx, 8);
   ValkeyModule_ReplyWithSimpleString(ctx, "name");
@@ -227,6 +286,15 @@ int VectorHNSW<T>::RespondWithInfoImpl(ValkeyModuleCtx *ctx) const {
   ValkeyModule_ReplyWithLongLong(ctx, GetEfConstruction());
   ValkeyModule_ReplyWithSimpleString(ctx, "ef_runtime");
   ValkeyModule_ReplyWithLongLong(ctx, GetEfRuntime());
+  if (IsBuilding()) {
+    ValkeyModule_ReplyWithSimpleString(ctx, "build_progress");
+    ValkeyModule_ReplyWithCString(
+        ctx, absl::StrFormat("%f", GetBuildProgress()).c_str());
+    ValkeyModule_ReplyWithSimpleString(ctx, "build_query_algorithm");
+    ValkeyModule_ReplyWithSimpleString(
+        ctx, options::GetHNSWBuildFlatFallback().GetValue() ? "FLAT" : "HNSW");
+    return 8;
+  }
   return 4;
 }
 
@@ -272,6 +340,50 @@ absl::Status VectorHNSW<T>::ResizeIfFull() {
   return absl::OkStatus();
 }
 
+template <typename T>
+absl::Status VectorHNSW<T>::ReserveImpl(size_t count) {
+  auto required_capacity = [this, count]()
+                               ABSL_SHARED_LOCKS_REQUIRED(resize_mutex_) {
+    size_t required = algo_->getCurrentElementCount() + count;
+    if (algo_->allow_replace_deleted_) {
+      required -= algo_->getDeletedCount();
+    }
+    return required;
+  };
+  {
+    absl::ReaderMutexLock lock(&resize_mutex_);
+    if (required_capacity() <= algo_->getMaxElements()) {
+      return absl::OkStatus();
+    }
+  }
+  try {
+    absl::WriterMutexLock lock(&resize_mutex_);
+    const size_t max_elements = algo_->getMaxElements();
+    const size_t required = required_capacity();
+    if (required > max_elements) {
+      vmsdk::StopWatch stop_watch;
+      // Grow by whole blocks, as ResizeIfFull does, but only once for the
+      // batch.
+      const size_t block_size =
+          std::max<size_t>(ValkeySearch::Instance().GetHNSWBlockSize(), 1);
+      const size_t new_max_elements =
+          max_elements +
+          (required - max_elements + block_size - 1) / block_size * block_size;
+      algo_->resizeIndex(new_max_elements);
+      VMSDK_LOG(WARNING, nullptr)
+          << "Resizing HNSW Index for a batch of " << count
+          << " records, current size: " << max_elements
+          << ", new size: " << new_max_elements << ", resize time took: "
+          << absl::FormatDuration(stop_watch.Duration());
+    }
+  } catch (const std::exception &e) {
+    ++Metrics::GetStats().hnsw_add_exceptions_cnt;
+    return absl::InternalError(
+        absl::StrCat("Error while reserving capacity: ", e.what()));
+  }
+  return absl::OkStatus();
+}
+
 template <typename T>
 absl::Status VectorHNSW<T>::ModifyRecordImpl(uint64_t internal_id,
                                              absl::string_view record) {
@@ -326,15 +438,21 @@ absl::StatusOr<std::vector<Neighbor>> VectorHNSW<T>::Search(
         query.size(), ") does not match index's expected size (",
         dimensions_ * GetDataTypeSize(), ")."));
   }
-  auto perform_search = [this, count, &filter, enable_partial_results,
-                         &ef_runtime,
+  auto perform_search = [this, search_count = GetSearchCount(count), &filter,
+                         enable_partial_results, &ef_runtime,
                          &cancellation_token](absl::string_view query)
                             ABSL_NO_THREAD_SAFETY_ANALYSIS
       -> absl::StatusOr<std::priority_queue<std::pair<T, hnswlib::labeltype>>> {
     try {
+      // Snapshot searches may overlap with a resize of the graph.
+      absl::ReaderMutexLock lock(&resize_mutex_);
       CancelCondition cancel_condition(cancellation_token);
-      auto res = algo_->searchKnn((T *)query.data(), count, ef_runtime,
-                                  filter.get(), &cancel_condition);
+      auto res =
+          IsBuilding() && options::GetHNSWBuildFlatFallback().GetValue()
+              ? ExactSearch(query.data(), search_count, filter.get(),
+                            cancellation_token)
+              : algo_->searchKnn((T *)query.data(), search_count, ef_runtime,
+                                 filter.get(), &cancel_condition);
       if (!enable_partial_results && cancellation_token->IsCancelled()) {
         return absl::CancelledError(
             "Search operation cancelled due to timeout");
@@ -346,29 +464,64 @@ absl::StatusOr<std::vector<Neighbor>> VectorHNSW<T>::Search(
       return absl::InternalError(e.what());
     }
   };
+  std::vector<char> norm_record;
   if (normalize_) {
-    auto norm_record = NormalizeEmbedding(query, GetDataTypeSize());
-    VMSDK_ASSIGN_OR_RETURN(
-        auto search_result,
-        perform_search(absl::string_view((const char *)norm_record.data(),
-                                         norm_record.size())));
-    return CreateReply(search_result);
+    norm_record = NormalizeEmbedding(query, vector_data_type_);
+    query =
+        absl::string_view((const char *)norm_record.data(), norm_record.size());
   }
-  VMSDK_ASSIGN_OR_RETURN(auto search_result, perform_search(query));
+  std::string code;
+  VMSDK_ASSIGN_OR_RETURN(auto search_result,
+                         perform_search(EncodeQuery(query, code)));
+  Rerank(query, count, search_result);
   return CreateReply(search_result);
 }
 
+template <typename T>
+bool VectorHNSW<T>::SupportsSnapshotSearch() const {
+  absl::ReaderMutexLock lock(&resize_mutex_);
+  return !IsBuilding() && !IsQuantized() && !algo_->allow_replace_deleted_;
+}
+
+template <typename T>
+std::priority_queue<std::pair<T, hnswlib::labeltype>>
+VectorHNSW<T>::ExactSearch(const void *query, uint64_t count,
+                           hnswlib::BaseFilterFunctor *filter,
+                           cancel::Token &cancellation_token) const {
+  // Queries and mutations of an index schema never run concurrently, so the
+  // vectors of the graph are stable while they are scanned.
+  std::priority_queue<std::pair<T, hnswlib::labeltype>> results;
+  if (count == 0) {
+    return results;
+  }
+  const size_t element_count = algo_->cur_element_count_;
+  for (hnswlib::tableint id = 0; id < element_count; ++id) {
+    if ((id % 1024) == 0 && cancellation_token->IsCancelled()) {
+      break;
+    }
+    if (algo_->isMarkedDeleted(id)) {
+      continue;
+    }
+    auto label = algo_->getExternalLabel(id);
+    if (filter && !(*filter)(label)) {
+      continue;
+    }
+    T distance = algo_->fstdistfunc_(query, algo_->getDataByInternalId(id),
+                                     algo_->dist_func_param_);
+    if (results.size() < count) {
+      results.emplace(distance, label);
+    } else if (distance < results.top().first) {
+      results.pop();
+      results.emplace(distance, label);
+    }
+  }
+  return results;
+}
+
 template <typename T>
 void VectorHNSW<T>::ToProtoImpl(
     data_model::VectorIndex *vector_index_proto) const {
-  data_model::VectorDataType data_type;
-  if constexpr (std::is_same_v<T, float>) {
-    data_type = data_model::VectorDataType::VECTOR_DATA_TYPE_FLOAT32;
-  } else {
-    DCHECK(false) << "Unsupported type: " << typeid(T).name();
-    data_type = data_model::VectorDataType::VECTOR_DATA_TYPE_UNSPECIFIED;
-  }
-  vector_index_proto->set_vector_data_type(data_type);
+  vector_index_proto->set_vector_data_type(vector_data_type_);
   absl::ReaderMutexLock lock(&resize_mutex_);
   auto hnsw_algorithm_proto = std::make_unique<data_model::HNSWAlgorithm>();
   hnsw_algorithm_proto->set_ef_construction(GetEfConstruction());
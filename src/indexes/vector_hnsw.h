@@ -7,11 +7,13 @@
 
 #ifndef VALKEYSEARCH_SRC_INDEXES_VECTOR_HNSW_H_
 #define VALKEYSEARCH_SRC_INDEXES_VECTOR_HNSW_H_
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <deque>
 #include <memory>
 #include <optional>
+#include <queue>
 #include <utility>
 
 #include "absl/base/thread_annotations.h"
@@ -19,6 +21,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "src/attribute_data_type.h"
 #include "src/indexes/vector_base.h"
 #include "src/rdb_serialization.h"
@@ -44,7 +47,6 @@ class VectorHNSW : public VectorBase {
       absl::string_view attribute_identifier,
       SupplementalContentChunkIter&& iter) ABSL_NO_THREAD_SAFETY_ANALYSIS;
   ~VectorHNSW() override = default;
-  size_t GetDataTypeSize() const override { return sizeof(T); }
 
   const hnswlib::SpaceInterface<float>* GetSpace() const {
     return space_.get();
@@ -64,6 +66,15 @@ class VectorHNSW : public VectorBase {
   size_t GetEfRuntime() const ABSL_SHARED_LOCKS_REQUIRED(resize_mutex_) {
     return algo_->ef_;
   }
+  struct GraphParameters {
+    int m;
+    size_t ef_runtime;
+  };
+  GraphParameters GetGraphParameters() const
+      ABSL_LOCKS_EXCLUDED(resize_mutex_) {
+    absl::ReaderMutexLock lock(&resize_mutex_);
+    return {.m = GetM(), .ef_runtime = GetEfRuntime()};
+  }
 
   absl::StatusOr<std::vector<Neighbor>> Search(
       absl::string_view query, uint64_t count,
@@ -72,11 +83,41 @@ class VectorHNSW : public VectorBase {
       std::optional<size_t> ef_runtime = std::nullopt,
       bool enable_partial_results = false) ABSL_LOCKS_EXCLUDED(resize_mutex_);
 
+  // Whether Search can run while the index is mutated, outside of the read
+  // phase of the index schema. hnswlib supports searching while points are
+  // added or marked as deleted, and the vectors of the graph are never freed.
+  // Points replaced in place, the exact search of a building index and the
+  // reranking of quantized vectors don't support it. An index stops building
+  // once and never starts again, so a true result holds for its lifetime.
+  bool SupportsSnapshotSearch() const ABSL_LOCKS_EXCLUDED(resize_mutex_);
+
+  // Marks the index as being built from scratch by the backfill, e.g. after
+  // an RDB load that skipped the index contents. While building, batches of
+  // records are inserted with the help of the writer threads, and queries are
+  // answered by an exact scan if hnsw-build-flat-fallback is enabled.
+  void SetBuilding(bool building) {
+    building_.store(building, std::memory_order_relaxed);
+  }
+  bool IsBuilding() const { return building_.load(std::memory_order_relaxed); }
+  // Fraction of the build completed, from 0 to 1, reported by FT.INFO while
+  // the index is building. Updated by the index schema as the backfill feeds
+  // the keyspace to the index.
+  void SetBuildProgress(float progress) {
+    build_progress_.store(progress, std::memory_order_relaxed);
+  }
+  float GetBuildProgress() const {
+    return build_progress_.load(std::memory_order_relaxed);
+  }
+
  protected:
   absl::Status ResizeIfFull() ABSL_LOCKS_EXCLUDED(resize_mutex_);
   absl::Status AddRecordImpl(uint64_t internal_id,
                              absl::string_view record) override
       ABSL_LOCKS_EXCLUDED(resize_mutex_);
+  absl::Status ReserveImpl(size_t count) override
+      ABSL_LOCKS_EXCLUDED(resize_mutex_);
+  void AddRecordsImpl(absl::Span<PendingAdd> adds) override
+      ABSL_LOCKS_EXCLUDED(resize_mutex_);
 
   absl::Status RemoveRecordImpl(uint64_t internal_id) override
       ABSL_LOCKS_EXCLUDED(resize_mutex_);
@@ -107,6 +148,13 @@ class VectorHNSW : public VectorBase {
  private:
   VectorHNSW(int dimensions, absl::string_view attribute_identifier,
              data_model::AttributeDataType attribute_data_type);
+  // Brute force search over the vectors of the graph, used in place of the
+  // graph search while the index is building.
+  std::priority_queue<std::pair<T, hnswlib::labeltype>> ExactSearch(
+      const void* query, uint64_t count, hnswlib::BaseFilterFunctor* filter,
+      cancel::Token& cancellation_token) const ABSL_NO_THREAD_SAFETY_ANALYSIS;
+  std::atomic<bool> building_{false};
+  std::atomic<float> build_progress_{0};
   std::unique_ptr<hnswlib::HierarchicalNSW<T>> algo_
       ABSL_GUARDED_BY(resize_mutex_);
   std::unique_ptr<hnswlib::SpaceInterface<T>> space_;
@@ -0,0 +1,872 @@
+/*
+ * Copyright (c) 2025, valkey-search contributors
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD 3-Clause
+ *
+ */
+
+#include "src/indexes/vector_ivf_pq.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "src/attribute_data_type.h"
+#include "src/index_schema.pb.h"
+#include "src/indexes/index_base.h"
+#include "src/indexes/vector_base.h"
+#include "src/metrics.h"
+#include "src/rdb_serialization.h"
+#include "src/utils/cancel.h"
+#include "src/utils/string_interning.h"
+#include "src/valkey_search.h"
+#include "third_party/hnswlib/hnswlib.h"
+#include "vmsdk/src/log.h"
+#include "vmsdk/src/status/status_macros.h"
+#include "vmsdk/src/valkey_module_api/valkey_module.h"
+
+namespace valkey_search::indexes {
+
+namespace {
+
+// k-means needs a few points per centroid to produce meaningful clusters. The
+// product quantizer codebooks, with kPqCentroids centroids each, are trained on
+// the same sample as the coarse quantizer.
+constexpr size_t kTrainingPointsPerCentroid = 16;
+constexpr int kKMeansIterations = 20;
+// Training is deterministic for a given sample.
+constexpr uint32_t kKMeansSeed = 1234;
+// Approximate candidates fetched per requested neighbor and rescored with the
+// exact distance.
+constexpr uint64_t kRefineFactor = 4;
+constexpr uint32_t kUnassignedList = std::numeric_limits<uint32_t>::max();
+
+// Plain loops, which the compiler vectorizes.
+inline float L2Sqr(const float *a, const float *b, size_t dimensions) {
+  float distance = 0.0f;
+  for (size_t i = 0; i < dimensions; ++i) {
+    float diff = a[i] - b[i];
+    distance += diff * diff;
+  }
+  return distance;
+}
+
+inline float Dot(const float *a, const float *b, size_t dimensions) {
+  float dot = 0.0f;
+  for (size_t i = 0; i < dimensions; ++i) {
+    dot += a[i] * b[i];
+  }
+  return dot;
+}
+
+inline bool IsInnerProduct(data_model::DistanceMetric distance_metric) {
+  return distance_metric == data_model::DistanceMetric::DISTANCE_METRIC_IP ||
+         distance_metric == data_model::DistanceMetric::DISTANCE_METRIC_COSINE;
+}
+
+// Smaller is closer: the squared L2 distance, or the negated inner product.
+inline float CentroidDistance(const float *vector, const float *centroid,
+                              size_t dimensions, bool inner_product) {
+  return inner_product ? -Dot(vector, centroid, dimensions)
+                       : L2Sqr(vector, centroid, dimensions);
+}
+
+uint32_t NearestCentroid(const float *vector, const float *centroids,
+                         size_t count, size_t dimensions, bool inner_product) {
+  uint32_t nearest = 0;
+  float nearest_distance = std::numeric_limits<float>::max();
+  for (size_t c = 0; c < count; ++c) {
+    float distance = CentroidDistance(vector, centroids + c * dimensions,
+                                      dimensions, inner_product);
+    if (distance < nearest_distance) {
+      nearest_distance = distance;
+      nearest = c;
+    }
+  }
+  return nearest;
+}
+
+inline void Normalize(float *vector, size_t dimensions) {
+  float norm = std::sqrt(Dot(vector, vector, dimensions));
+  if (norm > 0.0f) {
+    for (size_t d = 0; d < dimensions; ++d) {
+      vector[d] /= norm;
+    }
+  }
+}
+
+// Lloyd's k-means over `count` points of `dimensions` floats. Returns the
+// `k` x `dimensions` centroids. Centroids left empty by an iteration are
+// reseeded from a random point. With `inner_product`, points are assigned by
+// inner product, as they are when indexed, and the centroids are kept
+// normalized (spherical k-means) so that no centroid wins by its norm alone.
+std::vector<float> KMeans(const std::vector<float> &points, size_t count,
+                          size_t dimensions, size_t k, bool inner_product,
+                          std::mt19937 &rng) {
+  std::vector<float> centroids(k * dimensions);
+  std::vector<size_t> order(count);
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), rng);
+  for (size_t c = 0; c < k; ++c) {
+    std::copy_n(points.data() + order[c % count] * dimensions, dimensions,
+                centroids.data() + c * dimensions);
+  }
+  std::vector<uint32_t> assignment(count);
+  std::vector<float> sums(k * dimensions);
+  std::vector<size_t> sizes(k);
+  for (int iteration = 0; iteration < kKMeansIterations; ++iteration) {
+    for (size_t i = 0; i < count; ++i) {
+      assignment[i] =
+          NearestCentroid(points.data() + i * dimensions, centroids.data(), k,
+                          dimensions, inner_product);
+    }
+    std::fill(sums.begin(), sums.end(), 0.0f);
+    std::fill(sizes.begin(), sizes.end(), 0);
+    for (size_t i = 0; i < count; ++i) {
+      float *sum = sums.data() + assignment[i] * dimensions;
+      const float *point = points.data() + i * dimensions;
+      for (size_t d = 0; d < dimensions; ++d) {
+        sum[d] += point[d];
+      }
+      ++sizes[assignment[i]];
+    }
+    for (size_t c = 0; c < k; ++c) {
+      float *centroid = centroids.data() + c * dimensions;
+      if (sizes[c] == 0) {
+        std::copy_n(points.data() + (rng() % count) * dimensions, dimensions,
+                    centroid);
+      } else {
+        for (size_t d = 0; d < dimensions; ++d) {
+          centroid[d] = sums[c * dimensions + d] / sizes[c];
+        }
+      }
+      if (inner_product) {
+        Normalize(centroid, dimensions);
+      }
+    }
+  }
+  return centroids;
+}
+
+// Encodes the residual of `vector` from `centroid` as the nearest centroid of
+// each subspace codebook. The residuals are quantized by L2 for every metric,
+// since the codes approximate the residual itself.
+void EncodeResidual(const float *vector, const float *centroid,
+                    const float *codebooks, size_t dimensions, size_t pq_m,
+                    uint8_t *code) {
+  const size_t sub_dimensions = dimensions / pq_m;
+  std::vector<float> residual(dimensions);
+  for (size_t d = 0; d < dimensions; ++d) {
+    residual[d] = vector[d] - centroid[d];
+  }
+  for (size_t m = 0; m < pq_m; ++m) {
+    code[m] = NearestCentroid(
+        residual.data() + m * sub_dimensions,
+        codebooks + m * kPqCentroids * sub_dimensions, kPqCentroids,
+        sub_dimensions, /*inner_product=*/false);
+  }
+}
+
+// Picks 4 dimensional subspaces when possible, which keeps the codes at a
+// sixteenth of the float32 vector size.
+uint32_t DefaultPqM(uint32_t dimensions) {
+  for (uint32_t sub_dimensions : {4u, 2u}) {
+    if (dimensions % sub_dimensions == 0) {
+      return dimensions / sub_dimensions;
+    }
+  }
+  return dimensions;
+}
+
+inline void PushBounded(
+    std::priority_queue<std::pair<float, hnswlib::labeltype>> &results,
+    uint64_t count, float distance, hnswlib::labeltype label) {
+  if (results.size() < count) {
+    results.emplace(distance, label);
+  } else if (distance < results.top().first) {
+    results.pop();
+    results.emplace(distance, label);
+  }
+}
+
+}  // namespace
+
+template <typename T>
+absl::StatusOr<std::shared_ptr<VectorIVFPQ<T>>> VectorIVFPQ<T>::Create(
+    const data_model::VectorIndex &vector_index_proto,
+    absl::string_view attribute_identifier,
+    data_model::AttributeDataType attribute_data_type) {
+  const auto &algorithm = vector_index_proto.ivf_pq_algorithm();
+  const uint32_t dimensions = vector_index_proto.dimension_count();
+  const uint32_t pq_m =
+      algorithm.pq_m() > 0 ? algorithm.pq_m() : DefaultPqM(dimensions);
+  if (dimensions == 0 || dimensions % pq_m != 0 || algorithm.nlist() == 0) {
+    return absl::InvalidArgumentError(
+        "Invalid IVF_PQ index parameters: the dimensions must be a multiple "
+        "of PQ_M and NLIST must be positive.");
+  }
+  if (vector_index_proto.vector_data_type() !=
+      data_model::VECTOR_DATA_TYPE_FLOAT32) {
+    return absl::InvalidArgumentError("IVF_PQ requires FLOAT32 vectors.");
+  }
+  try {
+    auto index = std::shared_ptr<VectorIVFPQ<T>>(new VectorIVFPQ<T>(
+        dimensions, algorithm.nlist(), pq_m, algorithm.nprobe(),
+        vector_index_proto.initial_cap(), attribute_identifier,
+        attribute_data_type));
+    index->Init(dimensions, vector_index_proto.distance_metric(),
+                vector_index_proto.vector_data_type(),
+                data_model::VECTOR_QUANTIZATION_NONE, 0, index->space_);
+    return index;
+  } catch (const std::exception &e) {
+    ++Metrics::GetStats().ivf_pq_create_exceptions_cnt;
+    return absl::InternalError(
+        absl::StrCat("Error while creating an IVF_PQ index: ", e.what()));
+  }
+}
+
+template <typename T>
+VectorIVFPQ<T>::VectorIVFPQ(int dimensions, uint32_t nlist, uint32_t pq_m,
+                            uint32_t nprobe, uint32_t initial_cap,
+                            absl::string_view attribute_identifier,
+                            data_model::AttributeDataType attribute_data_type)
+    : VectorBase(IndexerType::kIVFPQ, dimensions, attribute_data_type,
+                 attribute_identifier),
+      nlist_(nlist),
+      pq_m_(pq_m),
+      nprobe_(std::max(nprobe, 1u)),
+      initial_cap_(initial_cap),
+      sub_dimensions_(dimensions / pq_m),
+      lists_(nlist) {}
+
+template <typename T>
+absl::StatusOr<std::shared_ptr<VectorIVFPQ<T>>> VectorIVFPQ<T>::LoadFromRDB(
+    ValkeyModuleCtx *ctx, const AttributeDataType *attribute_data_type,
+    const data_model::VectorIndex &vector_index_proto,
+    absl::string_view attribute_identifier,
+    SupplementalContentChunkIter &&iter) {
+  VMSDK_ASSIGN_OR_RETURN(
+      auto index, Create(vector_index_proto, attribute_identifier,
+                         attribute_data_type->ToProto()));
+  RDBChunkInputStream input(std::move(iter));
+  VMSDK_ASSIGN_OR_RETURN(auto serialized_header, input.LoadChunk());
+  data_model::IVFPQIndexHeader header;
+  if (!header.ParseFromString(*serialized_header)) {
+    return absl::InternalError("Could not deserialize IVF_PQ header");
+  }
+  if (header.nlist() != index->nlist_ || header.pq_m() != index->pq_m_) {
+    return absl::InternalError(
+        "Persisted IVF_PQ parameters do not match the index definition");
+  }
+  absl::WriterMutexLock lock(&index->index_mutex_);
+  if (header.trained()) {
+    VMSDK_ASSIGN_OR_RETURN(auto centroids, input.LoadChunk());
+    VMSDK_ASSIGN_OR_RETURN(auto codebooks, input.LoadChunk());
+    const size_t vector_size = index->dimensions_ * sizeof(float);
+    if (centroids->size() != index->nlist_ * vector_size ||
+        codebooks->size() != kPqCentroids * vector_size) {
+      return absl::InternalError("Persisted IVF_PQ quantizers are corrupted");
+    }
+    index->centroids_.resize(centroids->size() / sizeof(float));
+    std::memcpy(index->centroids_.data(), centroids->data(), centroids->size());
+    index->codebooks_.resize(codebooks->size() / sizeof(float));
+    std::memcpy(index->codebooks_.data(), codebooks->data(), codebooks->size());
+    index->trained_ = true;
+    index->training_started_ = true;
+  }
+  const size_t vector_size = index->GetVectorDataSize();
+  const size_t code_size =
+      header.trained() ? sizeof(uint32_t) + index->pq_m_ : 0;
+  std::vector<uint8_t> code(index->pq_m_);
+  for (uint64_t i = 0; i < header.element_count(); ++i) {
+    VMSDK_ASSIGN_OR_RETURN(auto record, input.LoadChunk());
+    if (record->size() != sizeof(uint64_t) + code_size + vector_size) {
+      return absl::InternalError("Persisted IVF_PQ record size mismatch");
+    }
+    uint64_t internal_id;
+    std::memcpy(&internal_id, record->data(), sizeof(internal_id));
+    const char *entry = record->data() + sizeof(internal_id);
+    char *tracked_vector = index->VectorBase::TrackVector(
+        internal_id, entry + code_size, vector_size);
+    if (!header.trained()) {
+      continue;
+    }
+    uint32_t list;
+    std::memcpy(&list, entry, sizeof(list));
+    if (list < index->nlist_) {
+      std::memcpy(code.data(), entry + sizeof(list), index->pq_m_);
+    } else {
+      // The vector was tracked but not encoded yet when the index was saved.
+      auto values = reinterpret_cast<const float *>(tracked_vector);
+      list = index->AssignList(values);
+      index->Encode(values, list, code.data());
+    }
+    index->AddToList(internal_id, list, code.data());
+  }
+  return index;
+}
+
+template <typename T>
+bool VectorIVFPQ<T>::IsTrained() const {
+  absl::ReaderMutexLock lock(&index_mutex_);
+  return trained_;
+}
+
+template <typename T>
+size_t VectorIVFPQ<T>::GetTrainingSize() const {
+  return std::max<size_t>(nlist_, kPqCentroids) * kTrainingPointsPerCentroid;
+}
+
+template <typename T>
+size_t VectorIVFPQ<T>::GetCapacity() const {
+  absl::ReaderMutexLock lock(&tracked_vectors_mutex_);
+  return std::max<size_t>(initial_cap_, tracked_vectors_.size());
+}
+
+template <typename T>
+uint64_t VectorIVFPQ<T>::GetMaxInternalLabel() const {
+  absl::ReaderMutexLock lock(&tracked_vectors_mutex_);
+  uint64_t max_label = 0;
+  for (const auto &[internal_id, _] : tracked_vectors_) {
+    max_label = std::max(max_label, internal_id);
+  }
+  return max_label;
+}
+
+template <typename T>
+size_t VectorIVFPQ<T>::GetLabelCount() const {
+  absl::ReaderMutexLock lock(&tracked_vectors_mutex_);
+  return tracked_vectors_.size();
+}
+
+template <typename T>
+void VectorIVFPQ<T>::TrackVector(uint64_t internal_id,
+                                 const InternedStringPtr &vector) {
+  absl::MutexLock lock(&tracked_vectors_mutex_);
+  tracked_vectors_[internal_id] = vector;
+}
+
+template <typename T>
+bool VectorIVFPQ<T>::IsVectorMatch(uint64_t internal_id,
+                                   const InternedStringPtr &vector) {
+  absl::ReaderMutexLock lock(&tracked_vectors_mutex_);
+  auto it = tracked_vectors_.find(internal_id);
+  if (it == tracked_vectors_.end()) {
+    return false;
+  }
+  return it->second->Str() == vector->Str();
+}
+
+template <typename T>
+void VectorIVFPQ<T>::UnTrackVector(uint64_t internal_id) {
+  absl::MutexLock lock(&tracked_vectors_mutex_);
+  tracked_vectors_.erase(internal_id);
+}
+
+template <typename T>
+char *VectorIVFPQ<T>::GetValueImpl(uint64_t internal_id) const {
+  absl::ReaderMutexLock lock(&tracked_vectors_mutex_);
+  auto it = tracked_vectors_.find(internal_id);
+  if (it == tracked_vectors_.end()) {
+    return nullptr;
+  }
+  return (char *)it->second->Str().data();
+}
+
+template <typename T>
+uint32_t VectorIVFPQ<T>::AssignList(const float *vector) const {
+  return NearestCentroid(vector, centroids_.data(), nlist_, dimensions_,
+                         IsInnerProduct(distance_metric_));
+}
+
+template <typename T>
+void VectorIVFPQ<T>::Encode(const float *vector, uint32_t list,
+                            uint8_t *code) const {
+  EncodeResidual(vector, centroids_.data() + list * dimensions_,
+                 codebooks_.data(), dimensions_, pq_m_, code);
+}
+
+template <typename T>
+void VectorIVFPQ<T>::AddToList(uint64_t internal_id, uint32_t list,
+                               const uint8_t *code) {
+  RemoveFromList(internal_id);
+  auto &inverted_list = lists_[list];
+  positions_[internal_id] = {
+      .list = list,
+      .offset = static_cast<uint32_t>(inverted_list.labels.size())};
+  inverted_list.labels.push_back(internal_id);
+  inverted_list.codes.insert(inverted_list.codes.end(), code, code + pq_m_);
+}
+
+template <typename T>
+void VectorIVFPQ<T>::RemoveFromList(uint64_t internal_id) {
+  auto it = positions_.find(internal_id);
+  if (it == positions_.end()) {
+    return;
+  }
+  auto &inverted_list = lists_[it->second.list];
+  const uint32_t offset = it->second.offset;
+  const uint32_t last = inverted_list.labels.size() - 1;
+  if (offset != last) {
+    // Swap the last entry into the hole to keep the codes contiguous.
+    uint64_t moved = inverted_list.labels[last];
+    inverted_list.labels[offset] = moved;
+    std::memcpy(inverted_list.codes.data() + offset * pq_m_,
+                inverted_list.codes.data() + last * pq_m_, pq_m_);
+    positions_[moved].offset = offset;
+  }
+  inverted_list.labels.pop_back();
+  inverted_list.codes.resize(inverted_list.codes.size() - pq_m_);
+  positions_.erase(internal_id);
+}
+
+template <typename T>
+void VectorIVFPQ<T>::EncodeTrackedVectors() {
+  absl::ReaderMutexLock lock(&tracked_vectors_mutex_);
+  std::vector<uint8_t> code(pq_m_);
+  for (const auto &[internal_id, vector] : tracked_vectors_) {
+    if (positions_.contains(internal_id)) {
+      continue;
+    }
+    auto values = reinterpret_cast<const float *>(vector->Str().data());
+    uint32_t list = AssignList(values);
+    Encode(values, list, code.data());
+    AddToList(internal_id, list, code.data());
+  }
+}
+
+template <typename T>
+void VectorIVFPQ<T>::MaybeTrain() {
+  if (training_started_ || GetLabelCount() < GetTrainingSize() ||
+      training_started_.exchange(true)) {
+    return;
+  }
+  // k-means takes far longer than a write slice, so the quantizers are trained
+  // on the utility threads. The vectors indexed in the meantime are only
+  // tracked, and searched by brute force, until the quantizers are swapped in.
+  ValkeySearch::Instance().ScheduleUtilityTask(
+      [weak_index = this->weak_from_this()]() {
+        if (auto index = weak_index.lock()) {
+          index->Train();
+        }
+      });
+}
+
+template <typename T>
+void VectorIVFPQ<T>::Train() {
+  const size_t training_size = GetTrainingSize();
+  std::vector<float> sample;
+  {
+    absl::ReaderMutexLock lock(&tracked_vectors_mutex_);
+    if (tracked_vectors_.size() < training_size) {
+      // Vectors were removed since the training was scheduled.
+      training_started_ = false;
+      return;
+    }
+    sample.reserve(training_size * dimensions_);
+    for (const auto &[_, vector] : tracked_vectors_) {
+      if (sample.size() == training_size * dimensions_) {
+        break;
+      }
+      auto values = reinterpret_cast<const float *>(vector->Str().data());
+      sample.insert(sample.end(), values, values + dimensions_);
+    }
+  }
+  VMSDK_LOG(NOTICE, nullptr) << "Training IVF_PQ index `"
+                             << attribute_identifier_ << "` on "
+                             << training_size << " vectors";
+  std::mt19937 rng(kKMeansSeed);
+  const bool inner_product = IsInnerProduct(distance_metric_);
+  auto centroids =
+      KMeans(sample, training_size, dimensions_, nlist_, inner_product, rng);
+  // The product quantizers encode the residuals from the coarse centroids.
+  for (size_t i = 0; i < training_size; ++i) {
+    float *point = sample.data() + i * dimensions_;
+    const float *centroid =
+        centroids.data() + NearestCentroid(point, centroids.data(), nlist_,
+                                           dimensions_, inner_product) *
+                               dimensions_;
+    for (int d = 0; d < dimensions_; ++d) {
+      point[d] -= centroid[d];
+    }
+  }
+  std::vector<float> codebooks;
+  codebooks.reserve(kPqCentroids * dimensions_);
+  std::vector<float> sub_points(training_size * sub_dimensions_);
+  for (size_t m = 0; m < pq_m_; ++m) {
+    for (size_t i = 0; i < training_size; ++i) {
+      std::copy_n(sample.data() + i * dimensions_ + m * sub_dimensions_,
+                  sub_dimensions_, sub_points.data() + i * sub_dimensions_);
+    }
+    auto codebook = KMeans(sub_points, training_size, sub_dimensions_,
+                           kPqCentroids, /*inner_product=*/false, rng);
+    codebooks.insert(codebooks.end(), codebook.begin(), codebook.end());
+  }
+
+  // Encode the vectors tracked so far before taking index_mutex_, so that the
+  // swap only inserts into the inverted lists.
+  std::vector<std::pair<uint64_t, InternedStringPtr>> encoded_vectors;
+  {
+    absl::ReaderMutexLock lock(&tracked_vectors_mutex_);
+    encoded_vectors.assign(tracked_vectors_.begin(), tracked_vectors_.end());
+  }
+  std::vector<uint32_t> encoded_lists(encoded_vectors.size());
+  std::vector<uint8_t> encoded_codes(encoded_vectors.size() * pq_m_);
+  for (size_t i = 0; i < encoded_vectors.size(); ++i) {
+    const auto &vector = encoded_vectors[i].second;
+    auto values = reinterpret_cast<const float *>(vector->Str().data());
+    encoded_lists[i] = NearestCentroid(values, centroids.data(), nlist_,
+                                       dimensions_, inner_product);
+    EncodeResidual(values, centroids.data() + encoded_lists[i] * dimensions_,
+                   codebooks.data(), dimensions_, pq_m_,
+                   encoded_codes.data() + i * pq_m_);
+  }
+
+  absl::WriterMutexLock lock(&index_mutex_);
+  centroids_ = std::move(centroids);
+  codebooks_ = std::move(codebooks);
+  trained_ = true;
+  {
+    absl::ReaderMutexLock tracked_lock(&tracked_vectors_mutex_);
+    for (size_t i = 0; i < encoded_vectors.size(); ++i) {
+      // Skip the vectors removed or modified while they were being encoded.
+      auto it = tracked_vectors_.find(encoded_vectors[i].first);
+      if (it == tracked_vectors_.end() ||
+          it->second != encoded_vectors[i].second) {
+        continue;
+      }
+      AddToList(it->first, encoded_lists[i],
+                encoded_codes.data() + i * pq_m_);
+    }
+  }
+  // Encode the vectors added or modified since.
+  EncodeTrackedVectors();
+}
+
+template <typename T>
+absl::Status VectorIVFPQ<T>::AddRecordImpl(uint64_t internal_id,
+                                           absl::string_view record) {
+  auto values = reinterpret_cast<const float *>(record.data());
+  std::vector<uint8_t> code(pq_m_);
+  uint32_t list = kUnassignedList;
+  {
+    // The quantizers never change once trained, so the vector is encoded
+    // under the shared lock.
+    absl::ReaderMutexLock lock(&index_mutex_);
+    if (trained_) {
+      list = AssignList(values);
+      Encode(values, list, code.data());
+    }
+  }
+  if (list == kUnassignedList) {
+    MaybeTrain();
+    return absl::OkStatus();
+  }
+  absl::WriterMutexLock lock(&index_mutex_);
+  AddToList(internal_id, list, code.data());
+  return absl::OkStatus();
+}
+
+template <typename T>
+absl::Status VectorIVFPQ<T>::ModifyRecordImpl(uint64_t internal_id,
+                                              absl::string_view record) {
+  return AddRecordImpl(internal_id, record);
+}
+
+template <typename T>
+absl::Status VectorIVFPQ<T>::RemoveRecordImpl(uint64_t internal_id) {
+  absl::WriterMutexLock lock(&index_mutex_);
+  RemoveFromList(internal_id);
+  return absl::OkStatus();
+}
+
+template <typename T>
+float VectorIVFPQ<T>::ExactDistance(const float *query,
+                                    const char *vector) const {
+  return space_->get_dist_func()(query, vector,
+                                 space_->get_dist_func_param());
+}
+
+template <typename T>
+std::priority_queue<std::pair<float, hnswlib::labeltype>>
+VectorIVFPQ<T>::SearchLists(const float *query, uint64_t count, size_t nprobe,
+                            cancel::Token &cancellation_token,
+                            hnswlib::BaseFilterFunctor *filter) const {
+  const bool inner_product = IsInnerProduct(distance_metric_);
+  std::vector<std::pair<float, uint32_t>> ranked_lists(nlist_);
+  for (uint32_t list = 0; list < nlist_; ++list) {
+    ranked_lists[list] = {
+        CentroidDistance(query, centroids_.data() + list * dimensions_,
+                         dimensions_, inner_product),
+        list};
+  }
+  nprobe = std::clamp<size_t>(nprobe, 1, nlist_);
+  std::partial_sort(ranked_lists.begin(), ranked_lists.begin() + nprobe,
+                    ranked_lists.end());
+
+  // table[m * kPqCentroids + k] holds the distance between subspace m of the
+  // query and centroid k of its codebook. For L2 the residual of the query
+  // from the list centroid is quantized, so the table is rebuilt per list.
+  // For inner products the query term is list independent:
+  //   <q, c + r> = <q, c> + sum_m <q_m, r_m>.
+  std::vector<float> table(pq_m_ * kPqCentroids);
+  auto fill_table = [this, &table](const float *target) {
+    for (size_t m = 0; m < pq_m_; ++m) {
+      const float *sub_target = target + m * sub_dimensions_;
+      const float *codebook =
+          codebooks_.data() + m * kPqCentroids * sub_dimensions_;
+      for (size_t k = 0; k < kPqCentroids; ++k) {
+        const float *centroid = codebook + k * sub_dimensions_;
+        table[m * kPqCentroids + k] =
+            IsInnerProduct(distance_metric_)
+                ? Dot(sub_target, centroid, sub_dimensions_)
+                : L2Sqr(sub_target, centroid, sub_dimensions_);
+      }
+    }
+  };
+  std::vector<float> residual;
+  if (inner_product) {
+    fill_table(query);
+  } else {
+    residual.resize(dimensions_);
+  }
+
+  std::priority_queue<std::pair<float, hnswlib::labeltype>> results;
+  for (size_t probe = 0; probe < nprobe; ++probe) {
+    if (cancellation_token->IsCancelled()) {
+      break;
+    }
+    const auto [centroid_distance, list] = ranked_lists[probe];
+    float base = 0.0f;
+    if (inner_product) {
+      // centroid_distance is -<q, c>.
+      base = 1.0f + centroid_distance;
+    } else {
+      const float *centroid = centroids_.data() + list * dimensions_;
+      for (int d = 0; d < dimensions_; ++d) {
+        residual[d] = query[d] - centroid[d];
+      }
+      fill_table(residual.data());
+    }
+    const auto &inverted_list = lists_[list];
+    const uint8_t *code = inverted_list.codes.data();
+    for (size_t i = 0; i < inverted_list.labels.size(); ++i, code += pq_m_) {
+      float score = 0.0f;
+      for (size_t m = 0; m < pq_m_; ++m) {
+        score += table[m * kPqCentroids + code[m]];
+      }
+      float distance = inner_product ? base - score : score;
+      if (results.size() >= count && distance >= results.top().first) {
+        continue;
+      }
+      // The filter is only evaluated for candidates that make the cut.
+      auto label = inverted_list.labels[i];
+      if (filter && !(*filter)(label)) {
+        continue;
+      }
+      PushBounded(results, count, distance, label);
+    }
+  }
+  return results;
+}
+
+template <typename T>
+std::priority_queue<std::pair<float, hnswlib::labeltype>>
+VectorIVFPQ<T>::Refine(
+    const float *query, uint64_t count,
+    std::priority_queue<std::pair<float, hnswlib::labeltype>> &candidates)
+    const {
+  absl::ReaderMutexLock lock(&tracked_vectors_mutex_);
+  std::priority_queue<std::pair<float, hnswlib::labeltype>> results;
+  for (; !candidates.empty(); candidates.pop()) {
+    auto label = candidates.top().second;
+    auto it = tracked_vectors_.find(label);
+    if (it == tracked_vectors_.end()) {
+      continue;
+    }
+    PushBounded(results, count, ExactDistance(query, it->second->Str().data()),
+                label);
+  }
+  return results;
+}
+
+template <typename T>
+std::priority_queue<std::pair<float, hnswlib::labeltype>>
+VectorIVFPQ<T>::BruteForceSearch(const float *query, uint64_t count,
+                                 cancel::Token &cancellation_token,
+                                 hnswlib::BaseFilterFunctor *filter) const {
+  absl::ReaderMutexLock lock(&tracked_vectors_mutex_);
+  std::priority_queue<std::pair<float, hnswlib::labeltype>> results;
+  for (const auto &[label, vector] : tracked_vectors_) {
+    if (cancellation_token->IsCancelled()) {
+      break;
+    }
+    float distance = ExactDistance(query, vector->Str().data());
+    if (results.size() >= count && distance >= results.top().first) {
+      continue;
+    }
+    if (filter && !(*filter)(label)) {
+      continue;
+    }
+    PushBounded(results, count, distance, label);
+  }
+  return results;
+}
+
+template <typename T>
+absl::StatusOr<std::vector<Neighbor>> VectorIVFPQ<T>::Search(
+    absl::string_view query, uint64_t count, cancel::Token &cancellation_token,
+    std::unique_ptr<hnswlib::BaseFilterFunctor> filter,
+    std::optional<size_t> nprobe) {
+  if (!IsValidSizeVector(query)) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Error parsing vector similarity query: query vector blob size (",
+        query.size(), ") does not match index's expected size (",
+        dimensions_ * GetDataTypeSize(), ")."));
+  }
+  std::vector<char> norm_record;
+  if (normalize_) {
+    norm_record = NormalizeEmbedding(query, vector_data_type_);
+    query =
+        absl::string_view((const char *)norm_record.data(), norm_record.size());
+  }
+  auto values = reinterpret_cast<const float *>(query.data());
+  std::priority_queue<std::pair<float, hnswlib::labeltype>> results;
+  {
+    absl::ReaderMutexLock lock(&index_mutex_);
+    if (trained_) {
+      auto candidates =
+          SearchLists(values, count * kRefineFactor, nprobe.value_or(nprobe_),
+                      cancellation_token, filter.get());
+      results = Refine(values, count, candidates);
+    } else {
+      results =
+          BruteForceSearch(values, count, cancellation_token, filter.get());
+    }
+  }
+  return CreateReply(results);
+}
+
+template <typename T>
+absl::StatusOr<std::pair<float, hnswlib::labeltype>>
+VectorIVFPQ<T>::ComputeDistanceFromRecordImpl(uint64_t internal_id,
+                                              absl::string_view query) const {
+  absl::ReaderMutexLock lock(&tracked_vectors_mutex_);
+  auto it = tracked_vectors_.find(internal_id);
+  if (it == tracked_vectors_.end()) {
+    return absl::InternalError(
+        absl::StrCat("Couldn't find internal id: ", internal_id));
+  }
+  return (std::pair<float, hnswlib::labeltype>){
+      ExactDistance(reinterpret_cast<const float *>(query.data()),
+                    it->second->Str().data()),
+      internal_id};
+}
+
+template <typename T>
+void VectorIVFPQ<T>::ToProtoImpl(
+    data_model::VectorIndex *vector_index_proto) const {
+  vector_index_proto->set_vector_data_type(vector_data_type_);
+
+  auto ivf_pq_algorithm_proto = std::make_unique<data_model::IVFPQAlgorithm>();
+  ivf_pq_algorithm_proto->set_nlist(nlist_);
+  ivf_pq_algorithm_proto->set_pq_m(pq_m_);
+  ivf_pq_algorithm_proto->set_nprobe(nprobe_);
+  vector_index_proto->set_allocated_ivf_pq_algorithm(
+      ivf_pq_algorithm_proto.release());
+}
+
+template <typename T>
+int VectorIVFPQ<T>::RespondWithInfoImpl(ValkeyModuleCtx *ctx) const {
+  ValkeyModule_ReplyWithSimpleString(ctx, "data_type");
+  ValkeyModule_ReplyWithSimpleString(
+      ctx, LookupKeyByValue(*kVectorDataTypeByStr, vector_data_type_).data());
+  ValkeyModule_ReplyWithSimpleString(ctx, "algorithm");
+  ValkeyModule_ReplyWithArray(ctx, 10);
+  ValkeyModule_ReplyWithSimpleString(ctx, "name");
+  ValkeyModule_ReplyWithSimpleString(
+      ctx,
+      LookupKeyByValue(*kVectorAlgoByStr,
+                       data_model::VectorIndex::AlgorithmCase::kIvfPqAlgorithm)
+          .data());
+  ValkeyModule_ReplyWithSimpleString(ctx, "nlist");
+  ValkeyModule_ReplyWithLongLong(ctx, nlist_);
+  ValkeyModule_ReplyWithSimpleString(ctx, "pq_m");
+  ValkeyModule_ReplyWithLongLong(ctx, pq_m_);
+  ValkeyModule_ReplyWithSimpleString(ctx, "nprobe");
+  ValkeyModule_ReplyWithLongLong(ctx, nprobe_);
+  ValkeyModule_ReplyWithSimpleString(ctx, "trained");
+  ValkeyModule_ReplyWithLongLong(ctx, IsTrained() ? 1 : 0);
+
+  return 4;
+}
+
+// Layout: the IVFPQIndexHeader, the centroids and codebooks when trained, then
+// one record per vector holding its internal id, its list id and code when
+// trained, and the vector.
+template <typename T>
+absl::Status VectorIVFPQ<T>::SaveIndexImpl(
+    RDBChunkOutputStream chunked_out) const {
+  absl::ReaderMutexLock index_lock(&index_mutex_);
+  absl::ReaderMutexLock lock(&tracked_vectors_mutex_);
+  data_model::IVFPQIndexHeader header;
+  header.set_trained(trained_);
+  header.set_nlist(nlist_);
+  header.set_pq_m(pq_m_);
+  header.set_element_count(tracked_vectors_.size());
+  std::string serialized;
+  if (!header.SerializeToString(&serialized)) {
+    return absl::InternalError("Could not serialize IVF_PQ header");
+  }
+  VMSDK_RETURN_IF_ERROR(
+      chunked_out.SaveChunk(serialized.data(), serialized.size()));
+  if (trained_) {
+    VMSDK_RETURN_IF_ERROR(
+        chunked_out.SaveChunk(reinterpret_cast<const char *>(centroids_.data()),
+                              centroids_.size() * sizeof(float)));
+    VMSDK_RETURN_IF_ERROR(
+        chunked_out.SaveChunk(reinterpret_cast<const char *>(codebooks_.data()),
+                              codebooks_.size() * sizeof(float)));
+  }
+  const size_t vector_size = GetVectorDataSize();
+  const size_t code_size = trained_ ? sizeof(uint32_t) + pq_m_ : 0;
+  std::string record(sizeof(uint64_t) + code_size + vector_size, '\0');
+  char *entry = record.data() + sizeof(uint64_t);
+  for (const auto &[internal_id, vector] : tracked_vectors_) {
+    std::memcpy(record.data(), &internal_id, sizeof(internal_id));
+    if (trained_) {
+      uint32_t list = kUnassignedList;
+      auto it = positions_.find(internal_id);
+      if (it != positions_.end()) {
+        list = it->second.list;
+        std::memcpy(entry + sizeof(list),
+                    lists_[list].codes.data() + it->second.offset * pq_m_,
+                    pq_m_);
+      }
+      std::memcpy(entry, &list, sizeof(list));
+    }
+    std::memcpy(entry + code_size, vector->Str().data(), vector_size);
+    VMSDK_RETURN_IF_ERROR(chunked_out.SaveChunk(record.data(), record.size()));
+  }
+  return absl::OkStatus();
+}
+
+template class VectorIVFPQ<float>;
+
+}  // namespace valkey_search::indexes
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2025, valkey-search contributors
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD 3-Clause
+ *
+ */
+
+#ifndef VALKEYSEARCH_SRC_INDEXES_VECTOR_IVF_PQ_H_
+#define VALKEYSEARCH_SRC_INDEXES_VECTOR_IVF_PQ_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "src/attribute_data_type.h"
+#include "src/indexes/vector_base.h"
+#include "src/rdb_serialization.h"
+#include "src/utils/cancel.h"
+#include "src/utils/string_interning.h"
+#include "third_party/hnswlib/hnswlib.h"
+#include "vmsdk/src/valkey_module_api/valkey_module.h"
+
+namespace valkey_search::indexes {
+
+// Number of centroids of each product quantizer subspace, so that every
+// subspace code fits in a single byte.
+constexpr size_t kPqCentroids = 256;
+
+// Inverted file index with product quantization (IVF-PQ).
+//
+// A coarse k-means quantizer partitions the vectors into `nlist` inverted
+// lists. The residual of each vector from its list centroid is split into
+// `pq_m` subspaces, and each subspace is encoded as the id of its nearest
+// centroid in a per-subspace codebook. Queries probe the `nprobe` lists with
+// the closest centroids and score the codes of the probed lists through
+// per-query distance lookup tables (asymmetric distance computation). The
+// best candidates are then rescored with the exact distance.
+//
+// The quantizers are trained in the background once enough vectors have been
+// indexed. Until they are swapped in, the index is searched by brute force.
+template <typename T>
+class VectorIVFPQ : public VectorBase,
+                    public std::enable_shared_from_this<VectorIVFPQ<T>> {
+ public:
+  static absl::StatusOr<std::shared_ptr<VectorIVFPQ<T>>> Create(
+      const data_model::VectorIndex& vector_index_proto,
+      absl::string_view attribute_identifier,
+      data_model::AttributeDataType attribute_data_type)
+      ABSL_NO_THREAD_SAFETY_ANALYSIS;
+  static absl::StatusOr<std::shared_ptr<VectorIVFPQ<T>>> LoadFromRDB(
+      ValkeyModuleCtx* ctx, const AttributeDataType* attribute_data_type,
+      const data_model::VectorIndex& vector_index_proto,
+      absl::string_view attribute_identifier,
+      SupplementalContentChunkIter&& iter) ABSL_NO_THREAD_SAFETY_ANALYSIS;
+  ~VectorIVFPQ() override = default;
+
+  int GetDimensions() const { return dimensions_; }
+  uint32_t GetNlist() const { return nlist_; }
+  uint32_t GetPqM() const { return pq_m_; }
+  uint32_t GetNprobe() const { return nprobe_; }
+  bool IsTrained() const ABSL_LOCKS_EXCLUDED(index_mutex_);
+  // Number of indexed vectors that triggers the training of the quantizers.
+  size_t GetTrainingSize() const;
+  size_t GetCapacity() const override
+      ABSL_LOCKS_EXCLUDED(tracked_vectors_mutex_);
+  uint64_t GetMaxInternalLabel() const override
+      ABSL_LOCKS_EXCLUDED(tracked_vectors_mutex_);
+  size_t GetLabelCount() const override
+      ABSL_LOCKS_EXCLUDED(tracked_vectors_mutex_);
+  absl::StatusOr<std::vector<Neighbor>> Search(
+      absl::string_view query, uint64_t count,
+      cancel::Token& cancellation_token,
+      std::unique_ptr<hnswlib::BaseFilterFunctor> filter = nullptr,
+      std::optional<size_t> nprobe = std::nullopt)
+      ABSL_LOCKS_EXCLUDED(index_mutex_);
+
+ protected:
+  absl::Status AddRecordImpl(uint64_t internal_id,
+                             absl::string_view record) override
+      ABSL_LOCKS_EXCLUDED(index_mutex_);
+  absl::Status RemoveRecordImpl(uint64_t internal_id) override
+      ABSL_LOCKS_EXCLUDED(index_mutex_);
+  absl::Status ModifyRecordImpl(uint64_t internal_id,
+                                absl::string_view record) override
+      ABSL_LOCKS_EXCLUDED(index_mutex_);
+  void ToProtoImpl(data_model::VectorIndex* vector_index_proto) const override;
+  int RespondWithInfoImpl(ValkeyModuleCtx* ctx) const override;
+  absl::Status SaveIndexImpl(RDBChunkOutputStream chunked_out) const override;
+  absl::StatusOr<std::pair<float, hnswlib::labeltype>>
+  ComputeDistanceFromRecordImpl(uint64_t internal_id,
+                                absl::string_view query) const override;
+  char* GetValueImpl(uint64_t internal_id) const override
+      ABSL_LOCKS_EXCLUDED(tracked_vectors_mutex_);
+  void TrackVector(uint64_t internal_id,
+                   const InternedStringPtr& vector) override
+      ABSL_LOCKS_EXCLUDED(tracked_vectors_mutex_);
+  bool IsVectorMatch(uint64_t internal_id,
+                     const InternedStringPtr& vector) override
+      ABSL_LOCKS_EXCLUDED(tracked_vectors_mutex_);
+  void UnTrackVector(uint64_t internal_id) override
+      ABSL_LOCKS_EXCLUDED(tracked_vectors_mutex_);
+
+ private:
+  struct InvertedList {
+    // Concatenated pq_m byte codes, in the order of `labels`.
+    std::vector<uint8_t> codes;
+    std::vector<uint64_t> labels;
+  };
+  struct ListPosition {
+    uint32_t list;
+    uint32_t offset;
+  };
+  VectorIVFPQ(int dimensions, uint32_t nlist, uint32_t pq_m, uint32_t nprobe,
+              uint32_t initial_cap, absl::string_view attribute_identifier,
+              data_model::AttributeDataType attribute_data_type);
+
+  // Schedules the training of the quantizers on the utility threads once the
+  // training size is reached.
+  void MaybeTrain() ABSL_LOCKS_EXCLUDED(index_mutex_, tracked_vectors_mutex_);
+  // Trains the quantizers and encodes the tracked vectors without holding
+  // index_mutex_, then swaps them in.
+  void Train() ABSL_LOCKS_EXCLUDED(index_mutex_, tracked_vectors_mutex_);
+  // Encodes every tracked vector that is not in an inverted list yet.
+  void EncodeTrackedVectors() ABSL_EXCLUSIVE_LOCKS_REQUIRED(index_mutex_)
+      ABSL_LOCKS_EXCLUDED(tracked_vectors_mutex_);
+  uint32_t AssignList(const float* vector) const
+      ABSL_SHARED_LOCKS_REQUIRED(index_mutex_);
+  void Encode(const float* vector, uint32_t list, uint8_t* code) const
+      ABSL_SHARED_LOCKS_REQUIRED(index_mutex_);
+  void AddToList(uint64_t internal_id, uint32_t list, const uint8_t* code)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(index_mutex_);
+  void RemoveFromList(uint64_t internal_id)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(index_mutex_);
+  // Scores the codes of the `nprobe` closest lists and returns the `count`
+  // best candidates by approximate distance.
+  std::priority_queue<std::pair<float, hnswlib::labeltype>> SearchLists(
+      const float* query, uint64_t count, size_t nprobe,
+      cancel::Token& cancellation_token, hnswlib::BaseFilterFunctor* filter)
+      const ABSL_SHARED_LOCKS_REQUIRED(index_mutex_);
+  // Keeps the `count` candidates closest to `query` by exact distance.
+  std::priority_queue<std::pair<float, hnswlib::labeltype>> Refine(
+      const float* query, uint64_t count,
+      std::priority_queue<std::pair<float, hnswlib::labeltype>>& candidates)
+      const ABSL_LOCKS_EXCLUDED(tracked_vectors_mutex_);
+  // Exact search over the tracked vectors, used until the index is trained.
+  std::priority_queue<std::pair<float, hnswlib::labeltype>> BruteForceSearch(
+      const float* query, uint64_t count, cancel::Token& cancellation_token,
+      hnswlib::BaseFilterFunctor* filter) const
+      ABSL_LOCKS_EXCLUDED(tracked_vectors_mutex_);
+  float ExactDistance(const float* query, const char* vector) const;
+
+  // Exact distance between full precision vectors.
+  std::unique_ptr<hnswlib::SpaceInterface<T>> space_;
+  uint32_t nlist_;
+  uint32_t pq_m_;
+  uint32_t nprobe_;
+  uint32_t initial_cap_;
+  size_t sub_dimensions_;
+  std::atomic<bool> training_started_{false};
+
+  mutable absl::Mutex index_mutex_;
+  bool trained_ ABSL_GUARDED_BY(index_mutex_){false};
+  // nlist_ x dimensions_ coarse centroids.
+  std::vector<float> centroids_ ABSL_GUARDED_BY(index_mutex_);
+  // pq_m_ x kPqCentroids x sub_dimensions_ residual codebooks.
+  std::vector<float> codebooks_ ABSL_GUARDED_BY(index_mutex_);
+  std::vector<InvertedList> lists_ ABSL_GUARDED_BY(index_mutex_);
+  absl::flat_hash_map<uint64_t, ListPosition> positions_
+      ABSL_GUARDED_BY(index_mutex_);
+
+  // Full precision vectors, shared with the keyspace through the vector
+  // externalizer. Used for training, refinement and prefiltered queries.
+  mutable absl::Mutex tracked_vectors_mutex_;
+  absl::flat_hash_map<uint64_t, InternedStringPtr> tracked_vectors_
+      ABSL_GUARDED_BY(tracked_vectors_mutex_);
+};
+
+}  // namespace valkey_search::indexes
+
+#endif  // VALKEYSEARCH_SRC_INDEXES_VECTOR_IVF_PQ_H_
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2025, valkey-search contributors
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD 3-Clause
+ *
+ */
+
+#include "src/indexes/vector_quantization.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "absl/log/check.h"
+#include "absl/strings/string_view.h"
+#include "src/index_schema.pb.h"
+#include "third_party/hnswlib/hnswlib.h"
+#include "third_party/simsimd/include/simsimd/simsimd.h"
+
+namespace valkey_search::indexes {
+
+namespace {
+
+constexpr float kSq8MaxCode = 127.0f;
+
+// Prefix of every SQ8 code. Codes are not guaranteed to be aligned, so the
+// header is always accessed through memcpy.
+struct Sq8Header {
+  // Multiplier reconstructing the vector from its code.
+  float scale;
+  // Squared L2 norm of the int8 code.
+  float code_norm;
+};
+
+struct Sq8Operands {
+  Sq8Header header_a;
+  Sq8Header header_b;
+  // Dot product of the two int8 codes.
+  float code_dot;
+};
+
+inline Sq8Operands ComputeSq8Operands(const void *a, const void *b,
+                                      const void *dim_ptr) {
+  size_t dim = *static_cast<const size_t *>(dim_ptr);
+  Sq8Operands operands;
+  std::memcpy(&operands.header_a, a, sizeof(Sq8Header));
+  std::memcpy(&operands.header_b, b, sizeof(Sq8Header));
+  // simsimd has no int8 dot product kernel, so the dot product is derived from
+  // the int8 L2 kernel and the norms stored in the headers.
+  simsimd_distance_t code_l2;
+  simsimd_l2sq_i8(reinterpret_cast<const simsimd_i8_t *>(
+                      static_cast<const char *>(a) + sizeof(Sq8Header)),
+                  reinterpret_cast<const simsimd_i8_t *>(
+                      static_cast<const char *>(b) + sizeof(Sq8Header)),
+                  dim, &code_l2);
+  operands.code_dot = (operands.header_a.code_norm +
+                       operands.header_b.code_norm - code_l2) /
+                      2.0f;
+  return operands;
+}
+
+float Sq8L2Sqr(const void *a, const void *b, const void *dim_ptr) {
+  auto operands = ComputeSq8Operands(a, b, dim_ptr);
+  const auto &header_a = operands.header_a;
+  const auto &header_b = operands.header_b;
+  float distance = header_a.scale * header_a.scale * header_a.code_norm +
+                   header_b.scale * header_b.scale * header_b.code_norm -
+                   2.0f * header_a.scale * header_b.scale * operands.code_dot;
+  return std::max(distance, 0.0f);
+}
+
+float Sq8InnerProductDistance(const void *a, const void *b,
+                              const void *dim_ptr) {
+  auto operands = ComputeSq8Operands(a, b, dim_ptr);
+  return 1.0f - operands.header_a.scale * operands.header_b.scale *
+                    operands.code_dot;
+}
+
+inline size_t BqCodeSize(size_t dim) { return (dim + 7) / 8; }
+
+inline float HammingDistance(const void *a, const void *b, size_t dim) {
+  simsimd_distance_t distance;
+  simsimd_hamming_b8(static_cast<const simsimd_b8_t *>(a),
+                     static_cast<const simsimd_b8_t *>(b), BqCodeSize(dim),
+                     &distance);
+  return distance;
+}
+
+float BqHammingDistance(const void *a, const void *b, const void *dim_ptr) {
+  return HammingDistance(a, b, *static_cast<const size_t *>(dim_ptr));
+}
+
+// The fraction of differing sign bits estimates the angle between the vectors,
+// scaled to the [0, 2] range of the inner product distance of unit vectors.
+float BqAngularDistance(const void *a, const void *b, const void *dim_ptr) {
+  size_t dim = *static_cast<const size_t *>(dim_ptr);
+  return 2.0f * HammingDistance(a, b, dim) / dim;
+}
+
+bool IsInnerProduct(data_model::DistanceMetric distance_metric) {
+  return distance_metric == data_model::DistanceMetric::DISTANCE_METRIC_IP ||
+         distance_metric == data_model::DistanceMetric::DISTANCE_METRIC_COSINE;
+}
+
+class Sq8Space : public QuantizedSpace {
+ public:
+  Sq8Space(size_t dimensions, data_model::DistanceMetric distance_metric)
+      : QuantizedSpace(data_model::VECTOR_QUANTIZATION_SQ8, dimensions,
+                       sizeof(Sq8Header) + dimensions,
+                       IsInnerProduct(distance_metric)
+                           ? Sq8InnerProductDistance
+                           : Sq8L2Sqr) {}
+
+ protected:
+  void EncodeTo(const float *vector, char *code) const override {
+    float max_abs = 0.0f;
+    for (size_t i = 0; i < dimensions_; ++i) {
+      max_abs = std::max(max_abs, std::fabs(vector[i]));
+    }
+    Sq8Header header{.scale = max_abs > 0.0f ? max_abs / kSq8MaxCode : 1.0f,
+                     .code_norm = 0.0f};
+    const float inverse_scale = 1.0f / header.scale;
+    auto values = reinterpret_cast<int8_t *>(code + sizeof(Sq8Header));
+    int64_t code_norm = 0;
+    for (size_t i = 0; i < dimensions_; ++i) {
+      float value = std::clamp(std::round(vector[i] * inverse_scale),
+                               -kSq8MaxCode, kSq8MaxCode);
+      values[i] = static_cast<int8_t>(value);
+      code_norm += values[i] * values[i];
+    }
+    header.code_norm = static_cast<float>(code_norm);
+    std::memcpy(code, &header, sizeof(Sq8Header));
+  }
+};
+
+class BqSpace : public QuantizedSpace {
+ public:
+  BqSpace(size_t dimensions, data_model::DistanceMetric distance_metric)
+      : QuantizedSpace(data_model::VECTOR_QUANTIZATION_BQ, dimensions,
+                       BqCodeSize(dimensions),
+                       IsInnerProduct(distance_metric) ? BqAngularDistance
+                                                       : BqHammingDistance) {}
+
+ protected:
+  void EncodeTo(const float *vector, char *code) const override {
+    std::memset(code, 0, code_size_);
+    for (size_t i = 0; i < dimensions_; ++i) {
+      if (vector[i] > 0.0f) {
+        code[i >> 3] |= static_cast<char>(1 << (i & 7));
+      }
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<QuantizedSpace> QuantizedSpace::Create(
+    data_model::VectorQuantization quantization, size_t dimensions,
+    data_model::DistanceMetric distance_metric) {
+  switch (quantization) {
+    case data_model::VECTOR_QUANTIZATION_SQ8:
+      return std::make_unique<Sq8Space>(dimensions, distance_metric);
+    case data_model::VECTOR_QUANTIZATION_BQ:
+      return std::make_unique<BqSpace>(dimensions, distance_metric);
+    default:
+      return nullptr;
+  }
+}
+
+std::string QuantizedSpace::Encode(absl::string_view vector) const {
+  CHECK_EQ(vector.size(), dimensions_ * sizeof(float));
+  std::string code(code_size_, '\0');
+  EncodeTo(reinterpret_cast<const float *>(vector.data()), code.data());
+  return code;
+}
+
+}  // namespace valkey_search::indexes
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2025, valkey-search contributors
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD 3-Clause
+ *
+ */
+
+#ifndef VALKEYSEARCH_SRC_INDEXES_VECTOR_QUANTIZATION_H_
+#define VALKEYSEARCH_SRC_INDEXES_VECTOR_QUANTIZATION_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "src/index_schema.pb.h"
+#include "third_party/hnswlib/hnswlib.h"
+
+namespace valkey_search::indexes {
+
+// hnswlib space over quantized vector codes. Quantized indexes store the code
+// returned by Encode() in place of the float32 vector, and encode the query the
+// same way before searching, so hnswlib only ever sees codes.
+//
+// SQ8 stores one signed byte per dimension, scaled by the largest absolute
+// component of the vector. The scale and the squared norm of the code are
+// kept in a small header so that both L2 and inner product distances can be
+// derived from a single int8 L2 kernel.
+//
+// BQ stores the sign of each dimension as a single bit. Distances are derived
+// from the hamming distance between codes.
+class QuantizedSpace : public hnswlib::SpaceInterface<float> {
+ public:
+  static std::unique_ptr<QuantizedSpace> Create(
+      data_model::VectorQuantization quantization, size_t dimensions,
+      data_model::DistanceMetric distance_metric);
+  ~QuantizedSpace() override = default;
+
+  size_t get_data_size() override { return code_size_; }
+  hnswlib::DISTFUNC<float> get_dist_func() override { return dist_func_; }
+  void *get_dist_func_param() override { return &dimensions_; }
+
+  data_model::VectorQuantization GetQuantization() const {
+    return quantization_;
+  }
+  size_t GetCodeSize() const { return code_size_; }
+  // Returns the code of `vector`, which must hold `dimensions` floats.
+  std::string Encode(absl::string_view vector) const;
+
+ protected:
+  QuantizedSpace(data_model::VectorQuantization quantization,
+                 size_t dimensions, size_t code_size,
+                 hnswlib::DISTFUNC<float> dist_func)
+      : quantization_(quantization),
+        dimensions_(dimensions),
+        code_size_(code_size),
+        dist_func_(dist_func) {}
+  virtual void EncodeTo(const float *vector, char *code) const = 0;
+
+  data_model::VectorQuantization quantization_;
+  size_t dimensions_;
+  size_t code_size_;
+  hnswlib::DISTFUNC<float> dist_func_;
+};
+
+}  // namespace valkey_search::indexes
+
+#endif  // VALKEYSEARCH_SRC_INDEXES_VECTOR_QUANTIZATION_H_
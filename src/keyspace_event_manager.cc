@@ -25,6 +25,58 @@ namespace valkey_search {
 static absl::NoDestructor<std::unique_ptr<KeyspaceEventManager>>
     keyspace_event_manager_instance;
 
+const InternedStringPtr &KeyspaceDocument::GetInternedKey() {
+  if (!interned_key_) {
+    interned_key_ = StringInternStore::Intern(GetKeyView());
+  }
+  return interned_key_;
+}
+
+ValkeyModuleKey *KeyspaceDocument::GetOpenKey() {
+  if (!open_key_.has_value()) {
+    open_key_ = vmsdk::MakeUniqueValkeyOpenKey(
+        ctx_, key_, VALKEYMODULE_OPEN_KEY_NOEFFECTS | VALKEYMODULE_READ);
+  }
+  return open_key_->get();
+}
+
+void KeyspaceDocument::GetRecords(const AttributeDataType &attribute_data_type,
+                                  bool scan_hash,
+                                  VectorExternalizer::FetchedRecords &records) {
+  vmsdk::VerifyMainThread();
+  if (!shared_) {
+    VectorExternalizer::Instance().GetRecords(ctx_, &attribute_data_type,
+                                              GetOpenKey(), GetKeyView(),
+                                              scan_hash, records);
+    return;
+  }
+  auto &fetched_records = fetched_records_[attribute_data_type.ToProto()];
+  VectorExternalizer::FetchedRecords missing_records;
+  for (const auto &[identifier, _] : records) {
+    if (!fetched_records.contains(identifier)) {
+      missing_records[identifier];
+    }
+  }
+  if (!missing_records.empty()) {
+    VectorExternalizer::Instance().GetRecords(ctx_, &attribute_data_type,
+                                              GetOpenKey(), GetKeyView(),
+                                              scan_hash, missing_records);
+    for (auto &[identifier, fetched] : missing_records) {
+      fetched_records.emplace(identifier, std::move(fetched));
+    }
+  }
+  // Each subscriber hands its records over to its own mutation.
+  for (auto &[identifier, fetched] : records) {
+    const auto &cached = fetched_records.at(identifier);
+    fetched.is_module_owned = cached.is_module_owned;
+    fetched.record = nullptr;
+    if (cached.record) {
+      fetched.record = vmsdk::MakeUniqueValkeyString(
+          vmsdk::ToStringView(cached.record.get()));
+    }
+  }
+}
+
 KeyspaceEventManager &KeyspaceEventManager::Instance() {
   return **keyspace_event_manager_instance;
 }
@@ -51,8 +103,13 @@ void KeyspaceEventManager::NotifySubscribers(ValkeyModuleCtx *ctx, int type,
       }
     }
   }
-  for (const auto &subscription : subscriptions_to_notify) {
-    subscription->OnKeyspaceNotification(ctx, type, event, key);
+  {
+    // The document must be closed before the engine update queue reopens the
+    // key.
+    KeyspaceDocument document(ctx, key, subscriptions_to_notify.size() > 1);
+    for (const auto &subscription : subscriptions_to_notify) {
+      subscription->OnKeyspaceNotification(ctx, type, event, document);
+    }
   }
   VectorExternalizer::Instance().ProcessEngineUpdateQueue();
 }
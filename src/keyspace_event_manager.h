@@ -10,12 +10,20 @@
 
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
 #include "src/attribute_data_type.h"
+#include "src/index_schema.pb.h"
 #include "src/utils/patricia_tree.h"
+#include "src/utils/string_interning.h"
+#include "src/vector_externalizer.h"
+#include "vmsdk/src/managed_pointers.h"
+#include "vmsdk/src/type_conversions.h"
 #include "vmsdk/src/utils.h"
 #include "vmsdk/src/valkey_module_api/valkey_module.h"
 
@@ -23,6 +31,43 @@ namespace valkey_search {
 using StartSubscriptionFunction =
     std::function<absl::Status(ValkeyModuleCtx *, int)>;
 
+// KeyspaceDocument holds the contents of a key notified to the subscribers of a
+// keyspace event. Subscriptions with overlapping prefixes share the document,
+// so the key is opened and interned once, and each of its fields is fetched
+// once per data type, however many subscribers index the key. Documents are
+// only used from the main thread, while the event is being notified.
+class KeyspaceDocument {
+ public:
+  // A `shared` document is handed to several subscribers and keeps the
+  // fetched records for all of them.
+  KeyspaceDocument(ValkeyModuleCtx *ctx, ValkeyModuleString *key,
+                   bool shared = false)
+      : ctx_(ctx), key_(key), shared_(shared) {}
+  KeyspaceDocument(const KeyspaceDocument &) = delete;
+  KeyspaceDocument &operator=(const KeyspaceDocument &) = delete;
+
+  ValkeyModuleString *GetKey() const { return key_; }
+  absl::string_view GetKeyView() const { return vmsdk::ToStringView(key_); }
+  const InternedStringPtr &GetInternedKey();
+  // Returns the key opened for reading, or nullptr if it doesn't exist.
+  ValkeyModuleKey *GetOpenKey();
+  // Fetches the records of the identifiers of `records` from the open key,
+  // see VectorExternalizer::GetRecords. Records a shared document already
+  // fetched for another subscriber are copied instead of fetched again.
+  void GetRecords(const AttributeDataType &attribute_data_type, bool scan_hash,
+                  VectorExternalizer::FetchedRecords &records);
+
+ private:
+  ValkeyModuleCtx *ctx_;
+  ValkeyModuleString *key_;
+  bool shared_;
+  InternedStringPtr interned_key_;
+  std::optional<vmsdk::UniqueValkeyOpenKey> open_key_;
+  absl::flat_hash_map<data_model::AttributeDataType,
+                      VectorExternalizer::FetchedRecords>
+      fetched_records_;
+};
+
 // KeyspaceEventSubscription is an interface for classes that want to subscribe
 // to keyspace events.
 class KeyspaceEventSubscription {
@@ -44,6 +89,13 @@ class KeyspaceEventSubscription {
   virtual void OnKeyspaceNotification(ValkeyModuleCtx *ctx, int type,
                                       const char *event,
                                       ValkeyModuleString *key) = 0;
+  // Called by the KeyspaceEventManager, `document` is shared with the other
+  // subscribers notified of the event.
+  virtual void OnKeyspaceNotification(ValkeyModuleCtx *ctx, int type,
+                                      const char *event,
+                                      KeyspaceDocument &document) {
+    OnKeyspaceNotification(ctx, type, event, document.GetKey());
+  }
 };
 
 class KeyspaceEventManager {
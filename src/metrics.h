@@ -47,6 +47,7 @@ class Metrics {
     std::atomic<uint64_t> flat_modify_exceptions_cnt{0};
     std::atomic<uint64_t> flat_search_exceptions_cnt{0};
     std::atomic<uint64_t> flat_create_exceptions_cnt{0};
+    std::atomic<uint64_t> ivf_pq_create_exceptions_cnt{0};
     std::atomic<uint64_t> worker_thread_pool_suspend_cnt{0};
     std::atomic<uint64_t> writer_worker_thread_pool_resumed_cnt{0};
     std::atomic<uint64_t> reader_worker_thread_pool_resumed_cnt{0};
@@ -76,6 +77,9 @@ class Metrics {
     vmsdk::LatencySampler flat_vector_index_search_latency{
         absl::ToInt64Nanoseconds(absl::Nanoseconds(1)),
         absl::ToInt64Nanoseconds(absl::Seconds(1)), LATENCY_PRECISION};
+    vmsdk::LatencySampler ivf_pq_vector_index_search_latency{
+        absl::ToInt64Nanoseconds(absl::Nanoseconds(1)),
+        absl::ToInt64Nanoseconds(absl::Seconds(1)), LATENCY_PRECISION};
     std::atomic<uint64_t> coordinator_server_get_global_metadata_success_cnt{0};
     std::atomic<uint64_t> coordinator_server_get_global_metadata_failure_cnt{0};
     std::atomic<uint64_t> coordinator_server_search_index_partition_success_cnt{
@@ -9,6 +9,7 @@
 
 #include <netinet/in.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstring>
 #include <memory>
@@ -30,6 +31,8 @@
 #include "src/coordinator/search_converter.h"
 #include "src/coordinator/util.h"
 #include "src/indexes/vector_base.h"
+#include "src/query/partial_aggregate.h"
+#include "src/query/response_generator.h"
 #include "src/query/search.h"
 #include "src/utils/string_interning.h"
 #include "src/valkey_search.h"
@@ -83,6 +86,15 @@ struct SearchPartitionResultsTracker {
   std::priority_queue<indexes::Neighbor, std::vector<indexes::Neighbor>,
                       NeighborComparator>
       results ABSL_GUARDED_BY(mutex);
+  // When the leading GROUPBY of an FT.AGGREGATE is pushed down to the shards,
+  // their partial groups are merged here instead of collecting `results`.
+  // Neighbors from shards that don't support the pushdown are grouped too.
+  std::shared_ptr<PartialAggregator> partial_groups ABSL_GUARDED_BY(mutex);
+  // For non-vector SORTBY queries every shard replies with its top neighbors
+  // in SORTBY order. These runs are merged once all shards replied.
+  bool merge_sorted_runs{false};
+  std::vector<std::vector<indexes::Neighbor>> sorted_runs
+      ABSL_GUARDED_BY(mutex);
   int outstanding_requests ABSL_GUARDED_BY(mutex);
   std::unique_ptr<SearchParameters> parameters ABSL_GUARDED_BY(mutex);
   // Error tracking
@@ -96,7 +108,15 @@ struct SearchPartitionResultsTracker {
   SearchPartitionResultsTracker(int outstanding_requests, int k,
                                 std::unique_ptr<SearchParameters> parameters)
       : outstanding_requests(outstanding_requests),
-        parameters(std::move(parameters)) {}
+        parameters(std::move(parameters)) {
+    if (this->parameters->partial_aggregate.has_value()) {
+      partial_groups = std::make_shared<PartialAggregator>(
+          *this->parameters->partial_aggregate,
+          this->parameters->index_schema->GetAttributeDataType().ToProto());
+    } else {
+      merge_sorted_runs = SortsShardResults(*this->parameters);
+    }
+  }
 
   void HandleResponse(coordinator::SearchIndexPartitionResponse &response,
                       const std::string &address, const grpc::Status &status) {
@@ -129,6 +149,10 @@ struct SearchPartitionResultsTracker {
     absl::MutexLock lock(&mutex);
     accumulated_total_count.fetch_add(response.total_count(),
                                       std::memory_order_relaxed);
+    if (partial_groups) {
+      partial_groups->Merge(response.partial_groups());
+    }
+    std::vector<indexes::Neighbor> run;
     while (response.neighbors_size() > 0) {
       auto neighbor_entry = std::unique_ptr<coordinator::NeighborEntry>(
           response.mutable_neighbors()->ReleaseLast());
@@ -146,23 +170,91 @@ struct SearchPartitionResultsTracker {
       indexes::Neighbor neighbor{
           StringInternStore::Intern(neighbor_entry->key()),
           neighbor_entry->score(), std::move(attribute_contents)};
-      AddResult(neighbor);
+      if (merge_sorted_runs) {
+        run.emplace_back(std::move(neighbor));
+      } else {
+        AddResult(neighbor);
+      }
+    }
+    if (merge_sorted_runs) {
+      // The neighbors were released from the back.
+      std::reverse(run.begin(), run.end());
+      AddSortedRun(std::move(run), response.sorted());
     }
   }
 
   void AddResults(std::vector<indexes::Neighbor> &neighbors) {
     absl::MutexLock lock(&mutex);
+    if (merge_sorted_runs) {
+      AddSortedRun(std::move(neighbors), false);
+      return;
+    }
     for (auto &neighbor : neighbors) {
       AddResult(neighbor);
     }
   }
 
+  // Shards that don't sort their replies, including the local one, are
+  // sorted here.
+  void AddSortedRun(std::vector<indexes::Neighbor> &&run, bool sorted)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex) {
+    if (!sorted) {
+      KeepSortedTop(run, *parameters);
+    }
+    sorted_runs.emplace_back(std::move(run));
+  }
+
+  // Bounded k-way merge of the sorted runs, which stops as soon as the first
+  // offset + limit neighbors are known.
+  std::vector<indexes::Neighbor> MergeSortedRuns()
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex) {
+    const size_t count =
+        parameters->limit.first_index + parameters->limit.number;
+    SortByComparator less(*parameters->sortby_parameter, *parameters);
+    // The next neighbor of every run, as (run, position).
+    using Head = std::pair<size_t, size_t>;
+    auto greater = [&](const Head &a, const Head &b) {
+      const auto &neighbor_a = sorted_runs[a.first][a.second];
+      const auto &neighbor_b = sorted_runs[b.first][b.second];
+      if (less(neighbor_b, neighbor_a)) {
+        return true;
+      }
+      if (less(neighbor_a, neighbor_b)) {
+        return false;
+      }
+      // Ties keep the order of the runs.
+      return a.first > b.first;
+    };
+    std::priority_queue<Head, std::vector<Head>, decltype(greater)> heads(
+        greater);
+    for (size_t run = 0; run < sorted_runs.size(); ++run) {
+      if (!sorted_runs[run].empty()) {
+        heads.emplace(run, 0);
+      }
+    }
+    std::vector<indexes::Neighbor> neighbors;
+    while (!heads.empty() && neighbors.size() < count) {
+      auto [run, position] = heads.top();
+      heads.pop();
+      neighbors.emplace_back(std::move(sorted_runs[run][position]));
+      if (++position < sorted_runs[run].size()) {
+        heads.emplace(run, position);
+      }
+    }
+    sorted_runs.clear();
+    return neighbors;
+  }
+
   void AddTotalCount(size_t count) {
     accumulated_total_count.fetch_add(count, std::memory_order_relaxed);
   }
 
   void AddResult(indexes::Neighbor &neighbor)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex) {
+    if (partial_groups) {
+      partial_groups->Add(neighbor);
+      return;
+    }
     // For non-vector queries, we can add the result directly.
     if (parameters->IsNonVectorQuery()) {
       results.emplace(std::move(neighbor));
@@ -191,23 +283,28 @@ struct SearchPartitionResultsTracker {
     } else {
       // No errors detected - success case
       std::vector<indexes::Neighbor> neighbors;
-      neighbors.resize(results.size());
-      size_t i = neighbors.size();
-      while (!results.empty()) {
-        CHECK(i != 0);
-        neighbors[--i] =
-            std::move(const_cast<indexes::Neighbor &>(results.top()));
-        results.pop();
+      if (merge_sorted_runs) {
+        neighbors = MergeSortedRuns();
+      } else {
+        neighbors.resize(results.size());
+        size_t i = neighbors.size();
+        while (!results.empty()) {
+          CHECK(i != 0);
+          neighbors[--i] =
+              std::move(const_cast<indexes::Neighbor &>(results.top()));
+          results.pop();
+        }
+        CHECK(i == 0);
       }
-      CHECK(i == 0);
-      // Note: We do not sort neighbors here because we do not have the content
-      // of the local shard yet. In the SendReply function, we will sort the all
-      // neighbors based on the content if sorting is required.
+      // Note: Apart from merging the sorted runs, we do not sort neighbors
+      // here. In the SendReply function, we will sort all the neighbors based
+      // on the content if sorting is required.
       // SearchResult construction automatically applies trimming based on LIMIT
       // offset count IF the command allows it (ie - it does not require
       // complete results).
       parameters->search_result = SearchResult(
           accumulated_total_count, std::move(neighbors), *parameters, true);
+      parameters->search_result.partial_groups = std::move(partial_groups);
       status = absl::OkStatus();
     }
     parameters->search_result.status = status;
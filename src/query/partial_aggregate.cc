@@ -0,0 +1,320 @@
+/*
+ * Copyright (c) 2025, valkey-search contributors
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD 3-Clause
+ *
+ */
+
+#include "src/query/partial_aggregate.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/log/check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "src/coordinator/coordinator.pb.h"
+#include "src/expr/value.h"
+#include "src/index_schema.pb.h"
+#include "src/indexes/vector_base.h"
+#include "vmsdk/src/managed_pointers.h"
+#include "vmsdk/src/type_conversions.h"
+#include "vmsdk/src/utils.h"
+
+namespace valkey_search::query {
+
+namespace {
+
+// Values made from attribute contents reference the fetched strings, copy
+// them before they are kept beyond the record.
+expr::Value Own(const expr::Value& value) {
+  if (value.IsString()) {
+    return expr::Value(std::string(value.GetStringView()));
+  }
+  return value;
+}
+
+void ValueToProto(const expr::Value& value,
+                  coordinator::AggregateValue* proto) {
+  if (value.IsBool()) {
+    proto->set_boolean(value.GetBool());
+  } else if (value.IsDouble()) {
+    proto->set_number(value.GetDouble());
+  } else if (value.IsString()) {
+    proto->set_text(std::string(value.GetStringView()));
+  }
+}
+
+expr::Value ValueFromProto(const coordinator::AggregateValue& proto) {
+  switch (proto.value_case()) {
+    case coordinator::AggregateValue::kNumber:
+      return expr::Value(proto.number());
+    case coordinator::AggregateValue::kText:
+      return expr::Value(std::string(proto.text()));
+    case coordinator::AggregateValue::kBoolean:
+      return expr::Value(proto.boolean());
+    case coordinator::AggregateValue::VALUE_NOT_SET:
+      break;
+  }
+  return expr::Value();
+}
+
+}  // namespace
+
+absl::StatusOr<expr::Value> ContentToValue(
+    absl::string_view content, bool numeric,
+    data_model::AttributeDataType data_type) {
+  if (numeric) {
+    auto numeric_value = vmsdk::To<double>(content);
+    if (!numeric_value.ok()) {
+      return absl::InvalidArgumentError("Invalid numeric value");
+    }
+    return expr::Value(numeric_value.value());
+  }
+  if (data_type == data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH) {
+    return expr::Value(content);
+  }
+  auto unquoted = vmsdk::JsonUnquote(content);
+  if (!unquoted) {
+    return absl::InvalidArgumentError("Failed to unquote JSON value");
+  }
+  return expr::Value(std::move(*unquoted));
+}
+
+std::optional<PartialAggregator::ReducerKind> PartialAggregator::GetKind(
+    absl::string_view name) {
+  if (name == "AVG") {
+    return ReducerKind::kAvg;
+  } else if (name == "COUNT") {
+    return ReducerKind::kCount;
+  } else if (name == "COUNT_DISTINCT") {
+    return ReducerKind::kCountDistinct;
+  } else if (name == "MAX") {
+    return ReducerKind::kMax;
+  } else if (name == "MIN") {
+    return ReducerKind::kMin;
+  } else if (name == "STDDEV") {
+    return ReducerKind::kStddev;
+  } else if (name == "SUM") {
+    return ReducerKind::kSum;
+  }
+  return std::nullopt;
+}
+
+absl::Status PartialAggregator::Validate(
+    const coordinator::PartialAggregate& plan) {
+  for (auto field : plan.group_by()) {
+    if (field >= static_cast<uint32_t>(plan.fields_size())) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Invalid GROUPBY field: ", field));
+    }
+  }
+  for (const auto& reducer : plan.reducers()) {
+    if (!GetKind(reducer.name())) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unknown reducer: ", reducer.name()));
+    }
+    if (reducer.has_field() &&
+        reducer.field() >= static_cast<uint32_t>(plan.fields_size())) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Invalid reducer field: ", reducer.field()));
+    }
+  }
+  return absl::OkStatus();
+}
+
+PartialAggregator::PartialAggregator(const coordinator::PartialAggregate& plan,
+                                     data_model::AttributeDataType data_type)
+    : plan_(plan), data_type_(data_type) {
+  for (const auto& reducer : plan_.reducers()) {
+    auto kind = GetKind(reducer.name());
+    CHECK(kind.has_value()) << "Unknown reducer " << reducer.name();
+    kinds_.push_back(*kind);
+  }
+  for (int i = 0; i < plan_.fields_size(); ++i) {
+    fields_by_name_.try_emplace(plan_.fields(i).alias(), i);
+  }
+  for (int i = 0; i < plan_.fields_size(); ++i) {
+    fields_by_name_.try_emplace(plan_.fields(i).identifier(), i);
+  }
+}
+
+PartialAggregator::States& PartialAggregator::FindGroup(Key&& key) {
+  auto [it, inserted] = groups_.try_emplace(std::move(key));
+  if (inserted) {
+    it->second.resize(kinds_.size());
+  }
+  return it->second;
+}
+
+void PartialAggregator::Add(const indexes::Neighbor& neighbor) {
+  absl::InlinedVector<expr::Value, 8> fields(plan_.fields_size());
+  if (neighbor.attribute_contents.has_value()) {
+    for (const auto& [name, content] : *neighbor.attribute_contents) {
+      auto it = fields_by_name_.find(name);
+      if (it == fields_by_name_.end()) {
+        continue;
+      }
+      bool numeric = plan_.fields(it->second).numeric();
+      auto value = ContentToValue(vmsdk::ToStringView(content.value.get()),
+                                  numeric, data_type_);
+      if (value.ok()) {
+        fields[it->second] = std::move(*value);
+      } else if (!numeric) {
+        // Like FT.AGGREGATE, drop records whose JSON can't be unquoted.
+        return;
+      }
+    }
+  }
+  Key key;
+  for (auto field : plan_.group_by()) {
+    key.push_back(Own(fields[field]));
+  }
+  auto& states = FindGroup(std::move(key));
+  for (size_t i = 0; i < kinds_.size(); ++i) {
+    const auto& reducer = plan_.reducers(i);
+    Accumulate(i,
+               reducer.has_field() ? fields[reducer.field()] : expr::Value(),
+               states[i]);
+  }
+}
+
+void PartialAggregator::Accumulate(size_t reducer, const expr::Value& value,
+                                   ReducerState& state) const {
+  switch (kinds_[reducer]) {
+    case ReducerKind::kCount:
+      state.count++;
+      return;
+    case ReducerKind::kMin:
+    case ReducerKind::kMax:
+      if (value.IsNil()) {
+        return;
+      }
+      if (state.extremum.IsNil() ||
+          (kinds_[reducer] == ReducerKind::kMin ? state.extremum > value
+                                                : state.extremum < value)) {
+        state.extremum = Own(value);
+      }
+      return;
+    case ReducerKind::kCountDistinct:
+      if (!value.IsNil()) {
+        state.distinct_values.insert(Own(value));
+      }
+      return;
+    case ReducerKind::kSum:
+    case ReducerKind::kAvg:
+    case ReducerKind::kStddev:
+      if (auto number = value.AsDouble(); number) {
+        state.count++;
+        state.sum += *number;
+        state.sum_of_squares += *number * *number;
+      }
+      return;
+  }
+}
+
+void PartialAggregator::MergeState(size_t reducer,
+                                   const coordinator::ReducerState& from,
+                                   ReducerState& state) const {
+  state.count += from.count();
+  state.sum += from.sum();
+  state.sum_of_squares += from.sum_of_squares();
+  if (from.has_extremum() && (kinds_[reducer] == ReducerKind::kMin ||
+                              kinds_[reducer] == ReducerKind::kMax)) {
+    Accumulate(reducer, ValueFromProto(from.extremum()), state);
+  }
+  for (const auto& value : from.distinct_values()) {
+    state.distinct_values.insert(ValueFromProto(value));
+  }
+}
+
+void PartialAggregator::Merge(
+    const google::protobuf::RepeatedPtrField<coordinator::PartialGroup>&
+        groups) {
+  for (const auto& group : groups) {
+    Key key;
+    for (const auto& value : group.keys()) {
+      key.push_back(ValueFromProto(value));
+    }
+    auto& states = FindGroup(std::move(key));
+    const size_t count =
+        std::min(states.size(), static_cast<size_t>(group.states_size()));
+    for (size_t i = 0; i < count; ++i) {
+      MergeState(i, group.states(i), states[i]);
+    }
+  }
+}
+
+void PartialAggregator::Serialize(
+    google::protobuf::RepeatedPtrField<coordinator::PartialGroup>* groups)
+    const {
+  groups->Reserve(groups->size() + groups_.size());
+  for (const auto& [key, states] : groups_) {
+    auto* group = groups->Add();
+    for (const auto& value : key) {
+      ValueToProto(value, group->add_keys());
+    }
+    for (const auto& state : states) {
+      auto* proto = group->add_states();
+      proto->set_count(state.count);
+      proto->set_sum(state.sum);
+      proto->set_sum_of_squares(state.sum_of_squares);
+      if (!state.extremum.IsNil()) {
+        ValueToProto(state.extremum, proto->mutable_extremum());
+      }
+      for (const auto& value : state.distinct_values) {
+        ValueToProto(value, proto->add_distinct_values());
+      }
+    }
+  }
+}
+
+expr::Value PartialAggregator::Finish(size_t reducer,
+                                      const ReducerState& state) const {
+  // Same results as the reducers of the GROUPBY stage.
+  switch (kinds_[reducer]) {
+    case ReducerKind::kCount:
+      return expr::Value(double(state.count));
+    case ReducerKind::kMin:
+    case ReducerKind::kMax:
+      return state.extremum;
+    case ReducerKind::kCountDistinct:
+      return expr::Value(double(state.distinct_values.size()));
+    case ReducerKind::kSum:
+      return expr::Value(state.sum);
+    case ReducerKind::kAvg:
+      return expr::Value(state.count ? state.sum / state.count : 0.0);
+    case ReducerKind::kStddev: {
+      if (state.count <= 1) {
+        return expr::Value(0.0);
+      }
+      double variance =
+          (state.sum_of_squares - (state.sum * state.sum) / state.count) /
+          (state.count - 1);
+      return expr::Value(std::sqrt(variance));
+    }
+  }
+  CHECK(false);
+}
+
+void PartialAggregator::ForEachGroup(
+    absl::FunctionRef<void(absl::Span<const expr::Value> keys,
+                           absl::Span<const expr::Value> results)>
+        fn) const {
+  absl::InlinedVector<expr::Value, 4> results(kinds_.size());
+  for (const auto& [key, states] : groups_) {
+    for (size_t i = 0; i < kinds_.size(); ++i) {
+      results[i] = Finish(i, states[i]);
+    }
+    fn(key, results);
+  }
+}
+
+}  // namespace valkey_search::query
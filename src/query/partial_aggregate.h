@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2025, valkey-search contributors
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD 3-Clause
+ *
+ */
+
+#ifndef VALKEYSEARCH_SRC_QUERY_PARTIAL_AGGREGATE_H_
+#define VALKEYSEARCH_SRC_QUERY_PARTIAL_AGGREGATE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "google/protobuf/repeated_ptr_field.h"
+#include "src/coordinator/coordinator.pb.h"
+#include "src/expr/value.h"
+#include "src/index_schema.pb.h"
+#include "src/indexes/vector_base.h"
+
+namespace valkey_search::query {
+
+// Converts fetched attribute content into the value seen by FT.AGGREGATE.
+// Numeric attributes are parsed as doubles and JSON strings are unquoted.
+absl::StatusOr<expr::Value> ContentToValue(
+    absl::string_view content, bool numeric,
+    data_model::AttributeDataType data_type);
+
+// Evaluates the GROUPBY described by a PartialAggregate.
+//
+// Each shard of a fanout groups its own results and replies with the
+// mergeable state of every group, see ReducerState in coordinator.proto. The
+// coordinator merges those states and only finalizes the reducers once, so
+// the records themselves never cross the network. Records are built from
+// the attribute contents the same way FT.AGGREGATE builds them, and the
+// reducers keep the semantics of the GROUPBY stage.
+class PartialAggregator {
+ public:
+  // Checks that a plan received from a coordinator only references known
+  // reducers and fields.
+  static absl::Status Validate(const coordinator::PartialAggregate& plan);
+
+  // `plan` must outlive the aggregator and have passed Validate.
+  PartialAggregator(const coordinator::PartialAggregate& plan,
+                    data_model::AttributeDataType data_type);
+
+  // Groups the record made from the attribute contents of `neighbor`.
+  void Add(const indexes::Neighbor& neighbor);
+  // Merges the groups serialized by another aggregator.
+  void Merge(
+      const google::protobuf::RepeatedPtrField<coordinator::PartialGroup>&
+          groups);
+  void Serialize(
+      google::protobuf::RepeatedPtrField<coordinator::PartialGroup>* groups)
+      const;
+  // Calls `fn` with the keys and the final reducer values of every group.
+  void ForEachGroup(
+      absl::FunctionRef<void(absl::Span<const expr::Value> keys,
+                             absl::Span<const expr::Value> results)>
+          fn) const;
+  size_t GroupCount() const { return groups_.size(); }
+
+ private:
+  enum class ReducerKind : uint8_t {
+    kAvg,
+    kCount,
+    kCountDistinct,
+    kMax,
+    kMin,
+    kStddev,
+    kSum
+  };
+  struct ReducerState {
+    uint64_t count{0};
+    double sum{0};
+    double sum_of_squares{0};
+    expr::Value extremum;
+    absl::flat_hash_set<expr::Value> distinct_values;
+  };
+  static std::optional<ReducerKind> GetKind(absl::string_view name);
+
+  using Key = absl::InlinedVector<expr::Value, 4>;
+  using States = absl::InlinedVector<ReducerState, 4>;
+
+  States& FindGroup(Key&& key);
+  void Accumulate(size_t reducer, const expr::Value& value,
+                  ReducerState& state) const;
+  void MergeState(size_t reducer, const coordinator::ReducerState& from,
+                  ReducerState& state) const;
+  expr::Value Finish(size_t reducer, const ReducerState& state) const;
+
+  const coordinator::PartialAggregate& plan_;
+  data_model::AttributeDataType data_type_;
+  std::vector<ReducerKind> kinds_;
+  // Field index of every attribute name, aliases taking precedence.
+  absl::flat_hash_map<absl::string_view, size_t> fields_by_name_;
+  absl::flat_hash_map<Key, States> groups_;
+};
+
+}  // namespace valkey_search::query
+
+#endif  // VALKEYSEARCH_SRC_QUERY_PARTIAL_AGGREGATE_H_
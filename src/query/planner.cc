@@ -7,41 +7,405 @@
 
 #include "src/query/planner.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
+#include "absl/base/no_destructor.h"
 #include "absl/log/check.h"
+#include "absl/strings/ascii.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "src/indexes/index_base.h"
 #include "src/indexes/vector_base.h"
+#include "src/indexes/vector_flat.h"
+#include "src/indexes/vector_hnsw.h"
+#include "src/indexes/vector_ivf_pq.h"
 #include "src/valkey_search_options.h"
+#include "vmsdk/src/status/status_macros.h"
 
 namespace valkey_search::query {
-// TODO: Tune the threshold ratio.
-// The query planner decides whether to use pre or inline filtering based on
-// heuristics.
-bool UsePreFiltering(size_t estimated_num_of_keys,
-                     indexes::VectorBase *vector_index) {
+
+namespace {
+
+// Cost of resolving a key and evaluating the filter predicate against it,
+// expressed in the same units as one vector dimension of a distance
+// computation. Predicate evaluation is dominated by per-index hash lookups.
+constexpr double kFilterEvalUnits = 64.0;
+// Cost of looking up the internal id and vector of a prefiltered key.
+constexpr double kPrefilterFetchUnits = 32.0;
+// Weight of a new latency observation in the calibrated coefficients.
+constexpr double kCalibrationAlpha = 0.05;
+// Single observations may move a coefficient by at most this factor, so that
+// one query stalled behind a write slice does not skew the model.
+constexpr double kMaxCalibrationStep = 4.0;
+constexpr double kInitialNsPerUnit = 1.0;
+constexpr size_t kRecentPlansCapacity = 32;
+// The recent plans are spread over shards picked by thread, so that reader
+// threads recording their plans don't contend on one mutex.
+constexpr size_t kRecentPlansShards = 16;
+// One in that many decisions of the cost model runs the plan it didn't
+// choose, so that a plan whose cost is overestimated still gets calibrated.
+constexpr uint64_t kExplorationInterval = 64;
+// Only decisions whose estimates are within this factor of each other are
+// explored. A plan estimated many times costlier is never run on a live
+// query, the calibration error it could reveal doesn't matter to the choice.
+constexpr double kMaxExplorationCostRatio = 2.0;
+
+struct RecentPlan {
+  uint64_t sequence;
+  std::string index_name;
+  QueryPlan plan;
+  absl::Duration elapsed;
+  bool completed;
+};
+
+class CostModel {
+ public:
+  static CostModel &Instance() {
+    static absl::NoDestructor<CostModel> instance;
+    return *instance;
+  }
+
+  double NsPerUnit(FilterPlan plan) const {
+    return coefficient(plan).load(std::memory_order_relaxed);
+  }
+
+  void Record(const QueryPlan &plan, absl::string_view index_name,
+              absl::Duration elapsed, bool completed) {
+    double units = plan.EstimatedUnits();
+    if (completed && units > 0.0) {
+      auto &coef = coefficient(plan.filter_plan);
+      double observed = absl::ToDoubleNanoseconds(elapsed) / units;
+      double current = coef.load(std::memory_order_relaxed);
+      observed = std::clamp(observed, current / kMaxCalibrationStep,
+                            current * kMaxCalibrationStep);
+      // Lost updates between racing queries are harmless, the model converges
+      // either way.
+      coef.store(current + kCalibrationAlpha * (observed - current),
+                 std::memory_order_relaxed);
+      samples(plan.filter_plan).fetch_add(1, std::memory_order_relaxed);
+    }
+    auto &shard = recent_plans_[std::hash<std::thread::id>{}(
+                                    std::this_thread::get_id()) %
+                                kRecentPlansShards];
+    uint64_t sequence =
+        recent_plans_sequence_.fetch_add(1, std::memory_order_relaxed);
+    absl::MutexLock lock(&shard.mutex);
+    if (shard.plans.size() >= kRecentPlansCapacity) {
+      shard.plans.pop_front();
+    }
+    shard.plans.push_back(RecentPlan{sequence, std::string(index_name), plan,
+                                     elapsed, completed});
+  }
+
+  // Whether the decision between plans of the given estimated costs explores
+  // the costlier one. Only close decisions count towards the interval.
+  bool ShouldExplore(double prefilter_cost_ns, double inline_cost_ns) {
+    if (std::max(prefilter_cost_ns, inline_cost_ns) >
+        std::min(prefilter_cost_ns, inline_cost_ns) *
+            kMaxExplorationCostRatio) {
+      return false;
+    }
+    return decisions_.fetch_add(1, std::memory_order_relaxed) %
+               kExplorationInterval ==
+           kExplorationInterval - 1;
+  }
+
+  CostModelCoefficients GetCoefficients() const {
+    return CostModelCoefficients{
+        .prefilter_ns_per_unit =
+            prefilter_ns_per_unit_.load(std::memory_order_relaxed),
+        .inline_ns_per_unit =
+            inline_ns_per_unit_.load(std::memory_order_relaxed),
+        .prefilter_samples = prefilter_samples_.load(std::memory_order_relaxed),
+        .inline_samples = inline_samples_.load(std::memory_order_relaxed),
+    };
+  }
+
+  // Returns the most recent plans of all the shards, oldest first.
+  std::vector<RecentPlan> GetRecentPlans() const {
+    std::vector<RecentPlan> recent_plans;
+    for (const auto &shard : recent_plans_) {
+      absl::MutexLock lock(&shard.mutex);
+      recent_plans.insert(recent_plans.end(), shard.plans.begin(),
+                          shard.plans.end());
+    }
+    std::sort(recent_plans.begin(), recent_plans.end(),
+              [](const RecentPlan &a, const RecentPlan &b) {
+                return a.sequence < b.sequence;
+              });
+    if (recent_plans.size() > kRecentPlansCapacity) {
+      recent_plans.erase(recent_plans.begin(),
+                         recent_plans.end() - kRecentPlansCapacity);
+    }
+    return recent_plans;
+  }
+
+  void Reset() {
+    prefilter_ns_per_unit_ = kInitialNsPerUnit;
+    inline_ns_per_unit_ = kInitialNsPerUnit;
+    prefilter_samples_ = 0;
+    inline_samples_ = 0;
+    decisions_ = 0;
+    for (auto &shard : recent_plans_) {
+      absl::MutexLock lock(&shard.mutex);
+      shard.plans.clear();
+    }
+  }
+
+ private:
+  std::atomic<double> &coefficient(FilterPlan plan) {
+    return plan == FilterPlan::kPreFilter ? prefilter_ns_per_unit_
+                                          : inline_ns_per_unit_;
+  }
+  const std::atomic<double> &coefficient(FilterPlan plan) const {
+    return plan == FilterPlan::kPreFilter ? prefilter_ns_per_unit_
+                                          : inline_ns_per_unit_;
+  }
+  std::atomic<uint64_t> &samples(FilterPlan plan) {
+    return plan == FilterPlan::kPreFilter ? prefilter_samples_
+                                          : inline_samples_;
+  }
+
+  std::atomic<double> prefilter_ns_per_unit_{kInitialNsPerUnit};
+  std::atomic<double> inline_ns_per_unit_{kInitialNsPerUnit};
+  std::atomic<uint64_t> prefilter_samples_{0};
+  std::atomic<uint64_t> inline_samples_{0};
+  std::atomic<uint64_t> decisions_{0};
+  struct RecentPlansShard {
+    mutable absl::Mutex mutex;
+    std::deque<RecentPlan> plans ABSL_GUARDED_BY(mutex);
+  };
+  std::atomic<uint64_t> recent_plans_sequence_{0};
+  RecentPlansShard recent_plans_[kRecentPlansShards];
+};
+
+// Pre-filtering resolves every key of the filtered space, evaluates the
+// predicate against it and computes one exact distance.
+double EstimatePreFilterUnits(size_t estimated_num_of_keys, int dimensions) {
+  return static_cast<double>(estimated_num_of_keys) *
+         (kFilterEvalUnits + kPrefilterFetchUnits + dimensions);
+}
+
+// Inline filtering greedily descends the upper layers of the graph and then
+// runs a best-first search on layer 0. To collect `ef` candidates that pass
+// the filter, the search has to expand roughly ef / selectivity nodes, each of
+// which computes distances to (and filters) up to 2*M neighbors. The visited
+// list bounds the total work by the size of the graph.
+double EstimateInlineFilterUnits(size_t estimated_num_of_keys,
+                                 size_t index_size, int dimensions, int m,
+                                 size_t ef) {
+  double n = static_cast<double>(index_size);
+  double selectivity = std::clamp(
+      static_cast<double>(estimated_num_of_keys) / n, 1.0 / n, 1.0);
+  double fanout = std::max(m, 2);
+  double upper_layer_distances = std::log(n) / std::log(fanout) * fanout;
+  double expanded_nodes = static_cast<double>(ef) / selectivity;
+  double layer0_distances = std::min(n, expanded_nodes * 2.0 * fanout);
+  return (upper_layer_distances + layer0_distances) * dimensions +
+         layer0_distances * kFilterEvalUnits;
+}
+
+// Inline filtering on an IVF-PQ index ranks the coarse centroids, builds the
+// distance tables of the probed lists and then scores every code of these
+// lists with one table lookup per subspace. Only the candidates that make the
+// cut are filtered, at most about k per probed list.
+double EstimateIVFPQInlineFilterUnits(size_t index_size, int dimensions,
+                                      uint32_t nlist, uint32_t pq_m,
+                                      size_t nprobe, uint64_t k) {
+  double probed_fraction =
+      std::min(1.0, static_cast<double>(nprobe) / std::max(nlist, 1u));
+  double scanned_codes = static_cast<double>(index_size) * probed_fraction;
+  return static_cast<double>(nlist) * dimensions +
+         static_cast<double>(nprobe) * indexes::kPqCentroids * dimensions +
+         scanned_codes * pq_m +
+         std::min(scanned_codes, static_cast<double>(nprobe * k)) *
+             kFilterEvalUnits;
+}
+
+bool WithinThresholdRatio(size_t estimated_num_of_keys, size_t index_size) {
+  return estimated_num_of_keys <=
+         options::GetPrefilteringThresholdRatio() * index_size;
+}
+
+void ChooseFilterPlan(QueryPlan &plan) {
+  auto &cost_model = CostModel::Instance();
+  plan.prefilter_cost_ns =
+      plan.prefilter_units * cost_model.NsPerUnit(FilterPlan::kPreFilter);
+  plan.inline_cost_ns =
+      plan.inline_units * cost_model.NsPerUnit(FilterPlan::kInlineFilter);
+  // A filtered space below the configured ratio is always cheap enough to
+  // search exhaustively; beyond it, the cost model decides.
+  if (WithinThresholdRatio(plan.estimated_num_of_keys, plan.index_size)) {
+    plan.filter_plan = FilterPlan::kPreFilter;
+  } else if (options::GetQueryPlannerCostModel().GetValue()) {
+    bool prefilter = plan.prefilter_cost_ns <= plan.inline_cost_ns;
+    plan.explored =
+        cost_model.ShouldExplore(plan.prefilter_cost_ns, plan.inline_cost_ns);
+    if (plan.explored) {
+      prefilter = !prefilter;
+    }
+    plan.filter_plan =
+        prefilter ? FilterPlan::kPreFilter : FilterPlan::kInlineFilter;
+  } else {
+    plan.filter_plan = FilterPlan::kInlineFilter;
+  }
+}
+
+}  // namespace
+
+absl::string_view FilterPlanToString(FilterPlan plan) {
+  return plan == FilterPlan::kPreFilter ? "prefilter" : "inline";
+}
+
+QueryPlan PlanFilteredVectorSearch(size_t estimated_num_of_keys,
+                                   indexes::VectorBase *vector_index,
+                                   uint64_t k, std::optional<unsigned> ef,
+                                   std::optional<unsigned> nprobe) {
+  auto &cost_model = CostModel::Instance();
+  QueryPlan plan;
+  plan.estimated_num_of_keys = estimated_num_of_keys;
+  plan.index_size = vector_index->GetTrackedKeyCount();
   if (vector_index->GetIndexerType() == indexes::IndexerType::kFlat) {
     /* With a flat index, the search needs to go through all the vectors,
     taking O(N*log(k)). With pre-filtering, we can do the same search on the
     reduced space, taking O(n*log(k)). Therefore we should always choose
     pre-filtering */
-    return true;
+    auto flat = dynamic_cast<indexes::VectorFlat<float> *>(vector_index);
+    int dimensions = flat ? flat->GetDimensions() : 0;
+    plan.prefilter_units =
+        EstimatePreFilterUnits(estimated_num_of_keys, dimensions);
+    plan.inline_units =
+        static_cast<double>(plan.index_size) * (kFilterEvalUnits + dimensions);
+    plan.prefilter_cost_ns =
+        plan.prefilter_units * cost_model.NsPerUnit(FilterPlan::kPreFilter);
+    plan.inline_cost_ns =
+        plan.inline_units * cost_model.NsPerUnit(FilterPlan::kInlineFilter);
+    plan.filter_plan = FilterPlan::kPreFilter;
+    return plan;
+  }
+  if (vector_index->GetIndexerType() == indexes::IndexerType::kIVFPQ) {
+    auto ivf_pq = dynamic_cast<indexes::VectorIVFPQ<float> *>(vector_index);
+    CHECK(ivf_pq != nullptr);
+    if (plan.index_size == 0 || !ivf_pq->IsTrained()) {
+      // Untrained indexes are searched exhaustively either way.
+      plan.filter_plan = FilterPlan::kPreFilter;
+      return plan;
+    }
+    plan.prefilter_units =
+        EstimatePreFilterUnits(estimated_num_of_keys, ivf_pq->GetDimensions());
+    plan.inline_units = EstimateIVFPQInlineFilterUnits(
+        plan.index_size, ivf_pq->GetDimensions(), ivf_pq->GetNlist(),
+        ivf_pq->GetPqM(), nprobe.value_or(ivf_pq->GetNprobe()), k);
+    ChooseFilterPlan(plan);
+    return plan;
+  }
+  CHECK(vector_index->GetIndexerType() == indexes::IndexerType::kHNSW)
+      << "Unsupported indexer type: " << (int)vector_index->GetIndexerType();
+  auto hnsw = dynamic_cast<indexes::VectorHNSW<float> *>(vector_index);
+  CHECK(hnsw != nullptr);
+  auto graph_parameters = hnsw->GetGraphParameters();
+  size_t effective_ef = std::max<size_t>(
+      ef.has_value() ? *ef : graph_parameters.ef_runtime, k);
+  if (plan.index_size == 0) {
+    plan.filter_plan = FilterPlan::kPreFilter;
+    return plan;
   }
-  if (vector_index->GetIndexerType() == indexes::IndexerType::kHNSW) {
-    // TODO: Come up with a formulation accounting for various
-    // other factors like ef_construction, M, size of vectors, ef_runtime, k
-    // etc. Also benchmark various combinations to tune the hyperparameters.
-    // size_t N = vector_index->GetCapacity();
+  plan.prefilter_units =
+      EstimatePreFilterUnits(estimated_num_of_keys, hnsw->GetDimensions());
+  plan.inline_units = EstimateInlineFilterUnits(
+      estimated_num_of_keys, plan.index_size, hnsw->GetDimensions(),
+      graph_parameters.m, effective_ef);
+  ChooseFilterPlan(plan);
+  return plan;
+}
+
+void RecordPlanExecution(const QueryPlan &plan, absl::string_view index_name,
+                         absl::Duration elapsed, bool completed) {
+  CostModel::Instance().Record(plan, index_name, elapsed, completed);
+}
 
-    // Switching to using the actual number of vectors in the index
-    size_t N = vector_index->GetTrackedKeyCount();
+CostModelCoefficients GetCostModelCoefficients() {
+  return CostModel::Instance().GetCoefficients();
+}
+
+void ResetCostModel() { CostModel::Instance().Reset(); }
+
+/*
+FT._DEBUG QUERY_PLANNER [RESET]
 
-    // We choose pre-filtering if the size of the filtered space is below a
-    // certain threshold (relative to the total size).
-    return estimated_num_of_keys <=
-           options::GetPrefilteringThresholdRatio() * N;
+Output is a map with the calibrated cost model coefficients followed by the
+most recent filtered vector query plans (oldest first). Each plan reports the
+filtered space estimate, the index size, the estimated cost of both
+alternatives in nanoseconds, the chosen plan, its actual execution time and
+whether it was run to calibrate the plan the cost model didn't choose.
+RESET discards the calibration and the plan history.
+*/
+absl::Status QueryPlannerCmd(ValkeyModuleCtx *ctx, vmsdk::ArgsIterator &itr) {
+  if (itr.HasNext()) {
+    std::string keyword;
+    VMSDK_RETURN_IF_ERROR(vmsdk::ParseParamValue(itr, keyword));
+    if (absl::AsciiStrToUpper(keyword) != "RESET" || itr.HasNext()) {
+      return absl::InvalidArgumentError("Usage: QUERY_PLANNER [RESET]");
+    }
+    ResetCostModel();
+    ValkeyModule_ReplyWithSimpleString(ctx, "OK");
+    return absl::OkStatus();
+  }
+  auto &cost_model = CostModel::Instance();
+  auto coefficients = cost_model.GetCoefficients();
+  auto recent_plans = cost_model.GetRecentPlans();
+  ValkeyModule_ReplyWithArray(ctx, 12);
+  ValkeyModule_ReplyWithCString(ctx, "cost_model_enabled");
+  ValkeyModule_ReplyWithLongLong(
+      ctx, options::GetQueryPlannerCostModel().GetValue() ? 1 : 0);
+  ValkeyModule_ReplyWithCString(ctx, "prefilter_ns_per_unit");
+  ValkeyModule_ReplyWithDouble(ctx, coefficients.prefilter_ns_per_unit);
+  ValkeyModule_ReplyWithCString(ctx, "inline_ns_per_unit");
+  ValkeyModule_ReplyWithDouble(ctx, coefficients.inline_ns_per_unit);
+  ValkeyModule_ReplyWithCString(ctx, "prefilter_samples");
+  ValkeyModule_ReplyWithLongLong(ctx, coefficients.prefilter_samples);
+  ValkeyModule_ReplyWithCString(ctx, "inline_samples");
+  ValkeyModule_ReplyWithLongLong(ctx, coefficients.inline_samples);
+  ValkeyModule_ReplyWithCString(ctx, "recent_plans");
+  ValkeyModule_ReplyWithArray(ctx, recent_plans.size());
+  for (const auto &recent : recent_plans) {
+    ValkeyModule_ReplyWithArray(ctx, 20);
+    ValkeyModule_ReplyWithCString(ctx, "index");
+    ValkeyModule_ReplyWithStringBuffer(ctx, recent.index_name.data(),
+                                       recent.index_name.size());
+    ValkeyModule_ReplyWithCString(ctx, "plan");
+    ValkeyModule_ReplyWithCString(
+        ctx, FilterPlanToString(recent.plan.filter_plan).data());
+    ValkeyModule_ReplyWithCString(ctx, "estimated_keys");
+    ValkeyModule_ReplyWithLongLong(ctx, recent.plan.estimated_num_of_keys);
+    ValkeyModule_ReplyWithCString(ctx, "index_size");
+    ValkeyModule_ReplyWithLongLong(ctx, recent.plan.index_size);
+    ValkeyModule_ReplyWithCString(ctx, "prefilter_cost_ns");
+    ValkeyModule_ReplyWithDouble(ctx, recent.plan.prefilter_cost_ns);
+    ValkeyModule_ReplyWithCString(ctx, "inline_cost_ns");
+    ValkeyModule_ReplyWithDouble(ctx, recent.plan.inline_cost_ns);
+    ValkeyModule_ReplyWithCString(ctx, "estimated_cost_ns");
+    ValkeyModule_ReplyWithDouble(ctx, recent.plan.EstimatedCostNs());
+    ValkeyModule_ReplyWithCString(ctx, "actual_ns");
+    ValkeyModule_ReplyWithLongLong(ctx,
+                                   absl::ToInt64Nanoseconds(recent.elapsed));
+    ValkeyModule_ReplyWithCString(ctx, "completed");
+    ValkeyModule_ReplyWithLongLong(ctx, recent.completed ? 1 : 0);
+    ValkeyModule_ReplyWithCString(ctx, "explored");
+    ValkeyModule_ReplyWithLongLong(ctx, recent.plan.explored ? 1 : 0);
   }
-  CHECK(false) << "Unsupported indexer type: "
-               << (int)vector_index->GetIndexerType();
+  return absl::OkStatus();
 }
+
 }  // namespace valkey_search::query
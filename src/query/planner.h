@@ -8,14 +8,84 @@
 #ifndef VALKEYSEARCH_SRC_QUERY_PLANNER_H_
 #define VALKEYSEARCH_SRC_QUERY_PLANNER_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "src/indexes/vector_base.h"
+#include "vmsdk/src/command_parser.h"
+#include "vmsdk/src/valkey_module_api/valkey_module.h"
 
 namespace valkey_search::query {
 
-// Returns whether to use pre-filtering as opposed to inline filtering based on
-// heuristics.
-bool UsePreFiltering(size_t estimated_num_of_keys,
-                     indexes::VectorBase *vector_index);
+enum class FilterPlan { kPreFilter, kInlineFilter };
+
+absl::string_view FilterPlanToString(FilterPlan plan);
+
+//
+// The outcome of planning a filtered vector query. The cost of each
+// alternative is first estimated in abstract work units (roughly one unit per
+// vector dimension touched by a distance computation) and then converted to
+// nanoseconds using per-plan coefficients that are calibrated from observed
+// query latencies.
+//
+struct QueryPlan {
+  FilterPlan filter_plan{FilterPlan::kPreFilter};
+  size_t estimated_num_of_keys{0};
+  size_t index_size{0};
+  double prefilter_units{0.0};
+  double inline_units{0.0};
+  double prefilter_cost_ns{0.0};
+  double inline_cost_ns{0.0};
+  // Whether the plan isn't the cheapest estimate, but sampled to calibrate
+  // its cost, see ChooseFilterPlan.
+  bool explored{false};
+  double EstimatedCostNs() const {
+    return filter_plan == FilterPlan::kPreFilter ? prefilter_cost_ns
+                                                 : inline_cost_ns;
+  }
+  double EstimatedUnits() const {
+    return filter_plan == FilterPlan::kPreFilter ? prefilter_units
+                                                 : inline_units;
+  }
+};
+
+// Chooses between pre-filtering and inline filtering for a filtered vector
+// query over `vector_index`, where `estimated_num_of_keys` is the estimated
+// size of the filtered space. `ef` and `nprobe` are the query overrides of
+// the HNSW and IVF-PQ search parameters.
+QueryPlan PlanFilteredVectorSearch(
+    size_t estimated_num_of_keys, indexes::VectorBase *vector_index,
+    uint64_t k, std::optional<unsigned> ef,
+    std::optional<unsigned> nprobe = std::nullopt);
+
+// Reports the observed execution time of a plan. Completed executions are
+// used to calibrate the cost model; every execution is kept in the recent
+// plan history shown by FT._DEBUG QUERY_PLANNER.
+void RecordPlanExecution(const QueryPlan &plan, absl::string_view index_name,
+                         absl::Duration elapsed, bool completed);
+
+struct CostModelCoefficients {
+  double prefilter_ns_per_unit;
+  double inline_ns_per_unit;
+  uint64_t prefilter_samples;
+  uint64_t inline_samples;
+};
+
+CostModelCoefficients GetCostModelCoefficients();
+
+// Resets the calibration and the recent plan history. Mainly for testing.
+void ResetCostModel();
+
+//
+// FT._DEBUG QUERY_PLANNER [RESET]
+//
+absl::Status QueryPlannerCmd(ValkeyModuleCtx *ctx, vmsdk::ArgsIterator &itr);
+
 }  // namespace valkey_search::query
 
 #endif  // VALKEYSEARCH_SRC_QUERY_PLANNER_H_
@@ -77,7 +77,7 @@ bool TryAddWordKeyIteratorForPrefilter(
     auto postings = word_iter.GetPostingsTarget();
     if (postings) {
       auto key_iter = postings->GetKeyIterator();
-      if (key_iter.SkipForwardKey(target_key) &&
+      if (key_iter.SkipForwardKey(text_index.GetDocId()) &&
           key_iter.ContainsFields(field_mask)) {
         if (require_positions) {
           key_iterators.emplace_back(std::move(key_iter));
@@ -173,7 +173,7 @@ EvaluationResult PrefixPredicate::Evaluate(
     if (postings) {
       auto key_iter = postings->GetKeyIterator();
       // Skip to target key and verify it contains the required fields
-      if (key_iter.SkipForwardKey(target_key) &&
+      if (key_iter.SkipForwardKey(text_index.GetDocId()) &&
           key_iter.ContainsFields(field_mask)) {
         key_iterators.emplace_back(std::move(key_iter));
       }
@@ -230,7 +230,7 @@ EvaluationResult SuffixPredicate::Evaluate(
     if (postings) {
       auto key_iter = postings->GetKeyIterator();
       // Skip to target key and verify it contains the required fields
-      if (key_iter.SkipForwardKey(target_key) &&
+      if (key_iter.SkipForwardKey(text_index.GetDocId()) &&
           key_iter.ContainsFields(field_mask)) {
         key_iterators.emplace_back(std::move(key_iter));
       }
@@ -295,7 +295,7 @@ EvaluationResult FuzzyPredicate::Evaluate(
       filtered_key_iterators;
   for (auto &key_iter : key_iters) {
     BACKGROUND_PAUSEPOINT("search_fuzzy_search");
-    if (key_iter.SkipForwardKey(target_key) &&
+    if (key_iter.SkipForwardKey(text_index.GetDocId()) &&
         key_iter.ContainsFields(field_mask)) {
       filtered_key_iterators.emplace_back(std::move(key_iter));
     }
@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2025, valkey-search contributors
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD 3-Clause
+ *
+ */
+
+#include "src/query/predicate_program.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <optional>
+#include <vector>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/log/check.h"
+#include "absl/types/span.h"
+#include "src/indexes/numeric.h"
+#include "src/indexes/tag.h"
+#include "src/query/predicate.h"
+#include "src/utils/string_interning.h"
+
+namespace valkey_search::query {
+
+namespace {
+
+// Number of value slots kept inline by PredicateProgram::Matches.
+constexpr size_t kInlineSlots = 4;
+
+template <typename Selection>
+void Subtract(const Selection& selection, const Selection& subset,
+              Selection& out) {
+  out.clear();
+  std::set_difference(selection.begin(), selection.end(), subset.begin(),
+                      subset.end(), std::back_inserter(out));
+}
+
+}  // namespace
+
+std::optional<PredicateProgram> PredicateProgram::Compile(
+    const Predicate& predicate) {
+  PredicateProgram program;
+  if (!program.Append(predicate)) {
+    return std::nullopt;
+  }
+  return program;
+}
+
+bool PredicateProgram::Append(const Predicate& predicate) {
+  const uint32_t pc = instructions_.size();
+  instructions_.emplace_back();
+  switch (predicate.GetType()) {
+    case PredicateType::kNumeric: {
+      const auto& numeric = static_cast<const NumericPredicate&>(predicate);
+      auto& instruction = instructions_[pc];
+      instruction.op = OpCode::kNumeric;
+      instruction.slot = GetSlot(numeric.GetIndex(), nullptr);
+      instruction.start = numeric.GetStart();
+      instruction.stop = numeric.GetEnd();
+      instruction.inclusive_start = numeric.IsStartInclusive();
+      instruction.inclusive_stop = numeric.IsEndInclusive();
+      break;
+    }
+    case PredicateType::kTag: {
+      const auto& tag = static_cast<const TagPredicate&>(predicate);
+      auto& instruction = instructions_[pc];
+      instruction.op = OpCode::kTag;
+      instruction.slot = GetSlot(nullptr, tag.GetIndex());
+      instruction.tag = &tag;
+      break;
+    }
+    case PredicateType::kComposedAnd:
+    case PredicateType::kComposedOr: {
+      instructions_[pc].op = predicate.GetType() == PredicateType::kComposedAnd
+                                 ? OpCode::kAnd
+                                 : OpCode::kOr;
+      const auto& composed = static_cast<const ComposedPredicate&>(predicate);
+      for (const auto& child : composed.GetChildren()) {
+        if (!Append(*child)) {
+          return false;
+        }
+      }
+      break;
+    }
+    case PredicateType::kNegate: {
+      instructions_[pc].op = OpCode::kNot;
+      if (!Append(*static_cast<const NegatePredicate&>(predicate)
+                       .GetPredicate())) {
+        return false;
+      }
+      break;
+    }
+    default:
+      return false;
+  }
+  instructions_[pc].end = instructions_.size();
+  return true;
+}
+
+uint32_t PredicateProgram::GetSlot(const indexes::Numeric* numeric,
+                                   const indexes::Tag* tag) {
+  for (uint32_t slot = 0; slot < slots_.size(); ++slot) {
+    if (slots_[slot].numeric == numeric && slots_[slot].tag == tag) {
+      return slot;
+    }
+  }
+  slots_.push_back(Slot{numeric, tag});
+  return slots_.size() - 1;
+}
+
+PredicateProgram::Value PredicateProgram::Lookup(
+    uint32_t slot, const InternedStringPtr& key) const {
+  Value value;
+  if (slots_[slot].numeric) {
+    value.number = slots_[slot].numeric->GetValue(key);
+  } else {
+    value.tags = slots_[slot].tag->GetValue(key, value.case_sensitive);
+  }
+  value.resolved = true;
+  return value;
+}
+
+bool PredicateProgram::Test(const Instruction& instruction,
+                            const Value& value) {
+  if (instruction.op == OpCode::kTag) {
+    return instruction.tag->Evaluate(value.tags, value.case_sensitive).matches;
+  }
+  // Same range semantics as NumericPredicate::Evaluate.
+  if (!value.number) {
+    return false;
+  }
+  const double number = *value.number;
+  return ((number > instruction.start ||
+           (instruction.inclusive_start && number == instruction.start)) &&
+          number < instruction.stop) ||
+         (instruction.inclusive_stop && number == instruction.stop);
+}
+
+bool PredicateProgram::Matches(const InternedStringPtr& key) const {
+  absl::InlinedVector<Value, kInlineSlots> values(slots_.size());
+  return Run(0, key, absl::MakeSpan(values));
+}
+
+bool PredicateProgram::Run(uint32_t pc, const InternedStringPtr& key,
+                           absl::Span<Value> values) const {
+  const auto& instruction = instructions_[pc];
+  switch (instruction.op) {
+    case OpCode::kNumeric:
+    case OpCode::kTag: {
+      auto& value = values[instruction.slot];
+      if (!value.resolved) {
+        value = Lookup(instruction.slot, key);
+      }
+      return Test(instruction, value);
+    }
+    case OpCode::kAnd:
+      for (uint32_t child = pc + 1; child < instruction.end;
+           child = instructions_[child].end) {
+        if (!Run(child, key, values)) {
+          return false;
+        }
+      }
+      return true;
+    case OpCode::kOr:
+      for (uint32_t child = pc + 1; child < instruction.end;
+           child = instructions_[child].end) {
+        if (Run(child, key, values)) {
+          return true;
+        }
+      }
+      return false;
+    case OpCode::kNot:
+      return !Run(pc + 1, key, values);
+  }
+  return false;
+}
+
+void PredicateProgram::EvaluateBatch(absl::Span<const InternedStringPtr> keys,
+                                     absl::Span<bool> matches) const {
+  CHECK_EQ(keys.size(), matches.size());
+  std::vector<Value> values(slots_.size() * keys.size());
+  Batch batch{keys, absl::MakeSpan(values)};
+  Selection selection(keys.size());
+  std::iota(selection.begin(), selection.end(), 0);
+  Selection matched;
+  RunBatch(0, batch, selection, matched);
+  std::fill(matches.begin(), matches.end(), false);
+  for (auto position : matched) {
+    matches[position] = true;
+  }
+}
+
+void PredicateProgram::RunBatch(uint32_t pc, const Batch& batch,
+                                const Selection& selection,
+                                Selection& matched) const {
+  matched.clear();
+  const auto& instruction = instructions_[pc];
+  switch (instruction.op) {
+    case OpCode::kNumeric:
+    case OpCode::kTag: {
+      auto values =
+          batch.values.subspan(instruction.slot * batch.keys.size());
+      for (auto position : selection) {
+        auto& value = values[position];
+        if (!value.resolved) {
+          value = Lookup(instruction.slot, batch.keys[position]);
+        }
+        if (Test(instruction, value)) {
+          matched.push_back(position);
+        }
+      }
+      return;
+    }
+    case OpCode::kAnd: {
+      // Each clause only sees the keys that passed the previous ones.
+      matched = selection;
+      Selection passed;
+      for (uint32_t child = pc + 1; child < instruction.end && !matched.empty();
+           child = instructions_[child].end) {
+        RunBatch(child, batch, matched, passed);
+        matched.swap(passed);
+      }
+      return;
+    }
+    case OpCode::kOr: {
+      // Each clause only sees the keys that failed the previous ones.
+      Selection remaining = selection;
+      Selection passed;
+      Selection failed;
+      for (uint32_t child = pc + 1;
+           child < instruction.end && !remaining.empty();
+           child = instructions_[child].end) {
+        RunBatch(child, batch, remaining, passed);
+        Subtract(remaining, passed, failed);
+        remaining.swap(failed);
+      }
+      Subtract(selection, remaining, matched);
+      return;
+    }
+    case OpCode::kNot: {
+      Selection passed;
+      RunBatch(pc + 1, batch, selection, passed);
+      Subtract(selection, passed, matched);
+      return;
+    }
+  }
+}
+
+}  // namespace valkey_search::query
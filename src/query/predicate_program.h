@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2025, valkey-search contributors
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD 3-Clause
+ *
+ */
+
+#ifndef VALKEYSEARCH_SRC_QUERY_PREDICATE_PROGRAM_H_
+#define VALKEYSEARCH_SRC_QUERY_PREDICATE_PROGRAM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "src/query/predicate.h"
+#include "src/utils/string_interning.h"
+
+namespace valkey_search::indexes {
+class Numeric;
+class Tag;
+}  // namespace valkey_search::indexes
+
+namespace valkey_search::query {
+
+// Number of keys evaluated together by PredicateProgram::EvaluateBatch.
+constexpr size_t kPredicateProgramBatchSize = 64;
+
+// A tag/numeric filter compiled into a flat program.
+//
+// The predicate tree is laid out in pre-order, with every instruction
+// recording where its subtree ends, so evaluation is a switch over the
+// instructions instead of virtual calls into the tree. Numeric ranges are
+// inlined and the attribute indexes are resolved at compile time. Every
+// distinct index is read at most once per key, even when several clauses
+// filter on the same attribute.
+//
+// Like the per-key lookups of PrefilterEvaluator, evaluation relies on the
+// indexes not being mutated while the time sliced mutex is in read mode.
+class PredicateProgram {
+ public:
+  // Returns std::nullopt when the predicate contains text clauses, which need
+  // the per-key text index and keep being evaluated by PrefilterEvaluator.
+  static std::optional<PredicateProgram> Compile(const Predicate& predicate);
+
+  bool Matches(const InternedStringPtr& key) const;
+  // Sets `matches[i]` to whether `keys[i]` matches. Clauses are evaluated for
+  // all the keys of the batch that are still undecided, so AND and OR
+  // short-circuit per clause rather than per key.
+  void EvaluateBatch(absl::Span<const InternedStringPtr> keys,
+                     absl::Span<bool> matches) const;
+
+ private:
+  enum class OpCode : uint8_t { kNumeric, kTag, kAnd, kOr, kNot };
+  struct Instruction {
+    OpCode op;
+    // Index of the first instruction following the subtree of this one.
+    uint32_t end{0};
+    // Value slot read by kNumeric and kTag.
+    uint32_t slot{0};
+    double start{0};
+    double stop{0};
+    bool inclusive_start{false};
+    bool inclusive_stop{false};
+    const TagPredicate* tag{nullptr};
+  };
+  struct Slot {
+    const indexes::Numeric* numeric{nullptr};
+    const indexes::Tag* tag{nullptr};
+  };
+  struct Value {
+    const double* number{nullptr};
+    const absl::flat_hash_set<absl::string_view>* tags{nullptr};
+    bool case_sensitive{true};
+    bool resolved{false};
+  };
+  // Positions within a batch, in increasing order.
+  using Selection = absl::InlinedVector<uint32_t, kPredicateProgramBatchSize>;
+  struct Batch {
+    absl::Span<const InternedStringPtr> keys;
+    // slots_.size() x keys.size() values, looked up on first use.
+    absl::Span<Value> values;
+  };
+
+  PredicateProgram() = default;
+  bool Append(const Predicate& predicate);
+  uint32_t GetSlot(const indexes::Numeric* numeric, const indexes::Tag* tag);
+  Value Lookup(uint32_t slot, const InternedStringPtr& key) const;
+  static bool Test(const Instruction& instruction, const Value& value);
+  bool Run(uint32_t pc, const InternedStringPtr& key,
+           absl::Span<Value> values) const;
+  void RunBatch(uint32_t pc, const Batch& batch, const Selection& selection,
+                Selection& matched) const;
+
+  std::vector<Instruction> instructions_;
+  std::vector<Slot> slots_;
+};
+
+}  // namespace valkey_search::query
+
+#endif  // VALKEYSEARCH_SRC_QUERY_PREDICATE_PROGRAM_H_
@@ -20,6 +20,7 @@
 #include "absl/strings/string_view.h"
 #include "src/attribute_data_type.h"
 #include "src/commands/ft_search_parser.h"
+#include "src/expr/value.h"
 #include "src/indexes/tag.h"
 #include "src/indexes/text.h"
 #include "src/indexes/text/text_index.h"
@@ -441,4 +442,77 @@ void ProcessNeighborsForReply(
       neighbors.end());
 }
 
+SortByComparator::SortByComparator(const SortByParameter &sortby,
+                                   const SearchParameters &parameters)
+    : sortby_(sortby) {
+  // Check if field is a declared numeric attribute
+  auto index = parameters.index_schema->GetIndex(sortby.field);
+  numeric_ = index.ok() &&
+             index.value()->GetIndexerType() == indexes::IndexerType::kNumeric;
+}
+
+bool SortByComparator::operator()(const indexes::Neighbor &a,
+                                  const indexes::Neighbor &b) const {
+  if (!a.attribute_contents.has_value() || !b.attribute_contents.has_value()) {
+    return false;
+  }
+
+  auto it_a = a.attribute_contents->find(sortby_.field);
+  auto it_b = b.attribute_contents->find(sortby_.field);
+
+  if (it_a == a.attribute_contents->end()) {
+    return false;
+  }
+  if (it_b == b.attribute_contents->end()) {
+    return true;
+  }
+
+  auto str_a = vmsdk::ToStringView(it_a->second.value.get());
+  auto str_b = vmsdk::ToStringView(it_b->second.value.get());
+
+  expr::Value val_a, val_b;
+  if (numeric_) {
+    val_a = expr::Value(vmsdk::To<double>(str_a).value_or(0.0));
+    val_b = expr::Value(vmsdk::To<double>(str_b).value_or(0.0));
+  } else {
+    val_a = expr::Value(str_a);
+    val_b = expr::Value(str_b);
+  }
+
+  auto cmp = expr::Compare(val_a, val_b);
+  if (cmp == expr::Ordering::kLESS) {
+    return sortby_.order == SortOrder::kAscending;
+  }
+  if (cmp == expr::Ordering::kGREATER) {
+    return sortby_.order == SortOrder::kDescending;
+  }
+  return false;
+}
+
+void SortNeighbors(std::vector<indexes::Neighbor> &neighbors,
+                   const SortByParameter &sortby,
+                   const SearchParameters &parameters, size_t count) {
+  SortByComparator compare(sortby, parameters);
+  if (count >= neighbors.size()) {
+    std::stable_sort(neighbors.begin(), neighbors.end(), compare);
+  } else {
+    std::partial_sort(neighbors.begin(), neighbors.begin() + count,
+                      neighbors.end(), compare);
+  }
+}
+
+bool SortsShardResults(const SearchParameters &parameters) {
+  return parameters.IsNonVectorQuery() &&
+         parameters.sortby_parameter.has_value();
+}
+
+void KeepSortedTop(std::vector<indexes::Neighbor> &neighbors,
+                   const SearchParameters &parameters) {
+  const size_t count = parameters.limit.first_index + parameters.limit.number;
+  SortNeighbors(neighbors, *parameters.sortby_parameter, parameters, count);
+  if (neighbors.size() > count) {
+    neighbors.erase(neighbors.begin() + count, neighbors.end());
+  }
+}
+
 }  // namespace valkey_search::query
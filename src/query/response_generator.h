@@ -8,6 +8,7 @@
 #ifndef VALKEYSEARCH_SRC_QUERY_RESPONSE_GENERATOR_H_
 #define VALKEYSEARCH_SRC_QUERY_RESPONSE_GENERATOR_H_
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -47,6 +48,37 @@ void ProcessNeighborsForReply(
     const std::optional<query::SortByParameter> &sortby_parameter =
         std::nullopt);
 
+// Orders neighbors by the SORTBY field of their attribute contents, which
+// ProcessNeighborsForReply fetches under the SORTBY name. Neighbors without
+// the field sort last. Numeric attributes compare as numbers, anything else
+// as strings.
+class SortByComparator {
+ public:
+  SortByComparator(const SortByParameter &sortby,
+                   const SearchParameters &parameters);
+  bool operator()(const indexes::Neighbor &a,
+                  const indexes::Neighbor &b) const;
+
+ private:
+  const SortByParameter &sortby_;
+  bool numeric_;
+};
+
+// Sorts the neighbors by `sortby`. Only the first `count` neighbors are
+// guaranteed to be in order, the others are left in unspecified order.
+void SortNeighbors(std::vector<indexes::Neighbor> &neighbors,
+                   const SortByParameter &sortby,
+                   const SearchParameters &parameters, size_t count);
+
+// Whether every shard of a fanout only needs to reply with its own top
+// neighbors by the SORTBY field. Vector queries are excluded, their global
+// candidates are the nearest neighbors across all shards.
+bool SortsShardResults(const SearchParameters &parameters);
+
+// Keeps the first offset + limit neighbors by the SORTBY field, in order.
+void KeepSortedTop(std::vector<indexes::Neighbor> &neighbors,
+                   const SearchParameters &parameters);
+
 }  // namespace valkey_search::query
 
 #endif  // VALKEYSEARCH_SRC_QUERY_RESPONSE_GENERATOR_H_
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2025, valkey-search contributors
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD 3-Clause
+ *
+ */
+
+#include "src/query/scorer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/numeric/bits.h"
+#include "absl/strings/string_view.h"
+#include "src/index_schema.h"
+#include "src/indexes/text/posting.h"
+#include "src/indexes/text/text_index.h"
+#include "src/query/predicate.h"
+#include "src/query/search.h"
+#include "src/utils/string_interning.h"
+
+namespace valkey_search::query {
+
+namespace {
+
+// Okapi BM25 parameters, with their usual values.
+constexpr double kBM25K1 = 1.2;
+constexpr double kBM25B = 0.75;
+
+// Number of keys of the schema holding `word` in any text field.
+size_t CountKeys(const indexes::text::TextIndex &text_index,
+                 absl::string_view word) {
+  auto word_iter = text_index.GetPrefix().GetWordIterator(word);
+  if (word_iter.Done() || word_iter.GetWord() != word) {
+    return 0;
+  }
+  auto postings = word_iter.GetPostingsTarget();
+  return postings ? postings->GetKeyCount() : 0;
+}
+
+// Number of occurrences of `word` in the fields of `field_mask` of `key`.
+uint32_t CountOccurrences(const indexes::text::TextIndex &key_index,
+                          absl::string_view word,
+                          FieldMaskPredicate field_mask) {
+  auto word_iter = key_index.GetPrefix().GetWordIterator(word);
+  if (word_iter.Done() || word_iter.GetWord() != word) {
+    return 0;
+  }
+  // The per-key index shares the postings of the schema wide index.
+  auto postings = word_iter.GetPostingsTarget();
+  if (!postings) {
+    return 0;
+  }
+  auto key_iter = postings->GetKeyIterator();
+  if (!key_iter.SkipForwardKey(key_index.GetDocId())) {
+    return 0;
+  }
+  uint32_t count = 0;
+  for (auto position_iter = key_iter.GetPositionIterator();
+       position_iter.IsValid(); position_iter.NextPosition()) {
+    count += absl::popcount(position_iter.GetFieldMask() & field_mask);
+  }
+  return count;
+}
+
+}  // namespace
+
+std::unique_ptr<Scorer> Scorer::Create(const SearchParameters &parameters) {
+  if (!parameters.scorer.has_value() ||
+      !parameters.filter_parse_results.root_predicate ||
+      !(parameters.filter_parse_results.query_operations &
+        QueryOperations::kContainsText)) {
+    return nullptr;
+  }
+  auto text_index_schema = parameters.index_schema->GetTextIndexSchema();
+  if (!text_index_schema) {
+    return nullptr;
+  }
+  std::unique_ptr<Scorer> scorer(
+      new Scorer(*parameters.scorer, std::move(text_index_schema)));
+  scorer->AddTerms(*parameters.filter_parse_results.root_predicate);
+  if (scorer->terms_.empty()) {
+    return nullptr;
+  }
+  return scorer;
+}
+
+Scorer::Scorer(
+    ScorerType type,
+    std::shared_ptr<indexes::text::TextIndexSchema> text_index_schema)
+    : type_(type), text_index_schema_(std::move(text_index_schema)) {
+  key_count_ = static_cast<double>(text_index_schema_->GetTrackedKeyCount());
+  average_doc_length_ =
+      key_count_ > 0
+          ? text_index_schema_->GetTotalTermFrequency() / key_count_
+          : 0;
+}
+
+void Scorer::AddTerms(const Predicate &predicate) {
+  switch (predicate.GetType()) {
+    case PredicateType::kText:
+      if (auto term = dynamic_cast<const TermPredicate *>(&predicate)) {
+        AddTerm(*term);
+      }
+      return;
+    case PredicateType::kComposedAnd:
+    case PredicateType::kComposedOr:
+      for (const auto &child :
+           static_cast<const ComposedPredicate &>(predicate).GetChildren()) {
+        AddTerms(*child);
+      }
+      return;
+    default:
+      // Negated clauses never occur in the matching keys.
+      return;
+  }
+}
+
+void Scorer::AddTerm(const TermPredicate &predicate) {
+  Term term{.field_mask = predicate.GetFieldMask()};
+  term.words.emplace_back(predicate.GetTextString());
+  const uint64_t stem_field_mask =
+      predicate.GetFieldMask() & text_index_schema_->GetStemTextFieldMask();
+  if (!predicate.IsExact() && stem_field_mask != 0) {
+    absl::InlinedVector<absl::string_view,
+                        indexes::text::kStemVariantsInlineCapacity>
+        variants;
+    std::string stemmed = text_index_schema_->GetAllStemVariants(
+        predicate.GetTextString(), variants, stem_field_mask, true);
+    variants.push_back(stemmed);
+    for (auto variant : variants) {
+      if (std::find(term.words.begin(), term.words.end(), variant) ==
+          term.words.end()) {
+        term.words.emplace_back(variant);
+      }
+    }
+  }
+  const auto &text_index = *text_index_schema_->GetTextIndex();
+  size_t key_count = 0;
+  for (const auto &word : term.words) {
+    key_count += CountKeys(text_index, word);
+  }
+  const double document_frequency =
+      std::min(static_cast<double>(key_count), key_count_);
+  if (document_frequency == 0) {
+    return;
+  }
+  switch (type_) {
+    case ScorerType::kBM25:
+      term.idf = std::log(1 + (key_count_ - document_frequency + 0.5) /
+                                  (document_frequency + 0.5));
+      break;
+    case ScorerType::kTFIDF:
+      term.idf = std::log(1 + key_count_ / document_frequency);
+      break;
+  }
+  terms_.push_back(std::move(term));
+}
+
+float Scorer::Score(const InternedStringPtr &key) const {
+  const indexes::text::TextIndex *key_index =
+      text_index_schema_->GetPerKeyTextIndex(key, false);
+  if (key_index == nullptr) {
+    return 0;
+  }
+  const double length_norm =
+      average_doc_length_ > 0
+          ? key_index->GetDocLength() / average_doc_length_
+          : 1;
+  double score = 0;
+  for (const auto &term : terms_) {
+    uint32_t frequency = 0;
+    for (const auto &word : term.words) {
+      frequency += CountOccurrences(*key_index, word, term.field_mask);
+    }
+    if (frequency == 0) {
+      continue;
+    }
+    switch (type_) {
+      case ScorerType::kBM25:
+        score += term.idf * frequency * (kBM25K1 + 1) /
+                 (frequency + kBM25K1 * (1 - kBM25B + kBM25B * length_norm));
+        break;
+      case ScorerType::kTFIDF:
+        score += term.idf * frequency;
+        break;
+    }
+  }
+  return static_cast<float>(score);
+}
+
+}  // namespace valkey_search::query
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2025, valkey-search contributors
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD 3-Clause
+ *
+ */
+
+#ifndef VALKEYSEARCH_SRC_QUERY_SCORER_H_
+#define VALKEYSEARCH_SRC_QUERY_SCORER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/inlined_vector.h"
+#include "src/indexes/text/posting.h"
+#include "src/indexes/text/text_index.h"
+#include "src/query/predicate.h"
+#include "src/query/search.h"
+#include "src/utils/string_interning.h"
+
+namespace valkey_search::query {
+
+// Scores the relevance of the keys matching a full-text query.
+//
+// Every non-negated term of the query contributes according to its frequency
+// in the queried fields of the key and to its inverse document frequency in
+// the index schema. BM25 also normalizes the term frequencies by the length
+// of the key relative to the average length. Terms match their stem variants
+// the same way they do when filtering. Prefix, suffix, infix and fuzzy
+// clauses expand to too many words to be weighted and don't contribute.
+//
+// Scores are only meaningful relative to each other within a shard, the
+// document frequencies are those of the local index.
+//
+// Like the per-key text evaluation, scoring relies on the text index not
+// being mutated while the time sliced mutex is in read mode.
+class Scorer {
+ public:
+  // Returns nullptr unless the query asks for a scorer and has text clauses.
+  static std::unique_ptr<Scorer> Create(const SearchParameters &parameters);
+
+  float Score(const InternedStringPtr &key) const;
+
+  // Neighbors hold the negated score as their distance, so that like vector
+  // distances, smaller is better.
+  static float ToDistance(float score) { return -score; }
+  static float FromDistance(float distance) { return -distance; }
+
+ private:
+  struct Term {
+    // The term and its stem variants.
+    absl::InlinedVector<std::string, 2> words;
+    FieldMaskPredicate field_mask;
+    double idf{0};
+  };
+
+  Scorer(ScorerType type,
+         std::shared_ptr<indexes::text::TextIndexSchema> text_index_schema);
+  void AddTerms(const Predicate &predicate);
+  void AddTerm(const TermPredicate &predicate);
+
+  ScorerType type_;
+  std::shared_ptr<indexes::text::TextIndexSchema> text_index_schema_;
+  double key_count_;
+  double average_doc_length_;
+  std::vector<Term> terms_;
+};
+
+}  // namespace valkey_search::query
+
+#endif  // VALKEYSEARCH_SRC_QUERY_SCORER_H_
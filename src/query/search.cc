@@ -9,8 +9,10 @@
 
 #include <absl/strings/str_split.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <deque>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <queue>
@@ -25,7 +27,11 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "src/attribute_data_type.h"
+#include "src/indexes/doc_id_set_fetcher.h"
 #include "src/indexes/index_base.h"
 #include "src/indexes/numeric.h"
 #include "src/indexes/tag.h"
@@ -35,12 +41,18 @@
 #include "src/indexes/text/text_fetcher.h"
 #include "src/indexes/universal_set_fetcher.h"
 #include "src/indexes/vector_base.h"
+#include "src/indexes/vector_data_type.h"
 #include "src/indexes/vector_flat.h"
+#include "src/indexes/vector_ivf_pq.h"
 #include "src/indexes/vector_hnsw.h"
 #include "src/metrics.h"
 #include "src/query/content_resolution.h"
 #include "src/query/planner.h"
 #include "src/query/predicate.h"
+#include "src/query/predicate_program.h"
+#include "src/query/scorer.h"
+#include "src/utils/doc_id_bitmap.h"
+#include "src/utils/doc_id_map.h"
 #include "src/valkey_search.h"
 #include "src/valkey_search_options.h"
 #include "third_party/hnswlib/hnswlib.h"
@@ -66,6 +78,9 @@ DEV_INTEGER_COUNTER(query_stats, query_text_proximity_count);
 DEV_INTEGER_COUNTER(query_stats, query_numeric_count);
 DEV_INTEGER_COUNTER(query_stats, query_tag_count);
 DEV_INTEGER_COUNTER(query_stats, nonvector_results_fetched_limited_count);
+DEV_INTEGER_COUNTER(query_stats, query_set_operation_resolved_count);
+DEV_INTEGER_COUNTER(query_stats, query_sorted_by_index_count);
+DEV_INTEGER_COUNTER(query_stats, query_snapshot_search_count);
 
 class InlineVectorFilter : public hnswlib::BaseFilterFunctor {
  public:
@@ -74,6 +89,7 @@ class InlineVectorFilter : public hnswlib::BaseFilterFunctor {
       const std::shared_ptr<indexes::text::TextIndexSchema> text_index_schema,
       QueryOperations query_operations)
       : filter_predicate_(filter_predicate),
+        program_(PredicateProgram::Compile(*filter_predicate)),
         vector_index_(vector_index),
         text_index_schema_(text_index_schema),
         query_operations_(query_operations) {}
@@ -85,6 +101,9 @@ class InlineVectorFilter : public hnswlib::BaseFilterFunctor {
     if (!key.ok()) {
       return false;
     }
+    if (program_.has_value()) {
+      return program_->Matches(*key);
+    }
     const valkey_search::indexes::text::TextIndex *text_index = nullptr;
     if (text_index_schema_) {
       text_index = text_index_schema_->GetPerKeyTextIndex(*key, false);
@@ -95,6 +114,8 @@ class InlineVectorFilter : public hnswlib::BaseFilterFunctor {
 
  private:
   query::Predicate *filter_predicate_;
+  // Set unless the filter has text clauses.
+  std::optional<PredicateProgram> program_;
   indexes::VectorBase *vector_index_;
   const std::shared_ptr<indexes::text::TextIndexSchema> text_index_schema_;
   QueryOperations query_operations_;
@@ -132,6 +153,17 @@ absl::StatusOr<std::vector<indexes::Neighbor>> PerformVectorSearch(
         std::move(latency_sample));
     return res;
   }
+  if (vector_index->GetIndexerType() == indexes::IndexerType::kIVFPQ) {
+    auto vector_ivf_pq =
+        dynamic_cast<indexes::VectorIVFPQ<float> *>(vector_index);
+    auto latency_sample = SAMPLE_EVERY_N(100);
+    auto res = vector_ivf_pq->Search(
+        parameters.query, parameters.k, parameters.cancellation_token,
+        std::move(inline_filter), parameters.nprobe);
+    Metrics::GetStats().ivf_pq_vector_index_search_latency.SubmitSample(
+        std::move(latency_sample));
+    return res;
+  }
   CHECK(false) << "Unsupported indexer type: "
                << (int)vector_index->GetIndexerType();
 }
@@ -356,6 +388,144 @@ size_t EvaluateFilterAsPrimary(
   CHECK(false);
 }
 
+// Bounds, relative to the estimated number of qualified entries, the size of
+// a single clause that is materialized for set operations. Larger clauses are
+// cheaper to check per key than to fetch.
+constexpr size_t kSetOperationClauseSizeRatio = 8;
+
+struct ResolvedDocIds {
+  DocIdBitmap doc_ids;
+  // False if some clauses were skipped and `doc_ids` is a superset of the keys
+  // matching the predicate.
+  bool exact;
+};
+
+// Resolves AND/OR compositions of (non-negated) tag and numeric predicates
+// with bitmap operations over the index postings. All the resolved clauses
+// must share `doc_id_map`, which is set by the first one. Returns nullopt if
+// the predicate cannot be resolved or resolving it would not narrow down the
+// keys any further.
+std::optional<ResolvedDocIds> ResolveAsDocIds(const Predicate *predicate,
+                                              bool negate,
+                                              size_t max_clause_size,
+                                              const DocIdMap *&doc_id_map) {
+  auto resolve_fetcher =
+      [&](const auto &fetcher) -> std::optional<ResolvedDocIds> {
+    if (fetcher->Size() > max_clause_size ||
+        (doc_id_map && doc_id_map != &fetcher->GetDocIdMap())) {
+      return std::nullopt;
+    }
+    doc_id_map = &fetcher->GetDocIdMap();
+    return ResolvedDocIds{fetcher->GetDocIds(), true};
+  };
+  // Negated tag fetchers are supersets of the matching keys, keep them out of
+  // the set operations altogether and let per-key evaluation handle them.
+  if (predicate->GetType() == PredicateType::kTag && !negate) {
+    auto tag_predicate = dynamic_cast<const TagPredicate *>(predicate);
+    return resolve_fetcher(
+        tag_predicate->GetIndex()->Search(*tag_predicate, negate));
+  }
+  if (predicate->GetType() == PredicateType::kNumeric && !negate) {
+    auto numeric_predicate = dynamic_cast<const NumericPredicate *>(predicate);
+    return resolve_fetcher(
+        numeric_predicate->GetIndex()->Search(*numeric_predicate, negate));
+  }
+  if (predicate->GetType() == PredicateType::kNegate) {
+    auto negate_predicate = dynamic_cast<const NegatePredicate *>(predicate);
+    return ResolveAsDocIds(negate_predicate->GetPredicate(), !negate,
+                           max_clause_size, doc_id_map);
+  }
+  if (predicate->GetType() != PredicateType::kComposedAnd &&
+      predicate->GetType() != PredicateType::kComposedOr) {
+    return std::nullopt;
+  }
+  auto composed_predicate = dynamic_cast<const ComposedPredicate *>(predicate);
+  auto predicate_type = EvaluateAsComposedPredicate(composed_predicate, negate);
+  std::vector<DocIdBitmap> child_doc_ids;
+  bool exact = true;
+  for (const auto &child : composed_predicate->GetChildren()) {
+    auto resolved =
+        ResolveAsDocIds(child.get(), negate, max_clause_size, doc_id_map);
+    if (!resolved.has_value()) {
+      // A union is only useful if every branch is covered.
+      if (predicate_type == PredicateType::kComposedOr) {
+        return std::nullopt;
+      }
+      exact = false;
+      continue;
+    }
+    exact = exact && resolved->exact;
+    child_doc_ids.push_back(std::move(resolved->doc_ids));
+  }
+  if (predicate_type == PredicateType::kComposedOr) {
+    DocIdBitmap doc_ids;
+    for (const auto &child : child_doc_ids) {
+      doc_ids |= child;
+    }
+    return ResolvedDocIds{std::move(doc_ids), exact};
+  }
+  // A single resolved clause of an inexact intersection is no better than
+  // the fetcher EvaluateFilterAsPrimary already picked.
+  if (child_doc_ids.empty() || (child_doc_ids.size() == 1 && !exact)) {
+    return std::nullopt;
+  }
+  // Intersect starting from the smallest clause, so the intermediate result
+  // shrinks as fast as possible.
+  std::sort(child_doc_ids.begin(), child_doc_ids.end(),
+            [](const DocIdBitmap &a, const DocIdBitmap &b) {
+              return a.size() < b.size();
+            });
+  DocIdBitmap doc_ids = std::move(child_doc_ids.front());
+  for (size_t i = 1; i < child_doc_ids.size() && !doc_ids.empty(); ++i) {
+    doc_ids &= child_doc_ids[i];
+  }
+  return ResolvedDocIds{std::move(doc_ids), exact};
+}
+
+// Outcome of ResolveFilterWithSetOperations.
+enum class FilterResolution {
+  // The entries fetchers are left untouched.
+  kUnresolved,
+  // The entries fetchers yield a duplicate-free superset of the matching keys
+  // which still requires per-key predicate evaluation.
+  kSuperset,
+  // The entries fetchers yield exactly the matching keys.
+  kExact,
+};
+
+// Replaces the entries fetchers produced by EvaluateFilterAsPrimary with the
+// result of intersecting/merging the tag and numeric postings of the filter,
+// so composed filters run at bitmap-operation speed instead of evaluating the
+// whole predicate for every key of the smallest clause.
+FilterResolution ResolveFilterWithSetOperations(
+    const SearchParameters &parameters,
+    std::queue<std::unique_ptr<indexes::EntriesFetcherBase>> &entries_fetchers,
+    size_t &qualified_entries) {
+  const QueryOperations query_operations =
+      parameters.filter_parse_results.query_operations;
+  if (qualified_entries == 0 ||
+      (query_operations & QueryOperations::kContainsText) ||
+      !(query_operations &
+        (QueryOperations::kContainsAnd | QueryOperations::kContainsOr))) {
+    return FilterResolution::kUnresolved;
+  }
+  const DocIdMap *doc_id_map = nullptr;
+  auto resolved = ResolveAsDocIds(
+      parameters.filter_parse_results.root_predicate.get(), false,
+      kSetOperationClauseSizeRatio * qualified_entries, doc_id_map);
+  if (!resolved.has_value()) {
+    return FilterResolution::kUnresolved;
+  }
+  qualified_entries = resolved->doc_ids.size();
+  std::queue<std::unique_ptr<indexes::EntriesFetcherBase>> resolved_fetchers;
+  resolved_fetchers.push(std::make_unique<indexes::DocIdSetFetcher>(
+      *doc_id_map, std::move(resolved->doc_ids)));
+  entries_fetchers.swap(resolved_fetchers);
+  query_set_operation_resolved_count.Increment();
+  return resolved->exact ? FilterResolution::kExact
+                         : FilterResolution::kSuperset;
+}
+
 struct PrefilteredKey {
   std::string key;
   float distance;
@@ -367,11 +537,12 @@ void EvaluatePrefilteredKeys(
     absl::AnyInvocable<bool(const InternedStringPtr &,
                             absl::flat_hash_set<const char *> &)>
         appender,
-    size_t max_keys, bool stop_on_fetch_limit) {
+    size_t max_keys, bool stop_on_fetch_limit, bool evaluate_predicate) {
   // If there was a union operation, we need to handle deduplication.
   // This implementation skips deduplication (flat_hash_set usage) if not needed
-  // for performance.
+  // for performance. Keys resolved with set operations are already unique.
   bool needs_dedup =
+      evaluate_predicate &&
       NeedsDeduplication(parameters.filter_parse_results.query_operations);
   absl::flat_hash_set<const char *> result_keys;
   if (needs_dedup) {
@@ -380,26 +551,58 @@ void EvaluatePrefilteredKeys(
   const std::shared_ptr<indexes::text::TextIndexSchema> text_index_schema =
       parameters.index_schema ? parameters.index_schema->GetTextIndexSchema()
                               : nullptr;
+  std::optional<PredicateProgram> program;
+  if (evaluate_predicate) {
+    program = PredicateProgram::Compile(
+        *parameters.filter_parse_results.root_predicate);
+  }
+  std::vector<InternedStringPtr> batch;
+  batch.reserve(kPredicateProgramBatchSize);
+  bool matches[kPredicateProgramBatchSize];
   while (!entries_fetchers.empty()) {
     auto fetcher = std::move(entries_fetchers.front());
     entries_fetchers.pop();
     auto iterator = fetcher->Begin();
     while (!iterator->Done()) {
-      const auto &key = **iterator;
-      // 1. Skip if already processed (only if dedup is needed)
-      if (needs_dedup && result_keys.contains(key->Str().data())) {
-        iterator->Next();
-        continue;
+      // 1. Gather a batch of keys, skipping the ones already processed (only
+      // if dedup is needed)
+      batch.clear();
+      for (; !iterator->Done() && batch.size() < kPredicateProgramBatchSize;
+           iterator->Next()) {
+        const auto &key = **iterator;
+        if (needs_dedup && result_keys.contains(key->Str().data())) {
+          continue;
+        }
+        batch.push_back(key);
       }
-      const valkey_search::indexes::text::TextIndex *text_index =
-          text_index_schema ? text_index_schema->GetPerKeyTextIndex(key, false)
-                            : nullptr;
-      indexes::PrefilterEvaluator key_evaluator(
-          text_index, parameters.filter_parse_results.query_operations);
-      BACKGROUND_PAUSEPOINT("search_prefilter_eval");
-      // 3. Evaluate predicate
-      if (key_evaluator.Evaluate(
-              *parameters.filter_parse_results.root_predicate, key)) {
+      // 2. Evaluate predicate
+      auto batch_matches = absl::MakeSpan(matches, batch.size());
+      if (!evaluate_predicate) {
+        std::fill(batch_matches.begin(), batch_matches.end(), true);
+      } else if (program.has_value()) {
+        BACKGROUND_PAUSEPOINT("search_prefilter_eval");
+        program->EvaluateBatch(batch, batch_matches);
+      } else {
+        for (size_t i = 0; i < batch.size(); ++i) {
+          const valkey_search::indexes::text::TextIndex *text_index =
+              text_index_schema
+                  ? text_index_schema->GetPerKeyTextIndex(batch[i], false)
+                  : nullptr;
+          indexes::PrefilterEvaluator key_evaluator(
+              text_index, parameters.filter_parse_results.query_operations);
+          BACKGROUND_PAUSEPOINT("search_prefilter_eval");
+          batch_matches[i] = key_evaluator.Evaluate(
+              *parameters.filter_parse_results.root_predicate, batch[i]);
+        }
+      }
+      // 3. Append the matching keys. A key can repeat within a batch when
+      // dedup is needed.
+      for (size_t i = 0; i < batch.size(); ++i) {
+        const auto &key = batch[i];
+        if (!batch_matches[i] ||
+            (needs_dedup && result_keys.contains(key->Str().data()))) {
+          continue;
+        }
         bool result = appender(key, result_keys);
         if (needs_dedup && result) {
           result_keys.insert(key->Str().data());
@@ -409,7 +612,6 @@ void EvaluatePrefilteredKeys(
           return;
         }
       }
-      iterator->Next();
       if (parameters.cancellation_token->IsCancelled()) {
         return;
       }
@@ -421,27 +623,42 @@ std::priority_queue<std::pair<float, hnswlib::labeltype>>
 CalcBestMatchingPrefilteredKeys(
     const SearchParameters &parameters,
     std::queue<std::unique_ptr<indexes::EntriesFetcherBase>> &entries_fetchers,
-    indexes::VectorBase *vector_index, size_t qualified_entries) {
+    indexes::VectorBase *vector_index, size_t qualified_entries,
+    bool evaluate_predicate) {
   std::priority_queue<std::pair<float, hnswlib::labeltype>> results;
+  // Quantized indexes compare the encoded query with the stored codes.
+  std::string code;
+  auto query = vector_index->EncodeQuery(parameters.query, code);
+  auto count = vector_index->GetSearchCount(parameters.k);
   auto results_appender =
-      [&results, &parameters, vector_index](
+      [&results, query, count, vector_index](
           const InternedStringPtr &key,
           absl::flat_hash_set<const char *> &top_keys) -> bool {
-    return vector_index->AddPrefilteredKey(parameters.query, parameters.k, key,
-                                           results, top_keys);
+    return vector_index->AddPrefilteredKey(query, count, key, results,
+                                           top_keys);
   };
   EvaluatePrefilteredKeys(parameters, entries_fetchers,
                           std::move(results_appender), qualified_entries,
-                          /*stop_on_fetch_limit=*/false);
+                          /*stop_on_fetch_limit=*/false, evaluate_predicate);
+  vector_index->Rerank(parameters.query, parameters.k, results);
   return results;
 }
 
-std::string StringFormatVector(std::vector<char> vector) {
+std::string StringFormatVector(std::vector<char> vector,
+                               data_model::VectorDataType vector_data_type) {
+  std::vector<std::string> float_strings;
+  if (indexes::IsHalfPrecision(vector_data_type)) {
+    for (float value : indexes::HalfPrecisionToFloat(
+             absl::string_view(vector.data(), vector.size()),
+             vector_data_type)) {
+      float_strings.push_back(absl::StrCat(value));
+    }
+    return absl::StrCat("[", absl::StrJoin(float_strings, ","), "]");
+  }
   if (vector.size() % sizeof(float) != 0) {
     return {vector.data(), vector.size()};
   }
 
-  std::vector<std::string> float_strings;
   for (size_t i = 0; i < vector.size(); i += sizeof(float)) {
     float value;
     std::memcpy(&value, vector.data() + i, sizeof(float));
@@ -507,15 +724,21 @@ absl::StatusOr<std::vector<indexes::Neighbor>> MaybeAddIndexedContent(
         }
         case indexes::IndexerType::kVector:
         case indexes::IndexerType::kHNSW:
-        case indexes::IndexerType::kFlat: {
+        case indexes::IndexerType::kFlat:
+        case indexes::IndexerType::kIVFPQ: {
           auto vector_index =
               dynamic_cast<indexes::VectorBase *>(attribute_info.index);
+          if (!vector_index->HasFullPrecisionValues()) {
+            // Fetched from the keyspace by the main thread instead.
+            break;
+          }
           auto vector = vector_index->GetValue(neighbor.external_id);
           if (vector.ok()) {
             if (parameters.index_schema->GetAttributeDataType().ToProto() ==
                 data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_JSON) {
               attribute_value = vmsdk::MakeUniqueValkeyString(
-                  StringFormatVector(vector.value()));
+                  StringFormatVector(vector.value(),
+                                     vector_index->GetVectorDataType()));
             } else {
               attribute_value =
                   vmsdk::UniqueValkeyString(ValkeyModule_CreateString(
@@ -561,8 +784,119 @@ absl::StatusOr<std::vector<indexes::Neighbor>> MaybeAddIndexedContent(
   return results;
 }
 
-absl::StatusOr<std::vector<indexes::Neighbor>> SearchNonVectorQuery(
+// Number of results to keep when only the first offset + limit are needed,
+// plus a buffer, as for TrimResults, for the keys dropped while the content
+// is fetched.
+size_t GetBufferedResultCount(const SearchParameters &parameters) {
+  return static_cast<size_t>(
+      (parameters.limit.first_index + parameters.limit.number) *
+      options::GetSearchResultBufferMultiplier());
+}
+
+// Returns the NUMERIC index of the SORTBY attribute, if any.
+const indexes::Numeric *GetSortByNumericIndex(
     const SearchParameters &parameters) {
+  if (!parameters.sortby_parameter.has_value()) {
+    return nullptr;
+  }
+  auto index =
+      parameters.index_schema->GetIndex(parameters.sortby_parameter->field);
+  if (!index.ok() ||
+      index.value()->GetIndexerType() != indexes::IndexerType::kNumeric) {
+    return nullptr;
+  }
+  return dynamic_cast<const indexes::Numeric *>(index.value().get());
+}
+
+// Serves a SORTBY on a NUMERIC attribute from the attribute index, so only
+// the first offset + limit matching keys are produced, already in order, and
+// no content has to be fetched on the main thread to sort them. The filter is
+// first resolved into the exact set of matching ids, which is only possible
+// for compositions of non-negated tag and numeric clauses. Then either the
+// index is walked in value order, keeping the matching ids, or, when the
+// filter is selective enough that the walk would visit more ids than there
+// are matches, the values of the matches are looked up and partially sorted.
+// Like ApplySorting, keys without a value for the attribute sort last.
+// Returns std::nullopt if the query can't be served this way.
+std::optional<std::vector<indexes::Neighbor>> SearchSortedByNumeric(
+    const SearchParameters &parameters, size_t &total_count) {
+  const indexes::Numeric *index = GetSortByNumericIndex(parameters);
+  if (index == nullptr || !parameters.filter_parse_results.root_predicate) {
+    return std::nullopt;
+  }
+  const DocIdMap *doc_id_map = &index->GetDocIdMap();
+  auto resolved = ResolveAsDocIds(
+      parameters.filter_parse_results.root_predicate.get(), false,
+      std::numeric_limits<size_t>::max(), doc_id_map);
+  if (!resolved.has_value() || !resolved->exact) {
+    return std::nullopt;
+  }
+  const DocIdBitmap &matches = resolved->doc_ids;
+  const size_t max_keys = static_cast<size_t>(
+      options::GetMaxNonVectorSearchResultsFetched().GetValue());
+  const size_t wanted = std::min(
+      {GetBufferedResultCount(parameters), max_keys, matches.size()});
+  const bool ascending =
+      parameters.sortby_parameter->order == SortOrder::kAscending;
+  total_count = matches.size();
+  std::vector<indexes::Neighbor> neighbors;
+  neighbors.reserve(wanted);
+  // The walk visits about wanted * tracked / matches ids.
+  const size_t tracked = index->GetTrackedKeyCount();
+  if (wanted > 0 &&
+      static_cast<double>(wanted) * tracked <
+          static_cast<double>(matches.size()) * matches.size()) {
+    index->ForEachDocIdByValue(ascending, [&](DocId id) {
+      if (matches.contains(id)) {
+        neighbors.emplace_back(
+            indexes::Neighbor{doc_id_map->GetKey(id), 0.0f});
+      }
+      return neighbors.size() < wanted &&
+             !parameters.cancellation_token->IsCancelled();
+    });
+  } else {
+    std::vector<std::pair<double, DocId>> values;
+    values.reserve(matches.size());
+    for (DocId id : matches) {
+      if (auto value = index->GetValue(doc_id_map->GetKey(id))) {
+        values.emplace_back(*value, id);
+      }
+    }
+    auto top = values.begin() + std::min(wanted, values.size());
+    if (ascending) {
+      std::partial_sort(values.begin(), top, values.end());
+    } else {
+      std::partial_sort(values.begin(), top, values.end(),
+                        [](const auto &a, const auto &b) {
+                          return a.first > b.first ||
+                                 (a.first == b.first && a.second < b.second);
+                        });
+    }
+    for (auto it = values.begin(); it != top; ++it) {
+      neighbors.emplace_back(
+          indexes::Neighbor{doc_id_map->GetKey(it->second), 0.0f});
+    }
+  }
+  if (neighbors.size() < wanted) {
+    for (auto it = matches.begin();
+         it != matches.end() && neighbors.size() < wanted; ++it) {
+      const auto &key = doc_id_map->GetKey(*it);
+      if (index->GetValue(key) == nullptr) {
+        neighbors.emplace_back(indexes::Neighbor{key, 0.0f});
+      }
+    }
+  }
+  return neighbors;
+}
+
+absl::StatusOr<std::vector<indexes::Neighbor>> SearchNonVectorQuery(
+    const SearchParameters &parameters, std::optional<size_t> &total_count) {
+  if (size_t count = 0;
+      auto neighbors = SearchSortedByNumeric(parameters, count)) {
+    query_sorted_by_index_count.Increment();
+    total_count = count;
+    return std::move(*neighbors);
+  }
   std::queue<std::unique_ptr<indexes::EntriesFetcherBase>> entries_fetchers;
   size_t qualified_entries = EvaluateFilterAsPrimary(
       parameters, parameters.filter_parse_results.root_predicate.get(),
@@ -573,25 +907,73 @@ absl::StatusOr<std::vector<indexes::Neighbor>> SearchNonVectorQuery(
   const size_t max_keys = static_cast<size_t>(
       options::GetMaxNonVectorSearchResultsFetched().GetValue());
   std::vector<indexes::Neighbor> neighbors;
-  neighbors.reserve(std::min(qualified_entries, static_cast<size_t>(5000)));
+  std::unique_ptr<Scorer> scorer = Scorer::Create(parameters);
+  // Without SORTBY, scored queries keep the best keys only, in a heap with
+  // the worst one on top, so every match gets scored regardless of the fetch
+  // limit.
+  const bool keep_best = scorer && !parameters.sortby_parameter.has_value();
+  const size_t kept =
+      keep_best ? std::min(GetBufferedResultCount(parameters), max_keys)
+                : max_keys;
+  neighbors.reserve(
+      std::min({qualified_entries, kept, static_cast<size_t>(5000)}));
+  auto worse = [](const indexes::Neighbor &a, const indexes::Neighbor &b) {
+    return a.distance < b.distance;
+  };
+  size_t matched = 0;
+  auto add_key = [&](const InternedStringPtr &key) -> bool {
+    if (!keep_best) {
+      if (neighbors.size() >= max_keys) {
+        return false;
+      }
+      neighbors.emplace_back(indexes::Neighbor{
+          key, scorer ? Scorer::ToDistance(scorer->Score(key)) : 0.0f});
+      return true;
+    }
+    ++matched;
+    const float distance = Scorer::ToDistance(scorer->Score(key));
+    if (neighbors.size() < kept) {
+      neighbors.emplace_back(indexes::Neighbor{key, distance});
+      std::push_heap(neighbors.begin(), neighbors.end(), worse);
+    } else if (kept > 0 && distance < neighbors.front().distance) {
+      std::pop_heap(neighbors.begin(), neighbors.end(), worse);
+      neighbors.back() = indexes::Neighbor{key, distance};
+      std::push_heap(neighbors.begin(), neighbors.end(), worse);
+    }
+    return true;
+  };
+  auto finish = [&]() {
+    if (keep_best) {
+      std::sort_heap(neighbors.begin(), neighbors.end(), worse);
+      total_count = matched;
+    }
+    return std::move(neighbors);
+  };
   bool fetch_limited = false;
   auto results_appender =
-      [&neighbors, &parameters, max_keys, &fetch_limited](
+      [&add_key, &fetch_limited](
           const InternedStringPtr &key,
           absl::flat_hash_set<const char *> &top_keys) -> bool {
-    if (neighbors.size() >= max_keys) {
+    if (!add_key(key)) {
       fetch_limited = true;
       return false;
     }
-    neighbors.emplace_back(indexes::Neighbor{key, 0.0f});
     return true;
   };
-  // Cannot skip evaluation if the query contains unsolved composed operations.
+  // Cannot skip evaluation if the query contains unsolved composed operations,
+  // unless they can be solved with set operations over the index postings.
   bool requires_prefilter_evaluation =
       IsUnsolvedQuery(parameters.filter_parse_results.query_operations);
+  bool needs_dedup =
+      NeedsDeduplication(parameters.filter_parse_results.query_operations);
+  if (requires_prefilter_evaluation &&
+      ResolveFilterWithSetOperations(parameters, entries_fetchers,
+                                     qualified_entries) ==
+          FilterResolution::kExact) {
+    requires_prefilter_evaluation = false;
+    needs_dedup = false;
+  }
   if (!requires_prefilter_evaluation) {
-    bool needs_dedup =
-        NeedsDeduplication(parameters.filter_parse_results.query_operations);
     absl::flat_hash_set<const char *> seen_keys;
     if (needs_dedup) {
       seen_keys.reserve(std::min(qualified_entries, static_cast<size_t>(5000)));
@@ -611,34 +993,31 @@ absl::StatusOr<std::vector<indexes::Neighbor>> SearchNonVectorQuery(
           seen_keys.insert(key->Str().data());
         }
         // Check if we've reached the limit
-        if (neighbors.size() >= max_keys) {
+        if (!add_key(key)) {
           nonvector_results_fetched_limited_count.Increment();
-          return neighbors;
+          return finish();
         }
-        neighbors.emplace_back(indexes::Neighbor{key, 0.0f});
         iterator->Next();
         if (parameters.cancellation_token->IsCancelled()) {
-          return neighbors;
+          return finish();
         }
       }
     }
-    return neighbors;
+    return finish();
   }
   EvaluatePrefilteredKeys(parameters, entries_fetchers,
                           std::move(results_appender), qualified_entries,
-                          /*stop_on_fetch_limit=*/true);
+                          /*stop_on_fetch_limit=*/true,
+                          /*evaluate_predicate=*/true);
   if (fetch_limited) {
     nonvector_results_fetched_limited_count.Increment();
   }
-  return neighbors;
+  return finish();
 }
 
-absl::StatusOr<std::vector<indexes::Neighbor>> DoSearch(
-    const SearchParameters &parameters, SearchMode search_mode,
-    vmsdk::ReaderMutexLock &lock) {
-  ++Metrics::GetStats().time_slice_queries;
-  // Handle OOM for search requests, defends against request
-  // coming from the coordinator
+// Handle OOM for search requests, defends against request
+// coming from the coordinator
+absl::Status CheckRemoteSearchOOM(SearchMode search_mode) {
   if (search_mode == SearchMode::kRemote) {
     auto ctx = vmsdk::MakeUniqueValkeyThreadSafeContext(nullptr);
     auto ctx_flags = ValkeyModule_GetContextFlags(ctx.get());
@@ -646,15 +1025,24 @@ absl::StatusOr<std::vector<indexes::Neighbor>> DoSearch(
       return absl::ResourceExhaustedError(kOOMMsg);
     }
   }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<indexes::Neighbor>> DoSearch(
+    const SearchParameters &parameters, SearchMode search_mode,
+    vmsdk::ReaderMutexLock &lock, std::optional<size_t> &total_count) {
+  ++Metrics::GetStats().time_slice_queries;
+  VMSDK_RETURN_IF_ERROR(CheckRemoteSearchOOM(search_mode));
   // Handle non vector queries first where attribute_alias is empty.
   if (parameters.IsNonVectorQuery()) {
-    return SearchNonVectorQuery(parameters);
+    return SearchNonVectorQuery(parameters, total_count);
   }
   VMSDK_ASSIGN_OR_RETURN(auto index, parameters.index_schema->GetIndex(
                                          parameters.attribute_alias));
   auto vector_index = dynamic_cast<indexes::VectorBase *>(index.get());
   if (index->GetIndexerType() != indexes::IndexerType::kHNSW &&
-      index->GetIndexerType() != indexes::IndexerType::kFlat) {
+      index->GetIndexerType() != indexes::IndexerType::kFlat &&
+      index->GetIndexerType() != indexes::IndexerType::kIVFPQ) {
     return absl::InvalidArgumentError(
         absl::StrCat(parameters.attribute_alias, " is not a Vector index "));
   }
@@ -668,21 +1056,36 @@ absl::StatusOr<std::vector<indexes::Neighbor>> DoSearch(
       entries_fetchers, false);
 
   // Query planner makes the decision for pre-filtering vs inline-filtering.
-  if (UsePreFiltering(qualified_entries, vector_index)) {
-    VMSDK_LOG(DEBUG, nullptr)
-        << "Using pre-filter query execution, qualified entries="
-        << qualified_entries;
+  QueryPlan plan =
+      PlanFilteredVectorSearch(qualified_entries, vector_index, parameters.k,
+                               parameters.ef, parameters.nprobe);
+  VMSDK_LOG(DEBUG, nullptr)
+      << "Using " << FilterPlanToString(plan.filter_plan)
+      << " query execution, qualified entries=" << qualified_entries
+      << " index size=" << plan.index_size
+      << " prefilter cost ns=" << plan.prefilter_cost_ns
+      << " inline cost ns=" << plan.inline_cost_ns;
+  auto start = absl::Now();
+  absl::StatusOr<std::vector<indexes::Neighbor>> neighbors;
+  if (plan.filter_plan == FilterPlan::kPreFilter) {
     // Do an exact nearest neighbour search on the reduced search space.
     ++Metrics::GetStats().query_prefiltering_requests_cnt;
+    auto resolution = ResolveFilterWithSetOperations(
+        parameters, entries_fetchers, qualified_entries);
     std::priority_queue<std::pair<float, hnswlib::labeltype>> results =
-        CalcBestMatchingPrefilteredKeys(parameters, entries_fetchers,
-                                        vector_index, qualified_entries);
-
-    return vector_index->CreateReply(results);
+        CalcBestMatchingPrefilteredKeys(
+            parameters, entries_fetchers, vector_index, qualified_entries,
+            resolution != FilterResolution::kExact);
+    neighbors = vector_index->CreateReply(results);
+  } else {
+    ++Metrics::GetStats().query_inline_filtering_requests_cnt;
+    lock.SetMayProlong();
+    neighbors = PerformVectorSearch(vector_index, parameters);
   }
-  ++Metrics::GetStats().query_inline_filtering_requests_cnt;
-  lock.SetMayProlong();
-  return PerformVectorSearch(vector_index, parameters);
+  RecordPlanExecution(
+      plan, parameters.index_schema->GetName(), absl::Now() - start,
+      neighbors.ok() && !parameters.cancellation_token->IsCancelled());
+  return neighbors;
 }
 
 // Check if no results should be returned based on query parameters.
@@ -784,16 +1187,58 @@ SerializationRange SearchResult::GetSerializationRange(
   return {start_index, end_index};
 }
 
+// Returns the HNSW index of an unfiltered vector query that can be searched
+// without the read phase of the time sliced mutex, see
+// VectorHNSW::SupportsSnapshotSearch.
+indexes::VectorHNSW<float> *GetSnapshotSearchIndex(
+    const SearchParameters &parameters) {
+  if (!options::GetHNSWSnapshotReads().GetValue() ||
+      parameters.IsNonVectorQuery() ||
+      parameters.filter_parse_results.root_predicate) {
+    return nullptr;
+  }
+  auto index = parameters.index_schema->GetIndex(parameters.attribute_alias);
+  if (!index.ok() ||
+      index.value()->GetIndexerType() != indexes::IndexerType::kHNSW) {
+    return nullptr;
+  }
+  auto vector_hnsw =
+      dynamic_cast<indexes::VectorHNSW<float> *>(index.value().get());
+  return vector_hnsw->SupportsSnapshotSearch() ? vector_hnsw : nullptr;
+}
+
+// Searches concurrently with the mutations of the index, so queries don't
+// wait for the write phase to end. The results reflect the index at some
+// point during the search and, as the index may change right after, their
+// contents are always fetched by the main thread.
+absl::Status SnapshotSearch(SearchParameters &parameters,
+                            SearchMode search_mode,
+                            indexes::VectorHNSW<float> *vector_hnsw) {
+  query_snapshot_search_count.Increment();
+  VMSDK_RETURN_IF_ERROR(CheckRemoteSearchOOM(search_mode));
+  VMSDK_ASSIGN_OR_RETURN(auto neighbors,
+                         PerformVectorSearch(vector_hnsw, parameters));
+  parameters.index_schema->PopulateSnapshotMutationSequenceNumbers(neighbors);
+  const size_t total_count = neighbors.size();
+  parameters.search_result =
+      SearchResult(total_count, std::move(neighbors), parameters);
+  return absl::OkStatus();
+}
+
 absl::Status Search(SearchParameters &parameters, SearchMode search_mode) {
+  if (auto vector_hnsw = GetSnapshotSearchIndex(parameters)) {
+    return SnapshotSearch(parameters, search_mode, vector_hnsw);
+  }
   auto &time_sliced_mutex = parameters.index_schema->GetTimeSlicedMutex();
   vmsdk::ReaderMutexLock lock(&time_sliced_mutex);
+  // Set when the search only returns some of the results.
+  std::optional<size_t> total_count;
   absl::StatusOr<std::vector<indexes::Neighbor>> neighbors =
-      DoSearch(parameters, search_mode, lock);
+      DoSearch(parameters, search_mode, lock, total_count);
   VMSDK_ASSIGN_OR_RETURN(
       auto result, MaybeAddIndexedContent(std::move(neighbors), parameters));
-  size_t total_count = result.size();
-  parameters.search_result =
-      SearchResult(total_count, std::move(result), parameters);
+  parameters.search_result = SearchResult(total_count.value_or(result.size()),
+                                          std::move(result), parameters);
   parameters.index_schema->PopulateIndexMutationSequenceNumbers(
       parameters.search_result.neighbors);
   return absl::OkStatus();
@@ -917,6 +1362,12 @@ absl::Status ParseKnnInner(query::SearchParameters &parameters,
         return absl::InvalidArgumentError("EF_RUNTIME argument is missing");
       }
       parameters.parse_vars.ef_string = params[i++];
+    } else if (absl::EqualsIgnoreCase(params[i], "NPROBE")) {
+      i++;
+      if (i == params.size()) {
+        return absl::InvalidArgumentError("NPROBE argument is missing");
+      }
+      parameters.parse_vars.nprobe_string = params[i++];
     } else if (absl::EqualsIgnoreCase(params[i], kAsParam)) {
       i++;
       if (i == params.size()) {
@@ -1041,7 +1492,8 @@ absl::Status query::SearchParameters::PreParseQueryString() {
     // Validate the index exists and is a vector index.
     VMSDK_ASSIGN_OR_RETURN(auto index, index_schema->GetIndex(attribute_alias));
     if (index->GetIndexerType() != indexes::IndexerType::kHNSW &&
-        index->GetIndexerType() != indexes::IndexerType::kFlat) {
+        index->GetIndexerType() != indexes::IndexerType::kFlat &&
+        index->GetIndexerType() != indexes::IndexerType::kIVFPQ) {
       return absl::InvalidArgumentError(absl::StrCat(
           "Index field `", attribute_alias, "` is not a Vector index "));
     }
@@ -1078,6 +1530,13 @@ absl::Status PostParseVectorParameters(query::SearchParameters &parameters) {
         SubstituteParam(parameters, parameters.parse_vars.ef_string));
     VMSDK_ASSIGN_OR_RETURN(parameters.ef, vmsdk::To<unsigned>(ef_string));
   }
+  if (!parameters.parse_vars.nprobe_string.empty()) {
+    VMSDK_ASSIGN_OR_RETURN(
+        auto nprobe_string,
+        SubstituteParam(parameters, parameters.parse_vars.nprobe_string));
+    VMSDK_ASSIGN_OR_RETURN(parameters.nprobe,
+                           vmsdk::To<unsigned>(nprobe_string));
+  }
 
   if (!parameters.parse_vars.score_as_string.empty()) {
     VMSDK_ASSIGN_OR_RETURN(
@@ -22,6 +22,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "src/commands/filter_parser.h"
+#include "src/coordinator/coordinator.pb.h"
 #include "src/index_schema.h"
 #include "src/indexes/index_base.h"
 #include "src/indexes/vector_base.h"
@@ -46,6 +47,9 @@ struct SortByParameter {
   SortOrder order{SortOrder::kAscending};
 };
 
+// Relevance scoring functions of full-text queries, see Scorer.
+enum class ScorerType { kBM25, kTFIDF };
+
 constexpr int64_t kTimeoutMS{50000};
 constexpr size_t kMaxTimeoutMs{60000};
 constexpr absl::string_view kOOMMsg{
@@ -69,6 +73,8 @@ constexpr absl::string_view kSomeShards{"SOMESHARDS"};
 constexpr absl::string_view kConsistent{"CONSISTENT"};
 constexpr absl::string_view kInconsistent{"INCONSISTENT"};
 constexpr absl::string_view kWithSortKeysParam{"WITHSORTKEYS"};
+constexpr absl::string_view kWithScoresParam{"WITHSCORES"};
+constexpr absl::string_view kScorerParam{"SCORER"};
 constexpr absl::string_view kVectorFilterDelimiter{"=>"};
 constexpr absl::string_view kSlop{"SLOP"};
 constexpr absl::string_view kInorder{"INORDER"};
@@ -97,6 +103,7 @@ inline std::ostream& operator<<(std::ostream& os, const ReturnAttribute& r) {
 
 struct SearchParameters;
 struct SerializationRange;
+class PartialAggregator;
 
 //
 // The output of the query pipeline
@@ -109,6 +116,9 @@ struct SearchResult {
   bool is_limited_with_buffer;
   // True if neighbors were offset using LIMIT first_index.
   bool is_offsetted;
+  // The merged groups of a fanout with SearchParameters::partial_aggregate,
+  // which replace the neighbors.
+  std::shared_ptr<PartialAggregator> partial_groups;
 
   // Constructor with automatic trimming based on query requirements
   SearchResult(size_t total_count, std::vector<indexes::Neighbor> neighbors,
@@ -170,6 +180,7 @@ struct SearchParameters {
   bool enable_consistency{options::GetPreferConsistentResults().GetValue()};
   int k{0};
   std::optional<unsigned> ef;
+  std::optional<unsigned> nprobe;
   LimitParameter limit;
   uint64_t timeout_ms{0};
   bool no_content{false};
@@ -190,6 +201,7 @@ struct SearchParameters {
     absl::string_view query_vector_string;
     absl::string_view k_string;
     absl::string_view ef_string;
+    absl::string_view nprobe_string;
     //
     // A Map of param names to values. The target of the map is a pair
     // that is the string of the value AND a reference count so that we can
@@ -204,6 +216,7 @@ struct SearchParameters {
       query_vector_string = absl::string_view();
       k_string = absl::string_view();
       ef_string = absl::string_view();
+      nprobe_string = absl::string_view();
       params.clear();
     }
   } parse_vars;
@@ -221,9 +234,16 @@ struct SearchParameters {
   virtual absl::Status PostParseQueryString();
   ContentProcessing GetContentProcessing() const;
 
+  // The leading GROUPBY of an FT.AGGREGATE, evaluated by each shard of a
+  // fanout. The shards then reply with partial groups instead of neighbors.
+  std::optional<coordinator::PartialAggregate> partial_aggregate;
+
   // The sortby parameter, populated by FT.SEARCH SORTBY clause or
   // deserialized from gRPC requests. Available to all query operations.
   std::optional<SortByParameter> sortby_parameter;
+  // When set, the keys matching the text clauses of a non-vector query are
+  // scored and, unless sorted by an attribute, returned best first.
+  std::optional<ScorerType> scorer;
   //
   // Called when the query is complete and results are ready to be sent back to
   // the client.
@@ -295,7 +315,8 @@ std::priority_queue<std::pair<float, hnswlib::labeltype>>
 CalcBestMatchingPrefilteredKeys(
     const SearchParameters& parameters,
     std::queue<std::unique_ptr<indexes::EntriesFetcherBase>>& entries_fetchers,
-    indexes::VectorBase* vector_index, size_t qualified_entries);
+    indexes::VectorBase* vector_index, size_t qualified_entries,
+    bool evaluate_predicate = true);
 
 bool QueryHasTextPredicate(const SearchParameters& parameters);
 
@@ -8,7 +8,12 @@
 #include "src/rdb_serialization.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <utility>
 
 #include "absl/log/check.h"
 #include "absl/status/status.h"
@@ -16,6 +21,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "src/metrics.h"
 #include "src/rdb_section.pb.h"
 #include "src/valkey_search.h"
@@ -65,6 +71,55 @@ void SupplementalContentChunkIter::ReadNextChunk() {
   done_ = !(*curr_chunk_)->has_binary_content();
 }
 
+absl::Status ReadAheadSafeRDB::ReadChunks(SafeRDB *rdb) {
+  while (true) {
+    auto serialized_chunk = rdb->LoadString();
+    absl::MutexLock lock(&mutex_);
+    if (!serialized_chunk.ok()) {
+      read_status_ = absl::InternalError(
+          "IO error while reading ahead SupplementalContentChunk from RDB");
+      return *read_status_;
+    }
+    // An empty string represents an EOF, see RDBChunkOutputStream::Close.
+    size_t size = vmsdk::ToStringView(serialized_chunk->get()).size();
+    if (decoder_state_ != DecoderState::kStopped) {
+      chunks_.push_back(std::move(*serialized_chunk));
+      buffered_bytes_ += size;
+    }
+    if (size == 0) {
+      read_status_ = absl::OkStatus();
+      return absl::OkStatus();
+    }
+    mutex_.Await(absl::Condition(this, &ReadAheadSafeRDB::CanReadAhead));
+  }
+}
+
+void ReadAheadSafeRDB::StopDecoding() {
+  std::deque<vmsdk::UniqueValkeyString> dropped;
+  absl::MutexLock lock(&mutex_);
+  decoder_state_ = DecoderState::kStopped;
+  dropped.swap(chunks_);
+  buffered_bytes_ = 0;
+}
+
+absl::StatusOr<vmsdk::UniqueValkeyString> ReadAheadSafeRDB::LoadString() {
+  absl::MutexLock lock(&mutex_);
+  if (decoder_state_ == DecoderState::kNotStarted) {
+    decoder_state_ = DecoderState::kDecoding;
+  }
+  mutex_.Await(absl::Condition(this, &ReadAheadSafeRDB::CanLoad));
+  if (chunks_.empty()) {
+    if (!read_status_->ok()) {
+      return *read_status_;
+    }
+    return absl::OutOfRangeError("No more chunks read ahead");
+  }
+  auto chunk = std::move(chunks_.front());
+  chunks_.pop_front();
+  buffered_bytes_ -= vmsdk::ToStringView(chunk.get()).size();
+  return chunk;
+}
+
 absl::StatusOr<std::unique_ptr<data_model::SupplementalContentHeader>>
 SupplementalContentIter::Next() {
   if (remaining_ == 0) {
@@ -132,6 +187,50 @@ absl::Status RDBChunkOutputStream::Close() {
   return absl::OkStatus();
 }
 
+absl::Status RDBBufferedOutputStream::SaveString(absl::string_view s) {
+  if (s.size() > std::numeric_limits<uint32_t>::max()) {
+    return absl::InvalidArgumentError("String too large for a buffered chunk");
+  }
+  uint32_t len = s.size();
+  buffer_.append(reinterpret_cast<const char *>(&len), sizeof(len));
+  buffer_.append(s.data(), s.size());
+  return MaybeFlush();
+}
+
+absl::Status RDBBufferedOutputStream::Flush() {
+  if (buffer_.empty()) {
+    return absl::OkStatus();
+  }
+  VMSDK_RETURN_IF_ERROR(out_.SaveString(buffer_));
+  buffer_.clear();
+  return absl::OkStatus();
+}
+
+absl::StatusOr<absl::string_view> RDBBufferedInputStream::LoadBytes(
+    size_t len) {
+  if (!chunk_ || pos_ == chunk_->size()) {
+    VMSDK_ASSIGN_OR_RETURN(chunk_, in_.LoadChunk());
+    pos_ = 0;
+  }
+  if (chunk_->size() - pos_ < len) {
+    return absl::InternalError("Truncated value in buffered chunk");
+  }
+  absl::string_view bytes(chunk_->data() + pos_, len);
+  pos_ += len;
+  return bytes;
+}
+
+absl::StatusOr<absl::string_view> RDBBufferedInputStream::LoadString() {
+  VMSDK_ASSIGN_OR_RETURN(auto len, LoadObject<uint32_t>());
+  // The string is in the same chunk as its length.
+  if (chunk_->size() - pos_ < len) {
+    return absl::InternalError("Truncated string in buffered chunk");
+  }
+  absl::string_view str(chunk_->data() + pos_, len);
+  pos_ += len;
+  return str;
+}
+
 void RegisterRDBCallback(data_model::RDBSectionType type,
                          RDBSectionCallbacks callbacks) {
   vmsdk::VerifyMainThread();
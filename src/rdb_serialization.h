@@ -10,12 +10,19 @@
 
 #include <cstddef>
 #include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
 #include <type_traits>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "src/rdb_section.pb.h"
 #include "third_party/hnswlib/iostream.h"
 #include "vmsdk/src/log.h"
@@ -157,6 +164,69 @@ class SafeRDB {
   ValkeyModuleIO *rdb_;
 };
 
+/* ReadAheadSafeRDB streams the serialized chunks of a supplemental content
+ * section from the main thread, which reads them from the RDB, to a decoder
+ * iterating them through a SupplementalContentChunkIter off the main thread.
+ * Once the decoder has started, the reader stays at most max_buffered_bytes
+ * ahead of it, so a section is never held whole in memory. Only LoadString is
+ * supported. */
+class ReadAheadSafeRDB : public SafeRDB {
+ public:
+  explicit ReadAheadSafeRDB(size_t max_buffered_bytes)
+      : max_buffered_bytes_(max_buffered_bytes) {}
+
+  // Reads the serialized chunks of the current supplemental content from
+  // `rdb`, up to and including its EOF marker. Blocks while the decoder lags
+  // behind by more than the bound. Until the decoder starts, the chunks are
+  // buffered without bound, as it may be queued behind other decoders.
+  absl::Status ReadChunks(SafeRDB *rdb) ABSL_LOCKS_EXCLUDED(mutex_);
+  // Called once the decoder is done with the section, even on failure. The
+  // chunks left, or read from then on, are dropped.
+  void StopDecoding() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Waits for the next chunk to be read.
+  absl::StatusOr<vmsdk::UniqueValkeyString> LoadString() override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  absl::StatusOr<size_t> LoadSizeT() override { return Unsupported(); }
+  absl::StatusOr<unsigned int> LoadUnsigned() override {
+    return Unsupported();
+  }
+  absl::StatusOr<int> LoadSigned() override { return Unsupported(); }
+  absl::StatusOr<double> LoadDouble() override { return Unsupported(); }
+  absl::Status SaveSizeT(size_t val) override { return Unsupported(); }
+  absl::Status SaveUnsigned(unsigned int val) override {
+    return Unsupported();
+  }
+  absl::Status SaveSigned(int val) override { return Unsupported(); }
+  absl::Status SaveDouble(double val) override { return Unsupported(); }
+  absl::Status SaveStringBuffer(absl::string_view buf) override {
+    return Unsupported();
+  }
+
+ private:
+  enum class DecoderState { kNotStarted, kDecoding, kStopped };
+
+  static absl::Status Unsupported() {
+    return absl::UnimplementedError("Only chunks are read ahead");
+  }
+  bool CanReadAhead() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return buffered_bytes_ <= max_buffered_bytes_ ||
+           decoder_state_ != DecoderState::kDecoding;
+  }
+  bool CanLoad() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return !chunks_.empty() || read_status_.has_value();
+  }
+
+  const size_t max_buffered_bytes_;
+  mutable absl::Mutex mutex_;
+  std::deque<vmsdk::UniqueValkeyString> chunks_ ABSL_GUARDED_BY(mutex_);
+  size_t buffered_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  DecoderState decoder_state_ ABSL_GUARDED_BY(mutex_) =
+      DecoderState::kNotStarted;
+  // Set once the EOF marker is read, or to the error that stopped the reads.
+  std::optional<absl::Status> read_status_ ABSL_GUARDED_BY(mutex_);
+};
+
 /* SupplementalContentChunkIter is an iterator over chunks of a supplemental
  * content section in the RDB. */
 class SupplementalContentChunkIter {
@@ -235,6 +305,11 @@ class SupplementalContentIter {
   absl::StatusOr<std::unique_ptr<data_model::SupplementalContentHeader>> Next();
   bool HasNext() { return remaining_ > 0; }
   SupplementalContentChunkIter IterateChunks() { return {rdb_}; }
+  // Reads the chunks of the current supplemental content into `read_ahead`
+  // without parsing them, in place of iterating them.
+  absl::Status ReadAheadChunks(ReadAheadSafeRDB &read_ahead) {
+    return read_ahead.ReadChunks(rdb_);
+  }
 
  private:
   SafeRDB *rdb_;
@@ -366,6 +441,67 @@ class RDBChunkOutputStream : public hnswlib::OutputStream {
   bool closed_ = false;
 };
 
+// Packs many small values into each chunk of an output stream. Every chunk
+// costs its own framing in the RDB and its own parse on load, which dominates
+// when saving millions of keys one chunk at a time. Values never span chunks.
+// Flush must be called once all the values are saved, RDBBufferedInputStream
+// reads them back in the same order.
+class RDBBufferedOutputStream {
+ public:
+  static constexpr size_t kDefaultChunkSize = 64 * 1024;
+  explicit RDBBufferedOutputStream(RDBChunkOutputStream &out,
+                                   size_t chunk_size = kDefaultChunkSize)
+      : out_(out), chunk_size_(chunk_size) {}
+
+  // Strings are prefixed by their length.
+  absl::Status SaveString(absl::string_view s);
+  template <typename T, std::enable_if_t<std::is_trivial<T>::value &&
+                                             std::is_standard_layout<T>::value,
+                                         bool> = true>
+  absl::Status SaveObject(const T &object) {
+    buffer_.append(reinterpret_cast<const char *>(&object), sizeof(T));
+    return MaybeFlush();
+  }
+  absl::Status Flush();
+
+ private:
+  absl::Status MaybeFlush() {
+    return buffer_.size() >= chunk_size_ ? Flush() : absl::OkStatus();
+  }
+
+  RDBChunkOutputStream &out_;
+  size_t chunk_size_;
+  std::string buffer_;
+};
+
+class RDBBufferedInputStream {
+ public:
+  explicit RDBBufferedInputStream(RDBChunkInputStream &in) : in_(in) {}
+
+  // The returned view is only valid until the next value is loaded.
+  absl::StatusOr<absl::string_view> LoadString();
+  template <typename T, std::enable_if_t<std::is_trivial<T>::value &&
+                                             std::is_standard_layout<T>::value,
+                                         bool> = true>
+  absl::StatusOr<T> LoadObject() {
+    VMSDK_ASSIGN_OR_RETURN(auto bytes, LoadBytes(sizeof(T)));
+    T object;
+    std::memcpy(&object, bytes.data(), sizeof(T));
+    return object;
+  }
+  bool AtEnd() const {
+    return (!chunk_ || pos_ == chunk_->size()) && in_.AtEnd();
+  }
+
+ private:
+  // Loads the next chunk once the current one is consumed.
+  absl::StatusOr<absl::string_view> LoadBytes(size_t len);
+
+  RDBChunkInputStream &in_;
+  std::unique_ptr<std::string> chunk_;
+  size_t pos_{0};
+};
+
 // Register for an RDB callback on RDB load and save, based on the RDBSection
 // type. For load callbacks, a callback is made for each matching RDBSection in
 // the loaded RDB. For save callbacks, a single callback is always given.
@@ -465,6 +465,32 @@ uint64_t SchemaManager::GetTotalIndexedDocuments() const {
   }
   return num_hash_keys;
 }
+std::string SchemaManager::GetTimeSliceStatsString() const {
+  absl::MutexLock lock(&db_to_index_schemas_mutex_);
+  std::string result;
+  for (const auto &[db_num, schema_map] : db_to_index_schemas_) {
+    for (const auto &[name, schema] : schema_map) {
+      absl::StrAppend(&result, result.empty() ? "" : ";", name, "@", db_num,
+                      ":", schema->GetTimeSliceStatsString());
+    }
+  }
+  return result;
+}
+
+void SchemaManager::AdaptTimeSlices() {
+  const bool adaptive = options::GetAdaptiveTimeSlicing().GetValue();
+  absl::MutexLock lock(&db_to_index_schemas_mutex_);
+  for (const auto &[db_num, schema_map] : db_to_index_schemas_) {
+    for (const auto &[name, schema] : schema_map) {
+      if (adaptive) {
+        schema->AdaptTimeSlices();
+      } else {
+        schema->ResetTimeSlices();
+      }
+    }
+  }
+}
+
 bool SchemaManager::IsIndexingInProgress() const {
   absl::MutexLock lock(&db_to_index_schemas_mutex_);
   for (const auto &[db_num, schema_map] : db_to_index_schemas_) {
@@ -746,6 +772,7 @@ void SchemaManager::OnServerCronCallback(ValkeyModuleCtx *ctx,
                                          [[maybe_unused]] void *data) {
   SchemaManager::Instance().PerformBackfill(
       ctx, options::GetBackfillBatchSize().GetValue());
+  SchemaManager::Instance().AdaptTimeSlices();
 }
 
 void SchemaManager::OnShutdownCallback(ValkeyModuleCtx *ctx,
@@ -853,6 +880,12 @@ static vmsdk::info_field::Integer total_indexed_documents(
     vmsdk::info_field::IntegerBuilder().App().Computed([] {
       return SchemaManager::Instance().GetTotalIndexedDocuments();
     }));
+static vmsdk::info_field::String time_slice_index_stats(
+    "time_slice_mutex", "time_slice_index_stats",
+    vmsdk::info_field::StringBuilder().Dev().ComputedString(
+        []() -> std::string {
+          return SchemaManager::Instance().GetTimeSliceStatsString();
+        }));
 static vmsdk::info_field::Integer total_active_write_threads(
     "index_stats", "total_active_write_threads",
     vmsdk::info_field::IntegerBuilder().App().Computed([] {
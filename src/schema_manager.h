@@ -74,6 +74,8 @@ class SchemaManager {
   uint64_t GetCorpusNumTextItems() const;
 
   uint64_t GetTotalIndexedDocuments() const;
+  // Per index time slicing statistics, "<name>@<db>:<stats>" joined by ';'.
+  std::string GetTimeSliceStatsString() const;
 
   bool IsIndexingInProgress() const;
   IndexSchema::Stats::ResultCnt<uint64_t> AccumulateIndexSchemaResults(
@@ -90,6 +92,9 @@ class SchemaManager {
 
   void PerformBackfill(ValkeyModuleCtx *ctx, uint32_t batch_size)
       ABSL_LOCKS_EXCLUDED(db_to_index_schemas_mutex_);
+  // Adapts the time quotas of every index when adaptive time slicing is
+  // enabled and restores them otherwise.
+  void AdaptTimeSlices() ABSL_LOCKS_EXCLUDED(db_to_index_schemas_mutex_);
 
   void OnFlushDBCallback(ValkeyModuleCtx *ctx, ValkeyModuleEvent eid,
                          uint64_t subevent, void *data)
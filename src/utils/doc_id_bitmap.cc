@@ -0,0 +1,423 @@
+/*
+ * Copyright (c) 2025, valkey-search contributors
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD 3-Clause
+ *
+ */
+
+#include "src/utils/doc_id_bitmap.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/log/check.h"
+
+namespace valkey_search {
+
+namespace {
+
+// Plain loops over fixed size word arrays, which the compiler vectorizes.
+uint32_t OrWords(uint64_t *dst, const uint64_t *src, size_t count) {
+  uint32_t cardinality = 0;
+  for (size_t i = 0; i < count; ++i) {
+    dst[i] |= src[i];
+    cardinality += std::popcount(dst[i]);
+  }
+  return cardinality;
+}
+
+uint32_t AndWords(uint64_t *dst, const uint64_t *src, size_t count) {
+  uint32_t cardinality = 0;
+  for (size_t i = 0; i < count; ++i) {
+    dst[i] &= src[i];
+    cardinality += std::popcount(dst[i]);
+  }
+  return cardinality;
+}
+
+}  // namespace
+
+DocIdBitmap::Chunk::Chunk(const Chunk &other)
+    : high(other.high), cardinality(other.cardinality), array(other.array) {
+  if (other.words) {
+    words = std::make_unique<uint64_t[]>(kWordsPerChunk);
+    std::memcpy(words.get(), other.words.get(),
+                kWordsPerChunk * sizeof(uint64_t));
+  }
+}
+
+DocIdBitmap::Chunk &DocIdBitmap::Chunk::operator=(const Chunk &other) {
+  if (this != &other) {
+    Chunk copy(other);
+    *this = std::move(copy);
+  }
+  return *this;
+}
+
+bool DocIdBitmap::Chunk::Contains(uint16_t low) const {
+  if (IsDense()) {
+    return (words[low >> 6] >> (low & 63)) & 1;
+  }
+  return std::binary_search(array.begin(), array.end(), low);
+}
+
+bool DocIdBitmap::Chunk::Insert(uint16_t low) {
+  if (IsDense()) {
+    uint64_t &word = words[low >> 6];
+    uint64_t bit = uint64_t{1} << (low & 63);
+    if (word & bit) {
+      return false;
+    }
+    word |= bit;
+    ++cardinality;
+    return true;
+  }
+  auto itr = std::lower_bound(array.begin(), array.end(), low);
+  if (itr != array.end() && *itr == low) {
+    return false;
+  }
+  if (cardinality >= kMaxArrayCardinality) {
+    ToDense();
+    return Insert(low);
+  }
+  array.insert(itr, low);
+  ++cardinality;
+  return true;
+}
+
+bool DocIdBitmap::Chunk::Erase(uint16_t low) {
+  if (IsDense()) {
+    uint64_t &word = words[low >> 6];
+    uint64_t bit = uint64_t{1} << (low & 63);
+    if (!(word & bit)) {
+      return false;
+    }
+    word &= ~bit;
+    --cardinality;
+    if (cardinality < kMinDenseCardinality) {
+      ToSparse();
+    }
+    return true;
+  }
+  auto itr = std::lower_bound(array.begin(), array.end(), low);
+  if (itr == array.end() || *itr != low) {
+    return false;
+  }
+  array.erase(itr);
+  --cardinality;
+  return true;
+}
+
+void DocIdBitmap::Chunk::ToDense() {
+  CHECK(!IsDense());
+  words = std::make_unique<uint64_t[]>(kWordsPerChunk);
+  for (uint16_t low : array) {
+    words[low >> 6] |= uint64_t{1} << (low & 63);
+  }
+  array.clear();
+  array.shrink_to_fit();
+}
+
+void DocIdBitmap::Chunk::ToSparse() {
+  CHECK(IsDense());
+  array.clear();
+  array.reserve(cardinality);
+  for (uint32_t w = 0; w < kWordsPerChunk; ++w) {
+    uint64_t word = words[w];
+    while (word) {
+      array.push_back(w * 64 + std::countr_zero(word));
+      word &= word - 1;
+    }
+  }
+  words.reset();
+}
+
+uint32_t DocIdBitmap::Chunk::NextSetBit(uint32_t from) const {
+  if (from >= kChunkBits) {
+    return kChunkBits;
+  }
+  uint32_t w = from >> 6;
+  uint64_t word = words[w] & (~uint64_t{0} << (from & 63));
+  while (word == 0) {
+    if (++w == kWordsPerChunk) {
+      return kChunkBits;
+    }
+    word = words[w];
+  }
+  return w * 64 + std::countr_zero(word);
+}
+
+void DocIdBitmap::Chunk::Or(const Chunk &other) {
+  if (!IsDense() && !other.IsDense()) {
+    absl::InlinedVector<uint16_t, 4> merged;
+    merged.reserve(array.size() + other.array.size());
+    std::set_union(array.begin(), array.end(), other.array.begin(),
+                   other.array.end(), std::back_inserter(merged));
+    cardinality = merged.size();
+    array = std::move(merged);
+    if (cardinality > kMaxArrayCardinality) {
+      ToDense();
+    }
+    return;
+  }
+  if (!IsDense()) {
+    ToDense();
+  }
+  if (other.IsDense()) {
+    cardinality = OrWords(words.get(), other.words.get(), kWordsPerChunk);
+    return;
+  }
+  for (uint16_t low : other.array) {
+    uint64_t &word = words[low >> 6];
+    uint64_t bit = uint64_t{1} << (low & 63);
+    cardinality += (word & bit) ? 0 : 1;
+    word |= bit;
+  }
+}
+
+void DocIdBitmap::Chunk::And(const Chunk &other) {
+  if (IsDense() && other.IsDense()) {
+    cardinality = AndWords(words.get(), other.words.get(), kWordsPerChunk);
+    if (cardinality < kMinDenseCardinality) {
+      ToSparse();
+    }
+    return;
+  }
+  if (IsDense()) {
+    // Keep the ids of the sparse side that are set in this chunk.
+    absl::InlinedVector<uint16_t, 4> kept;
+    kept.reserve(other.array.size());
+    for (uint16_t low : other.array) {
+      if (Contains(low)) {
+        kept.push_back(low);
+      }
+    }
+    words.reset();
+    array = std::move(kept);
+  } else if (other.IsDense()) {
+    array.erase(std::remove_if(array.begin(), array.end(),
+                               [&other](uint16_t low) {
+                                 return !other.Contains(low);
+                               }),
+                array.end());
+  } else {
+    absl::InlinedVector<uint16_t, 4> kept;
+    kept.reserve(std::min(array.size(), other.array.size()));
+    std::set_intersection(array.begin(), array.end(), other.array.begin(),
+                          other.array.end(), std::back_inserter(kept));
+    array = std::move(kept);
+  }
+  cardinality = array.size();
+}
+
+bool DocIdBitmap::Chunk::operator==(const Chunk &other) const {
+  if (high != other.high || cardinality != other.cardinality) {
+    return false;
+  }
+  if (IsDense() == other.IsDense()) {
+    return IsDense() ? std::memcmp(words.get(), other.words.get(),
+                                   kWordsPerChunk * sizeof(uint64_t)) == 0
+                     : array == other.array;
+  }
+  const Chunk &sparse = IsDense() ? other : *this;
+  const Chunk &dense = IsDense() ? *this : other;
+  return std::all_of(sparse.array.begin(), sparse.array.end(),
+                     [&dense](uint16_t low) { return dense.Contains(low); });
+}
+
+DocIdBitmap::DocIdBitmap(std::initializer_list<DocId> ids) {
+  for (DocId id : ids) {
+    insert(id);
+  }
+}
+
+DocIdBitmap DocIdBitmap::FromIds(std::vector<DocId> ids) {
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+  DocIdBitmap bitmap;
+  for (size_t begin = 0; begin < ids.size();) {
+    const uint16_t high = High(ids[begin]);
+    size_t end = begin;
+    while (end < ids.size() && High(ids[end]) == high) {
+      ++end;
+    }
+    Chunk &chunk = bitmap.chunks_.emplace_back(high);
+    chunk.cardinality = end - begin;
+    if (chunk.cardinality > kMaxArrayCardinality) {
+      chunk.words = std::make_unique<uint64_t[]>(kWordsPerChunk);
+      for (size_t i = begin; i < end; ++i) {
+        uint16_t low = Low(ids[i]);
+        chunk.words[low >> 6] |= uint64_t{1} << (low & 63);
+      }
+    } else {
+      chunk.array.reserve(chunk.cardinality);
+      for (size_t i = begin; i < end; ++i) {
+        chunk.array.push_back(Low(ids[i]));
+      }
+    }
+    begin = end;
+  }
+  bitmap.size_ = ids.size();
+  return bitmap;
+}
+
+size_t DocIdBitmap::LowerBound(uint16_t high) const {
+  return std::lower_bound(chunks_.begin(), chunks_.end(), high,
+                          [](const Chunk &chunk, uint16_t high) {
+                            return chunk.high < high;
+                          }) -
+         chunks_.begin();
+}
+
+bool DocIdBitmap::insert(DocId id) {
+  size_t pos = LowerBound(High(id));
+  if (pos == chunks_.size() || chunks_[pos].high != High(id)) {
+    chunks_.insert(chunks_.begin() + pos, Chunk(High(id)));
+  }
+  if (!chunks_[pos].Insert(Low(id))) {
+    return false;
+  }
+  ++size_;
+  return true;
+}
+
+size_t DocIdBitmap::erase(DocId id) {
+  size_t pos = LowerBound(High(id));
+  if (pos == chunks_.size() || chunks_[pos].high != High(id) ||
+      !chunks_[pos].Erase(Low(id))) {
+    return 0;
+  }
+  if (chunks_[pos].cardinality == 0) {
+    chunks_.erase(chunks_.begin() + pos);
+  }
+  --size_;
+  return 1;
+}
+
+bool DocIdBitmap::contains(DocId id) const {
+  size_t pos = LowerBound(High(id));
+  return pos < chunks_.size() && chunks_[pos].high == High(id) &&
+         chunks_[pos].Contains(Low(id));
+}
+
+void DocIdBitmap::clear() {
+  chunks_.clear();
+  size_ = 0;
+}
+
+DocIdBitmap &DocIdBitmap::operator|=(const DocIdBitmap &other) {
+  if (other.empty()) {
+    return *this;
+  }
+  absl::InlinedVector<Chunk, 1> merged;
+  merged.reserve(chunks_.size() + other.chunks_.size());
+  size_t i = 0;
+  size_t j = 0;
+  size_ = 0;
+  while (i < chunks_.size() || j < other.chunks_.size()) {
+    if (j == other.chunks_.size() ||
+        (i < chunks_.size() && chunks_[i].high < other.chunks_[j].high)) {
+      merged.push_back(std::move(chunks_[i++]));
+    } else if (i == chunks_.size() ||
+               other.chunks_[j].high < chunks_[i].high) {
+      merged.push_back(other.chunks_[j++]);
+    } else {
+      chunks_[i].Or(other.chunks_[j++]);
+      merged.push_back(std::move(chunks_[i++]));
+    }
+    size_ += merged.back().cardinality;
+  }
+  chunks_ = std::move(merged);
+  return *this;
+}
+
+DocIdBitmap &DocIdBitmap::operator&=(const DocIdBitmap &other) {
+  absl::InlinedVector<Chunk, 1> kept;
+  size_t j = 0;
+  size_ = 0;
+  for (auto &chunk : chunks_) {
+    while (j < other.chunks_.size() && other.chunks_[j].high < chunk.high) {
+      ++j;
+    }
+    if (j == other.chunks_.size()) {
+      break;
+    }
+    if (other.chunks_[j].high != chunk.high) {
+      continue;
+    }
+    chunk.And(other.chunks_[j]);
+    if (chunk.cardinality > 0) {
+      size_ += chunk.cardinality;
+      kept.push_back(std::move(chunk));
+    }
+  }
+  chunks_ = std::move(kept);
+  return *this;
+}
+
+bool DocIdBitmap::operator==(const DocIdBitmap &other) const {
+  return size_ == other.size_ &&
+         std::equal(chunks_.begin(), chunks_.end(), other.chunks_.begin(),
+                    other.chunks_.end());
+}
+
+size_t DocIdBitmap::MemoryUsage() const {
+  size_t bytes = sizeof(*this);
+  if (chunks_.capacity() > 1) {
+    bytes += chunks_.capacity() * sizeof(Chunk);
+  }
+  for (const auto &chunk : chunks_) {
+    if (chunk.IsDense()) {
+      bytes += kWordsPerChunk * sizeof(uint64_t);
+    } else if (chunk.array.capacity() > 4) {
+      bytes += chunk.array.capacity() * sizeof(uint16_t);
+    }
+  }
+  return bytes;
+}
+
+DocIdBitmap::const_iterator::const_iterator(const DocIdBitmap *bitmap,
+                                            size_t chunk)
+    : bitmap_(bitmap), chunk_(chunk) {
+  SeekChunkStart();
+}
+
+void DocIdBitmap::const_iterator::SeekChunkStart() {
+  pos_ = 0;
+  if (chunk_ < bitmap_->chunks_.size() && bitmap_->chunks_[chunk_].IsDense()) {
+    pos_ = bitmap_->chunks_[chunk_].NextSetBit(0);
+  }
+}
+
+DocId DocIdBitmap::const_iterator::operator*() const {
+  const auto &chunk = bitmap_->chunks_[chunk_];
+  uint32_t low = chunk.IsDense() ? pos_ : chunk.array[pos_];
+  return (static_cast<DocId>(chunk.high) << 16) | low;
+}
+
+DocIdBitmap::const_iterator &DocIdBitmap::const_iterator::operator++() {
+  const auto &chunk = bitmap_->chunks_[chunk_];
+  bool chunk_done;
+  if (chunk.IsDense()) {
+    pos_ = chunk.NextSetBit(pos_ + 1);
+    chunk_done = pos_ == kChunkBits;
+  } else {
+    chunk_done = ++pos_ == chunk.array.size();
+  }
+  if (chunk_done) {
+    ++chunk_;
+    SeekChunkStart();
+  }
+  return *this;
+}
+
+}  // namespace valkey_search
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2025, valkey-search contributors
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD 3-Clause
+ *
+ */
+
+#ifndef VALKEYSEARCH_SRC_UTILS_DOC_ID_BITMAP_H_
+#define VALKEYSEARCH_SRC_UTILS_DOC_ID_BITMAP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "absl/container/inlined_vector.h"
+
+namespace valkey_search {
+
+// Dense, schema-wide document id. See DocIdMap.
+using DocId = uint32_t;
+
+// A compressed bitmap of document ids in the style of Roaring bitmaps. The id
+// space is split into chunks of 2^16 ids keyed by the high 16 bits. Sparse
+// chunks hold a sorted array of the low 16 bits (2 bytes per id) and dense
+// chunks hold an 8KB bitset, so a posting costs at most 2 bytes and
+// intersections and unions of dense chunks run a word at a time.
+//
+// The set-like interface lets the bitmap replace hash sets as the posting
+// container of PatriciaTree and BTreeNumeric.
+class DocIdBitmap {
+ public:
+  DocIdBitmap() = default;
+  DocIdBitmap(std::initializer_list<DocId> ids);
+  // Builds the bitmap of `ids`, in any order and possibly repeated, in a
+  // single pass over the sorted ids. Much cheaper than unioning many small
+  // bitmaps one at a time, which rewrites the sparse chunks on every union.
+  static DocIdBitmap FromIds(std::vector<DocId> ids);
+  DocIdBitmap(const DocIdBitmap &other) = default;
+  DocIdBitmap &operator=(const DocIdBitmap &other) = default;
+  DocIdBitmap(DocIdBitmap &&other) noexcept = default;
+  DocIdBitmap &operator=(DocIdBitmap &&other) noexcept = default;
+
+  // Returns true if the id was not already present.
+  bool insert(DocId id);
+  // Returns the number of removed ids (0 or 1).
+  size_t erase(DocId id);
+  bool contains(DocId id) const;
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  void clear();
+
+  // Iterates the ids in increasing order.
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = DocId;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const DocId *;
+    using reference = DocId;
+
+    const_iterator() = default;
+    DocId operator*() const;
+    const_iterator &operator++();
+    const_iterator operator++(int) {
+      auto copy = *this;
+      ++*this;
+      return copy;
+    }
+    bool operator==(const const_iterator &other) const {
+      return chunk_ == other.chunk_ && pos_ == other.pos_;
+    }
+    bool operator!=(const const_iterator &other) const {
+      return !(*this == other);
+    }
+
+   private:
+    friend class DocIdBitmap;
+    const_iterator(const DocIdBitmap *bitmap, size_t chunk);
+    void SeekChunkStart();
+
+    const DocIdBitmap *bitmap_{nullptr};
+    size_t chunk_{0};
+    // Index into the array of a sparse chunk or bit offset in a dense chunk.
+    uint32_t pos_{0};
+  };
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, chunks_.size()); }
+
+  DocIdBitmap &operator|=(const DocIdBitmap &other);
+  DocIdBitmap &operator&=(const DocIdBitmap &other);
+  friend DocIdBitmap operator|(DocIdBitmap lhs, const DocIdBitmap &rhs) {
+    return lhs |= rhs;
+  }
+  friend DocIdBitmap operator&(DocIdBitmap lhs, const DocIdBitmap &rhs) {
+    return lhs &= rhs;
+  }
+  bool operator==(const DocIdBitmap &other) const;
+
+  // Bytes used by this bitmap, including its own footprint.
+  size_t MemoryUsage() const;
+
+ private:
+  static constexpr uint32_t kChunkBits = 1 << 16;
+  static constexpr uint32_t kWordsPerChunk = kChunkBits / 64;
+  // Above this cardinality the 8KB bitset is smaller than the array.
+  static constexpr uint32_t kMaxArrayCardinality = 4096;
+  // Dense chunks shrink back to arrays below this cardinality. The gap to
+  // kMaxArrayCardinality avoids flapping on alternating inserts and erases.
+  static constexpr uint32_t kMinDenseCardinality = kMaxArrayCardinality / 2;
+
+  struct Chunk {
+    Chunk() = default;
+    explicit Chunk(uint16_t high) : high(high) {}
+    Chunk(const Chunk &other);
+    Chunk &operator=(const Chunk &other);
+    Chunk(Chunk &&other) noexcept = default;
+    Chunk &operator=(Chunk &&other) noexcept = default;
+
+    bool IsDense() const { return words != nullptr; }
+    bool Contains(uint16_t low) const;
+    bool Insert(uint16_t low);
+    bool Erase(uint16_t low);
+    void ToDense();
+    void ToSparse();
+    // Returns the first set bit at or after `from`, or kChunkBits.
+    uint32_t NextSetBit(uint32_t from) const;
+    void Or(const Chunk &other);
+    void And(const Chunk &other);
+    bool operator==(const Chunk &other) const;
+
+    uint16_t high{0};
+    uint32_t cardinality{0};
+    // Sorted low 16 bits of the ids while the chunk is sparse.
+    absl::InlinedVector<uint16_t, 4> array;
+    // kWordsPerChunk words once the chunk is dense.
+    std::unique_ptr<uint64_t[]> words;
+  };
+
+  static uint16_t High(DocId id) { return id >> 16; }
+  static uint16_t Low(DocId id) { return id & 0xFFFF; }
+  // Returns the position of the first chunk not ordered before `high`.
+  size_t LowerBound(uint16_t high) const;
+
+  // Sorted by Chunk::high. Most postings fit in a single chunk, which is kept
+  // inline.
+  absl::InlinedVector<Chunk, 1> chunks_;
+  size_t size_{0};
+};
+
+}  // namespace valkey_search
+
+#endif  // VALKEYSEARCH_SRC_UTILS_DOC_ID_BITMAP_H_
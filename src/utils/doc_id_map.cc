@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2025, valkey-search contributors
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD 3-Clause
+ *
+ */
+
+#include "src/utils/doc_id_map.h"
+
+#include <cstddef>
+#include <optional>
+
+#include "absl/log/check.h"
+#include "absl/synchronization/mutex.h"
+#include "src/utils/doc_id_bitmap.h"
+#include "src/utils/string_interning.h"
+
+namespace valkey_search {
+
+DocId DocIdMap::Acquire(const InternedStringPtr &key) {
+  absl::MutexLock lock(&mutex_);
+  auto [it, inserted] = ids_by_key_.try_emplace(key);
+  Entry &entry = it->second;
+  if (inserted) {
+    if (free_ids_.empty()) {
+      CHECK(keys_.size() < kMaxDocIds) << "Document id space exhausted";
+      entry.id = keys_.size();
+      keys_.emplace_back();
+    } else {
+      entry.id = free_ids_.back();
+      free_ids_.pop_back();
+    }
+    keys_[entry.id] = key;
+  }
+  ++entry.ref_count;
+  return entry.id;
+}
+
+void DocIdMap::Release(DocId id) {
+  absl::MutexLock lock(&mutex_);
+  auto it = ids_by_key_.find(keys_[id]);
+  CHECK(it != ids_by_key_.end() && it->second.id == id);
+  if (--it->second.ref_count > 0) {
+    return;
+  }
+  ids_by_key_.erase(it);
+  keys_[id] = InternedStringPtr();
+  free_ids_.push_back(id);
+}
+
+std::optional<DocId> DocIdMap::Find(const InternedStringPtr &key) const {
+  absl::MutexLock lock(&mutex_);
+  if (auto it = ids_by_key_.find(key); it != ids_by_key_.end()) {
+    return it->second.id;
+  }
+  return std::nullopt;
+}
+
+size_t DocIdMap::Size() const {
+  absl::MutexLock lock(&mutex_);
+  return ids_by_key_.size();
+}
+
+}  // namespace valkey_search
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2025, valkey-search contributors
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD 3-Clause
+ *
+ */
+
+#ifndef VALKEYSEARCH_SRC_UTILS_DOC_ID_MAP_H_
+#define VALKEYSEARCH_SRC_UTILS_DOC_ID_MAP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "src/utils/doc_id_bitmap.h"
+#include "src/utils/string_interning.h"
+
+namespace valkey_search {
+
+// Assigns dense document ids to the keys of an index schema. Ids are shared by
+// all the indexes of the schema, so postings of different attributes can be
+// combined with bitmap operations. An id stays assigned while at least one
+// index holds the key and is recycled once the last one releases it, which
+// keeps the id space, and therefore the bitmaps, dense.
+class DocIdMap {
+ public:
+  DocIdMap() = default;
+  DocIdMap(const DocIdMap &) = delete;
+  DocIdMap &operator=(const DocIdMap &) = delete;
+
+  // Returns the id of the key, assigning one if needed. Every call must be
+  // balanced with a call to Release.
+  DocId Acquire(const InternedStringPtr &key) ABSL_LOCKS_EXCLUDED(mutex_);
+  void Release(DocId id) ABSL_LOCKS_EXCLUDED(mutex_);
+  std::optional<DocId> Find(const InternedStringPtr &key) const
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  // Note that ids are not assigned or released while the time sliced mutex is
+  // in a read mode, so readers may resolve ids without acquiring the lock.
+  const InternedStringPtr &GetKey(DocId id) const
+      ABSL_NO_THREAD_SAFETY_ANALYSIS {
+    return keys_[id];
+  }
+  size_t Size() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  static constexpr size_t kMaxDocIds = std::numeric_limits<DocId>::max();
+  // The count fits in the padding of the slot of the key, so a key costs a
+  // slot of ids_by_key_ and a pointer in keys_.
+  struct Entry {
+    DocId id{0};
+    uint32_t ref_count{0};
+  };
+  mutable absl::Mutex mutex_;
+  InternedStringHashMap<Entry> ids_by_key_ ABSL_GUARDED_BY(mutex_);
+  // Indexed by id. A deque keeps references returned by GetKey stable.
+  std::deque<InternedStringPtr> keys_ ABSL_GUARDED_BY(mutex_);
+  std::vector<DocId> free_ids_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace valkey_search
+
+#endif  // VALKEYSEARCH_SRC_UTILS_DOC_ID_MAP_H_
@@ -28,25 +28,29 @@
 
 namespace valkey_search {
 
+// `Set` is the container holding the values of a node. It needs the insert,
+// erase, size and empty members of absl::flat_hash_set.
 template <typename T, typename Hasher = absl::Hash<T>,
-          typename Equaler = std::equal_to<T>>
+          typename Equaler = std::equal_to<T>,
+          typename Set = absl::flat_hash_set<T, Hasher, Equaler>>
 class PatriciaNode {
  public:
   PatriciaNode() = default;
   absl::flat_hash_map<std::string,
-                      std::unique_ptr<PatriciaNode<T, Hasher, Equaler>>>
+                      std::unique_ptr<PatriciaNode<T, Hasher, Equaler, Set>>>
       children;
   int64_t subtree_values_count = 0;
-  std::optional<absl::flat_hash_set<T, Hasher, Equaler>> value;
+  std::optional<Set> value;
   void PrintValue() {}
 };
 
 template <typename T, typename Hasher = absl::Hash<T>,
-          typename Equaler = std::equal_to<T>>
+          typename Equaler = std::equal_to<T>,
+          typename Set = absl::flat_hash_set<T, Hasher, Equaler>>
 class PatriciaTree {
  public:
-  using SetType = absl::flat_hash_set<T, Hasher, Equaler>;
-  using PatriciaNodeType = PatriciaNode<T, Hasher, Equaler>;
+  using SetType = Set;
+  using PatriciaNodeType = PatriciaNode<T, Hasher, Equaler, Set>;
   PatriciaTree(bool case_sensitive)
       : root_(std::make_unique<PatriciaNodeType>()),
         case_sensitive_(case_sensitive) {}
@@ -253,9 +257,7 @@ class PatriciaTree {
       if (!node->value) {
         return false;  // Key not found
       }
-      auto itr = node->value.value().find(value);
-      if (itr != node->value.value().end()) {
-        node->value.value().erase(itr);
+      if (node->value.value().erase(value)) {
         node->subtree_values_count--;
         return true;
       }
@@ -879,6 +879,20 @@ static vmsdk::info_field::String flat_vector_index_search_latency_usec(
               .flat_vector_index_search_latency.HasSamples();
         }));
 
+static vmsdk::info_field::String ivf_pq_vector_index_search_latency_usec(
+    "latency", "ivf_pq_vector_index_search_latency_usec",
+    vmsdk::info_field::StringBuilder()
+        .App()
+        .ComputedString([]() -> std::string {
+          auto &sampler =
+              Metrics::GetStats().ivf_pq_vector_index_search_latency;
+          return sampler.GetStatsString();
+        })
+        .VisibleIf([]() -> bool {
+          return Metrics::GetStats()
+              .ivf_pq_vector_index_search_latency.HasSamples();
+        }));
+
 static vmsdk::info_field::Integer info_fanout_retry_count(
     "fanout", "info_fanout_retry_count",
     vmsdk::info_field::IntegerBuilder().Dev().Computed([]() -> long long {
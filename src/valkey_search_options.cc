@@ -153,6 +153,20 @@ static auto hnsw_allow_replace_deleted =
         .Dev()
         .Build();
 
+/// While an HNSW index is rebuilt from scratch after an RDB load that skipped
+/// the index contents, answer its queries with an exact scan of the vectors
+/// indexed so far instead of the partially built graph.
+constexpr absl::string_view kHNSWBuildFlatFallback{"hnsw-build-flat-fallback"};
+static auto hnsw_build_flat_fallback =
+    config::BooleanBuilder(kHNSWBuildFlatFallback, true).Build();
+
+/// Serve vector queries without filters on HNSW indexes outside of the read
+/// phase of the index, so that they don't wait for the pending mutations to
+/// be applied.
+constexpr absl::string_view kHNSWSnapshotReads{"hnsw-snapshot-reads"};
+static auto hnsw_snapshot_reads =
+    config::BooleanBuilder(kHNSWSnapshotReads, false).Build();
+
 // Register an enumerator for the log level
 static const std::vector<std::string_view> kLogLevelNames = {
     VALKEYMODULE_LOGLEVEL_WARNING,
@@ -314,6 +328,59 @@ static auto thread_pool_wait_time_samples =
         })
         .Build();
 
+/// Register the "--max-search-parallelism" flag. Caps the number of reader
+/// threads a single search is split across, to keep the tail latency of
+/// concurrent queries predictable. 1 disables intra-query parallelism.
+constexpr absl::string_view kMaxSearchParallelismConfig{
+    "max-search-parallelism"};
+constexpr uint32_t kDefaultMaxSearchParallelism{4};
+constexpr uint32_t kMinimumMaxSearchParallelism{1};
+constexpr uint32_t kMaximumMaxSearchParallelism{1024};
+static auto max_search_parallelism =
+    vmsdk::config::NumberBuilder(kMaxSearchParallelismConfig,
+                                 kDefaultMaxSearchParallelism,
+                                 kMinimumMaxSearchParallelism,
+                                 kMaximumMaxSearchParallelism)
+        .Build();
+
+/// Register the "--adaptive-time-slicing" flag. When enabled, the read and
+/// write time quotas of every index are adjusted periodically, favoring the
+/// side whose backlog exceeds its target.
+constexpr absl::string_view kAdaptiveTimeSlicingConfig{
+    "adaptive-time-slicing"};
+static auto adaptive_time_slicing =
+    config::BooleanBuilder(kAdaptiveTimeSlicingConfig, false).Build();
+
+/// Register the "--time-slice-read-wait-target" flag. The average time (in
+/// milliseconds) the readers of an index wait for a read phase above which
+/// adaptive time slicing lengthens its read phases.
+constexpr absl::string_view kTimeSliceReadWaitTargetConfig{
+    "time-slice-read-wait-target"};
+constexpr uint32_t kDefaultTimeSliceReadWaitTarget{5};  // 5ms
+constexpr uint32_t kMinimumTimeSliceReadWaitTarget{1};
+constexpr uint32_t kMaximumTimeSliceReadWaitTarget{10000};  // 10 seconds
+static auto time_slice_read_wait_target =
+    vmsdk::config::NumberBuilder(kTimeSliceReadWaitTargetConfig,
+                                 kDefaultTimeSliceReadWaitTarget,
+                                 kMinimumTimeSliceReadWaitTarget,
+                                 kMaximumTimeSliceReadWaitTarget)
+        .Build();
+
+/// Register the "--time-slice-mutation-queue-target" flag. The mutation queue
+/// size of an index above which adaptive time slicing lengthens its write
+/// phases.
+constexpr absl::string_view kTimeSliceMutationQueueTargetConfig{
+    "time-slice-mutation-queue-target"};
+constexpr uint32_t kDefaultTimeSliceMutationQueueTarget{1000};
+constexpr uint32_t kMinimumTimeSliceMutationQueueTarget{1};
+constexpr uint32_t kMaximumTimeSliceMutationQueueTarget{UINT32_MAX};
+static auto time_slice_mutation_queue_target =
+    vmsdk::config::NumberBuilder(kTimeSliceMutationQueueTargetConfig,
+                                 kDefaultTimeSliceMutationQueueTarget,
+                                 kMinimumTimeSliceMutationQueueTarget,
+                                 kMaximumTimeSliceMutationQueueTarget)
+        .Build();
+
 /// Register the "--max-term-expansions" flag. Controls the maximum number of
 /// words to search in text operations (prefix, suffix, fuzzy) to limit memory
 /// usage
@@ -341,6 +408,51 @@ static auto tag_min_prefix_length =
                           UINT_MAX)                    // max limit
         .Build();
 
+/// Register the "--backfill-mutation-batch-size" flag. Controls the number of
+/// backfilled keys indexed together by a single mutation task. Batching
+/// amortizes the per-record locking and index growth of vector indexes.
+constexpr absl::string_view kBackfillMutationBatchSizeConfig{
+    "backfill-mutation-batch-size"};
+constexpr uint32_t kDefaultBackfillMutationBatchSize{256};
+constexpr uint32_t kMinimumBackfillMutationBatchSize{1};
+constexpr uint32_t kMaximumBackfillMutationBatchSize{100000};
+static auto backfill_mutation_batch_size =
+    config::NumberBuilder(kBackfillMutationBatchSizeConfig,   // name
+                          kDefaultBackfillMutationBatchSize,  // default (256)
+                          kMinimumBackfillMutationBatchSize,  // min (1)
+                          kMaximumBackfillMutationBatchSize)  // max (100k)
+        .Build();
+
+/// Register the "--mutation-group-commit-size" flag. Controls the maximum
+/// number of pending keys a mutation task indexes under a single write lock.
+/// Records added by the keys of a group are applied to each index together.
+constexpr absl::string_view kMutationGroupCommitSizeConfig{
+    "mutation-group-commit-size"};
+constexpr uint32_t kDefaultMutationGroupCommitSize{32};
+constexpr uint32_t kMinimumMutationGroupCommitSize{1};
+constexpr uint32_t kMaximumMutationGroupCommitSize{10000};
+static auto mutation_group_commit_size =
+    config::NumberBuilder(kMutationGroupCommitSizeConfig,   // name
+                          kDefaultMutationGroupCommitSize,  // default (32)
+                          kMinimumMutationGroupCommitSize,  // min (1)
+                          kMaximumMutationGroupCommitSize)  // max (10k)
+        .Build();
+
+/// Register the "--hash-scan-min-attributes" flag. Schemas of HASH keys with
+/// at least this many attributes extract the records of a mutated key in a
+/// single scan of the hash, instead of with one lookup per attribute.
+constexpr absl::string_view kHashScanMinAttributesConfig{
+    "hash-scan-min-attributes"};
+constexpr uint32_t kDefaultHashScanMinAttributes{8};
+constexpr uint32_t kMinimumHashScanMinAttributes{1};
+constexpr uint32_t kMaximumHashScanMinAttributes{100000};
+static auto hash_scan_min_attributes =
+    config::NumberBuilder(kHashScanMinAttributesConfig,   // name
+                          kDefaultHashScanMinAttributes,  // default (8)
+                          kMinimumHashScanMinAttributes,  // min (1)
+                          kMaximumHashScanMinAttributes)  // max (100k)
+        .Build();
+
 /// Register the "--prefiltering-threshold-ratio" flag
 /// Controls when pre-filtering is used vs inline-filtering for hybrid queries
 constexpr absl::string_view kPrefilteringThresholdRatioConfig{
@@ -415,6 +527,20 @@ double GetSearchResultBufferMultiplier() {
 
 double GetPrefilteringThresholdRatio() { return prefiltering_threshold_ratio; }
 
+/// Register the "query-planner-cost-model" flag
+/// When enabled, hybrid queries whose filtered space exceeds the
+/// prefiltering threshold ratio choose between pre-filtering and inline
+/// filtering based on a calibrated cost model. When disabled, they always use
+/// inline filtering.
+constexpr absl::string_view kQueryPlannerCostModelConfig{
+    "query-planner-cost-model"};
+static auto query_planner_cost_model =
+    config::BooleanBuilder(kQueryPlannerCostModelConfig, true).Build();
+
+config::Boolean& GetQueryPlannerCostModel() {
+  return dynamic_cast<config::Boolean&>(*query_planner_cost_model);
+}
+
 /// Register the "drain-mutation-queue-on-load" flag
 /// Drain the mutation queue after RDB load
 constexpr absl::string_view kDrainMutationQueueOnLoadConfig{
@@ -578,6 +704,22 @@ config::Boolean& GetHNSWAllowReplaceDeletedMutable() {
   return dynamic_cast<config::Boolean&>(*hnsw_allow_replace_deleted);
 }
 
+const config::Boolean& GetHNSWBuildFlatFallback() {
+  return dynamic_cast<const config::Boolean&>(*hnsw_build_flat_fallback);
+}
+
+config::Boolean& GetHNSWBuildFlatFallbackMutable() {
+  return dynamic_cast<config::Boolean&>(*hnsw_build_flat_fallback);
+}
+
+const config::Boolean& GetHNSWSnapshotReads() {
+  return dynamic_cast<const config::Boolean&>(*hnsw_snapshot_reads);
+}
+
+config::Boolean& GetHNSWSnapshotReadsMutable() {
+  return dynamic_cast<config::Boolean&>(*hnsw_snapshot_reads);
+}
+
 absl::Status Reset() {
   VMSDK_RETURN_IF_ERROR(use_coordinator->SetValue(false));
   VMSDK_RETURN_IF_ERROR(rdb_load_skip_index->SetValue(false));
@@ -617,6 +759,23 @@ vmsdk::config::Number& GetThreadPoolWaitTimeSamples() {
   return dynamic_cast<vmsdk::config::Number&>(*thread_pool_wait_time_samples);
 }
 
+vmsdk::config::Number& GetMaxSearchParallelism() {
+  return dynamic_cast<vmsdk::config::Number&>(*max_search_parallelism);
+}
+
+const vmsdk::config::Boolean& GetAdaptiveTimeSlicing() {
+  return dynamic_cast<const vmsdk::config::Boolean&>(*adaptive_time_slicing);
+}
+
+vmsdk::config::Number& GetTimeSliceReadWaitTarget() {
+  return dynamic_cast<vmsdk::config::Number&>(*time_slice_read_wait_target);
+}
+
+vmsdk::config::Number& GetTimeSliceMutationQueueTarget() {
+  return dynamic_cast<vmsdk::config::Number&>(
+      *time_slice_mutation_queue_target);
+}
+
 vmsdk::config::Number& GetMaxTermExpansions() {
   return dynamic_cast<vmsdk::config::Number&>(*max_term_expansions);
 }
@@ -625,6 +784,18 @@ vmsdk::config::Number& GetTagMinPrefixLength() {
   return dynamic_cast<vmsdk::config::Number&>(*tag_min_prefix_length);
 }
 
+vmsdk::config::Number& GetBackfillMutationBatchSize() {
+  return dynamic_cast<vmsdk::config::Number&>(*backfill_mutation_batch_size);
+}
+
+vmsdk::config::Number& GetMutationGroupCommitSize() {
+  return dynamic_cast<vmsdk::config::Number&>(*mutation_group_commit_size);
+}
+
+vmsdk::config::Number& GetHashScanMinAttributes() {
+  return dynamic_cast<vmsdk::config::Number&>(*hash_scan_min_attributes);
+}
+
 const vmsdk::config::Boolean& GetDrainMutationQueueOnSave() {
   return dynamic_cast<const vmsdk::config::Boolean&>(
       *drain_mutation_queue_on_save);
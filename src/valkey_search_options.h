@@ -62,6 +62,20 @@ const config::Boolean& GetHNSWAllowReplaceDeleted();
 /// Return a mutable reference for testing
 config::Boolean& GetHNSWAllowReplaceDeletedMutable();
 
+/// Return the configuration entry for serving HNSW queries with an exact scan
+/// while the index is rebuilt
+const config::Boolean& GetHNSWBuildFlatFallback();
+
+/// Return a mutable reference for testing
+config::Boolean& GetHNSWBuildFlatFallbackMutable();
+
+/// Return the configuration entry for serving unfiltered HNSW queries outside
+/// of the read phase of the index
+const config::Boolean& GetHNSWSnapshotReads();
+
+/// Return a mutable reference for testing
+config::Boolean& GetHNSWSnapshotReadsMutable();
+
 /// Reset the state of the options (mainly needed for testing)
 absl::Status Reset();
 
@@ -87,6 +101,20 @@ config::Number& GetLocalFanoutQueueWaitThreshold();
 /// Return the sample queue size for thread pool wait time tracking
 config::Number& GetThreadPoolWaitTimeSamples();
 
+/// Return the maximum number of reader threads a single search is split
+/// across
+config::Number& GetMaxSearchParallelism();
+
+/// Return true if the time quotas of the indexes adapt to their backlogs
+const config::Boolean& GetAdaptiveTimeSlicing();
+
+/// Return the target of adaptive time slicing for the average wait of the read
+/// locks of an index for a read phase (milliseconds)
+config::Number& GetTimeSliceReadWaitTarget();
+
+/// Return the per index mutation queue target of adaptive time slicing
+config::Number& GetTimeSliceMutationQueueTarget();
+
 /// Return the maximum number of words to search in text operations (prefix,
 /// suffix, fuzzy)
 config::Number& GetMaxTermExpansions();
@@ -94,12 +122,25 @@ config::Number& GetMaxTermExpansions();
 /// Return the minimum TAG prefix length for wildcard queries (excluding '*')
 config::Number& GetTagMinPrefixLength();
 
+/// Return the number of backfilled keys indexed by a single mutation task
+config::Number& GetBackfillMutationBatchSize();
+
+/// Return the maximum number of pending keys indexed by a single mutation task
+config::Number& GetMutationGroupCommitSize();
+
+/// Return the minimum number of attributes of a HASH schema for which mutated
+/// keys are scanned once rather than looked up per attribute
+config::Number& GetHashScanMinAttributes();
+
 /// Return the search result buffer multiplier value
 double GetSearchResultBufferMultiplier();
 
 /// Return the prefiltering threshold ratio value
 double GetPrefilteringThresholdRatio();
 
+/// Return the configuration entry for the cost based query planner
+config::Boolean& GetQueryPlannerCostModel();
+
 /// Return the configuration entry for draining mutation queue on save
 const config::Boolean& GetDrainMutationQueueOnSave();
 
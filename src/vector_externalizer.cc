@@ -17,6 +17,8 @@
 #include "absl/log/check.h"
 #include "absl/strings/string_view.h"
 #include "src/attribute_data_type.h"
+#include "src/index_schema.pb.h"
+#include "src/indexes/vector_data_type.h"
 #include "src/utils/lru.h"
 #include "src/utils/string_interning.h"
 #include "vmsdk/src/managed_pointers.h"
@@ -27,15 +29,24 @@ namespace valkey_search {
 VectorExternalizer::VectorExternalizer()
     : lru_cache_(std::make_unique<LRU<LRUCacheEntry>>(kLRUCapacity)) {}
 
-std::vector<char> DenormalizeVector(absl::string_view record, size_t type_size,
-                                    float magnitude) {
+std::vector<char> DenormalizeVector(
+    absl::string_view record, data_model::VectorDataType vector_data_type,
+    float magnitude) {
   std::vector<char> ret(record.size());
-  if (type_size == sizeof(float)) {
+  if (indexes::IsHalfPrecision(vector_data_type)) {
+    auto values = indexes::HalfPrecisionToFloat(record, vector_data_type);
+    CopyAndDenormalizeEmbedding(values.data(), values.data(), values.size(),
+                                magnitude);
+    indexes::FloatToHalfPrecision(values.data(), values.size(),
+                                  vector_data_type, ret.data());
+    return ret;
+  }
+  if (vector_data_type == data_model::VECTOR_DATA_TYPE_FLOAT32) {
     CopyAndDenormalizeEmbedding((float*)ret.data(), (float*)record.data(),
                                 ret.size() / sizeof(float), magnitude);
     return ret;
   }
-  CHECK(false) << "unsupported type size";
+  CHECK(false) << "unsupported vector data type";
 }
 
 char* ExternalizeCB(void* cb_data, size_t* len) {
@@ -53,9 +64,9 @@ char* ExternalizeCB(void* cb_data, size_t* len) {
     return (char*)ptr;
   }
   if (vector_externalizer_entry->magnitude.has_value()) {
-    auto vector =
-        DenormalizeVector(vector_externalizer_entry->vector->Str(),
-                          sizeof(float), *vector_externalizer_entry->magnitude);
+    auto vector = DenormalizeVector(vector_externalizer_entry->vector->Str(),
+                                    vector_externalizer_entry->vector_data_type,
+                                    *vector_externalizer_entry->magnitude);
     vector_externalizer_entry->cache_normalized_ =
         std::make_unique<VectorExternalizer::LRUCacheEntry>(
             std::move(vector), vector_externalizer_entry);
@@ -105,7 +116,8 @@ VectorExternalizer::LRUCacheEntry::~LRUCacheEntry() {
 bool VectorExternalizer::Externalize(
     const InternedStringPtr& key, absl::string_view attribute_identifier,
     data_model::AttributeDataType attribute_data_type,
-    const InternedStringPtr& vector, std::optional<float> magnitude) {
+    const InternedStringPtr& vector, std::optional<float> magnitude,
+    data_model::VectorDataType vector_data_type) {
   if (!hash_registration_supported_ ||
       attribute_data_type !=
           data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH) {
@@ -115,14 +127,14 @@ bool VectorExternalizer::Externalize(
   // This ensures that consecutive reads of the record do not lose precision due
   // to vector denormalization.
   auto& deferred_shared_vectors = deferred_shared_vectors_.Get();
-  VectorExternalizerEntry entry = {vector, magnitude};
+  VectorExternalizerEntry entry = {vector, magnitude, vector_data_type};
   auto result = deferred_shared_vectors[key].emplace(attribute_identifier,
                                                      std::move(entry));
   if (!result.second) {
     // To maintain precision and reduce denormalization overhead, prefer
     // externalizing the unnormalized vector, if available.
     if (result.first->second.magnitude != std::nullopt) {
-      VectorExternalizerEntry tmp = {vector, magnitude};
+      VectorExternalizerEntry tmp = {vector, magnitude, vector_data_type};
       result.first->second = std::move(tmp);
     }
   }
@@ -240,6 +252,57 @@ vmsdk::UniqueValkeyString VectorExternalizer::GetRecord(
   return std::move(res.value());
 }
 
+namespace {
+
+struct ScanRecordsData {
+  VectorExternalizer::FetchedRecords& records;
+  size_t generated_value_cnt;
+};
+
+}  // namespace
+
+void VectorExternalizer::ScanRecordsCallback(ValkeyModuleKey* key,
+                                             ValkeyModuleString* field,
+                                             ValkeyModuleString* value,
+                                             void* privdata) {
+  auto data = static_cast<ScanRecordsData*>(privdata);
+  // The engine generates the values of externalized fields as they are
+  // scanned, see ExternalizeCB.
+  auto generated_value_cnt = Instance().stats_.Get().generated_value_cnt;
+  bool is_module_owned = generated_value_cnt != data->generated_value_cnt;
+  data->generated_value_cnt = generated_value_cnt;
+  if (!field || !value) {
+    return;
+  }
+  auto it = data->records.find(vmsdk::ToStringView(field));
+  if (it == data->records.end()) {
+    return;
+  }
+  it->second.record = vmsdk::RetainUniqueValkeyString(value);
+  it->second.is_module_owned = is_module_owned;
+}
+
+void VectorExternalizer::GetRecords(
+    ValkeyModuleCtx* ctx, const AttributeDataType* attribute_data_type,
+    ValkeyModuleKey* key_obj, absl::string_view key_cstr, bool scan_hash,
+    FetchedRecords& records) {
+  vmsdk::VerifyMainThread();
+  if (scan_hash &&
+      attribute_data_type->ToProto() ==
+          data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH) {
+    ScanRecordsData data{records, stats_.Get().generated_value_cnt};
+    vmsdk::UniqueValkeyScanCursor cursor = vmsdk::MakeUniqueValkeyScanCursor();
+    while (ValkeyModule_ScanKey(key_obj, cursor.get(), ScanRecordsCallback,
+                                &data)) {
+    }
+    return;
+  }
+  for (auto& [identifier, fetched] : records) {
+    fetched.record = GetRecord(ctx, attribute_data_type, key_obj, key_cstr,
+                               identifier, fetched.is_module_owned);
+  }
+}
+
 void VectorExternalizer::Reset() {
   ctx_.Get().reset();
   stats_.Get() = Stats();
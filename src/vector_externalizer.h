@@ -30,8 +30,9 @@ namespace valkey_search {
 
 constexpr size_t kLRUCapacity = 100;
 char* ExternalizeCB(void* cb_data, size_t* len);
-std::vector<char> DenormalizeVector(absl::string_view record, size_t type_size,
-                                    float magnitude);
+std::vector<char> DenormalizeVector(
+    absl::string_view record, data_model::VectorDataType vector_data_type,
+    float magnitude);
 
 class VectorExternalizer {
  public:
@@ -44,7 +45,8 @@ class VectorExternalizer {
                    absl::string_view attribute_identifier,
                    data_model::AttributeDataType attribute_data_type,
                    const InternedStringPtr& vector,
-                   std::optional<float> magnitude);
+                   std::optional<float> magnitude,
+                   data_model::VectorDataType vector_data_type);
   void Remove(const InternedStringPtr& key,
               absl::string_view attribute_identifier,
               data_model::AttributeDataType attribute_data_type);
@@ -75,6 +77,8 @@ class VectorExternalizer {
   struct VectorExternalizerEntry {
     InternedStringPtr vector;
     std::optional<float> magnitude;
+    data_model::VectorDataType vector_data_type{
+        data_model::VECTOR_DATA_TYPE_FLOAT32};
     // We cache the normalized vector to ensure that the generated normalized
     // vector string remains alive until the engine deep copy it.
     std::unique_ptr<LRUCacheEntry> cache_normalized_;
@@ -92,11 +96,30 @@ class VectorExternalizer {
       ValkeyModuleKey* key_obj, absl::string_view key_cstr,
       absl::string_view attribute_identifier, bool& is_module_owned);
 
+  struct FetchedRecord {
+    vmsdk::UniqueValkeyString record;
+    bool is_module_owned{false};
+    // Number of attributes of the schema indexing the identifier.
+    size_t uses{0};
+  };
+  // Fetched records, keyed by attribute identifier.
+  using FetchedRecords = absl::flat_hash_map<absl::string_view, FetchedRecord>;
+  // Fetches the records of all the identifiers of `records`, leaving missing
+  // ones null. With `scan_hash`, the records of a HASH key are extracted in a
+  // single scan of the hash rather than with one lookup per identifier.
+  void GetRecords(ValkeyModuleCtx* ctx,
+                  const AttributeDataType* attribute_data_type,
+                  ValkeyModuleKey* key_obj, absl::string_view key_cstr,
+                  bool scan_hash, FetchedRecords& records);
+
   // Used for testing.
   void Reset();
 
  private:
   VectorExternalizer();
+  static void ScanRecordsCallback(ValkeyModuleKey* key,
+                                  ValkeyModuleString* field,
+                                  ValkeyModuleString* value, void* privdata);
 
   vmsdk::MainThreadAccessGuard<InternedStringHashMap<
       absl::flat_hash_map<std::string, VectorExternalizerEntry>>>
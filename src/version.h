@@ -94,7 +94,8 @@ constexpr vmsdk::ValkeyVersion kRelease10(1, 0, 0);
 constexpr vmsdk::ValkeyVersion kRelease11(1, 1, 0);
 
 //
-// Release 1.2, added support for full text search.
+// Release 1.2, added support for full text search, quantized vector indexes
+// and half precision vector data types.
 //
 constexpr vmsdk::ValkeyVersion kRelease12(1, 2, 0);
 
@@ -38,6 +38,7 @@
 #include "src/rdb_serialization.h"
 #include "src/schema_manager.h"
 #include "src/server_events.h"
+#include "src/utils/doc_id_map.h"
 #include "src/utils/string_interning.h"
 #include "src/valkey_search.h"
 #include "src/vector_externalizer.h"
@@ -53,6 +54,8 @@ template <typename T, typename K>
 class IndexTeser : public T {
  public:
   explicit IndexTeser(K proto) : T(K(proto)) {}
+  IndexTeser(K proto, std::shared_ptr<DocIdMap> doc_ids)
+      : T(K(proto), std::move(doc_ids)) {}
   absl::StatusOr<bool> AddRecord(absl::string_view key,
                                  absl::string_view data) {
     auto interned_key = StringInternStore::Intern(key);
@@ -215,6 +218,10 @@ data_model::VectorIndex CreateFlatVectorIndexProto(
     int dimensions, data_model::DistanceMetric distance_metric, int initial_cap,
     uint32_t block_size);
 
+data_model::VectorIndex CreateIVFPQVectorIndexProto(
+    int dimensions, data_model::DistanceMetric distance_metric, int initial_cap,
+    uint32_t nlist, uint32_t pq_m, uint32_t nprobe);
+
 data_model::NumericIndex CreateNumericIndexProto();
 
 data_model::TagIndex CreateTagIndexProto(const std::string& separator = ",",
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2025, valkey-search contributors
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD 3-Clause
+ *
+ */
+
+#include "src/indexes/doc_id_set_fetcher.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "src/indexes/index_base.h"
+#include "src/indexes/numeric.h"
+#include "src/indexes/tag.h"
+#include "src/query/predicate.h"
+#include "src/utils/doc_id_bitmap.h"
+#include "src/utils/doc_id_map.h"
+#include "src/utils/string_interning.h"
+#include "testing/common.h"
+#include "vmsdk/src/testing_infra/utils.h"
+
+namespace valkey_search::indexes {
+
+namespace {
+
+using testing::UnorderedElementsAre;
+using testing::UnorderedElementsAreArray;
+
+std::vector<std::string> Keys(EntriesFetcherBase& fetcher) {
+  std::vector<std::string> keys;
+  for (auto iterator = fetcher.Begin(); !iterator->Done(); iterator->Next()) {
+    keys.emplace_back((**iterator)->Str());
+  }
+  return keys;
+}
+
+class DocIdSetFetcherTest : public vmsdk::ValkeyTest {
+ protected:
+  void SetUp() override {
+    vmsdk::ValkeyTest::SetUp();
+    data_model::TagIndex tag_index_proto;
+    tag_index_proto.set_separator(",");
+    tag_index_proto.set_case_sensitive(false);
+    tag_index_ = std::make_unique<IndexTeser<Tag, data_model::TagIndex>>(
+        tag_index_proto, doc_ids_);
+    numeric_index_ =
+        std::make_unique<IndexTeser<Numeric, data_model::NumericIndex>>(
+            data_model::NumericIndex{}, doc_ids_);
+  }
+  std::shared_ptr<DocIdMap> doc_ids_ = std::make_shared<DocIdMap>();
+  std::unique_ptr<IndexTeser<Tag, data_model::TagIndex>> tag_index_;
+  std::unique_ptr<IndexTeser<Numeric, data_model::NumericIndex>>
+      numeric_index_;
+};
+
+TEST_F(DocIdSetFetcherTest, IndexesShareDocIds) {
+  VMSDK_EXPECT_OK(tag_index_->AddRecord("key1", "a"));
+  VMSDK_EXPECT_OK(numeric_index_->AddRecord("key1", "1"));
+  VMSDK_EXPECT_OK(numeric_index_->AddRecord("key2", "2"));
+  EXPECT_EQ(doc_ids_->Size(), 2);
+  auto id = doc_ids_->Find(StringInternStore::Intern("key1"));
+  ASSERT_TRUE(id.has_value());
+  EXPECT_EQ(doc_ids_->GetKey(*id)->Str(), "key1");
+
+  // The id is kept until the last index releases the key.
+  VMSDK_EXPECT_OK(tag_index_->RemoveRecord("key1", DeletionType::kRecord));
+  EXPECT_EQ(doc_ids_->Find(StringInternStore::Intern("key1")), id);
+  VMSDK_EXPECT_OK(numeric_index_->RemoveRecord("key1", DeletionType::kRecord));
+  EXPECT_FALSE(doc_ids_->Find(StringInternStore::Intern("key1")).has_value());
+  EXPECT_EQ(doc_ids_->Size(), 1);
+
+  // Released ids are recycled.
+  VMSDK_EXPECT_OK(tag_index_->AddRecord("key3", "a"));
+  EXPECT_EQ(doc_ids_->Find(StringInternStore::Intern("key3")), id);
+}
+
+TEST_F(DocIdSetFetcherTest, TagAndNumericPostings) {
+  for (int i = 0; i < 100; ++i) {
+    auto key = absl::StrCat("key", i);
+    std::string tags = i % 2 == 0 ? "even" : "odd";
+    if (i % 3 == 0) {
+      absl::StrAppend(&tags, ",three,tri");
+    }
+    VMSDK_EXPECT_OK(tag_index_->AddRecord(key, tags));
+    VMSDK_EXPECT_OK(numeric_index_->AddRecord(key, std::to_string(i)));
+  }
+  // The prefix matches both "three" and "tri", so every key is fetched twice
+  // by the tag fetcher but only once from its doc ids.
+  query::TagPredicate tag_predicate(tag_index_.get(), "attribute_alias",
+                                    "attribute_id", "t*", {"t*"});
+  auto tag_fetcher = tag_index_->Search(tag_predicate, false);
+  EXPECT_EQ(tag_fetcher->Size(), 68);
+  auto tag_doc_ids = tag_fetcher->GetDocIds();
+  EXPECT_EQ(tag_doc_ids.size(), 34);
+
+  query::NumericPredicate numeric_predicate(numeric_index_.get(),
+                                            "attribute_alias", "attribute_id",
+                                            10, true, 20, false);
+  auto numeric_fetcher = numeric_index_->Search(numeric_predicate, false);
+  auto numeric_doc_ids = numeric_fetcher->GetDocIds();
+  EXPECT_EQ(numeric_doc_ids.size(), 10);
+  EXPECT_EQ(&tag_fetcher->GetDocIdMap(), &numeric_fetcher->GetDocIdMap());
+
+  DocIdSetFetcher intersection(*doc_ids_, tag_doc_ids & numeric_doc_ids);
+  EXPECT_EQ(intersection.Size(), 3);
+  EXPECT_THAT(Keys(intersection),
+              UnorderedElementsAre("key12", "key15", "key18"));
+
+  DocIdSetFetcher doc_id_union(*doc_ids_, tag_doc_ids | numeric_doc_ids);
+  EXPECT_EQ(doc_id_union.Size(), 41);
+  EXPECT_THAT(Keys(doc_id_union), testing::SizeIs(41));
+}
+
+TEST_F(DocIdSetFetcherTest, ModifiedRecordsKeepTheirId) {
+  VMSDK_EXPECT_OK(tag_index_->AddRecord("key1", "a,b"));
+  VMSDK_EXPECT_OK(numeric_index_->AddRecord("key1", "1"));
+  auto id = doc_ids_->Find(StringInternStore::Intern("key1"));
+  VMSDK_EXPECT_OK(tag_index_->ModifyRecord("key1", "b,c"));
+  VMSDK_EXPECT_OK(numeric_index_->ModifyRecord("key1", "5"));
+  EXPECT_EQ(doc_ids_->Find(StringInternStore::Intern("key1")), id);
+
+  query::TagPredicate tag_predicate(tag_index_.get(), "attribute_alias",
+                                    "attribute_id", "c", {"c"});
+  auto tag_fetcher = tag_index_->Search(tag_predicate, false);
+  EXPECT_THAT(Keys(*tag_fetcher), UnorderedElementsAreArray({"key1"}));
+  query::TagPredicate stale_predicate(tag_index_.get(), "attribute_alias",
+                                      "attribute_id", "a", {"a"});
+  EXPECT_TRUE(tag_index_->Search(stale_predicate, false)->GetDocIds().empty());
+}
+
+TEST_F(DocIdSetFetcherTest, EmptySet) {
+  DocIdSetFetcher fetcher(*doc_ids_, DocIdBitmap());
+  EXPECT_EQ(fetcher.Size(), 0);
+  EXPECT_TRUE(fetcher.Begin()->Done());
+}
+
+}  // namespace
+
+}  // namespace valkey_search::indexes
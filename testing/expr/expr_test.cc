@@ -8,8 +8,11 @@
 
 #include <map>
 #include <set>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "gtest/gtest.h"
 #include "src/expr/value.h"
 
@@ -175,5 +178,32 @@ TEST_F(ExprTest, TypesTest) {
   }
 }
 
+TEST_F(ExprTest, BatchTest) {
+  std::vector<Record> records(5);
+  for (size_t i = 0; i < records.size(); ++i) {
+    records[i].attrs["one"] = Value(double(i));
+    if (i % 2) {
+      records[i].attrs["two"] = Value(absl::StrCat("s", i));
+    }
+  }
+  std::vector<const Expression::Record*> rows;
+  for (auto& record : records) {
+    rows.push_back(&record);
+  }
+  for (auto text : {"1", "$two", "@one", "@two", "!@one", "@one*2+1",
+                    "@one>=2 && @one<4", "exists(@two)", "concat(@two, 'x')",
+                    "!(@one==3)"}) {
+    auto e = Expression::Compile(cc, text);
+    ASSERT_TRUE(e.ok()) << text;
+    Expression::EvalContext ec;
+    std::vector<Value> results(rows.size());
+    (*e)->EvaluateBatch(ec, rows, absl::MakeSpan(results));
+    for (size_t i = 0; i < records.size(); ++i) {
+      EXPECT_EQ(results[i], (*e)->Evaluate(ec, records[i]))
+          << text << " record " << i;
+    }
+  }
+}
+
 }  // namespace expr
 }  // namespace valkey_search
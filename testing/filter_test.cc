@@ -7,7 +7,9 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "absl/types/span.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "src/commands/filter_parser.h"
@@ -15,6 +17,7 @@
 #include "src/indexes/numeric.h"
 #include "src/indexes/tag.h"
 #include "src/indexes/text.h"
+#include "src/query/predicate_program.h"
 #include "src/utils/string_interning.h"
 #include "testing/common.h"
 namespace valkey_search {
@@ -163,6 +166,27 @@ TEST_P(FilterTest, ParseParams) {
                 evaluator.Evaluate(*parse_results.value().root_predicate,
                                    interned_key));
     }
+
+    // Filters without text clauses compile and must agree with the evaluator,
+    // both per key and within a batch.
+    auto program = query::PredicateProgram::Compile(
+        *parse_results.value().root_predicate);
+    if (program.has_value()) {
+      EXPECT_EQ(test_case.evaluate_success.value(),
+                program->Matches(interned_key));
+      auto missing_key = StringInternStore::Intern("missing_key");
+      indexes::PrefilterEvaluator evaluator(
+          nullptr, parse_results.value().query_operations);
+      bool missing_key_matches = evaluator.Evaluate(
+          *parse_results.value().root_predicate, missing_key);
+      std::vector<InternedStringPtr> keys{interned_key, missing_key,
+                                          interned_key};
+      bool matches[3];
+      program->EvaluateBatch(keys, absl::MakeSpan(matches));
+      EXPECT_EQ(matches[0], test_case.evaluate_success.value());
+      EXPECT_EQ(matches[1], missing_key_matches);
+      EXPECT_EQ(matches[2], test_case.evaluate_success.value());
+    }
   }
 }
 
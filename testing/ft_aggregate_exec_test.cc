@@ -6,8 +6,13 @@
 
 #include "src/commands/ft_aggregate_exec.h"
 
+#include <algorithm>
+
 #include "gtest/gtest.h"
 #include "src/commands/ft_aggregate_parser.h"
+#include "src/coordinator/coordinator.pb.h"
+#include "src/query/partial_aggregate.h"
+#include "src/utils/string_interning.h"
 #include "vmsdk/src/testing_infra/utils.h"
 
 namespace valkey_search {
@@ -269,6 +274,113 @@ TEST_F(AggregateExecTest, ReducerTest) {
     }
   }
 }
+TEST_F(AggregateExecTest, MultipleBatchesTest) {
+  // More records than a single evaluation batch holds.
+  const size_t m = 2500;
+  auto param = MakeStages(
+      "apply @n1*2 as x filter @x>=10 sortby 2 @x desc max 3 "
+      "groupby 1 @n2 reduce sum 1 @x reduce count 0");
+  auto records = MakeData(m);
+  for (auto i = 0; i < 3; ++i) {
+    EXPECT_TRUE((param->stages_[i]->Execute(records)).ok());
+  }
+  ASSERT_EQ(records.size(), 3);
+  for (auto i = 0; i < 3; ++i) {
+    EXPECT_EQ(records[i]->fields_[0], expr::Value(double(m - 1 - i)));
+    EXPECT_EQ(records[i]->fields_[2], expr::Value(double(2 * (m - 1 - i))));
+  }
+
+  records = MakeData(m);
+  EXPECT_TRUE((param->stages_[0]->Execute(records)).ok());
+  EXPECT_TRUE((param->stages_[1]->Execute(records)).ok());
+  EXPECT_EQ(records.size(), m - 5);
+  EXPECT_TRUE((param->stages_[3]->Execute(records)).ok());
+  ASSERT_EQ(records.size(), 1);
+  auto record = records.pop_front();
+  EXPECT_EQ(record->fields_.at(3), expr::Value(double(m * (m - 1) - 20)));
+  EXPECT_EQ(record->fields_.at(4), expr::Value(double(m - 5)));
+}
+
+TEST_F(AggregateExecTest, PartialGroupByTest) {
+  const size_t m = 100;
+  const size_t shards = 3;
+  auto param = MakeStages(
+      "groupby 1 @n2 reduce count 0 reduce sum 1 @n1 reduce min 1 @n1 "
+      "reduce max 1 @n1 reduce avg 1 @n1 reduce stddev 1 @n1 "
+      "reduce count_distinct 1 @n1");
+  const auto& group_by = dynamic_cast<const GroupBy&>(*param->stages_[0]);
+  coordinator::PartialAggregate plan;
+  for (auto name : {"n1", "n2"}) {
+    auto* field = plan.add_fields();
+    field->set_identifier(name);
+    field->set_alias(name);
+    field->set_numeric(true);
+  }
+  plan.add_group_by(1);
+  for (const auto& reducer : group_by.reducers_) {
+    auto* partial = plan.add_reducers();
+    partial->set_name(reducer.info_->name_);
+    if (!reducer.args_.empty()) {
+      partial->set_field(0);
+    }
+  }
+  ASSERT_TRUE(query::PartialAggregator::Validate(plan).ok());
+
+  // Every shard groups its share of the records, the coordinator merges.
+  RecordSet expected(nullptr);
+  std::vector<query::PartialAggregator> shard_aggregators;
+  for (size_t i = 0; i < shards; ++i) {
+    shard_aggregators.emplace_back(
+        plan, data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH);
+  }
+  for (size_t i = 0; i < m; ++i) {
+    auto n1 = std::to_string(i % 40);
+    auto n2 = std::to_string(i % 7);
+    RecordsMap contents;
+    for (auto [name, value] : {std::pair{"n1", n1}, std::pair{"n2", n2}}) {
+      auto identifier = vmsdk::MakeUniqueValkeyString(name);
+      auto identifier_view = vmsdk::ToStringView(identifier.get());
+      contents.emplace(identifier_view,
+                       RecordsMapValue(std::move(identifier),
+                                       vmsdk::MakeUniqueValkeyString(value)));
+    }
+    indexes::Neighbor neighbor(
+        StringInternStore::Intern(absl::StrCat("key", i)), 0,
+        std::move(contents));
+    shard_aggregators[i % shards].Add(neighbor);
+    auto record = std::make_unique<Record>(2);
+    record->fields_[0] = expr::Value(double(i % 40));
+    record->fields_[1] = expr::Value(double(i % 7));
+    expected.push_back(std::move(record));
+  }
+  EXPECT_TRUE(group_by.Execute(expected).ok());
+
+  query::PartialAggregator merged(
+      plan, data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH);
+  for (const auto& aggregator : shard_aggregators) {
+    coordinator::SearchIndexPartitionResponse response;
+    aggregator.Serialize(response.mutable_partial_groups());
+    merged.Merge(response.partial_groups());
+  }
+  EXPECT_EQ(merged.GroupCount(), 7);
+  RecordSet records(nullptr);
+  merged.ForEachGroup([&](absl::Span<const expr::Value> keys,
+                          absl::Span<const expr::Value> results) {
+    records.push_back(group_by.MakeGroupRecord(2, keys, results));
+  });
+
+  auto by_group = [](const RecordPtr& l, const RecordPtr& r) {
+    return l->fields_[1] < r->fields_[1];
+  };
+  std::sort(expected.begin(), expected.end(), by_group);
+  std::sort(records.begin(), records.end(), by_group);
+  ASSERT_EQ(records.size(), expected.size());
+  for (size_t i = 0; i < records.size(); ++i) {
+    EXPECT_EQ(*records[i], *expected[i]) << *records[i] << " vs "
+                                         << *expected[i];
+  }
+}
+
 /*
 TEST_F(AggregateExecTest, testHash) {
   GroupKey key1({expr::Value(1.0), expr::Value(2.0)});
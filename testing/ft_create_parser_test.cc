@@ -76,6 +76,7 @@ struct FTCreateParserTestCase {
   int text_field_count{0};
   std::vector<HNSWParameters> hnsw_parameters;
   std::vector<FlatParameters> flat_parameters;
+  std::vector<IVFPQParameters> ivf_pq_parameters;
   std::vector<FTCreateTagParameters> tag_parameters;
   std::vector<PerFieldTextParams> text_parameters;
   FTCreateParameters expected;
@@ -93,6 +94,9 @@ void VerifyVectorParams(const data_model::VectorIndex &vector_index_proto,
   EXPECT_EQ(vector_index_proto.vector_data_type(),
             expected_params->vector_data_type);
   EXPECT_EQ(vector_index_proto.initial_cap(), expected_params->initial_cap);
+  EXPECT_EQ(vector_index_proto.quantization(), expected_params->quantization);
+  EXPECT_EQ(vector_index_proto.rerank_factor(),
+            expected_params->rerank_factor);
 }
 
 TEST_P(FTCreateParserTest, ParseParams) {
@@ -172,6 +176,7 @@ TEST_P(FTCreateParserTest, ParseParams) {
 
     auto hnsw_index = 0;
     auto flat_index = 0;
+    auto ivf_pq_index = 0;
     auto tag_index = 0;
     auto text_index = 0;
     for (auto i = 0; i < index_schema_proto->attributes().size(); ++i) {
@@ -214,6 +219,26 @@ TEST_P(FTCreateParserTest, ParseParams) {
                   test_case.hnsw_parameters[hnsw_index].ef_runtime);
         EXPECT_EQ(hnsw_proto.m(), test_case.hnsw_parameters[hnsw_index].m);
         ++hnsw_index;
+      } else if (test_case.expected.attributes[i].indexer_type ==
+                 indexes::IndexerType::kIVFPQ) {
+        EXPECT_TRUE(index_schema_proto->attributes(i)
+                        .index()
+                        .vector_index()
+                        .has_ivf_pq_algorithm());
+        VerifyVectorParams(
+            index_schema_proto->attributes(i).index().vector_index(),
+            &test_case.ivf_pq_parameters[ivf_pq_index]);
+        auto ivf_pq_proto = index_schema_proto->attributes(i)
+                                .index()
+                                .vector_index()
+                                .ivf_pq_algorithm();
+        EXPECT_EQ(ivf_pq_proto.nlist(),
+                  test_case.ivf_pq_parameters[ivf_pq_index].nlist);
+        EXPECT_EQ(ivf_pq_proto.pq_m(),
+                  test_case.ivf_pq_parameters[ivf_pq_index].pq_m);
+        EXPECT_EQ(ivf_pq_proto.nprobe(),
+                  test_case.ivf_pq_parameters[ivf_pq_index].nprobe);
+        ++ivf_pq_index;
       } else if (test_case.expected.attributes[i].indexer_type ==
                  indexes::IndexerType::kNumeric) {
         EXPECT_TRUE(
@@ -322,6 +347,117 @@ INSTANTIATE_TEST_SUITE_P(
                               .indexer_type = indexes::IndexerType::kFlat,
                           }}},
          },
+         {
+             .test_name = "happy_path_hnsw_quantized",
+             .success = true,
+             .command_str = " idx1 on HASH SChema hash_field1 as "
+                            "hash_field11 vector hnsw 10 TYPE  FLOAT32 DIM 3  "
+                            "DISTANCE_METRIC COSINE QUANTIZE sq8 RERANK 4 ",
+             .hnsw_parameters = {{
+                 {
+                     .dimensions = 3,
+                     .distance_metric = data_model::DISTANCE_METRIC_COSINE,
+                     .vector_data_type = data_model::VECTOR_DATA_TYPE_FLOAT32,
+                     .quantization = data_model::VECTOR_QUANTIZATION_SQ8,
+                     .rerank_factor = 4,
+                 },
+             }},
+             .expected = {.index_schema_name = "idx1",
+                          .on_data_type = data_model::ATTRIBUTE_DATA_TYPE_HASH,
+                          .attributes = {{
+                              .identifier = "hash_field1",
+                              .attribute_alias = "hash_field11",
+                              .indexer_type = indexes::IndexerType::kHNSW,
+                          }}},
+         },
+         {
+             .test_name = "happy_path_flat_quantized",
+             .success = true,
+             .command_str = " idx1 on HASH SChema hash_field1 as "
+                            "hash_field11 vector flat 8 TYPE  FLOAT32 DIM 3  "
+                            "DISTANCE_METRIC L2 QUANTIZE BQ ",
+             .flat_parameters = {{
+                 {
+                     .dimensions = 3,
+                     .distance_metric = data_model::DISTANCE_METRIC_L2,
+                     .vector_data_type = data_model::VECTOR_DATA_TYPE_FLOAT32,
+                     .quantization = data_model::VECTOR_QUANTIZATION_BQ,
+                 },
+             }},
+             .expected = {.index_schema_name = "idx1",
+                          .on_data_type = data_model::ATTRIBUTE_DATA_TYPE_HASH,
+                          .attributes = {{
+                              .identifier = "hash_field1",
+                              .attribute_alias = "hash_field11",
+                              .indexer_type = indexes::IndexerType::kFlat,
+                          }}},
+         },
+         {
+             .test_name = "happy_path_flat_float16",
+             .success = true,
+             .command_str = " idx1 on HASH SChema hash_field1 as "
+                            "hash_field11 vector flat 6 TYPE  FLOAT16 DIM 3  "
+                            "DISTANCE_METRIC L2 ",
+             .flat_parameters = {{
+                 {
+                     .dimensions = 3,
+                     .distance_metric = data_model::DISTANCE_METRIC_L2,
+                     .vector_data_type = data_model::VECTOR_DATA_TYPE_FLOAT16,
+                 },
+             }},
+             .expected = {.index_schema_name = "idx1",
+                          .on_data_type = data_model::ATTRIBUTE_DATA_TYPE_HASH,
+                          .attributes = {{
+                              .identifier = "hash_field1",
+                              .attribute_alias = "hash_field11",
+                              .indexer_type = indexes::IndexerType::kFlat,
+                          }}},
+         },
+         {
+             .test_name = "happy_path_ivf_pq",
+             .success = true,
+             .command_str = " idx1 on HASH SChema hash_field1 as "
+                            "hash_field11 vector ivf_pq 12 TYPE  FLOAT32 DIM 8 "
+                            "DISTANCE_METRIC L2 NLIST 64 PQ_M 4 NPROBE 16 ",
+             .ivf_pq_parameters = {{
+                 {
+                     .dimensions = 8,
+                     .distance_metric = data_model::DISTANCE_METRIC_L2,
+                     .vector_data_type = data_model::VECTOR_DATA_TYPE_FLOAT32,
+                 },
+                 /* .nlist =*/64,
+                 /* .pq_m =*/4,
+                 /* .nprobe =*/16,
+             }},
+             .expected = {.index_schema_name = "idx1",
+                          .on_data_type = data_model::ATTRIBUTE_DATA_TYPE_HASH,
+                          .attributes = {{
+                              .identifier = "hash_field1",
+                              .attribute_alias = "hash_field11",
+                              .indexer_type = indexes::IndexerType::kIVFPQ,
+                          }}},
+         },
+         {
+             .test_name = "happy_path_ivf_pq_defaults",
+             .success = true,
+             .command_str = " idx1 on HASH SChema hash_field1 as "
+                            "hash_field11 vector ivf_pq 6 TYPE  FLOAT32 DIM 8 "
+                            "DISTANCE_METRIC COSINE ",
+             .ivf_pq_parameters = {{
+                 {
+                     .dimensions = 8,
+                     .distance_metric = data_model::DISTANCE_METRIC_COSINE,
+                     .vector_data_type = data_model::VECTOR_DATA_TYPE_FLOAT32,
+                 },
+             }},
+             .expected = {.index_schema_name = "idx1",
+                          .on_data_type = data_model::ATTRIBUTE_DATA_TYPE_HASH,
+                          .attributes = {{
+                              .identifier = "hash_field1",
+                              .attribute_alias = "hash_field11",
+                              .indexer_type = indexes::IndexerType::kIVFPQ,
+                          }}},
+         },
          {
              .test_name = "happy_path_hnsw_and_numeric",
              .success = true,
@@ -747,6 +883,68 @@ INSTANTIATE_TEST_SUITE_P(
                  "Value below minimum; EF_RUNTIME must be a positive integer "
                  "greater than 0 and cannot exceed 1000000.",
          },
+         {
+             .test_name = "invalid_ivf_pq_nprobe_above_nlist",
+             .success = false,
+             .command_str = "idx1 SChema hash_field1 as "
+                            "hash_field11 vector ivf_pq 10 TYPE  FLOAT32 DIM 8 "
+                            "DISTANCE_METRIC IP NLIST 4 NPROBE 5",
+             .expected_error_message =
+                 "Invalid field type for field `hash_field1`: Invalid range: "
+                 "Value above maximum; NPROBE must be a positive integer "
+                 "greater than 0 and cannot exceed NLIST.",
+         },
+         {
+             .test_name = "invalid_ivf_pq_pq_m_not_divisor",
+             .success = false,
+             .command_str = "idx1 SChema hash_field1 as "
+                            "hash_field11 vector ivf_pq 8 TYPE  FLOAT32 DIM 8 "
+                            "DISTANCE_METRIC IP PQ_M 3",
+             .expected_error_message =
+                 "Invalid field type for field `hash_field1`: PQ_M must be a "
+                 "positive divisor of the dimensions.",
+         },
+         {
+             .test_name = "invalid_ivf_pq_float16",
+             .success = false,
+             .command_str = "idx1 SChema hash_field1 as "
+                            "hash_field11 vector ivf_pq 6 TYPE  FLOAT16 DIM 8 "
+                            "DISTANCE_METRIC IP",
+             .expected_error_message =
+                 "Invalid field type for field `hash_field1`: IVF_PQ requires "
+                 "FLOAT32 vectors.",
+         },
+         {
+             .test_name = "invalid_rerank_without_quantize",
+             .success = false,
+             .command_str = "idx1 SChema hash_field1 as "
+                            "hash_field11 vector hnsw 8 TYPE  FLOAT32 DIM 3 "
+                            "DISTANCE_METRIC IP RERANK 4",
+             .expected_error_message =
+                 "Invalid field type for field `hash_field1`: RERANK requires "
+                 "the QUANTIZE parameter.",
+         },
+         {
+             .test_name = "invalid_quantize_bfloat16",
+             .success = false,
+             .command_str = "idx1 SChema hash_field1 as "
+                            "hash_field11 vector hnsw 8 TYPE  BFLOAT16 DIM 3 "
+                            "DISTANCE_METRIC IP QUANTIZE BQ",
+             .expected_error_message =
+                 "Invalid field type for field `hash_field1`: QUANTIZE "
+                 "requires FLOAT32 vectors.",
+         },
+         {
+             .test_name = "invalid_rerank_too_big",
+             .success = false,
+             .command_str = "idx1 SChema hash_field1 as "
+                            "hash_field11 vector hnsw 10 TYPE  FLOAT32 DIM 3 "
+                            "DISTANCE_METRIC IP QUANTIZE SQ8 RERANK 101",
+             .expected_error_message =
+                 "Invalid field type for field `hash_field1`: Invalid range: "
+                 "Value above maximum; RERANK must be a non-negative integer "
+                 "that cannot exceed 100.",
+         },
          {
              .test_name = "invalid_m_negative",
              .success = false,
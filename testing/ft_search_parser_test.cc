@@ -62,6 +62,7 @@ struct FTSearchParserTestCase {
   std::string attribute_alias = "vec";
   int k{-1};
   std::optional<int> ef;
+  std::optional<unsigned> nprobe;
   std::string score_as;
   std::string expected_error_message;
   std::string return_str;
@@ -79,6 +80,8 @@ struct FTSearchParserTestCase {
   query::SortOrder sortby_order{query::SortOrder::kAscending};
   bool sortby_enabled{false};
   bool with_sort_keys{false};
+  std::optional<query::ScorerType> scorer;
+  bool with_scores{false};
 };
 
 class FTSearchParserTest
@@ -257,6 +260,7 @@ void DoVectorSearchParserTest(const FTSearchParserTestCase &test_case,
       EXPECT_EQ(search_params.value()->query, vector_str.c_str());
       EXPECT_EQ(search_params.value()->k, test_case.k);
       EXPECT_EQ(search_params.value()->ef, test_case.ef);
+      EXPECT_EQ(search_params.value()->nprobe, test_case.nprobe);
       EXPECT_EQ(search_params.value()->attribute_alias,
                 test_case.attribute_alias);
       auto score_as = vmsdk::MakeUniqueValkeyString(test_case.score_as);
@@ -299,6 +303,8 @@ void DoVectorSearchParserTest(const FTSearchParserTestCase &test_case,
     EXPECT_EQ(search_params.value()->sortby.has_value(),
               test_case.sortby_enabled);
     EXPECT_EQ(search_params.value()->with_sort_keys, test_case.with_sort_keys);
+    EXPECT_EQ(search_params.value()->scorer, test_case.scorer);
+    EXPECT_EQ(search_params.value()->with_scores, test_case.with_scores);
     if (test_case.sortby_enabled) {
       EXPECT_EQ(search_params.value()->sortby->field, test_case.sortby_field);
       EXPECT_EQ(search_params.value()->sortby->order, test_case.sortby_order);
@@ -408,6 +414,14 @@ INSTANTIATE_TEST_SUITE_P(
             .search_parameters_str = "TIMEOUT 200 RETURN 2 r1 r2 NOCONTENT ",
             .timeout_ms = 200,
         },
+        {
+            .test_name = "happy_path_nprobe_as_param",
+            .success = true,
+            .params_str = " PARAMS 4 NP 32",
+            .filter_str = "*=>[KNN 10 @vec $BLOB NPROBE $NP]",
+            .k = 10,
+            .nprobe = 32,
+        },
         {
             .test_name = "happy_path_braces_prefilter",
             .success = true,
@@ -479,6 +493,15 @@ INSTANTIATE_TEST_SUITE_P(
                 "Error parsing vector similarity parameters: `[KNN 10 @vec "
                 "$BLOB EF_RUNTIMe]`. EF_RUNTIME argument is missing",
         },
+        {
+            .test_name = "missing_nprobe_value",
+            .success = false,
+            .params_str = " PARAMS 2",
+            .filter_str = "(*)=>[KNN 10 @vec $BLOB NPROBE]",
+            .expected_error_message =
+                "Error parsing vector similarity parameters: `[KNN 10 @vec "
+                "$BLOB NPROBE]`. NPROBE argument is missing",
+        },
         {
             .test_name = "missing_as_score_value",
             .success = false,
@@ -1015,6 +1038,47 @@ INSTANTIATE_TEST_SUITE_P(
             .sortby_enabled = true,
             .with_sort_keys = true,
         },
+        {
+            .test_name = "with_scores",
+            .success = true,
+            .params_str = "",
+            .filter_str = "@attribute_identifier_2:{electronics}",
+            .attribute_alias = "",
+            .k = 0,
+            .ef = 0,
+            .score_as = "",
+            .vector_query = false,
+            .sortby_parameters_str = "WITHSCORES",
+            .scorer = query::ScorerType::kBM25,
+            .with_scores = true,
+        },
+        {
+            .test_name = "scorer",
+            .success = true,
+            .params_str = "",
+            .filter_str = "@attribute_identifier_2:{electronics}",
+            .attribute_alias = "",
+            .k = 0,
+            .ef = 0,
+            .score_as = "",
+            .vector_query = false,
+            .sortby_parameters_str = "SCORER tfidf WITHSCORES",
+            .scorer = query::ScorerType::kTFIDF,
+            .with_scores = true,
+        },
+        {
+            .test_name = "unknown_scorer",
+            .success = false,
+            .params_str = "",
+            .filter_str = "@attribute_identifier_2:{electronics}",
+            .attribute_alias = "",
+            .k = 0,
+            .ef = 0,
+            .score_as = "",
+            .expected_error_message = "Unknown scorer `DISMAX`",
+            .vector_query = false,
+            .sortby_parameters_str = "SCORER DISMAX",
+        },
     }),
     [](const TestParamInfo<FTSearchParserTestCase> &info) {
       return info.param.test_name;
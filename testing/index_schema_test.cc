@@ -25,6 +25,7 @@
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
 #include "gmock/gmock.h"
@@ -668,6 +669,67 @@ TEST_P(IndexSchemaSubscriptionSimpleTest, DropIndexPrematurely) {
             0);
 }
 
+TEST_P(IndexSchemaSubscriptionSimpleTest, IndexInlineIfDrainNotScheduled) {
+  // A mutation whose drain task can't be scheduled is indexed right away
+  // rather than left pending.
+  MockThreadPool mutations_thread_pool("writer-thread-pool-", 1);
+  mutations_thread_pool.StartWorkers();
+  EXPECT_CALL(mutations_thread_pool,
+              Schedule(testing::_, vmsdk::ThreadPool::Priority::kHigh))
+      .WillOnce(Return(false));
+  std::vector<absl::string_view> key_prefixes = {"prefix:"};
+  std::string index_schema_name_str("index_schema_name");
+  auto index_schema =
+      MockIndexSchema::Create(&fake_ctx_, index_schema_name_str, key_prefixes,
+                              std::make_unique<HashAttributeDataType>(),
+                              &mutations_thread_pool)
+          .value();
+  auto mock_index = std::make_shared<MockIndex>();
+  VMSDK_EXPECT_OK(
+      index_schema->AddIndex("attribute_name", "vector", mock_index));
+
+  auto key = StringInternStore::Intern("key");
+  auto key_valkey_str = vmsdk::MakeUniqueValkeyString(key->Str().data());
+  EXPECT_CALL(*mock_index, IsTracked(key)).WillRepeatedly(Return(false));
+  EXPECT_CALL(*mock_index, AddRecord(key, absl::string_view("vector_buffer")))
+      .WillOnce(Return(true));
+  EXPECT_CALL(*kMockValkeyModule, KeyType(testing::_))
+      .WillRepeatedly(TestValkeyModule_KeyTypeDefaultImpl);
+  EXPECT_CALL(*kMockValkeyModule,
+              KeyType(vmsdk::ValkeyModuleKeyIsForString(key->Str())))
+      .WillRepeatedly(Return(VALKEYMODULE_KEYTYPE_HASH));
+  EXPECT_CALL(*kMockValkeyModule, GetClientId(testing::_))
+      .WillRepeatedly(testing::Return(1));
+  EXPECT_CALL(
+      *kMockValkeyModule,
+      BlockClient(testing::_, testing::_, testing::_, testing::_, testing::_))
+      .WillOnce(Return((ValkeyModuleBlockedClient *)1));
+  // The client blocked on the mutation is released once it is indexed.
+  EXPECT_CALL(*kMockValkeyModule,
+              UnblockClient((ValkeyModuleBlockedClient *)1, nullptr))
+      .WillOnce(Return(1));
+  ValkeyModuleString *value_valkey_str =
+      TestValkeyModule_CreateStringPrintf(nullptr, "%s", "vector_buffer");
+  EXPECT_CALL(*kMockValkeyModule,
+              HashGet(vmsdk::ValkeyModuleKeyIsForString(key->Str()),
+                      VALKEYMODULE_HASH_CFIELDS, StrEq("vector"),
+                      An<ValkeyModuleString **>(), TypedEq<void *>(nullptr)))
+      .WillOnce([value_valkey_str](
+                    ValkeyModuleKey *key, int flags, const char *field,
+                    ValkeyModuleString **value_out, void *terminating_null) {
+        *value_out = value_valkey_str;
+        return VALKEYMODULE_OK;
+      });
+
+  index_schema->OnKeyspaceNotification(&fake_ctx_, VALKEYMODULE_NOTIFY_HASH,
+                                       "event", key_valkey_str.get());
+  EXPECT_EQ(index_schema->GetStats().GetStats().mutation_queue_size, 0);
+  EXPECT_EQ(index_schema->GetStats().subscription_add.success_cnt, 1);
+  EXPECT_EQ(vmsdk::BlockedClientTracker::GetInstance().GetClientCount(
+                vmsdk::BlockedClientCategory::kHash),
+            0);
+}
+
 TEST_P(IndexSchemaSubscriptionSimpleTest, EmptyKeyPrefixesTest) {
   vmsdk::ThreadPool mutations_thread_pool("writer-thread-pool-", 1);
   auto use_thread_pool = GetParam();
@@ -799,6 +861,135 @@ TEST_P(IndexSchemaSubscriptionSimpleTest, KeyspaceNotificationWithNullptrTest) {
   }
 }
 
+TEST_P(IndexSchemaSubscriptionSimpleTest, ScanHashRecordsTest) {
+  auto &scan_config = options::GetHashScanMinAttributes();
+  auto scan_config_old_value = scan_config.GetValue();
+  VMSDK_EXPECT_OK(scan_config.SetValue(2));
+  vmsdk::ThreadPool mutations_thread_pool("writer-thread-pool-", 1);
+  mutations_thread_pool.StartWorkers();
+  auto use_thread_pool = GetParam();
+  std::vector<absl::string_view> key_prefixes = {};
+  std::string index_schema_name_str("index_schema_name");
+  auto index_schema = MockIndexSchema::Create(
+                          &fake_ctx_, index_schema_name_str, key_prefixes,
+                          std::make_unique<HashAttributeDataType>(),
+                          use_thread_pool ? &mutations_thread_pool : nullptr)
+                          .value();
+  auto mock_index_1 = std::make_shared<MockIndex>();
+  auto mock_index_2 = std::make_shared<MockIndex>();
+  auto mock_index_3 = std::make_shared<MockIndex>();
+  VMSDK_EXPECT_OK(
+      index_schema->AddIndex("attribute_1", "field_1", mock_index_1));
+  VMSDK_EXPECT_OK(
+      index_schema->AddIndex("attribute_2", "field_2", mock_index_2));
+  // Indexes the same field as the first attribute.
+  VMSDK_EXPECT_OK(
+      index_schema->AddIndex("attribute_3", "field_1", mock_index_3));
+
+  auto key = StringInternStore::Intern("key");
+  auto key_valkey_str = vmsdk::MakeUniqueValkeyString(key->Str().data());
+  for (const auto &mock_index : {mock_index_1, mock_index_2, mock_index_3}) {
+    EXPECT_CALL(*mock_index, IsTracked(key)).WillRepeatedly(Return(false));
+  }
+  EXPECT_CALL(*mock_index_1, AddRecord(key, absl::string_view("value_1")))
+      .WillOnce(Return(true));
+  EXPECT_CALL(*mock_index_2, AddRecord(key, absl::string_view("value_2")))
+      .WillOnce(Return(true));
+  EXPECT_CALL(*mock_index_3, AddRecord(key, absl::string_view("value_1")))
+      .WillOnce(Return(true));
+  EXPECT_CALL(*kMockValkeyModule, KeyType(testing::_))
+      .WillRepeatedly(TestValkeyModule_KeyTypeDefaultImpl);
+  EXPECT_CALL(*kMockValkeyModule,
+              KeyType(vmsdk::ValkeyModuleKeyIsForString(key->Str())))
+      .WillRepeatedly(Return(VALKEYMODULE_KEYTYPE_HASH));
+  // The records are scanned once rather than looked up per attribute.
+  EXPECT_CALL(*kMockValkeyModule,
+              HashGet(testing::_, testing::_, testing::_,
+                      An<ValkeyModuleString **>(), TypedEq<void *>(nullptr)))
+      .Times(0);
+  std::vector<std::pair<std::string, std::string>> hash = {
+      {"field_1", "value_1"}, {"other", "other_value"}, {"field_2", "value_2"}};
+  auto hash_itr = hash.begin();
+  EXPECT_CALL(*kMockValkeyModule,
+              ScanKey(vmsdk::ValkeyModuleKeyIsForString(key->Str()),
+                      An<ValkeyModuleScanCursor *>(),
+                      An<ValkeyModuleScanKeyCB>(), An<void *>()))
+      .WillRepeatedly([&](ValkeyModuleKey *key_obj, ValkeyModuleScanCursor *,
+                          ValkeyModuleScanKeyCB fn, void *privdata) {
+        if (hash_itr == hash.end()) {
+          return 0;
+        }
+        auto field = vmsdk::MakeUniqueValkeyString(hash_itr->first);
+        auto value = vmsdk::MakeUniqueValkeyString(hash_itr->second);
+        fn(key_obj, field.get(), value.get(), privdata);
+        ++hash_itr;
+        return 1;
+      });
+
+  index_schema->OnKeyspaceNotification(&fake_ctx_, VALKEYMODULE_NOTIFY_HASH,
+                                       "event", key_valkey_str.get());
+  if (use_thread_pool) {
+    WaitWorkerTasksAreCompleted(mutations_thread_pool);
+  }
+  VMSDK_EXPECT_OK(scan_config.SetValue(scan_config_old_value));
+}
+
+TEST_P(IndexSchemaSubscriptionSimpleTest, SharedKeyspaceDocumentTest) {
+  vmsdk::ThreadPool mutations_thread_pool("writer-thread-pool-", 1);
+  mutations_thread_pool.StartWorkers();
+  auto use_thread_pool = GetParam();
+  std::vector<absl::string_view> key_prefixes = {"doc:"};
+  std::vector<std::shared_ptr<MockIndexSchema>> index_schemas;
+  std::vector<std::shared_ptr<MockIndex>> mock_indexes;
+  auto key = StringInternStore::Intern("doc:1");
+  auto key_valkey_str = vmsdk::MakeUniqueValkeyString(key->Str().data());
+  for (int i = 0; i < 3; ++i) {
+    auto index_schema =
+        MockIndexSchema::Create(
+            &fake_ctx_, absl::StrCat("index_schema_name_", i), key_prefixes,
+            std::make_unique<HashAttributeDataType>(),
+            use_thread_pool ? &mutations_thread_pool : nullptr)
+            .value();
+    auto mock_index = std::make_shared<MockIndex>();
+    VMSDK_EXPECT_OK(
+        index_schema->AddIndex("attribute_name", "field", mock_index));
+    EXPECT_CALL(*mock_index, IsTracked(key)).WillRepeatedly(Return(false));
+    EXPECT_CALL(*mock_index, AddRecord(key, absl::string_view("value")))
+        .WillOnce(Return(true));
+    index_schemas.push_back(std::move(index_schema));
+    mock_indexes.push_back(std::move(mock_index));
+  }
+  EXPECT_CALL(*kMockValkeyModule, KeyType(testing::_))
+      .WillRepeatedly(TestValkeyModule_KeyTypeDefaultImpl);
+  EXPECT_CALL(*kMockValkeyModule,
+              KeyType(vmsdk::ValkeyModuleKeyIsForString(key->Str())))
+      .WillRepeatedly(Return(VALKEYMODULE_KEYTYPE_HASH));
+  // The key is opened and its field fetched once for all the schemas.
+  EXPECT_CALL(*kMockValkeyModule, OpenKey(&fake_ctx_, testing::_, testing::_))
+      .WillRepeatedly(TestValkeyModule_OpenKeyDefaultImpl);
+  EXPECT_CALL(*kMockValkeyModule,
+              OpenKey(&fake_ctx_, key_valkey_str.get(),
+                      VALKEYMODULE_OPEN_KEY_NOEFFECTS | VALKEYMODULE_READ))
+      .WillOnce(TestValkeyModule_OpenKeyDefaultImpl);
+  ValkeyModuleString *value_valkey_str =
+      TestValkeyModule_CreateStringPrintf(nullptr, "value");
+  EXPECT_CALL(*kMockValkeyModule,
+              HashGet(vmsdk::ValkeyModuleKeyIsForString(key->Str()),
+                      VALKEYMODULE_HASH_CFIELDS, StrEq("field"),
+                      An<ValkeyModuleString **>(), TypedEq<void *>(nullptr)))
+      .WillOnce([value_valkey_str](ValkeyModuleKey *, int, const char *,
+                                   ValkeyModuleString **value_out, void *) {
+        *value_out = value_valkey_str;
+        return VALKEYMODULE_OK;
+      });
+
+  KeyspaceEventManager::Instance().NotifySubscribers(
+      &fake_ctx_, VALKEYMODULE_NOTIFY_HASH, "event", key_valkey_str.get());
+  if (use_thread_pool) {
+    WaitWorkerTasksAreCompleted(mutations_thread_pool);
+  }
+}
+
 TEST_P(IndexSchemaSubscriptionSimpleTest, GetKeyPrefixesTest) {
   vmsdk::ThreadPool mutations_thread_pool("writer-thread-pool-", 1);
   mutations_thread_pool.StartWorkers();
@@ -862,6 +1053,11 @@ TEST_P(IndexSchemaBackfillTest, PerformBackfillTest) {
   auto &params = GetParam();
   bool use_thread_pool = std::get<0>(params);
   const IndexSchemaBackfillTestCase &test_case = std::get<1>(params);
+  // Schedule every backfilled key on its own, so that each scanned key is
+  // processed before the next one is returned by the scan.
+  auto &batch_size_config = options::GetBackfillMutationBatchSize();
+  auto batch_size_default = batch_size_config.GetValue();
+  VMSDK_EXPECT_OK(batch_size_config.SetValue(1));
   MockThreadPool thread_pool("writer-thread-pool-", 5);
   thread_pool.StartWorkers();
   std::vector<absl::string_view> key_prefixes;
@@ -979,6 +1175,82 @@ TEST_P(IndexSchemaBackfillTest, PerformBackfillTest) {
         .Times(thread_pool.Size());
     WaitWorkerTasksAreCompleted(thread_pool);
   }
+  VMSDK_EXPECT_OK(batch_size_config.SetValue(batch_size_default));
+}
+
+TEST_F(IndexSchemaBackfillTest, PerformBackfill_BatchesKeys) {
+  auto &batch_size_config = options::GetBackfillMutationBatchSize();
+  auto batch_size_default = batch_size_config.GetValue();
+  VMSDK_EXPECT_OK(batch_size_config.SetValue(2));
+  MockThreadPool thread_pool("writer-thread-pool-", 1);
+  thread_pool.StartWorkers();
+  std::vector<absl::string_view> key_prefixes = {"prefix:"};
+  std::vector<std::string> keys = {"prefix:key1", "prefix:key2",
+                                   "prefix:key3"};
+  EXPECT_CALL(*kMockValkeyModule, DbSize(testing::_))
+      .WillRepeatedly(Return(keys.size()));
+
+  ValkeyModuleCtx parent_ctx;
+  ValkeyModuleCtx scan_ctx;
+  EXPECT_CALL(*kMockValkeyModule, GetDetachedThreadSafeContext(&parent_ctx))
+      .WillRepeatedly(Return(&scan_ctx));
+  EXPECT_CALL(*kMockValkeyModule, GetContextFlags(&parent_ctx))
+      .WillRepeatedly(Return(0));
+  EXPECT_CALL(*kMockValkeyModule, GetContextFlags(&scan_ctx))
+      .WillRepeatedly(Return(0));
+  auto index_schema =
+      MockIndexSchema::Create(&parent_ctx, "index_schema_name", key_prefixes,
+                              std::make_unique<HashAttributeDataType>(),
+                              &thread_pool)
+          .value();
+  auto mock_index = std::make_shared<MockIndex>();
+  VMSDK_EXPECT_OK(
+      index_schema->AddIndex("attribute_name", "test_identifier", mock_index));
+  EXPECT_CALL(*mock_index, IsTracked(testing::_))
+      .WillRepeatedly(Return(false));
+  EXPECT_CALL(*mock_index, AddRecord(testing::_, testing::_))
+      .Times(keys.size())
+      .WillRepeatedly(Return(true));
+  EXPECT_CALL(*kMockValkeyModule, KeyType(testing::_))
+      .WillRepeatedly(Return(VALKEYMODULE_KEYTYPE_HASH));
+  EXPECT_CALL(*kMockValkeyModule,
+              HashGet(testing::_, VALKEYMODULE_HASH_CFIELDS, testing::_,
+                      An<ValkeyModuleString **>(), TypedEq<void *>(nullptr)))
+      .WillRepeatedly([](ValkeyModuleKey *key, int flags, const char *field,
+                         ValkeyModuleString **value_out,
+                         void *terminating_null) {
+        *value_out =
+            TestValkeyModule_CreateStringPrintf(nullptr, "arbitrary data");
+        return VALKEYMODULE_OK;
+      });
+
+  // One task for the first two keys, and one for the remaining key once the
+  // scan is done.
+  EXPECT_CALL(thread_pool,
+              Schedule(testing::_, vmsdk::ThreadPool::Priority::kLow))
+      .Times(2);
+  size_t i = 0;
+  EXPECT_CALL(*kMockValkeyModule,
+              Scan(&scan_ctx, testing::An<ValkeyModuleScanCursor *>(),
+                   testing::An<ValkeyModuleScanCB>(), testing::An<void *>()))
+      .WillRepeatedly([&](ValkeyModuleCtx *ctx, ValkeyModuleScanCursor *cursor,
+                          ValkeyModuleScanCB fn, void *privdata) -> int {
+        if (i >= keys.size()) {
+          return 0;
+        }
+        auto key_r_str = vmsdk::MakeUniqueValkeyString(keys[i]);
+        ValkeyModuleKey key = {.ctx = &scan_ctx, .key = keys[i]};
+        fn(ctx, key_r_str.get(), &key, privdata);
+        return (++i < keys.size()) ? 1 : 0;
+      });
+  EXPECT_EQ(index_schema->PerformBackfill(&parent_ctx, keys.size()),
+            keys.size());
+  EXPECT_CALL(thread_pool,
+              Schedule(testing::_, vmsdk::ThreadPool::Priority::kLow))
+      .Times(thread_pool.Size());
+  WaitWorkerTasksAreCompleted(thread_pool);
+  EXPECT_FALSE(index_schema->IsBackfillInProgress());
+  VMSDK_EXPECT_OK(batch_size_config.SetValue(batch_size_default));
 }
 
 TEST_F(IndexSchemaBackfillTest, PerformBackfill_NoOngoingBackfillTest) {
@@ -1321,6 +1593,103 @@ TEST_F(IndexSchemaRDBTest, SaveAndLoad) ABSL_NO_THREAD_SAFETY_ANALYSIS {
   EXPECT_EQ(index_schema->CountRecords(), 10);
 }
 
+TEST_F(IndexSchemaRDBTest, SaveAndLoadInParallel)
+ABSL_NO_THREAD_SAFETY_ANALYSIS {
+  std::vector<absl::string_view> key_prefixes = {"prefix1"};
+  int dimensions = 100;
+  auto distance_metric = data_model::DISTANCE_METRIC_COSINE;
+  size_t key_count = 10;
+
+  FakeSafeRDB rdb_stream;
+
+  {
+    auto index_schema = MockIndexSchema::Create(
+                            &fake_ctx_, "index_schema_name", key_prefixes,
+                            std::make_unique<HashAttributeDataType>(), nullptr)
+                            .value();
+    auto hnsw_index =
+        indexes::VectorHNSW<float>::Create(
+            CreateHNSWVectorIndexProto(dimensions, distance_metric, 12, 16,
+                                       100, 5),
+            "hnsw_identifier",
+            data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH)
+            .value();
+    VMSDK_EXPECT_OK(index_schema->AddIndex("hnsw_attribute", "hnsw_identifier",
+                                           hnsw_index));
+    auto flat_index =
+        indexes::VectorFlat<float>::Create(
+            CreateFlatVectorIndexProto(dimensions, distance_metric, 12, 250),
+            "flat_identifier",
+            data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH)
+            .value();
+    VMSDK_EXPECT_OK(index_schema->AddIndex("flat_attribute", "flat_identifier",
+                                           flat_index));
+    VMSDK_EXPECT_OK(index_schema->AddIndex(
+        "numeric_attribute", "numeric_identifier",
+        std::make_shared<indexes::Numeric>(CreateNumericIndexProto())));
+    VMSDK_EXPECT_OK(index_schema->AddIndex(
+        "tag_attribute", "tag_identifier",
+        std::make_shared<indexes::Tag>(CreateTagIndexProto(",", false))));
+
+    auto vectors = DeterministicallyGenerateVectors(key_count, dimensions, 2);
+    for (const auto &alias : {"hnsw_attribute", "flat_attribute"}) {
+      auto itr = index_schema->attributes_.find(alias);
+      ASSERT_NE(itr, index_schema->attributes_.end());
+      for (size_t i = 0; i < vectors.size(); ++i) {
+        index_schema->ProcessAttributeMutation(
+            &fake_ctx_, itr->second,
+            StringInternStore::Intern("key" + std::to_string(i)),
+            vmsdk::MakeUniqueValkeyString(absl::string_view(
+                (char *)&vectors[i][0], dimensions * sizeof(float))),
+            indexes::DeletionType::kNone);
+      }
+    }
+    VMSDK_EXPECT_OK(index_schema->RDBSave(&rdb_stream));
+  }
+
+  // The vector indexes are decoded by the mutation threads.
+  vmsdk::ThreadPool mutations_thread_pool("writer-thread-pool-", 2);
+  mutations_thread_pool.StartWorkers();
+  ValkeyModuleCtx parent_ctx;
+  ValkeyModuleCtx scan_ctx;
+  EXPECT_CALL(*kMockValkeyModule, GetDetachedThreadSafeContext(&parent_ctx))
+      .WillRepeatedly(Return(&scan_ctx));
+  RDBSectionIter iter(&rdb_stream, 1);
+  auto section = iter.Next();
+  VMSDK_EXPECT_OK_STATUSOR(section);
+  auto index_schema_or = IndexSchema::LoadFromRDB(
+      &parent_ctx, &mutations_thread_pool,
+      std::make_unique<data_model::IndexSchema>(
+          (*section)->index_schema_contents()),
+      iter.IterateSupplementalContent());
+  VMSDK_EXPECT_OK_STATUSOR(index_schema_or);
+  auto index_schema = std::move(index_schema_or.value());
+
+  // The attributes keep their positions.
+  std::vector<std::string> aliases = {"hnsw_attribute", "flat_attribute",
+                                      "numeric_attribute", "tag_attribute"};
+  for (size_t i = 0; i < aliases.size(); ++i) {
+    auto position = index_schema->GetAttributePositionByAlias(aliases[i]);
+    VMSDK_EXPECT_OK_STATUSOR(position);
+    EXPECT_EQ(*position, i);
+  }
+  auto hnsw_index = dynamic_cast<indexes::VectorHNSW<float> *>(
+      index_schema->GetIndex("hnsw_attribute").value().get());
+  ASSERT_NE(hnsw_index, nullptr);
+  EXPECT_EQ(hnsw_index->GetTrackedKeyCount(), key_count);
+  auto flat_index = dynamic_cast<indexes::VectorFlat<float> *>(
+      index_schema->GetIndex("flat_attribute").value().get());
+  ASSERT_NE(flat_index, nullptr);
+  EXPECT_EQ(flat_index->GetTrackedKeyCount(), key_count);
+  for (size_t i = 0; i < key_count; ++i) {
+    auto key = StringInternStore::Intern("key" + std::to_string(i));
+    EXPECT_TRUE(hnsw_index->IsTracked(key));
+    EXPECT_TRUE(flat_index->IsTracked(key));
+  }
+  VMSDK_EXPECT_OK(index_schema->GetIndex("numeric_attribute"));
+  VMSDK_EXPECT_OK(index_schema->GetIndex("tag_attribute"));
+}
+
 TEST_F(IndexSchemaRDBTest, SaveAndLoadTextIndex)
 ABSL_NO_THREAD_SAFETY_ANALYSIS {
   std::vector<absl::string_view> key_prefixes = {"doc:"};
@@ -1443,6 +1812,76 @@ ABSL_NO_THREAD_SAFETY_ANALYSIS {
   }
 }
 
+TEST_F(IndexSchemaRDBTest, SaveIndexRecordsWithTextAttributes)
+ABSL_NO_THREAD_SAFETY_ANALYSIS {
+  std::vector<absl::string_view> key_prefixes = {"doc:"};
+  auto key = StringInternStore::Intern("doc:0");
+  FakeSafeRDB rdb_stream;
+  {
+    auto index_schema = MockIndexSchema::Create(
+                            &fake_ctx_, "text_index_schema", key_prefixes,
+                            std::make_unique<HashAttributeDataType>(), nullptr)
+                            .value();
+    index_schema->CreateTextIndexSchema();
+    VMSDK_EXPECT_OK(index_schema->AddIndex(
+        "description", "desc_id",
+        std::make_shared<indexes::Text>(CreateTextIndexProto(false, false, 1.0),
+                                        index_schema->GetTextIndexSchema())));
+    auto tag_index =
+        std::make_shared<indexes::Tag>(CreateTagIndexProto(",", false));
+    VMSDK_EXPECT_OK(
+        index_schema->AddIndex("tag_attribute", "tag_identifier", tag_index));
+    VMSDK_EXPECT_OK(tag_index->AddRecord(key, "a,b"));
+    index_schema->backfill_job_.Get()->MarkScanAsDone();
+    VMSDK_EXPECT_OK(index_schema->RDBSave(&rdb_stream));
+  }
+  std::string saved = rdb_stream.buffer_.str();
+
+  // The tag records are saved, the key infos are not since the keys are read
+  // again to rebuild the text index.
+  {
+    RDBSectionIter iter(&rdb_stream, 1);
+    VMSDK_EXPECT_OK_STATUSOR(iter.Next());
+    auto supplemental_iter = iter.IterateSupplementalContent();
+    std::vector<data_model::SupplementalContentType> types;
+    while (supplemental_iter.HasNext()) {
+      auto header = supplemental_iter.Next();
+      VMSDK_EXPECT_OK_STATUSOR(header);
+      types.push_back((*header)->type());
+      auto chunk_iter = supplemental_iter.IterateChunks();
+      while (chunk_iter.HasNext()) {
+        VMSDK_EXPECT_OK_STATUSOR(chunk_iter.Next());
+      }
+    }
+    EXPECT_EQ(std::ranges::count(
+                  types, data_model::SUPPLEMENTAL_CONTENT_INDEX_RECORDS),
+              1);
+    EXPECT_EQ(
+        std::ranges::count(types, data_model::SUPPLEMENTAL_CONTENT_KEY_INFO),
+        0);
+  }
+
+  // The tag index is restored from its records.
+  FakeSafeRDB load_stream;
+  load_stream.buffer_.str(saved);
+  ValkeyModuleCtx parent_ctx;
+  ValkeyModuleCtx scan_ctx;
+  EXPECT_CALL(*kMockValkeyModule, GetDetachedThreadSafeContext(&parent_ctx))
+      .WillRepeatedly(Return(&scan_ctx));
+  RDBSectionIter iter(&load_stream, 1);
+  auto section = iter.Next();
+  VMSDK_EXPECT_OK_STATUSOR(section);
+  auto index_schema = IndexSchema::LoadFromRDB(
+      &parent_ctx, nullptr,
+      std::make_unique<data_model::IndexSchema>(
+          (*section)->index_schema_contents()),
+      iter.IterateSupplementalContent());
+  VMSDK_EXPECT_OK_STATUSOR(index_schema);
+  auto tag_index = (*index_schema)->GetIndex("tag_attribute");
+  VMSDK_EXPECT_OK_STATUSOR(tag_index);
+  EXPECT_TRUE((*tag_index)->IsTracked(key));
+}
+
 TEST_F(IndexSchemaRDBTest, LoadEndedDeletesOrphanedKeys) {
   vmsdk::ThreadPool mutations_thread_pool("writer-thread-pool-", 1);
   mutations_thread_pool.StartWorkers();
@@ -2110,6 +2549,9 @@ TEST_F(IndexSchemaRDBTest, ComprehensiveSkipLoadTest) {
     auto vec_index = normal_schema->GetIndex("embedding");
     VMSDK_EXPECT_OK_STATUSOR(vec_index);
     EXPECT_EQ(vec_index.value()->GetTrackedKeyCount(), num_vectors);
+    EXPECT_FALSE(dynamic_cast<indexes::VectorHNSW<float> *>(
+                     vec_index.value().get())
+                     ->IsBuilding());
     LOG(INFO) << "✓ Normal load verified - " << num_vectors
               << " vectors loaded";
   }
@@ -2174,7 +2616,23 @@ TEST_F(IndexSchemaRDBTest, ComprehensiveSkipLoadTest) {
     VMSDK_EXPECT_OK_STATUSOR(vec_index);
     EXPECT_EQ(vec_index.value()->GetTrackedKeyCount(), 0);
     EXPECT_TRUE(skip_schema->IsBackfillInProgress());
+    // The HNSW graph is rebuilt by the backfill.
+    auto hnsw_index =
+        dynamic_cast<indexes::VectorHNSW<float> *>(vec_index.value().get());
+    EXPECT_TRUE(hnsw_index->IsBuilding());
+    EXPECT_EQ(hnsw_index->GetBuildProgress(), 0);
     LOG(INFO) << "✓ Skip load verified - index empty, backfill ready";
+
+    EXPECT_CALL(*kMockValkeyModule, GetContextFlags(testing::_))
+        .WillRepeatedly(Return(0));
+    EXPECT_EQ(skip_schema->PerformBackfill(&parent_ctx, num_vectors + 1),
+              static_cast<uint32_t>(num_vectors));
+    EXPECT_FALSE(skip_schema->IsBackfillInProgress());
+    EXPECT_TRUE(hnsw_index->IsBuilding());
+    // The build ends once the backfill is observed as complete.
+    EXPECT_EQ(skip_schema->PerformBackfill(&parent_ctx, num_vectors + 1), 0);
+    EXPECT_FALSE(hnsw_index->IsBuilding());
+    EXPECT_EQ(hnsw_index->GetBuildProgress(), 1);
   }
 
   // STEP 3: Drop the schema (implicitly done when schema goes out of scope)
@@ -119,6 +119,49 @@ TEST_F(NumericIndexTest, ModifyWithNonNumericString) {
   EXPECT_EQ(index.GetTrackedKeyCount(), 0);
 }
 
+TEST_F(NumericIndexTest, AddRecords) {
+  VMSDK_EXPECT_OK(index.AddRecord("key1", "1.5"));
+  std::vector<IndexBase::Record> records = {
+      {.key = StringInternStore::Intern("key3"), .record = "3.0"},
+      {.key = StringInternStore::Intern("key1"), .record = "1.0"},
+      {.key = StringInternStore::Intern("key4"), .record = "abcde"},
+      {.key = StringInternStore::Intern("key2"), .record = "2.0"},
+  };
+  auto results = index.AddRecords(records);
+  ASSERT_EQ(results.size(), 4);
+  EXPECT_TRUE(results[0].value());
+  EXPECT_EQ(results[1].status().code(), absl::StatusCode::kAlreadyExists);
+  EXPECT_FALSE(results[2].value());
+  EXPECT_TRUE(results[3].value());
+  EXPECT_EQ(index.GetTrackedKeyCount(), 3);
+  EXPECT_FALSE(index.IsTracked("key4"));
+
+  auto predicate = query::NumericPredicate(&index, "attribute1", "id1", 1.0,
+                                           true, 2.5, true);
+  auto fetcher = index.Search(predicate, false);
+  EXPECT_THAT(Fetch(*fetcher), testing::UnorderedElementsAre("key1", "key2"));
+}
+
+TEST_F(NumericIndexTest, SaveAndLoadRecords) {
+  VMSDK_EXPECT_OK(index.AddRecord("key1", "1.5"));
+  VMSDK_EXPECT_OK(index.AddRecord("key2", "-2.0"));
+  VMSDK_EXPECT_OK(index.AddRecord("key3", "abcde"));
+  FakeSafeRDB rdb;
+  VMSDK_EXPECT_OK(index.SaveRecords(RDBChunkOutputStream(&rdb)));
+
+  IndexTeser<Numeric, data_model::NumericIndex> loaded{numeric_index_proto};
+  VMSDK_EXPECT_OK(loaded.LoadRecords(
+      RDBChunkInputStream(SupplementalContentChunkIter(&rdb))));
+  EXPECT_EQ(loaded.GetTrackedKeyCount(), 2);
+  EXPECT_EQ(loaded.GetUnTrackedKeyCount(), 1);
+  EXPECT_EQ(*loaded.GetValue(StringInternStore::Intern("key2")), -2.0);
+
+  auto predicate = query::NumericPredicate(&loaded, "attribute1", "id1", 1.0,
+                                           true, 2.5, true);
+  auto fetcher = loaded.Search(predicate, true);
+  EXPECT_THAT(Fetch(*fetcher), testing::UnorderedElementsAre("key2", "key3"));
+}
+
 TEST_F(NumericIndexTest, RangeSearchInclusiveExclusive) {
   EXPECT_TRUE(index.AddRecord("key1", "1.0").value());
   EXPECT_TRUE(index.AddRecord("key2", "2.0").value());
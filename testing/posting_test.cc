@@ -8,6 +8,7 @@
 #include "src/indexes/text/posting.h"
 
 #include "gtest/gtest.h"
+#include "src/utils/doc_id_map.h"
 #include "src/utils/string_interning.h"
 #include "testing/common.h"
 #include "vmsdk/src/memory_allocation.h"
@@ -20,7 +21,7 @@ class PostingTest : public ValkeySearchTest {
   void SetUp() override {
     ValkeySearchTest::SetUp();
 
-    postings_ = std::make_unique<Postings>();
+    postings_ = std::make_unique<Postings>(&doc_ids_);
     metadata_ = std::make_unique<TextIndexMetadata>();
   }
 
@@ -30,6 +31,7 @@ class PostingTest : public ValkeySearchTest {
 
   void TearDown() override { ValkeySearchTest::TearDown(); }
 
+  DocIdMap doc_ids_;
   std::unique_ptr<Postings> postings_;
   std::unique_ptr<TextIndexMetadata> metadata_;
 
@@ -53,7 +55,12 @@ class PostingTest : public ValkeySearchTest {
                                 PositionMap&& pos_map, size_t num_fields = 5) {
     // Create FlatPositionMap from PositionMap
     FlatPositionMap* flat_map = FlatPositionMap::Create(pos_map, num_fields);
-    postings_->InsertKey(key, flat_map);
+    postings_->InsertKey(doc_ids_.Acquire(key), flat_map);
+  }
+
+  // Keys that were never inserted get an id which no posting holds.
+  void RemoveKey(const InternedStringPtr& key) {
+    postings_->RemoveKey(doc_ids_.Acquire(key), metadata_.get());
   }
 };
 
@@ -79,7 +86,7 @@ TEST_F(PostingTest, InsertionCounters) {
   EXPECT_EQ(postings_->GetTotalTermFrequency(), 3);
 
   // Single key with multiple positions
-  postings_ = std::make_unique<Postings>();
+  postings_ = std::make_unique<Postings>(&doc_ids_);
   metadata_ = std::make_unique<TextIndexMetadata>();
   InsertKeyWithPositionMap(
       InternKey("doc1"), CreatePositionMap({{10, {0}}, {20, {0}}, {30, {1}}}));
@@ -88,7 +95,7 @@ TEST_F(PostingTest, InsertionCounters) {
   EXPECT_EQ(postings_->GetTotalTermFrequency(), 3);
 
   // Multiple fields at same position
-  postings_ = std::make_unique<Postings>();
+  postings_ = std::make_unique<Postings>(&doc_ids_);
   InsertKeyWithPositionMap(InternKey("doc1"),
                            CreatePositionMap({{10, {0, 2}}}));
   EXPECT_EQ(postings_->GetKeyCount(), 1);
@@ -103,14 +110,14 @@ TEST_F(PostingTest, RemoveKey) {
 
   EXPECT_EQ(postings_->GetKeyCount(), 2);
 
-  postings_->RemoveKey(InternKey("doc1"), metadata_.get());
+  RemoveKey(InternKey("doc1"));
   EXPECT_EQ(postings_->GetKeyCount(), 1);
   EXPECT_EQ(postings_->GetPositionCount(), 1);
 
-  postings_->RemoveKey(InternKey("nonexistent"), metadata_.get());
+  RemoveKey(InternKey("nonexistent"));
   EXPECT_EQ(postings_->GetKeyCount(), 1);
 
-  postings_->RemoveKey(InternKey("doc2"), metadata_.get());
+  RemoveKey(InternKey("doc2"));
   EXPECT_TRUE(postings_->IsEmpty());
 }
 
@@ -147,7 +154,7 @@ TEST_F(PostingTest, KeyIteratorSkipForward) {
 
   // Test that we can skip to an existing key
   auto doc3_key = InternKey("doc3");
-  bool found_exact = key_iter.SkipForwardKey(doc3_key);
+  bool found_exact = key_iter.SkipForwardKey(*doc_ids_.Find(doc3_key));
   if (found_exact) {
     EXPECT_TRUE(key_iter.IsValid());
     EXPECT_EQ(key_iter.GetKey()->Str(), "doc3");
@@ -564,6 +564,35 @@ INSTANTIATE_TEST_SUITE_P(
       return info.param.test_name;
     });
 
+TEST_F(ResponseGeneratorTest, KeepSortedTop) {
+  UnitTestSearchParameters parameters;
+  parameters.index_schema = CreateIndexSchema("index_schema_name").value();
+  parameters.sortby_parameter = query::SortByParameter{
+      .field = "name", .order = query::SortOrder::kDescending};
+  parameters.limit = {.first_index = 1, .number = 2};
+  EXPECT_TRUE(query::SortsShardResults(parameters));
+
+  std::vector<indexes::Neighbor> neighbors;
+  for (const auto &[key, name] :
+       std::vector<std::pair<std::string, std::string>>{
+           {"k1", "b"}, {"k2", "d"}, {"k3", ""}, {"k4", "a"}, {"k5", "c"}}) {
+    neighbors.emplace_back(StringInternStore::Intern(key), 0);
+    neighbors.back().attribute_contents =
+        ToRecordsMap({{name.empty() ? "other" : "name", name}});
+  }
+  query::KeepSortedTop(neighbors, parameters);
+
+  // The first offset + limit neighbors are kept, the one missing the field
+  // sorts last.
+  ASSERT_EQ(neighbors.size(), 3);
+  EXPECT_EQ(std::string(*neighbors[0].external_id), "k2");
+  EXPECT_EQ(std::string(*neighbors[1].external_id), "k5");
+  EXPECT_EQ(std::string(*neighbors[2].external_id), "k1");
+
+  parameters.attribute_alias = "vector";
+  EXPECT_FALSE(query::SortsShardResults(parameters));
+}
+
 class ResponseGeneratorDbParamTest
     : public ValkeySearchTestWithParam<data_model::AttributeDataType> {};
 
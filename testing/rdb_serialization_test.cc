@@ -9,8 +9,13 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "absl/status/status.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "src/version.h"
@@ -240,6 +245,122 @@ TEST_F(SafeRDBTest, SaveStringBufferFailureIOError) {
             absl::StatusCode::kInternal);
 }
 
+TEST_F(SafeRDBTest, BufferedStreamRoundTrip) {
+  FakeSafeRDB rdb;
+  {
+    RDBChunkOutputStream chunked_out(&rdb);
+    // Small enough for the values to spread over several chunks.
+    RDBBufferedOutputStream out(chunked_out, 16);
+    for (size_t i = 0; i < 10; ++i) {
+      VMSDK_EXPECT_OK(out.SaveObject(i));
+      VMSDK_EXPECT_OK(out.SaveString(std::string(i, 'a')));
+    }
+    VMSDK_EXPECT_OK(out.Flush());
+  }
+  RDBChunkInputStream chunked_in(SupplementalContentChunkIter(&rdb));
+  RDBBufferedInputStream in(chunked_in);
+  for (size_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(in.LoadObject<size_t>().value(), i);
+    EXPECT_EQ(in.LoadString().value(), std::string(i, 'a'));
+  }
+  EXPECT_TRUE(in.AtEnd());
+  EXPECT_EQ(in.LoadObject<size_t>().status().code(),
+            absl::StatusCode::kNotFound);
+}
+
+// Holds the reads past the first chunk until the decoder has loaded it.
+class GatedSafeRDB : public FakeSafeRDB {
+ public:
+  absl::StatusOr<vmsdk::UniqueValkeyString> LoadString() override {
+    if (loads_++ > 0) {
+      first_chunk_loaded.WaitForNotification();
+    }
+    return FakeSafeRDB::LoadString();
+  }
+  absl::Notification first_chunk_loaded;
+
+ private:
+  size_t loads_ = 0;
+};
+
+std::vector<std::string> SaveChunks(SafeRDB* rdb, size_t count) {
+  std::vector<std::string> contents;
+  RDBChunkOutputStream out(rdb);
+  for (size_t i = 0; i < count; ++i) {
+    contents.push_back(std::string(100, 'a' + i));
+    VMSDK_EXPECT_OK(
+        out.SaveChunk(contents.back().data(), contents.back().size()));
+  }
+  VMSDK_EXPECT_OK(out.Close());
+  return contents;
+}
+
+TEST_F(SafeRDBTest, ReadAheadIsBoundedOnceDecoding) {
+  GatedSafeRDB rdb;
+  auto contents = SaveChunks(&rdb, 10);
+  // Less than two chunks are buffered ahead of the decoder.
+  ReadAheadSafeRDB read_ahead(150);
+  absl::Notification resume_decoding;
+  std::vector<std::string> decoded;
+  std::thread decoder([&] {
+    SupplementalContentChunkIter iter(&read_ahead);
+    rdb.first_chunk_loaded.Notify();
+    resume_decoding.WaitForNotification();
+    while (iter.HasNext()) {
+      auto chunk = iter.Next();
+      VMSDK_EXPECT_OK_STATUSOR(chunk);
+      if ((*chunk)->has_binary_content()) {
+        decoded.push_back((*chunk)->binary_content());
+      }
+    }
+    read_ahead.StopDecoding();
+  });
+  absl::Notification read;
+  std::thread reader([&] {
+    VMSDK_EXPECT_OK(read_ahead.ReadChunks(&rdb));
+    read.Notify();
+  });
+  EXPECT_FALSE(read.WaitForNotificationWithTimeout(absl::Milliseconds(100)));
+  resume_decoding.Notify();
+  reader.join();
+  decoder.join();
+  EXPECT_EQ(decoded, contents);
+}
+
+TEST_F(SafeRDBTest, ReadAheadIsUnboundedBeforeDecoding) {
+  FakeSafeRDB rdb;
+  auto contents = SaveChunks(&rdb, 10);
+  ReadAheadSafeRDB read_ahead(0);
+  VMSDK_EXPECT_OK(read_ahead.ReadChunks(&rdb));
+  std::vector<std::string> decoded;
+  SupplementalContentChunkIter iter(&read_ahead);
+  while (iter.HasNext()) {
+    auto chunk = iter.Next();
+    VMSDK_EXPECT_OK_STATUSOR(chunk);
+    if ((*chunk)->has_binary_content()) {
+      decoded.push_back((*chunk)->binary_content());
+    }
+  }
+  EXPECT_EQ(decoded, contents);
+  EXPECT_EQ(read_ahead.LoadString().status().code(),
+            absl::StatusCode::kOutOfRange);
+}
+
+TEST_F(SafeRDBTest, ReadAheadDropsChunksOnceStopped) {
+  GatedSafeRDB rdb;
+  SaveChunks(&rdb, 10);
+  ReadAheadSafeRDB read_ahead(0);
+  std::thread decoder([&] {
+    auto chunk = read_ahead.LoadString();
+    VMSDK_EXPECT_OK_STATUSOR(chunk);
+    // The decoder gives up on the section.
+    read_ahead.StopDecoding();
+    rdb.first_chunk_loaded.Notify();
+  });
+  VMSDK_EXPECT_OK(read_ahead.ReadChunks(&rdb));
+  decoder.join();
+}
+
 class MockRDBSectionCallback {
  public:
   MOCK_METHOD(absl::Status, load,
@@ -7,6 +7,8 @@
 
 #include "src/query/search.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <deque>
@@ -26,6 +28,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "src/attribute_data_type.h"
@@ -34,12 +37,17 @@
 #include "src/indexes/index_base.h"
 #include "src/indexes/numeric.h"
 #include "src/indexes/tag.h"
+#include "src/indexes/text.h"
 #include "src/indexes/vector_base.h"
 #include "src/indexes/vector_flat.h"
 #include "src/indexes/vector_hnsw.h"
+#include "src/query/planner.h"
 #include "src/query/predicate.h"
+#include "src/query/scorer.h"
+#include "src/utils/doc_id_map.h"
 #include "src/utils/patricia_tree.h"
 #include "src/utils/string_interning.h"
+#include "src/valkey_search_options.h"
 #include "testing/common.h"
 #include "vmsdk/src/managed_pointers.h"
 #include "vmsdk/src/type_conversions.h"
@@ -75,6 +83,12 @@ class MockNumeric : public indexes::Numeric {
               (const, override));
 };
 
+// Document ids of the hand-built fetchers below, which never assign any.
+const DocIdMap &TestedDocIdMap() {
+  static const auto *doc_id_map = new DocIdMap();
+  return *doc_id_map;
+}
+
 class TestedNumericEntriesFetcherIterator
     : public indexes::EntriesFetcherIteratorBase {
  public:
@@ -96,11 +110,13 @@ class TestedNumericEntriesFetcher : public indexes::Numeric::EntriesFetcher {
   TestedNumericEntriesFetcher(indexes::Numeric::EntriesRange &entries_range,
                               std::pair<size_t, size_t> key_range)
       : indexes::Numeric::EntriesFetcher(
-            entries_range, key_range.second - key_range.first + 1),
+            TestedDocIdMap(), entries_range,
+            key_range.second - key_range.first + 1),
         key_range_(key_range) {}
   TestedNumericEntriesFetcher(indexes::Numeric::EntriesRange &entries_range,
                               size_t size)
-      : indexes::Numeric::EntriesFetcher(entries_range, size) {
+      : indexes::Numeric::EntriesFetcher(TestedDocIdMap(), entries_range,
+                                         size) {
     key_range_ = std::make_pair(0, size - 1);
   }
   size_t Size() const override {
@@ -134,11 +150,11 @@ class MockTag : public indexes::Tag {
 class TestedTagEntriesFetcher : public indexes::Tag::EntriesFetcher {
  public:
   TestedTagEntriesFetcher(
-      size_t size, PatriciaTree<InternedStringPtr> &tree,
-      absl::flat_hash_set<PatriciaNode<InternedStringPtr> *> &entries,
+      size_t size, indexes::Tag::PatriciaTreeIndex &tree,
+      absl::flat_hash_set<indexes::Tag::PatriciaNodeIndex *> &entries,
       bool negate, InternedStringSet &untracked_keys)
-      : indexes::Tag::EntriesFetcher(tree, entries, size, negate,
-                                     untracked_keys),
+      : indexes::Tag::EntriesFetcher(TestedDocIdMap(), tree, entries, size,
+                                     negate, untracked_keys),
         size_(size) {}
 
   size_t Size() const override { return size_; }
@@ -215,8 +231,8 @@ void InitIndexSchema(MockIndexSchema *index_schema) {
 
   VMSDK_EXPECT_OK(index_schema->AddIndex("tag_index_100_15", "tag_index_100_15",
                                          tag_index_100_15));
-  static PatriciaTree<InternedStringPtr> tree(false);
-  static absl::flat_hash_set<PatriciaNode<InternedStringPtr> *> entries;
+  static indexes::Tag::PatriciaTreeIndex tree(false);
+  static absl::flat_hash_set<indexes::Tag::PatriciaNodeIndex *> entries;
   static InternedStringSet untracked_keys;
   EXPECT_CALL(*tag_index_100_15, Search(_, false)).WillRepeatedly([]() {
     return std::make_unique<TestedTagEntriesFetcher>(15, tree, entries, false,
@@ -499,14 +515,16 @@ std::shared_ptr<MockIndexSchema> CreateIndexSchemaWithMultipleAttributes(
 
   // Add numeric index
   data_model::NumericIndex numeric_index_proto;
-  auto numeric_index = std::make_shared<indexes::Numeric>(numeric_index_proto);
+  auto numeric_index = std::make_shared<indexes::Numeric>(
+      numeric_index_proto, index_schema->GetDocIdMap());
   VMSDK_EXPECT_OK(index_schema->AddIndex("numeric", "numeric", numeric_index));
 
   // Add tag index
   data_model::TagIndex tag_index_proto;
   tag_index_proto.set_separator(",");
   tag_index_proto.set_case_sensitive(false);
-  auto tag_index = std::make_shared<indexes::Tag>(tag_index_proto);
+  auto tag_index = std::make_shared<indexes::Tag>(tag_index_proto,
+                                                  index_schema->GetDocIdMap());
   VMSDK_EXPECT_OK(index_schema->AddIndex("tag", "tag", tag_index));
 
   // Add records
@@ -628,6 +646,24 @@ INSTANTIATE_TEST_SUITE_P(
             .filter = "@tag:{random}",
             .expected_neighbors_size = 0,
         },
+        {
+            .test_name = "numeric_and_tag_filter",
+            .k = 10,
+            .filter = "@numeric:[1 10] @tag:{LT5}",
+            .expected_neighbors_size = 4,
+        },
+        {
+            .test_name = "numeric_or_tag_filter",
+            .k = 10,
+            .filter = "@numeric:[50 52] | @tag:{LT3}",
+            .expected_neighbors_size = 6,
+        },
+        {
+            .test_name = "numeric_and_negated_tag_filter",
+            .k = 10,
+            .filter = "@numeric:[1 10] -@tag:{LT5}",
+            .expected_neighbors_size = 6,
+        },
         {
             .test_name = "non_vector_numeric_filter_eligible_candidates",
             .filter = "@numeric:[1 10]",
@@ -651,6 +687,154 @@ INSTANTIATE_TEST_SUITE_P(
       return info.param.test_name;
     });
 
+struct SortedByNumericTestCase {
+  std::string test_name;
+  std::string filter;
+  query::SortOrder order;
+  std::vector<std::string> expected_keys;
+  // -1 for every key of the schema.
+  int expected_total_count;
+};
+
+class SortedByNumericTest
+    : public ValkeySearchTestWithParam<SortedByNumericTestCase> {};
+
+TEST_P(SortedByNumericTest, ReturnsTopKeysInOrder) {
+  auto index_schema = CreateIndexSchemaWithMultipleAttributes();
+  const SortedByNumericTestCase &test_case = GetParam();
+  UnitTestSearchParameters params;
+  params.index_schema_name = kIndexSchemaName;
+  params.index_schema = index_schema;
+  TextParsingOptions options{};
+  FilterParser parser(*index_schema, test_case.filter, options);
+  params.filter_parse_results = std::move(parser.Parse().value());
+  params.sortby_parameter =
+      query::SortByParameter{.field = "numeric", .order = test_case.order};
+  params.limit = {.first_index = 2, .number = 3};
+  VMSDK_EXPECT_OK(Search(params, query::SearchMode::kLocal));
+
+  // The first offset + limit keys, plus the buffer kept for the keys that
+  // may be dropped while fetching their content.
+  const auto &neighbors = params.search_result.neighbors;
+  ASSERT_EQ(neighbors.size(), 7);
+  for (size_t i = 0; i < test_case.expected_keys.size(); ++i) {
+    EXPECT_EQ(std::string(*neighbors[i].external_id),
+              test_case.expected_keys[i]);
+  }
+  auto numeric_index = index_schema->GetIndex("numeric").value();
+  EXPECT_EQ(params.search_result.total_count,
+            test_case.expected_total_count < 0
+                ? numeric_index->GetTrackedKeyCount()
+                : static_cast<size_t>(test_case.expected_total_count));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    SortedByNumericTests, SortedByNumericTest,
+    testing::ValuesIn<SortedByNumericTestCase>({
+        {
+            .test_name = "walk_index_ascending",
+            .filter = "@tag:{LT10000}",
+            .order = query::SortOrder::kAscending,
+            .expected_keys = {"0", "1", "2", "3", "4"},
+            .expected_total_count = -1,
+        },
+        {
+            .test_name = "sort_selective_filter_descending",
+            .filter = "@numeric:[10 20]",
+            .order = query::SortOrder::kDescending,
+            .expected_keys = {"20", "19", "18", "17", "16"},
+            .expected_total_count = 11,
+        },
+        {
+            .test_name = "composed_filter_descending",
+            .filter = "@numeric:[10 30] @tag:{LT10000}",
+            .order = query::SortOrder::kDescending,
+            .expected_keys = {"30", "29", "28", "27", "26"},
+            .expected_total_count = 21,
+        },
+    }),
+    [](const testing::TestParamInfo<SortedByNumericTestCase> &info) {
+      return info.param.test_name;
+    });
+
+class ScoredTextSearchTest : public ValkeySearchTest {
+ protected:
+  // Five keys of lengths 1, 3, 4, 2 and 8 words, an average of 3.6. "cat"
+  // occurs in four of them, once through its stem variant "cats".
+  std::shared_ptr<MockIndexSchema> CreateTextIndexSchema() {
+    auto index_schema = CreateIndexSchema(kIndexSchemaName).value();
+    index_schema->CreateTextIndexSchema();
+    auto text_index_schema = index_schema->GetTextIndexSchema();
+    auto text_index = std::make_shared<indexes::Text>(
+        CreateTextIndexProto(false, false, 1.0), text_index_schema);
+    VMSDK_EXPECT_OK(index_schema->AddIndex("body", "body", text_index));
+    for (const auto &[key, body] :
+         std::vector<std::pair<std::string, std::string>>{
+             {"short", "cat"},
+             {"twice", "cat cat dog"},
+             {"stemmed", "cats dog dog dog"},
+             {"none", "dog dog"},
+             {"long", "cat dog dog dog dog dog dog dog"},
+         }) {
+      auto interned_key = StringInternStore::Intern(key);
+      VMSDK_EXPECT_OK(text_index->AddRecord(interned_key, body));
+      text_index_schema->CommitKeyData(interned_key);
+    }
+    return index_schema;
+  }
+
+  void RunSearch(UnitTestSearchParameters &params,
+                 const std::shared_ptr<MockIndexSchema> &index_schema,
+                 query::ScorerType scorer, uint64_t limit) {
+    params.index_schema_name = kIndexSchemaName;
+    params.index_schema = index_schema;
+    TextParsingOptions options{};
+    FilterParser parser(*index_schema, "@body:cat", options);
+    params.filter_parse_results = std::move(parser.Parse().value());
+    params.scorer = scorer;
+    params.limit = {.first_index = 0, .number = limit};
+    VMSDK_EXPECT_OK(query::Search(params, query::SearchMode::kLocal));
+  }
+};
+
+TEST_F(ScoredTextSearchTest, KeepsBestBM25Scores) {
+  auto index_schema = CreateTextIndexSchema();
+  UnitTestSearchParameters params;
+  RunSearch(params, index_schema, query::ScorerType::kBM25, 2);
+
+  // idf = ln(1 + (5 - 4 + 0.5) / (4 + 0.5)), and each key scores
+  // idf * tf * 2.2 / (tf + 1.2 * (0.25 + 0.75 * length / 3.6)).
+  const double idf = std::log(4.0 / 3.0);
+  const std::vector<std::pair<std::string, double>> expected = {
+      {"twice", idf * 4.4 / 3.05},
+      {"short", idf * 2.2 / 1.55},
+      {"stemmed", idf * 2.2 / 2.3},
+  };
+  // The limit plus its buffer, the longest key scoring the lowest is dropped.
+  const auto &neighbors = params.search_result.neighbors;
+  ASSERT_EQ(neighbors.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(std::string(*neighbors[i].external_id), expected[i].first);
+    EXPECT_NEAR(query::Scorer::FromDistance(neighbors[i].distance),
+                expected[i].second, 1e-5);
+  }
+  EXPECT_EQ(params.search_result.total_count, 4);
+}
+
+TEST_F(ScoredTextSearchTest, KeepsBestTFIDFScores) {
+  auto index_schema = CreateTextIndexSchema();
+  UnitTestSearchParameters params;
+  RunSearch(params, index_schema, query::ScorerType::kTFIDF, 1);
+
+  // idf = ln(1 + 5 / 4), TF-IDF doesn't normalize by the key length.
+  const auto &neighbors = params.search_result.neighbors;
+  ASSERT_EQ(neighbors.size(), 1);
+  EXPECT_EQ(std::string(*neighbors[0].external_id), "twice");
+  EXPECT_NEAR(query::Scorer::FromDistance(neighbors[0].distance),
+              2 * std::log(2.25), 1e-5);
+  EXPECT_EQ(params.search_result.total_count, 4);
+}
+
 struct FetchFilteredKeysTestCase {
   std::string test_name;
   std::string filter;
@@ -725,6 +909,138 @@ INSTANTIATE_TEST_SUITE_P(
       return info.param.test_name;
     });
 
+class QueryPlannerTest : public ValkeySearchTest {
+ protected:
+  void SetUp() override {
+    ValkeySearchTest::SetUp();
+    query::ResetCostModel();
+  }
+  void TearDown() override {
+    VMSDK_EXPECT_OK(options::GetQueryPlannerCostModel().SetValue(true));
+    query::ResetCostModel();
+    ValkeySearchTest::TearDown();
+  }
+};
+
+TEST_F(QueryPlannerTest, FlatAlwaysPreFilters) {
+  auto index_schema =
+      CreateIndexSchemaWithMultipleAttributes(IndexerType::kFlat);
+  auto vector_index = dynamic_cast<indexes::VectorBase *>(
+      index_schema->GetIndex(kVectorAttributeAlias)->get());
+  auto index_size = vector_index->GetTrackedKeyCount();
+  auto plan = query::PlanFilteredVectorSearch(index_size, vector_index, 10,
+                                              std::nullopt);
+  EXPECT_EQ(plan.filter_plan, query::FilterPlan::kPreFilter);
+  EXPECT_EQ(plan.index_size, index_size);
+}
+
+TEST_F(QueryPlannerTest, HNSWChoosesCheaperPlan) {
+  auto index_schema = CreateIndexSchemaWithMultipleAttributes();
+  auto vector_index = dynamic_cast<indexes::VectorBase *>(
+      index_schema->GetIndex(kVectorAttributeAlias)->get());
+  auto index_size = vector_index->GetTrackedKeyCount();
+
+  // A selective filter beyond the threshold ratio is still pre-filtered.
+  size_t selective = index_size / 100 + 1;
+  ASSERT_GT(selective, options::GetPrefilteringThresholdRatio() * index_size);
+  auto plan = query::PlanFilteredVectorSearch(selective, vector_index, 10,
+                                              kEfRuntime);
+  EXPECT_EQ(plan.filter_plan, query::FilterPlan::kPreFilter);
+  EXPECT_LT(plan.prefilter_cost_ns, plan.inline_cost_ns);
+
+  // An unselective filter is cheaper to evaluate during graph traversal.
+  plan = query::PlanFilteredVectorSearch(index_size, vector_index, 10,
+                                         kEfRuntime);
+  EXPECT_EQ(plan.filter_plan, query::FilterPlan::kInlineFilter);
+  EXPECT_GT(plan.prefilter_cost_ns, plan.inline_cost_ns);
+
+  // Without the cost model only the threshold ratio is considered.
+  VMSDK_EXPECT_OK(options::GetQueryPlannerCostModel().SetValue(false));
+  plan = query::PlanFilteredVectorSearch(selective, vector_index, 10,
+                                         kEfRuntime);
+  EXPECT_EQ(plan.filter_plan, query::FilterPlan::kInlineFilter);
+}
+
+TEST_F(QueryPlannerTest, ExploresTheUnchosenPlan) {
+  auto index_schema = CreateIndexSchemaWithMultipleAttributes();
+  auto vector_index = dynamic_cast<indexes::VectorBase *>(
+      index_schema->GetIndex(kVectorAttributeAlias)->get());
+  auto index_size = vector_index->GetTrackedKeyCount();
+
+  // A filtered space whose plans have close estimates.
+  size_t close = 0;
+  for (size_t keys = index_size; keys > 0; --keys) {
+    auto plan = query::PlanFilteredVectorSearch(keys, vector_index, 10,
+                                                kEfRuntime);
+    if (std::max(plan.prefilter_cost_ns, plan.inline_cost_ns) <=
+        1.5 * std::min(plan.prefilter_cost_ns, plan.inline_cost_ns)) {
+      close = keys;
+      break;
+    }
+  }
+  ASSERT_GT(close, 0);
+  query::ResetCostModel();
+
+  // Once in a while the costlier plan runs, so that it is calibrated too.
+  int explored = 0;
+  for (int i = 0; i < 128; ++i) {
+    auto plan = query::PlanFilteredVectorSearch(close, vector_index, 10,
+                                                kEfRuntime);
+    auto cheaper = plan.prefilter_cost_ns <= plan.inline_cost_ns
+                       ? query::FilterPlan::kPreFilter
+                       : query::FilterPlan::kInlineFilter;
+    if (plan.explored) {
+      ++explored;
+      EXPECT_NE(plan.filter_plan, cheaper);
+    } else {
+      EXPECT_EQ(plan.filter_plan, cheaper);
+    }
+  }
+  EXPECT_EQ(explored, 2);
+}
+
+TEST_F(QueryPlannerTest, NeverExploresALopsidedPlan) {
+  auto index_schema = CreateIndexSchemaWithMultipleAttributes();
+  auto vector_index = dynamic_cast<indexes::VectorBase *>(
+      index_schema->GetIndex(kVectorAttributeAlias)->get());
+  auto index_size = vector_index->GetTrackedKeyCount();
+
+  // Inline filtering of a small filtered space beyond the threshold ratio is
+  // estimated far costlier than its exhaustive search, so it is never run.
+  size_t selective = index_size / 100 + 1;
+  ASSERT_GT(selective, options::GetPrefilteringThresholdRatio() * index_size);
+  for (int i = 0; i < 256; ++i) {
+    auto plan = query::PlanFilteredVectorSearch(selective, vector_index, 10,
+                                                kEfRuntime);
+    ASSERT_GT(plan.inline_cost_ns, 2 * plan.prefilter_cost_ns);
+    EXPECT_FALSE(plan.explored);
+    EXPECT_EQ(plan.filter_plan, query::FilterPlan::kPreFilter);
+  }
+}
+
+TEST_F(QueryPlannerTest, CalibratesFromObservedLatency) {
+  query::QueryPlan plan;
+  plan.filter_plan = query::FilterPlan::kInlineFilter;
+  plan.inline_units = 1000;
+  auto initial = query::GetCostModelCoefficients();
+
+  // Cancelled executions do not calibrate the model.
+  query::RecordPlanExecution(plan, kIndexSchemaName, absl::Microseconds(10),
+                             /*completed=*/false);
+  EXPECT_EQ(query::GetCostModelCoefficients().inline_samples, 0);
+
+  for (int i = 0; i < 100; ++i) {
+    query::RecordPlanExecution(plan, kIndexSchemaName, absl::Microseconds(10),
+                               /*completed=*/true);
+  }
+  auto calibrated = query::GetCostModelCoefficients();
+  EXPECT_EQ(calibrated.inline_samples, 100);
+  EXPECT_EQ(calibrated.prefilter_samples, 0);
+  EXPECT_GT(calibrated.inline_ns_per_unit, initial.inline_ns_per_unit);
+  EXPECT_NEAR(calibrated.inline_ns_per_unit, 10.0, 1.0);
+  EXPECT_EQ(calibrated.prefilter_ns_per_unit, initial.prefilter_ns_per_unit);
+}
+
 struct SearchTestCase {
   std::string test_name;
   std::string filter;
@@ -875,6 +1191,37 @@ INSTANTIATE_TEST_SUITE_P(
       return test_name;
     });
 
+class SnapshotSearchTest : public ValkeySearchTest {};
+
+TEST_F(SnapshotSearchTest, DoesNotWaitForWritePhase) {
+  VMSDK_EXPECT_OK(options::GetHNSWSnapshotReadsMutable().SetValue(true));
+  UnitTestSearchParameters params;
+  params.index_schema = CreateIndexSchemaWithMultipleAttributes();
+  params.index_schema_name = kIndexSchemaName;
+  params.attribute_alias = kVectorAttributeAlias;
+  params.score_as = vmsdk::MakeUniqueValkeyString(kScoreAs);
+  params.dialect = kDialect;
+  params.k = 5;
+  params.ef = kEfRuntime;
+  std::vector<float> query_vector(kVectorDimensions, 0.0);
+  params.query = VectorToStr(query_vector);
+  {
+    // A regular search would wait for this write phase to end.
+    vmsdk::WriterMutexLock lock(&params.index_schema->GetTimeSlicedMutex());
+    VMSDK_EXPECT_OK(Search(params, query::SearchMode::kLocal));
+  }
+#ifndef SAN_BUILD
+  EXPECT_EQ(params.search_result.neighbors.size(), 5);
+#endif
+  std::unordered_set<std::string> expected_keys = {"0", "1", "2", "3", "4"};
+  for (auto &neighbor : params.search_result.neighbors) {
+    EXPECT_TRUE(expected_keys.contains(std::string(*neighbor.external_id)));
+    EXPECT_EQ(neighbor.sequence_number,
+              std::stoi(std::string(*neighbor.external_id)));
+  }
+  VMSDK_EXPECT_OK(options::GetHNSWSnapshotReadsMutable().SetValue(false));
+}
+
 struct IndexedContentTestCase {
   struct TestReturnAttribute {
     std::string identifier;
@@ -993,7 +1340,8 @@ TEST_P(IndexedContentTest, MaybeAddIndexedContentTest) {
         data_model::TagIndex tag_index_proto;
         tag_index_proto.set_separator(",");
         tag_index_proto.set_case_sensitive(false);
-        auto tag_index = std::make_shared<indexes::Tag>(tag_index_proto);
+        auto tag_index = std::make_shared<indexes::Tag>(
+            tag_index_proto, index_schema->GetDocIdMap());
         VMSDK_EXPECT_OK(index_schema->AddIndex(
             index.attribute_alias, index.attribute_identifier, tag_index));
         index_base = tag_index;
@@ -1001,8 +1349,8 @@ TEST_P(IndexedContentTest, MaybeAddIndexedContentTest) {
       }
       case IndexerType::kNumeric: {
         data_model::NumericIndex numeric_index_proto;
-        auto numeric_index =
-            std::make_shared<indexes::Numeric>(numeric_index_proto);
+        auto numeric_index = std::make_shared<indexes::Numeric>(
+            numeric_index_proto, index_schema->GetDocIdMap());
         VMSDK_EXPECT_OK(index_schema->AddIndex(
             index.attribute_alias, index.attribute_identifier, numeric_index));
         index_base = numeric_index;
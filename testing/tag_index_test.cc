@@ -68,6 +68,56 @@ TEST_F(TagIndexTest, AddRecordAndSearchTest) {
   EXPECT_THAT(Fetch(*entries_fetcher), testing::UnorderedElementsAre("key1"));
 }
 
+TEST_F(TagIndexTest, AddRecordsAndSearchTest) {
+  EXPECT_TRUE(index->AddRecord("key1", "tag1").value());
+  std::vector<IndexBase::Record> records = {
+      {.key = StringInternStore::Intern("key3"), .record = "tag3,tag1"},
+      {.key = StringInternStore::Intern("key1"), .record = "tag2"},
+      {.key = StringInternStore::Intern("key4"), .record = "    "},
+      {.key = StringInternStore::Intern("key2"), .record = "tag2"},
+  };
+  auto results = index->AddRecords(records);
+  ASSERT_EQ(results.size(), 4);
+  EXPECT_TRUE(results[0].value());
+  EXPECT_EQ(results[1].status().code(), absl::StatusCode::kAlreadyExists);
+  EXPECT_FALSE(results[2].value());
+  EXPECT_TRUE(results[3].value());
+  EXPECT_FALSE(index->IsTracked("key4"));
+
+  std::string filter_tag_string = "tag1";
+  auto parsed_tags = FilterParser::ParseQueryTags(filter_tag_string).value();
+  query::TagPredicate predicate(index.get(), alias, identifier,
+                                filter_tag_string, parsed_tags);
+  auto entries_fetcher = index->Search(predicate, false);
+  EXPECT_THAT(Fetch(*entries_fetcher),
+              testing::UnorderedElementsAre("key1", "key3"));
+}
+
+TEST_F(TagIndexTest, SaveAndLoadRecordsTest) {
+  EXPECT_TRUE(index->AddRecord("key1", "tag1,tag2").value());
+  EXPECT_TRUE(index->AddRecord("key2", "tag2").value());
+  EXPECT_FALSE(index->AddRecord("key3", "    ").value());
+  FakeSafeRDB rdb;
+  VMSDK_EXPECT_OK(index->SaveRecords(RDBChunkOutputStream(&rdb)));
+
+  data_model::TagIndex tag_index_proto;
+  tag_index_proto.set_separator(",");
+  tag_index_proto.set_case_sensitive(false);
+  IndexTeser<Tag, data_model::TagIndex> loaded(tag_index_proto);
+  VMSDK_EXPECT_OK(loaded.LoadRecords(
+      RDBChunkInputStream(SupplementalContentChunkIter(&rdb))));
+  EXPECT_EQ(loaded.GetTrackedKeyCount(), 2);
+  EXPECT_EQ(loaded.GetUnTrackedKeyCount(), 1);
+
+  std::string filter_tag_string = "tag2";
+  auto parsed_tags = FilterParser::ParseQueryTags(filter_tag_string).value();
+  query::TagPredicate predicate(&loaded, alias, identifier, filter_tag_string,
+                                parsed_tags);
+  auto entries_fetcher = loaded.Search(predicate, false);
+  EXPECT_THAT(Fetch(*entries_fetcher),
+              testing::UnorderedElementsAre("key1", "key2"));
+}
+
 TEST_F(TagIndexTest, RemoveRecordAndSearchTest) {
   EXPECT_TRUE(index->AddRecord("key1", "tag1").value());
   EXPECT_TRUE(index->AddRecord("key2", "tag2").value());
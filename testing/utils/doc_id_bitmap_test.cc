@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2025, valkey-search contributors
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD 3-Clause
+ *
+ */
+
+#include "src/utils/doc_id_bitmap.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <set>
+#include <vector>
+
+#include "absl/random/random.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace valkey_search {
+
+namespace {
+
+using testing::ElementsAre;
+using testing::ElementsAreArray;
+
+std::vector<DocId> ToVector(const DocIdBitmap& bitmap) {
+  return std::vector<DocId>(bitmap.begin(), bitmap.end());
+}
+
+TEST(DocIdBitmapTest, InsertEraseContains) {
+  DocIdBitmap bitmap;
+  EXPECT_TRUE(bitmap.empty());
+  EXPECT_TRUE(bitmap.insert(5));
+  EXPECT_FALSE(bitmap.insert(5));
+  EXPECT_TRUE(bitmap.insert(1 << 20));
+  EXPECT_TRUE(bitmap.insert(0));
+  EXPECT_EQ(bitmap.size(), 3);
+  EXPECT_TRUE(bitmap.contains(1 << 20));
+  EXPECT_FALSE(bitmap.contains(6));
+  EXPECT_THAT(ToVector(bitmap), ElementsAre(0, 5, 1 << 20));
+  EXPECT_EQ(bitmap.erase(6), 0);
+  EXPECT_EQ(bitmap.erase(1 << 20), 1);
+  EXPECT_THAT(ToVector(bitmap), ElementsAre(0, 5));
+  bitmap.clear();
+  EXPECT_TRUE(bitmap.empty());
+  EXPECT_EQ(bitmap.begin(), bitmap.end());
+}
+
+TEST(DocIdBitmapTest, DenseChunks) {
+  DocIdBitmap bitmap;
+  std::vector<DocId> expected;
+  // Every other id of the first chunk makes it dense.
+  for (DocId id = 0; id < 20000; id += 2) {
+    bitmap.insert(id);
+    expected.push_back(id);
+  }
+  EXPECT_EQ(bitmap.size(), expected.size());
+  EXPECT_THAT(ToVector(bitmap), ElementsAreArray(expected));
+  EXPECT_LT(bitmap.MemoryUsage(), expected.size() * sizeof(DocId));
+  // Erasing most of the ids converts the chunk back to an array.
+  for (DocId id = 2; id < 20000; id += 2) {
+    bitmap.erase(id);
+  }
+  EXPECT_THAT(ToVector(bitmap), ElementsAre(0));
+  EXPECT_EQ(bitmap, DocIdBitmap({0}));
+}
+
+TEST(DocIdBitmapTest, FromIds) {
+  EXPECT_TRUE(DocIdBitmap::FromIds({}).empty());
+  absl::BitGen gen;
+  for (int round = 0; round < 20; ++round) {
+    DocIdBitmap expected;
+    std::vector<DocId> ids;
+    // Unordered and repeated ids over sparse and dense chunks.
+    size_t size = absl::Uniform<size_t>(gen, 0, round % 2 ? 100 : 20000);
+    for (size_t i = 0; i < size; ++i) {
+      DocId id = absl::Uniform<DocId>(gen, 0, 3 << 16);
+      ids.push_back(id);
+      ids.push_back(id);
+      expected.insert(id);
+    }
+    auto bitmap = DocIdBitmap::FromIds(std::move(ids));
+    EXPECT_EQ(bitmap.size(), expected.size());
+    EXPECT_EQ(bitmap, expected);
+    EXPECT_THAT(ToVector(bitmap), ElementsAreArray(ToVector(expected)));
+  }
+}
+
+TEST(DocIdBitmapTest, MatchesReferenceSetOperations) {
+  absl::BitGen gen;
+  for (int round = 0; round < 50; ++round) {
+    std::set<DocId> expected_a;
+    std::set<DocId> expected_b;
+    DocIdBitmap a;
+    DocIdBitmap b;
+    // Mix sparse and dense chunks over a few chunks of the id space.
+    size_t size_a = absl::Uniform<size_t>(gen, 0, 20000);
+    size_t size_b = absl::Uniform<size_t>(gen, 0, round % 2 ? 100 : 20000);
+    for (size_t i = 0; i < size_a; ++i) {
+      DocId id = absl::Uniform<DocId>(gen, 0, 3 << 16);
+      EXPECT_EQ(a.insert(id), expected_a.insert(id).second);
+    }
+    for (size_t i = 0; i < size_b; ++i) {
+      DocId id = absl::Uniform<DocId>(gen, 0, 3 << 16);
+      EXPECT_EQ(b.insert(id), expected_b.insert(id).second);
+    }
+    EXPECT_THAT(ToVector(a), ElementsAreArray(expected_a));
+
+    std::vector<DocId> expected_and;
+    std::set_intersection(expected_a.begin(), expected_a.end(),
+                          expected_b.begin(), expected_b.end(),
+                          std::back_inserter(expected_and));
+    std::vector<DocId> expected_or;
+    std::set_union(expected_a.begin(), expected_a.end(), expected_b.begin(),
+                   expected_b.end(), std::back_inserter(expected_or));
+    auto intersection = a & b;
+    auto merged = a | b;
+    EXPECT_EQ(intersection.size(), expected_and.size());
+    EXPECT_THAT(ToVector(intersection), ElementsAreArray(expected_and));
+    EXPECT_EQ(merged.size(), expected_or.size());
+    EXPECT_THAT(ToVector(merged), ElementsAreArray(expected_or));
+    EXPECT_EQ(b & a, intersection);
+    EXPECT_EQ(b | a, merged);
+  }
+}
+
+}  // namespace
+
+}  // namespace valkey_search
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2025, valkey-search contributors
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD 3-Clause
+ *
+ */
+
+#include "src/utils/doc_id_map.h"
+
+#include <optional>
+
+#include "gtest/gtest.h"
+#include "src/utils/doc_id_bitmap.h"
+#include "src/utils/string_interning.h"
+#include "vmsdk/src/testing_infra/utils.h"
+
+namespace valkey_search {
+
+namespace {
+
+class DocIdMapTest : public vmsdk::ValkeyTest {};
+
+TEST_F(DocIdMapTest, AssignsDenseIds) {
+  DocIdMap doc_ids;
+  auto key1 = StringInternStore::Intern("key1");
+  auto key2 = StringInternStore::Intern("key2");
+  EXPECT_EQ(doc_ids.Acquire(key1), 0);
+  EXPECT_EQ(doc_ids.Acquire(key2), 1);
+  EXPECT_EQ(doc_ids.Size(), 2);
+  EXPECT_EQ(doc_ids.Find(key2), 1);
+  EXPECT_EQ(doc_ids.GetKey(0), key1);
+  EXPECT_EQ(doc_ids.Find(StringInternStore::Intern("key3")), std::nullopt);
+}
+
+TEST_F(DocIdMapTest, KeepsIdUntilLastRelease) {
+  DocIdMap doc_ids;
+  auto key = StringInternStore::Intern("key");
+  const DocId id = doc_ids.Acquire(key);
+  EXPECT_EQ(doc_ids.Acquire(key), id);
+  doc_ids.Release(id);
+  EXPECT_EQ(doc_ids.Find(key), id);
+  EXPECT_EQ(doc_ids.GetKey(id), key);
+  doc_ids.Release(id);
+  EXPECT_EQ(doc_ids.Find(key), std::nullopt);
+  EXPECT_EQ(doc_ids.Size(), 0);
+}
+
+TEST_F(DocIdMapTest, RecyclesReleasedIds) {
+  DocIdMap doc_ids;
+  auto key1 = StringInternStore::Intern("key1");
+  auto key2 = StringInternStore::Intern("key2");
+  auto key3 = StringInternStore::Intern("key3");
+  doc_ids.Acquire(key1);
+  const DocId id2 = doc_ids.Acquire(key2);
+  doc_ids.Release(id2);
+  EXPECT_EQ(doc_ids.Acquire(key3), id2);
+  EXPECT_EQ(doc_ids.GetKey(id2), key3);
+  EXPECT_EQ(doc_ids.Acquire(key2), 2);
+}
+
+}  // namespace
+
+}  // namespace valkey_search
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2025, valkey-search contributors
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD 3-Clause
+ *
+ */
+
+#include "src/indexes/vector_flat.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/index_schema.pb.h"
+#include "src/utils/cancel.h"
+#include "src/utils/string_interning.h"
+#include "src/valkey_search.h"
+#include "src/valkey_search_options.h"
+#include "testing/common.h"
+#include "third_party/hnswlib/bruteforce.h"
+#include "third_party/hnswlib/hnswlib.h"
+#include "third_party/hnswlib/space_l2.h"
+#include "vmsdk/src/testing_infra/utils.h"
+
+namespace valkey_search::indexes {
+
+namespace {
+
+constexpr int kDimensions = 4;
+constexpr uint64_t kK = 10;
+constexpr int kQueries = 5;
+
+using Results = std::priority_queue<std::pair<float, hnswlib::labeltype>>;
+
+class EvenLabelsFilter : public hnswlib::BaseFilterFunctor {
+ public:
+  bool operator()(hnswlib::labeltype id) override { return id % 2 == 0; }
+};
+
+class AlwaysCancelled : public hnswlib::BaseCancellationFunctor {
+ public:
+  bool isCancelled() override { return true; }
+};
+
+std::vector<std::pair<float, hnswlib::labeltype>> Drain(Results results) {
+  std::vector<std::pair<float, hnswlib::labeltype>> drained;
+  for (; !results.empty(); results.pop()) {
+    drained.push_back(results.top());
+  }
+  return drained;
+}
+
+// The k closest of `vectors` to `query`, labeled by position.
+Results ExactSearch(const std::vector<std::vector<float>>& vectors,
+                    const float* query, size_t k,
+                    hnswlib::BaseFilterFunctor* filter) {
+  hnswlib::L2Space space(kDimensions);
+  Results results;
+  for (size_t i = 0; i < vectors.size(); ++i) {
+    if (filter && !(*filter)(i)) {
+      continue;
+    }
+    float distance = space.get_dist_func()(query, vectors[i].data(),
+                                           space.get_dist_func_param());
+    results.emplace(distance, i);
+    if (results.size() > k) {
+      results.pop();
+    }
+  }
+  return results;
+}
+
+class SearchKnnRangeTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    vectors_ = DeterministicallyGenerateVectors(1000, kDimensions, 2.2);
+    algo_ = std::make_unique<hnswlib::BruteforceSearch<float>>(&space_,
+                                                               vectors_.size());
+    for (size_t i = 0; i < vectors_.size(); ++i) {
+      algo_->addPoint(vectors_[i].data(), i);
+    }
+    queries_ = DeterministicallyGenerateVectors(kQueries, kDimensions, 1.5);
+  }
+
+  hnswlib::L2Space space_{kDimensions};
+  std::vector<std::vector<float>> vectors_;
+  std::vector<std::vector<float>> queries_;
+  std::unique_ptr<hnswlib::BruteforceSearch<float>> algo_;
+};
+
+TEST_F(SearchKnnRangeTest, FullRangeMatchesSearchKnn) {
+  for (const auto& query : queries_) {
+    auto range = algo_->searchKnnRange(query.data(), kK, 0, vectors_.size());
+    EXPECT_EQ(Drain(range), Drain(algo_->searchKnn(query.data(), kK)));
+  }
+}
+
+TEST_F(SearchKnnRangeTest, MergedRangesMatchFullRange) {
+  for (const auto& query : queries_) {
+    Results merged;
+    // The last range ends past the element count.
+    for (auto [begin, end] : {std::pair<size_t, size_t>{0, 300},
+                              {300, 700},
+                              {700, vectors_.size() + 100}}) {
+      auto results = algo_->searchKnnRange(query.data(), kK, begin, end);
+      EXPECT_LE(results.size(), kK);
+      for (; !results.empty(); results.pop()) {
+        merged.push(results.top());
+        if (merged.size() > kK) {
+          merged.pop();
+        }
+      }
+    }
+    EXPECT_EQ(Drain(merged),
+              Drain(ExactSearch(vectors_, query.data(), kK, nullptr)));
+  }
+}
+
+TEST_F(SearchKnnRangeTest, Filter) {
+  EvenLabelsFilter filter;
+  for (const auto& query : queries_) {
+    auto results = Drain(
+        algo_->searchKnnRange(query.data(), kK, 0, vectors_.size(), &filter));
+    EXPECT_EQ(results.size(), kK);
+    for (const auto& [_, label] : results) {
+      EXPECT_EQ(label % 2, 0);
+    }
+    EXPECT_EQ(results,
+              Drain(ExactSearch(vectors_, query.data(), kK, &filter)));
+  }
+}
+
+TEST_F(SearchKnnRangeTest, EmptyRangesAndCancellation) {
+  const float* query = queries_[0].data();
+  EXPECT_TRUE(algo_->searchKnnRange(query, 0, 0, vectors_.size()).empty());
+  EXPECT_TRUE(algo_->searchKnnRange(query, kK, 500, 500).empty());
+  EXPECT_TRUE(
+      algo_->searchKnnRange(query, kK, vectors_.size(), vectors_.size() + 10)
+          .empty());
+  AlwaysCancelled cancelled;
+  EXPECT_TRUE(algo_->searchKnnRange(query, kK, 0, vectors_.size(), nullptr,
+                                    &cancelled)
+                  .empty());
+}
+
+// Runs the same searches serially and split across the reader threads, with
+// fewer and more vectors than a search morsel.
+class ParallelSearchKnnTest : public ValkeySearchTestWithParam<size_t> {
+ protected:
+  void SetUp() override {
+    ValkeySearchTestWithParam<size_t>::SetUp();
+    InitThreadPools(4, std::nullopt, std::nullopt);
+    auto index = VectorFlat<float>::Create(
+        CreateFlatVectorIndexProto(kDimensions, data_model::DISTANCE_METRIC_L2,
+                                   GetParam(), 1024),
+        "attribute_identifier",
+        data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH);
+    VMSDK_EXPECT_OK(index);
+    index_ = std::move(index.value());
+    auto vectors = DeterministicallyGenerateVectors(GetParam(), kDimensions,
+                                                    2.2);
+    for (size_t i = 0; i < vectors.size(); ++i) {
+      auto res = index_->AddRecord(
+          StringInternStore::Intern(std::to_string(i) + "_key"),
+          VectorToStr(vectors[i]));
+      VMSDK_EXPECT_OK(res);
+    }
+    queries_ = DeterministicallyGenerateVectors(kQueries, kDimensions, 1.5);
+  }
+  void TearDown() override {
+    VMSDK_EXPECT_OK(options::GetMaxSearchParallelism().SetValue(
+        default_parallelism_));
+    ValkeySearchTestWithParam<size_t>::TearDown();
+  }
+
+  std::vector<NeighborTest> Search(const std::vector<float>& query,
+                                   size_t parallelism, bool filter,
+                                   cancel::Token& token) {
+    VMSDK_EXPECT_OK(options::GetMaxSearchParallelism().SetValue(parallelism));
+    auto res = index_->Search(
+        VectorToStr(query), kK, token,
+        filter ? std::make_unique<EvenLabelsFilter>() : nullptr);
+    VMSDK_EXPECT_OK(res);
+    return ToVectorNeighborTest(*res);
+  }
+
+  const long long default_parallelism_ =
+      options::GetMaxSearchParallelism().GetValue();
+  std::shared_ptr<VectorFlat<float>> index_;
+  std::vector<std::vector<float>> queries_;
+};
+
+TEST_P(ParallelSearchKnnTest, MatchesSerialSearch) {
+  for (bool filter : {false, true}) {
+    for (const auto& query : queries_) {
+      auto token = cancel::Make(1000000, nullptr);
+      auto serial = Search(query, 1, filter, token);
+      auto parallel = Search(query, 4, filter, token);
+      EXPECT_EQ(parallel, serial);
+    }
+  }
+}
+
+TEST_P(ParallelSearchKnnTest, Cancellation) {
+  auto token = cancel::Make(1000000, nullptr);
+  token->Cancel();
+  auto results = Search(queries_[0], 4, false, token);
+  if (GetParam() > kSearchMorselSize) {
+    // No morsel is scanned once the search is cancelled.
+    EXPECT_TRUE(results.empty());
+  }
+  // The helpers that did not start before the search completed find no
+  // morsel left, and the pool drains.
+  WaitWorkerTasksAreCompleted(
+      *ValkeySearch::Instance().GetReaderThreadPool());
+  auto uncancelled = cancel::Make(1000000, nullptr);
+  EXPECT_EQ(Search(queries_[0], 4, false, uncancelled).size(),
+            Search(queries_[0], 1, false, uncancelled).size());
+}
+
+INSTANTIATE_TEST_SUITE_P(ParallelSearchKnnTests, ParallelSearchKnnTest,
+                         testing::Values(1000, 2 * kSearchMorselSize + 1000),
+                         [](const testing::TestParamInfo<size_t>& info) {
+                           return "Vectors" + std::to_string(info.param);
+                         });
+
+}  // namespace
+
+}  // namespace valkey_search::indexes
@@ -21,21 +21,26 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/notification.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "src/attribute_data_type.h"
 #include "src/index_schema.pb.h"
 #include "src/indexes/index_base.h"
 #include "src/indexes/vector_base.h"
+#include "src/indexes/vector_data_type.h"
 #include "src/indexes/vector_flat.h"
 #include "src/indexes/vector_hnsw.h"
+#include "src/indexes/vector_ivf_pq.h"
 #include "src/utils/cancel.h"
 #include "src/utils/string_interning.h"
+#include "src/valkey_search.h"
 #include "src/valkey_search_options.h"
 #include "testing/common.h"
 #include "third_party/hnswlib/space_ip.h"
 #include "third_party/hnswlib/space_l2.h"
 #include "vmsdk/src/managed_pointers.h"
+#include "vmsdk/src/thread_pool.h"
 #include "vmsdk/src/type_conversions.h"
 
 namespace valkey_search::indexes {
@@ -363,16 +368,72 @@ TEST_F(VectorIndexTest, ResizeFlat) ABSL_NO_THREAD_SAFETY_ANALYSIS {
   }
 }
 
-float CalcRecall(VectorFlat<float>* flat_index, VectorHNSW<float>* hnsw_index,
-                 uint64_t k, int dimensions, std::optional<size_t> ef_runtime) {
+void VerifyAddRecords(VectorBase* index, size_t initial_cap,
+                      size_t block_size) {
+  auto vectors = DeterministicallyGenerateVectors(
+      initial_cap + block_size + 100, kDimensions, 10.0);
+  std::vector<float> wrong_size_vector(kDimensions - 1, 1.0);
+  std::vector<VectorBase::VectorRecord> records;
+  for (size_t i = 0; i < vectors.size(); ++i) {
+    records.push_back(
+        {.key = IndexToKey(i), .record = VectorToStr(vectors[i])});
+  }
+  records.push_back({.key = IndexToKey(0), .record = VectorToStr(vectors[1])});
+  records.push_back({.key = IndexToKey(vectors.size()),
+                     .record = VectorToStr(wrong_size_vector)});
+  auto results = index->AddRecords(records);
+  ASSERT_EQ(results.size(), records.size());
+  for (size_t i = 0; i < vectors.size(); ++i) {
+    VerifyResult(results[i], ExpectedResults::kSuccess);
+    EXPECT_TRUE(index->IsTracked(IndexToKey(i)));
+  }
+  VerifyResult(results[vectors.size()], ExpectedResults::kError);
+  VerifyResult(results[vectors.size() + 1], ExpectedResults::kSkipped);
+  EXPECT_FALSE(index->IsTracked(IndexToKey(vectors.size())));
+  // The capacity is grown once for the whole batch, by whole blocks.
+  EXPECT_EQ(index->GetCapacity(), initial_cap + 2 * block_size);
+  for (size_t i = 0; i < vectors.size(); ++i) {
+    auto value = index->GetValue(IndexToKey(i));
+    VMSDK_EXPECT_OK(value);
+    EXPECT_EQ(absl::string_view(value->data(), value->size()),
+              VectorToStr(vectors[i]));
+  }
+}
+
+TEST_F(VectorIndexTest, AddRecordsHNSW) ABSL_NO_THREAD_SAFETY_ANALYSIS {
+  const int initial_cap = 10;
+  auto index = VectorHNSW<float>::Create(
+      CreateHNSWVectorIndexProto(kDimensions, data_model::DISTANCE_METRIC_L2,
+                                 initial_cap, kM, kEFConstruction, kEFRuntime),
+      "attribute_identifier_1",
+      data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH);
+  ValkeySearch::Instance().SetHNSWBlockSize(1024);
+  VerifyAddRecords(index->get(), initial_cap,
+                   ValkeySearch::Instance().GetHNSWBlockSize());
+}
+
+TEST_F(VectorIndexTest, AddRecordsFlat) ABSL_NO_THREAD_SAFETY_ANALYSIS {
+  const int initial_cap = 10;
+  auto index = VectorFlat<float>::Create(
+      CreateFlatVectorIndexProto(kDimensions, data_model::DISTANCE_METRIC_L2,
+                                 initial_cap, kBlockSize),
+      "attribute_identifier_1",
+      data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH);
+  VerifyAddRecords(index->get(), initial_cap, kBlockSize);
+}
+
+template <typename T>
+float CalcRecall(VectorFlat<float>* flat_index, T* approximate_index,
+                 uint64_t k, int dimensions,
+                 std::optional<size_t> search_param) {
   auto search_vectors = DeterministicallyGenerateVectors(50, dimensions, 1.5);
   int cnt = 0;
   for (const auto& search_vector : search_vectors) {
     absl::string_view vector = VectorToStr(search_vector);
-    auto res_hnsw =
-        hnsw_index->Search(vector, k, CancelNever(), nullptr, ef_runtime);
+    auto res_approximate = approximate_index->Search(vector, k, CancelNever(),
+                                                     nullptr, search_param);
     auto res_flat = flat_index->Search(vector, k, CancelNever());
-    for (auto& label : *res_hnsw) {
+    for (auto& label : *res_approximate) {
       for (auto& real_label : *res_flat) {
         if (label.external_id == real_label.external_id) {
           ++cnt;
@@ -383,6 +444,47 @@ float CalcRecall(VectorFlat<float>* flat_index, VectorHNSW<float>* hnsw_index,
   }
   return ((float)(cnt)) / ((float)(k * search_vectors.size()));
 }
+TEST_F(VectorIndexTest, BuildingHNSW) ABSL_NO_THREAD_SAFETY_ANALYSIS {
+  InitThreadPools(std::nullopt, 4, std::nullopt);
+  auto index_hnsw = VectorHNSW<float>::Create(
+      CreateHNSWVectorIndexProto(kDimensions, data_model::DISTANCE_METRIC_L2,
+                                 kInitialCap, kM, kEFConstruction, kEFRuntime),
+      "attribute_identifier_1",
+      data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH);
+  auto index_flat = VectorFlat<float>::Create(
+      CreateFlatVectorIndexProto(kDimensions, data_model::DISTANCE_METRIC_L2,
+                                 kInitialCap, kBlockSize),
+      "attribute_identifier_1",
+      data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH);
+  (*index_hnsw)->SetBuilding(true);
+  // The batch is inserted with the help of the writer threads.
+  auto vectors = DeterministicallyGenerateVectors(1000, kDimensions, 2.2);
+  std::vector<VectorBase::VectorRecord> records;
+  for (size_t i = 0; i < vectors.size(); ++i) {
+    records.push_back(
+        {.key = IndexToKey(i), .record = VectorToStr(vectors[i])});
+    VerifyAdd(index_flat->get(), vectors, i, ExpectedResults::kSuccess);
+  }
+  for (const auto& result : (*index_hnsw)->AddRecords(records)) {
+    VerifyResult(result, ExpectedResults::kSuccess);
+  }
+  EXPECT_EQ((*index_hnsw)->GetTrackedKeyCount(), vectors.size());
+  // Queries are answered by an exact scan while building.
+  EXPECT_EQ(CalcRecall(index_flat->get(), index_hnsw->get(), 10, kDimensions,
+                       std::nullopt),
+            1.0f);
+
+  VMSDK_EXPECT_OK(options::GetHNSWBuildFlatFallbackMutable().SetValue(false));
+  EXPECT_GE(CalcRecall(index_flat->get(), index_hnsw->get(), 10, kDimensions,
+                       kEFRuntime * 8),
+            0.96f);
+  VMSDK_EXPECT_OK(options::GetHNSWBuildFlatFallbackMutable().SetValue(true));
+  (*index_hnsw)->SetBuilding(false);
+  EXPECT_GE(CalcRecall(index_flat->get(), index_hnsw->get(), 10, kDimensions,
+                       kEFRuntime * 8),
+            0.96f);
+}
+
 // Note this test is expected to fail if run with `config=release`. This has to
 // do with the usage of the optimization flag `-ffast-math`
 TEST_F(VectorIndexTest, EfRuntimeRecall) {
@@ -420,6 +522,332 @@ TEST_F(VectorIndexTest, EfRuntimeRecall) {
   }
 }
 
+TEST_F(VectorIndexTest, IVFPQRecall) {
+  const int dimensions = 16;
+  const uint32_t nlist = 16;
+  const uint64_t k = 10;
+  for (auto& distance_metric :
+       {data_model::DISTANCE_METRIC_COSINE, data_model::DISTANCE_METRIC_L2}) {
+    auto index_ivf_pq = VectorIVFPQ<float>::Create(
+        CreateIVFPQVectorIndexProto(dimensions, distance_metric, kInitialCap,
+                                    nlist, 0, 1),
+        "attribute_identifier_1",
+        data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH);
+    VMSDK_EXPECT_OK(index_ivf_pq);
+    EXPECT_EQ(index_ivf_pq.value()->GetPqM(), 4u);
+    auto index_flat = VectorFlat<float>::Create(
+        CreateFlatVectorIndexProto(dimensions, distance_metric, kInitialCap,
+                                   kBlockSize),
+        "attribute_identifier_1",
+        data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH);
+    const size_t training_size = index_ivf_pq.value()->GetTrainingSize();
+    auto vectors =
+        DeterministicallyGenerateVectors(training_size + 500, dimensions, 2.2);
+    for (size_t i = 0; i < vectors.size(); ++i) {
+      VerifyAdd(index_flat->get(), vectors, i, ExpectedResults::kSuccess);
+      VerifyAdd(index_ivf_pq->get(), vectors, i, ExpectedResults::kSuccess);
+      // Until the quantizers are trained the index is searched exactly.
+      if (i + 1 == training_size - 1) {
+        EXPECT_FALSE(index_ivf_pq.value()->IsTrained());
+        EXPECT_EQ(CalcRecall(index_flat->get(), index_ivf_pq->get(), k,
+                             dimensions, std::nullopt),
+                  1.0f);
+      }
+    }
+    EXPECT_TRUE(index_ivf_pq.value()->IsTrained());
+    auto default_nprobe_recall = CalcRecall(
+        index_flat->get(), index_ivf_pq->get(), k, dimensions, std::nullopt);
+    auto full_nprobe_recall = CalcRecall(index_flat->get(), index_ivf_pq->get(),
+                                         k, dimensions, nlist);
+    EXPECT_LE(default_nprobe_recall, full_nprobe_recall);
+    EXPECT_GE(full_nprobe_recall, 0.9f);
+
+    // Removed vectors are no longer returned.
+    auto res = index_ivf_pq.value()->Search(VectorToStr(vectors[0]), k,
+                                            CancelNever(), nullptr, nlist);
+    VMSDK_EXPECT_OK(res);
+    EXPECT_EQ((*res)[0].external_id, IndexToKey(0));
+    VMSDK_EXPECT_OK(
+        index_ivf_pq.value()->RemoveRecord(IndexToKey(0), DeletionType::kNone));
+    res = index_ivf_pq.value()->Search(VectorToStr(vectors[0]), k,
+                                       CancelNever(), nullptr, nlist);
+    VMSDK_EXPECT_OK(res);
+    for (const auto& neighbor : *res) {
+      EXPECT_NE(neighbor.external_id, IndexToKey(0));
+    }
+  }
+}
+
+TEST_F(VectorIndexTest, IVFPQTrainsInTheBackground) {
+  const int dimensions = 16;
+  const uint32_t nlist = 16;
+  const uint64_t k = 10;
+  InitThreadPools(std::nullopt, std::nullopt, 1);
+  auto utility_thread_pool = ValkeySearch::Instance().GetUtilityThreadPool();
+  // Hold the utility thread so that the training stays pending.
+  absl::Notification release_training;
+  utility_thread_pool->Schedule(
+      [&]() { release_training.WaitForNotification(); },
+      vmsdk::ThreadPool::Priority::kHigh);
+  auto index_ivf_pq = VectorIVFPQ<float>::Create(
+      CreateIVFPQVectorIndexProto(dimensions,
+                                  data_model::DISTANCE_METRIC_COSINE,
+                                  kInitialCap, nlist, 0, 1),
+      "attribute_identifier_1",
+      data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH);
+  VMSDK_EXPECT_OK(index_ivf_pq);
+  auto index_flat = VectorFlat<float>::Create(
+      CreateFlatVectorIndexProto(dimensions, data_model::DISTANCE_METRIC_COSINE,
+                                 kInitialCap, kBlockSize),
+      "attribute_identifier_1",
+      data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH);
+  auto vectors = DeterministicallyGenerateVectors(
+      index_ivf_pq.value()->GetTrainingSize() + 500, dimensions, 2.2);
+  for (size_t i = 0; i < vectors.size(); ++i) {
+    VerifyAdd(index_flat->get(), vectors, i, ExpectedResults::kSuccess);
+    VerifyAdd(index_ivf_pq->get(), vectors, i, ExpectedResults::kSuccess);
+  }
+  // The writes do not wait for the training, and the vectors indexed past the
+  // training size are searched exactly until the quantizers are swapped in.
+  EXPECT_FALSE(index_ivf_pq.value()->IsTrained());
+  EXPECT_EQ(CalcRecall(index_flat->get(), index_ivf_pq->get(), k, dimensions,
+                       std::nullopt),
+            1.0f);
+
+  release_training.Notify();
+  WaitWorkerTasksAreCompleted(*utility_thread_pool);
+  EXPECT_TRUE(index_ivf_pq.value()->IsTrained());
+  EXPECT_GE(CalcRecall(index_flat->get(), index_ivf_pq->get(), k, dimensions,
+                       nlist),
+            0.9f);
+}
+
+TEST_F(VectorIndexTest, IVFPQInvalidParameters) {
+  EXPECT_EQ(VectorIVFPQ<float>::Create(
+                CreateIVFPQVectorIndexProto(
+                    kDimensions, data_model::DISTANCE_METRIC_L2, kInitialCap,
+                    16, 7, 1),
+                "attribute_identifier_1",
+                data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH)
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+  auto proto = CreateIVFPQVectorIndexProto(
+      kDimensions, data_model::DISTANCE_METRIC_L2, kInitialCap, 16, 0, 1);
+  proto.set_vector_data_type(data_model::VECTOR_DATA_TYPE_FLOAT16);
+  EXPECT_EQ(VectorIVFPQ<float>::Create(
+                proto, "attribute_identifier_1",
+                data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH)
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST_F(VectorIndexTest, QuantizedRerankMatchesFullPrecision) {
+  auto vectors = DeterministicallyGenerateVectors(1000, kDimensions, 2.2);
+  auto search_vectors = DeterministicallyGenerateVectors(20, kDimensions, 1.5);
+  uint64_t k = 10;
+  for (auto& distance_metric :
+       {data_model::DISTANCE_METRIC_COSINE, data_model::DISTANCE_METRIC_L2}) {
+    auto full_precision = VectorFlat<float>::Create(
+        CreateFlatVectorIndexProto(kDimensions, distance_metric, kInitialCap,
+                                   kBlockSize),
+        "attribute_identifier_1",
+        data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH);
+    auto proto = CreateFlatVectorIndexProto(kDimensions, distance_metric,
+                                            kInitialCap, kBlockSize);
+    proto.set_quantization(data_model::VECTOR_QUANTIZATION_SQ8);
+    proto.set_rerank_factor(8);
+    auto quantized = VectorFlat<float>::Create(
+        proto, "attribute_identifier_1",
+        data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH);
+    EXPECT_TRUE(quantized.value()->IsQuantized());
+    EXPECT_TRUE(quantized.value()->HasFullPrecisionValues());
+    for (size_t i = 0; i < vectors.size(); ++i) {
+      VerifyAdd(full_precision->get(), vectors, i, ExpectedResults::kSuccess);
+      VerifyAdd(quantized->get(), vectors, i, ExpectedResults::kSuccess);
+    }
+    for (const auto& search_vector : search_vectors) {
+      absl::string_view vector = VectorToStr(search_vector);
+      auto expected = full_precision.value()->Search(vector, k, CancelNever());
+      auto res = quantized.value()->Search(vector, k, CancelNever());
+      EXPECT_EQ(ToVectorNeighborTest(*res), ToVectorNeighborTest(*expected));
+    }
+  }
+}
+
+TEST_F(VectorIndexTest, QuantizedRerankSaveAndLoad) {
+  auto vectors = DeterministicallyGenerateVectors(200, kDimensions, 2.2);
+  auto search_vectors = DeterministicallyGenerateVectors(10, kDimensions, 1.5);
+  uint64_t k = 10;
+  auto proto = CreateFlatVectorIndexProto(
+      kDimensions, data_model::DISTANCE_METRIC_L2, kInitialCap, kBlockSize);
+  proto.set_quantization(data_model::VECTOR_QUANTIZATION_SQ8);
+  proto.set_rerank_factor(8);
+  auto index = VectorFlat<float>::Create(
+      proto, "attribute_identifier_1",
+      data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH);
+  VMSDK_EXPECT_OK(index);
+  for (size_t i = 0; i < vectors.size(); ++i) {
+    VerifyAdd(index->get(), vectors, i, ExpectedResults::kSuccess);
+  }
+  FakeSafeRDB rdb;
+  VMSDK_EXPECT_OK((*index)->SaveIndex(RDBChunkOutputStream(&rdb)));
+  VMSDK_EXPECT_OK((*index)->SaveTrackedKeys(RDBChunkOutputStream(&rdb)));
+
+  // The full precision vectors are loaded along with the index rather than
+  // read from the keyspace, which holds none of the keys here.
+  auto loaded = VectorFlat<float>::LoadFromRDB(
+      &fake_ctx_, &hash_attribute_data_type_,
+      (*index)->ToProto()->vector_index(), "attribute_identifier_1",
+      SupplementalContentChunkIter(&rdb));
+  VMSDK_EXPECT_OK(loaded);
+  VMSDK_EXPECT_OK((*loaded)->LoadTrackedKeys(
+      &fake_ctx_, &hash_attribute_data_type_,
+      SupplementalContentChunkIter(&rdb)));
+  for (const auto& search_vector : search_vectors) {
+    absl::string_view vector = VectorToStr(search_vector);
+    auto expected = index.value()->Search(vector, k, CancelNever());
+    auto res = loaded.value()->Search(vector, k, CancelNever());
+    EXPECT_EQ(ToVectorNeighborTest(*res), ToVectorNeighborTest(*expected));
+  }
+}
+
+TEST_F(VectorIndexTest, QuantizedRerankSharesVectorsWithKeyspace) {
+  auto vectors = DeterministicallyGenerateVectors(100, kDimensions, 2.2);
+  for (auto& distance_metric :
+       {data_model::DISTANCE_METRIC_COSINE, data_model::DISTANCE_METRIC_L2}) {
+    auto proto = CreateFlatVectorIndexProto(kDimensions, distance_metric,
+                                            kInitialCap, kBlockSize);
+    proto.set_quantization(data_model::VECTOR_QUANTIZATION_SQ8);
+    proto.set_rerank_factor(8);
+    auto index = VectorFlat<float>::Create(
+        proto, "attribute_identifier_1",
+        data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH);
+    VMSDK_EXPECT_OK(index);
+    for (size_t i = 0; i < vectors.size(); ++i) {
+      VerifyAdd(index->get(), vectors, i, ExpectedResults::kSuccess);
+    }
+    // The vectors handed to the externalizer are the ones kept for
+    // reranking, so externalizing them interns no new string.
+    const size_t unique_strings =
+        StringInternStore::Instance().UniqueStrings();
+    for (const auto& vector : vectors) {
+      std::optional<float> magnitude;
+      auto externalized = index.value()->InternExternalizedVector(
+          VectorToStr(vector), magnitude);
+      EXPECT_TRUE(externalized);
+      EXPECT_EQ(magnitude.has_value(),
+                distance_metric == data_model::DISTANCE_METRIC_COSINE);
+    }
+    EXPECT_EQ(StringInternStore::Instance().UniqueStrings(), unique_strings);
+  }
+}
+
+TEST_F(VectorIndexTest, QuantizedWithoutRerank) {
+  auto vectors = DeterministicallyGenerateVectors(100, kDimensions, 2.2);
+  uint64_t k = 10;
+  for (auto quantization : {data_model::VECTOR_QUANTIZATION_SQ8,
+                            data_model::VECTOR_QUANTIZATION_BQ}) {
+    auto proto = CreateHNSWVectorIndexProto(kDimensions,
+                                            data_model::DISTANCE_METRIC_L2,
+                                            kInitialCap, kM, kEFConstruction,
+                                            kEFRuntime);
+    proto.set_quantization(quantization);
+    auto index = VectorHNSW<float>::Create(
+        proto, "attribute_identifier_1",
+        data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH);
+    EXPECT_TRUE(index.value()->IsQuantized());
+    EXPECT_FALSE(index.value()->HasFullPrecisionValues());
+    for (size_t i = 0; i < vectors.size(); ++i) {
+      VerifyAdd(index->get(), vectors, i, ExpectedResults::kSuccess);
+    }
+    // Identical vectors share a code, so modifications are detected.
+    VerifyModify(index->get(), vectors[0], 0, ExpectedResults::kSkipped,
+                 true);
+    auto res = index.value()->Search(VectorToStr(vectors[1]), k, CancelNever());
+    VMSDK_EXPECT_OK(res);
+    EXPECT_EQ(res->size(), k);
+    EXPECT_EQ(index.value()->GetValue(IndexToKey(0)).status().code(),
+              absl::StatusCode::kNotFound);
+    std::optional<float> magnitude;
+    EXPECT_FALSE(index.value()->InternExternalizedVector(
+        VectorToStr(vectors[0]), magnitude));
+  }
+}
+
+TEST_F(VectorIndexTest, HalfPrecision) {
+  auto vectors = DeterministicallyGenerateVectors(1000, kDimensions, 2.2);
+  auto search_vectors = DeterministicallyGenerateVectors(20, kDimensions, 1.5);
+  uint64_t k = 10;
+  auto to_half_precision = [](const std::vector<float>& vector,
+                              data_model::VectorDataType vector_data_type) {
+    std::string result(vector.size() * sizeof(uint16_t), '\0');
+    FloatToHalfPrecision(vector.data(), vector.size(), vector_data_type,
+                         result.data());
+    return result;
+  };
+  for (auto vector_data_type : {data_model::VECTOR_DATA_TYPE_FLOAT16,
+                                data_model::VECTOR_DATA_TYPE_BFLOAT16}) {
+    for (auto& distance_metric :
+         {data_model::DISTANCE_METRIC_COSINE, data_model::DISTANCE_METRIC_L2}) {
+      auto full_precision = VectorFlat<float>::Create(
+          CreateFlatVectorIndexProto(kDimensions, distance_metric,
+                                     kInitialCap, kBlockSize),
+          "attribute_identifier_1",
+          data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH);
+      auto proto = CreateHNSWVectorIndexProto(kDimensions, distance_metric,
+                                              kInitialCap, kM,
+                                              kEFConstruction, kEFRuntime);
+      proto.set_vector_data_type(vector_data_type);
+      auto index = VectorHNSW<float>::Create(
+          proto, "attribute_identifier_1",
+          data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH);
+      EXPECT_EQ(index.value()->GetVectorDataType(), vector_data_type);
+      EXPECT_EQ(index.value()->GetVectorDataSize(), kDimensions * 2);
+      for (size_t i = 0; i < vectors.size(); ++i) {
+        VerifyAdd(full_precision->get(), vectors, i,
+                  ExpectedResults::kSuccess);
+        auto vector = to_half_precision(vectors[i], vector_data_type);
+        auto res = index.value()->AddRecord(IndexToKey(i), vector);
+        VMSDK_EXPECT_OK(res);
+        EXPECT_TRUE(res.value());
+      }
+      // Float32 records don't match the dimensions of the index.
+      VerifyAdd(index->get(), vectors, 0, ExpectedResults::kSkipped);
+
+      auto value = index.value()->GetValue(IndexToKey(1));
+      VMSDK_EXPECT_OK(value);
+      EXPECT_EQ(value->size(), kDimensions * sizeof(uint16_t));
+      if (distance_metric == data_model::DISTANCE_METRIC_L2) {
+        EXPECT_EQ(absl::string_view(value->data(), value->size()),
+                  to_half_precision(vectors[1], vector_data_type));
+      }
+
+      int cnt = 0;
+      for (const auto& search_vector : search_vectors) {
+        auto query = to_half_precision(search_vector, vector_data_type);
+        auto res = index.value()->Search(query, k, CancelNever());
+        auto expected = full_precision.value()->Search(
+            VectorToStr(search_vector), k, CancelNever());
+        for (auto& label : *res) {
+          for (auto& expected_label : *expected) {
+            if (label.external_id == expected_label.external_id) {
+              ++cnt;
+              break;
+            }
+          }
+        }
+      }
+      EXPECT_GE(((float)cnt) / (k * search_vectors.size()), 0.9f);
+
+      auto index_proto = index.value()->ToProto();
+      EXPECT_EQ(index_proto->vector_index().vector_data_type(),
+                vector_data_type);
+    }
+  }
+}
+
 TEST_F(VectorIndexTest, SaveAndLoadHnsw) {
   for (auto& distance_metric :
        {data_model::DISTANCE_METRIC_COSINE, data_model::DISTANCE_METRIC_L2}) {
@@ -613,6 +1041,61 @@ TEST_F(VectorIndexTest, SaveAndLoadFlat) {
     }
   }
 }
+
+TEST_F(VectorIndexTest, SaveAndLoadIVFPQ) {
+  const int dimensions = 16;
+  const uint32_t nlist = 16;
+  const uint64_t k = 10;
+  FakeSafeRDB rdb;
+  data_model::VectorIndex ivf_pq_proto = CreateIVFPQVectorIndexProto(
+      dimensions, data_model::DISTANCE_METRIC_L2, kInitialCap, nlist, 0, 4);
+  auto search_vectors = DeterministicallyGenerateVectors(50, dimensions, 1.5);
+  std::vector<std::vector<Neighbor>> expected_results;
+  size_t vector_count;
+  // Populate past the training size, search and save the index
+  {
+    auto index_pr = VectorIVFPQ<float>::Create(
+        ivf_pq_proto, "attribute_identifier_1",
+        data_model::AttributeDataType::ATTRIBUTE_DATA_TYPE_HASH);
+    VMSDK_EXPECT_OK(index_pr);
+    auto index = std::move(index_pr.value());
+    auto vectors = DeterministicallyGenerateVectors(
+        index->GetTrainingSize() + 100, dimensions, 2.2);
+    vector_count = vectors.size();
+    for (size_t i = 0; i < vectors.size(); ++i) {
+      VerifyAdd(index.get(), vectors, i, ExpectedResults::kSuccess);
+    }
+    EXPECT_TRUE(index->IsTrained());
+    for (const auto& search_vector : search_vectors) {
+      auto res = index->Search(VectorToStr(search_vector), k, CancelNever());
+      expected_results.push_back(std::move(*res));
+    }
+    VMSDK_EXPECT_OK(index->SaveIndex(RDBChunkOutputStream(&rdb)));
+    VMSDK_EXPECT_OK(index->SaveTrackedKeys(RDBChunkOutputStream(&rdb)));
+    ivf_pq_proto = index->ToProto()->vector_index();
+  }
+
+  // Load the index and validate that the search results match the previous
+  // results
+  {
+    auto index_pr = VectorIVFPQ<float>::LoadFromRDB(
+        &fake_ctx_, &hash_attribute_data_type_, ivf_pq_proto,
+        "attribute_identifier_2", SupplementalContentChunkIter(&rdb));
+    VMSDK_EXPECT_OK(index_pr);
+    auto index = std::move(index_pr.value());
+    VMSDK_EXPECT_OK(
+        index->LoadTrackedKeys(&fake_ctx_, &hash_attribute_data_type_,
+                               SupplementalContentChunkIter(&rdb)));
+    EXPECT_TRUE(index->IsTrained());
+    EXPECT_EQ(index->GetLabelCount(), vector_count);
+    for (size_t i = 0; i < search_vectors.size(); ++i) {
+      auto res =
+          index->Search(VectorToStr(search_vectors[i]), k, CancelNever());
+      EXPECT_EQ(ToVectorNeighborTest(*res),
+                ToVectorNeighborTest(expected_results[i]));
+    }
+  }
+}
 }  // namespace
 
 }  // namespace valkey_search::indexes
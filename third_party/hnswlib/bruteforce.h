@@ -1,6 +1,7 @@
 #pragma once
 #include <assert.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
@@ -144,6 +145,30 @@ class BruteforceSearch : public AlgorithmInterface<dist_t> {
         return topResults;
     }
 
+    // Same as searchKnn, restricted to the elements in [begin, end), so that
+    // disjoint ranges can be scanned concurrently and their results merged.
+    std::priority_queue<std::pair<dist_t, labeltype >>
+    searchKnnRange(const void *query_data, size_t k, size_t begin, size_t end,
+                   BaseFilterFunctor* isIdAllowed = nullptr,
+                   BaseCancellationFunctor *isCancelled = nullptr) const {
+        std::priority_queue<std::pair<dist_t, labeltype >> topResults;
+        end = std::min(end, cur_element_count_);
+        if (k == 0) return topResults;
+        for (size_t i = begin; i < end && (!isCancelled || !isCancelled->isCancelled()); i++) {
+            dist_t dist = fstdistfunc_(query_data, *(char**)(*data_)[i], dist_func_param_);
+            if (topResults.size() >= k && dist > topResults.top().first) {
+                continue;
+            }
+            labeltype label = *((labeltype *) ((*data_)[i] + data_ptr_size_));
+            if ((!isIdAllowed) || (*isIdAllowed)(label)) {
+                topResults.emplace(dist, label);
+                if (topResults.size() > k)
+                    topResults.pop();
+            }
+        }
+        return topResults;
+    }
+
     absl::Status SaveIndex(OutputStream &output) {
       data_model::BruteForceIndexHeader header;
       const size_t size_per_element = vector_size_ + sizeof(labeltype);
@@ -41,6 +41,11 @@ class ThreadRunContext {
   std::shared_ptr<vmsdk::ThreadPool::Thread> thread_ = nullptr;
 };
 
+// The pool and home queue of the worker running on this thread, if any, so
+// that tasks scheduled by a worker land in its own queue.
+thread_local const vmsdk::ThreadPool *current_pool = nullptr;
+thread_local size_t current_queue_index = 0;
+
 void *RunWorkerThread(void *arg) {
   ThreadRunContext *ctx = static_cast<ThreadRunContext *>(arg);
   ctx->GetThread()->InitThreadMonitor();
@@ -52,13 +57,65 @@ void *RunWorkerThread(void *arg) {
 
 namespace vmsdk {
 
+void WaitTimeWindow::Add(double wait_time_ms, size_t capacity,
+                         uint64_t generation) {
+  if (capacity == 0) {
+    return;
+  }
+  if (samples_.size() != capacity ||
+      generation_.load(std::memory_order_relaxed) != generation) {
+    samples_.assign(capacity, 0.0);
+    Clear();
+    generation_.store(generation, std::memory_order_relaxed);
+  }
+  size_t count = count_.load(std::memory_order_relaxed);
+  double old_sample = (count >= capacity) ? samples_[index_] : 0.0;
+
+  samples_[index_] = wait_time_ms;
+
+  double current_avg = average_.load(std::memory_order_relaxed);
+  double new_avg;
+
+  if (count < capacity) {
+    ++count;
+    count_.store(count, std::memory_order_relaxed);
+    // Adding a new sample - use cumulative average formula
+    new_avg = (current_avg * (count - 1) + wait_time_ms) / count;
+  } else {
+    // Replacing an old sample - use rolling average formula
+    new_avg = current_avg + (wait_time_ms - old_sample) / capacity;
+  }
+
+  average_.store(new_avg, std::memory_order_relaxed);
+
+  index_ = (index_ + 1) % capacity;
+}
+
+void WaitTimeWindow::Clear() {
+  index_ = 0;
+  count_.store(0, std::memory_order_relaxed);
+  average_.store(0.0, std::memory_order_relaxed);
+}
+
 ThreadPool::ThreadPool(const std::string &name_prefix, size_t num_threads,
                        size_t sample_queue_size)
     : initial_thread_count_(num_threads),
-      priority_tasks_(static_cast<int>(ThreadPool::Priority::kMax) + 1),
       name_prefix_(name_prefix),
-      sample_queue_size_(sample_queue_size),
-      wait_time_samples_(sample_queue_size, 0.0) {}
+      sample_queue_size_(sample_queue_size) {
+  // One queue per worker, Resize adds queues for the added workers. A single
+  // worker pool is strictly FIFO.
+  task_queues_.resize(kMaxTaskQueues);
+  GrowTaskQueues(std::max<size_t>(num_threads, 1));
+}
+
+void ThreadPool::GrowTaskQueues(size_t thread_count) {
+  thread_count = std::min(thread_count, kMaxTaskQueues);
+  for (size_t i = TaskQueueCount(); i < thread_count; ++i) {
+    task_queues_[i] = std::make_unique<TaskQueue>();
+    // Publishes the queue to Schedule and PopTask.
+    task_queue_count_.store(i + 1, std::memory_order_release);
+  }
+}
 
 void ThreadPool::StartWorkers() {
   CHECK(!started_);
@@ -94,20 +151,67 @@ absl::StatusOr<double> ThreadPool::GetAvgCPUPercentage() {
 }
 
 absl::StatusOr<double> ThreadPool::GetRecentQueueWaitTime() {
-  return recent_avg_wait_time_.load();
+  const uint64_t generation = sample_generation_.load();
+  double weighted_sum = 0.0;
+  size_t sample_count = 0;
+  threads_.ForEach([generation, &weighted_sum, &sample_count](auto thread) {
+    const auto &wait_times = thread->wait_times;
+    if (wait_times.Generation() != generation) {
+      return;
+    }
+    size_t count = wait_times.Count();
+    weighted_sum += wait_times.Average() * count;
+    sample_count += count;
+  });
+  if (sample_count == 0) {
+    return 0.0;
+  }
+  return weighted_sum / sample_count;
+}
+
+size_t ThreadPool::PickQueue() {
+  if (current_pool == this) {
+    return current_queue_index;
+  }
+  return next_queue_.fetch_add(1, std::memory_order_relaxed) %
+         TaskQueueCount();
 }
 
 bool ThreadPool::Schedule(absl::AnyInvocable<void()> task, Priority priority) {
-  absl::MutexLock lock(&queue_mutex_);
-  if (stop_mode_.has_value()) {
-    return false;
+  const int index = static_cast<int>(priority);
+  auto &queue = *task_queues_[PickQueue()];
+  {
+    absl::MutexLock lock(&queue.mutex);
+    if (stopped_.load(std::memory_order_relaxed)) {
+      return false;
+    }
+    queue.tasks[index].emplace(std::move(task));
+    queue.sizes[index].fetch_add(1, std::memory_order_relaxed);
+    // Sequentially consistent with the idle_workers_ load below and the
+    // increment of idle workers followed by QueueReady, so that either the
+    // worker sees the task or this sees the worker.
+    queued_tasks_[index].fetch_add(1);
+  }
+  if (idle_workers_.load() > 0) {
+    absl::MutexLock lock(&queue_mutex_);
+    condition_.Signal();
   }
-  auto &tasks_queue = GetPriorityTasksQueue(priority);
-  tasks_queue.emplace(std::move(task));
-  condition_.Signal();
   return true;
 }
 
+void ThreadPool::SetStopMode(StopMode stop_mode) {
+  stop_mode_ = stop_mode;
+  suspend_workers_ = false;
+  UpdateInterrupted();
+  stopped_.store(true, std::memory_order_relaxed);
+  // Wait out the Schedule calls which saw the pool running, their tasks
+  // must be counted before workers decide whether the queues are drained.
+  for (size_t i = 0; i < TaskQueueCount(); ++i) {
+    absl::MutexLock lock(&task_queues_[i]->mutex);
+  }
+  condition_.SignalAll();
+}
+
 absl::Status ThreadPool::MarkForStop(StopMode stop_mode) {
   absl::MutexLock lock(&queue_mutex_);
   if (stop_mode_ == stop_mode) {
@@ -117,9 +221,7 @@ absl::Status ThreadPool::MarkForStop(StopMode stop_mode) {
     return absl::InvalidArgumentError(
         "Cannot set stop mode to kGraceful after kAbrupt mode was set");
   }
-  stop_mode_ = stop_mode;
-  suspend_workers_ = false;
-  condition_.SignalAll();
+  SetStopMode(stop_mode);
   return absl::OkStatus();
 }
 
@@ -129,10 +231,10 @@ void ThreadPool::JoinWorkers() {
   {
     absl::MutexLock lock(&queue_mutex_);
     if (!stop_mode_.has_value()) {
-      stop_mode_ = StopMode::kGraceful;
-      condition_.SignalAll();
+      SetStopMode(StopMode::kGraceful);
     }
     suspend_workers_ = false;
+    UpdateInterrupted();
   }
 
   threads_.ClearWithCallback(
@@ -163,6 +265,7 @@ absl::Status ThreadPool::SuspendWorkers() {
       return absl::InvalidArgumentError("Thread pool is already suspended");
     }
     suspend_workers_ = true;
+    UpdateInterrupted();
     blocking_refcount_ =
         std::make_unique<absl::BlockingCounter>(threads_.Size());
     condition_.SignalAll();
@@ -185,6 +288,7 @@ absl::Status ThreadPool::ResumeWorkers() {
       return absl::InvalidArgumentError("Thread pool is not suspended");
     }
     suspend_workers_ = false;
+    UpdateInterrupted();
     blocking_refcount_ =
         std::make_unique<absl::BlockingCounter>(threads_.Size());
   }
@@ -209,15 +313,20 @@ void ThreadPool::AwaitSuspensionCleared()
 }
 
 void ThreadPool::WorkerThread(std::shared_ptr<Thread> thread) {
+  current_pool = this;
+  current_queue_index = thread->queue_index;
   while (true) {
-    absl::AnyInvocable<void()> task;
-    {
+    // Busy workers go from task to task without the pool mutex, as long as
+    // the pool is neither stopped nor suspended.
+    if (interrupted_.load(std::memory_order_acquire) || QueuedTasks() == 0) {
       absl::MutexLock lock(&queue_mutex_);
       AwaitSuspensionCleared();
       auto condition = absl::Condition(this, &ThreadPool::QueueReady);
+      ++idle_workers_;
       while (!condition.Eval()) {
         condition_.WaitWithTimeout(&queue_mutex_, absl::Seconds(1));
         if (thread->IsShutdown()) {
+          --idle_workers_;
           thread->InvokeShutdownCallback();
           // remove this thread from the threads list and place it in the
           // pending join list
@@ -228,41 +337,43 @@ void ThreadPool::WorkerThread(std::shared_ptr<Thread> thread) {
           return;
         }
       }
+      --idle_workers_;
       if (stop_mode_.has_value() &&
-          (stop_mode_.value() == StopMode::kAbrupt ||
-           std::all_of(priority_tasks_.begin(), priority_tasks_.end(),
-                       [](const auto &tasks) { return tasks.empty(); }))) {
+          (stop_mode_.value() == StopMode::kAbrupt || QueuedTasks() == 0)) {
         return;
       }
       if (suspend_workers_) {
         continue;
       }
+    }
 
-      // Use the new fairness-aware task selection
-      auto optional_task = TryGetNextTask();
-      if (!optional_task.has_value()) {
-        continue;  // No tasks available, go back to waiting
-      }
-      task = std::move(*optional_task);
+    // Use the new fairness-aware task selection
+    auto optional_task = TryGetNextTask(*thread);
+    if (!optional_task.has_value()) {
+      continue;  // No tasks available, go back to waiting
     }
-    task();
+    (*optional_task)();
   }
 }
 
-size_t ThreadPool::QueueSize() const {
-  absl::MutexLock lock(&queue_mutex_);
-  return std::accumulate(
-      priority_tasks_.begin(), priority_tasks_.end(), 0,
-      [](size_t sum, const auto &tasks) { return sum + tasks.size(); });
+size_t ThreadPool::QueuedTasks() const {
+  size_t sum = 0;
+  for (const auto &count : queued_tasks_) {
+    sum += count.load();
+  }
+  return sum;
 }
 
+size_t ThreadPool::QueueSize() const { return QueuedTasks(); }
+
 void ThreadPool::IncrThreadCountBy(size_t count) {
   for (size_t i = 0; i < count; ++i) {
     std::shared_ptr<Thread> thread_ptr = std::make_shared<Thread>();
     ThreadRunContext *context = new ThreadRunContext{this, thread_ptr};
+    size_t thread_num = threads_.Size();
+    thread_ptr->queue_index = thread_num % TaskQueueCount();
     pthread_create(&thread_ptr->thread_id, nullptr, RunWorkerThread, context);
 #ifndef __APPLE__
-    size_t thread_num = threads_.Size();
     pthread_setname_np(thread_ptr->thread_id,
                        (name_prefix_ + std::to_string(thread_num)).c_str());
 #endif
@@ -294,6 +405,7 @@ void ThreadPool::Resize(size_t count, bool wait_for_resize) {
     return;
   } else if (count > current_size) {
     // We need to add more threads
+    GrowTaskQueues(count);
     IncrThreadCountBy(count - current_size);
   } else {
     // Shutdown "current_size - count" threads
@@ -328,76 +440,61 @@ int ThreadPool::GetHighPriorityWeight() const {
   return high_priority_weight_.load(std::memory_order_relaxed);
 }
 
-void ThreadPool::AddWaitTimeSample(
-    std::chrono::steady_clock::time_point enqueue_time) {
-  double wait_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(
-                            std::chrono::steady_clock::now() - enqueue_time)
-                            .count() /
-                        1000.0;
-
-  double old_sample = (current_sample_count_ >= sample_queue_size_)
-                          ? wait_time_samples_[sample_index_]
-                          : 0.0;
-
-  wait_time_samples_[sample_index_] = wait_time_ms;
-
-  double current_avg = recent_avg_wait_time_.load();
-  double new_avg;
-
-  if (current_sample_count_ < sample_queue_size_) {
-    current_sample_count_++;
-    // Adding a new sample - use cumulative average formula
-    size_t safe_count = std::max(current_sample_count_, size_t{1});
-    new_avg = (current_avg * (safe_count - 1) + wait_time_ms) / safe_count;
-  } else {
-    // Replacing an old sample - use rolling average formula
-    new_avg = current_avg + (wait_time_ms - old_sample) / sample_queue_size_;
-  }
-
-  recent_avg_wait_time_.store(new_avg);
-
-  sample_index_ = (sample_index_ + 1) % sample_queue_size_;
-}
-
-void ThreadPool::ClearWaitTimeSamples() {
-  current_sample_count_ = 0;
-  sample_index_ = 0;
-  recent_avg_wait_time_.store(0.0);
-}
-
 void ThreadPool::ResizeSampleQueue(size_t new_size) {
-  absl::MutexLock lock(&queue_mutex_);
-  sample_queue_size_ = new_size;
-  wait_time_samples_.resize(new_size, 0.0);
-  ClearWaitTimeSamples();
+  sample_queue_size_.store(new_size);
+  sample_generation_.fetch_add(1);
 }
 
-std::optional<absl::AnyInvocable<void()>> ThreadPool::TryGetNextTask() {
-  // Clear samples when all queues are empty
-  bool all_empty = std::all_of(priority_tasks_.begin(), priority_tasks_.end(),
-                               [](const auto &queue) { return queue.empty(); });
-  if (all_empty) {
-    ClearWaitTimeSamples();
-    return std::nullopt;
+std::optional<TaskWithTime> ThreadPool::PopTask(Priority priority,
+                                                size_t home) {
+  const int index = static_cast<int>(priority);
+  const size_t queue_count = TaskQueueCount();
+  for (size_t i = 0; i < queue_count; ++i) {
+    auto &queue = *task_queues_[(home + i) % queue_count];
+    if (queue.sizes[index].load(std::memory_order_relaxed) == 0) {
+      continue;
+    }
+    absl::MutexLock lock(&queue.mutex);
+    auto &tasks = queue.tasks[index];
+    if (tasks.empty()) {
+      continue;
+    }
+    auto task_with_time = std::move(tasks.front());
+    tasks.pop();
+    queue.sizes[index].fetch_sub(1, std::memory_order_relaxed);
+    queued_tasks_[index].fetch_sub(1);
+    return task_with_time;
   }
+  return std::nullopt;
+}
 
-  // Check for kMax priority first - always takes precedence
-  if (!GetPriorityTasksQueue(Priority::kMax).empty()) {
-    auto &max_queue = GetPriorityTasksQueue(Priority::kMax);
-    auto task_with_time = std::move(max_queue.front());
-    max_queue.pop();
-
-    AddWaitTimeSample(task_with_time.enqueue_time);
-
+std::optional<absl::AnyInvocable<void()>> ThreadPool::TryGetNextTask(
+    Thread &thread) {
+  auto take = [this, &thread](TaskWithTime &task_with_time) {
+    double wait_time_ms =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - task_with_time.enqueue_time)
+            .count() /
+        1000.0;
+    thread.wait_times.Add(wait_time_ms, sample_queue_size_.load(),
+                          sample_generation_.load());
     return std::move(task_with_time.task);
+  };
+
+  // Check for kMax priority first - always takes precedence
+  if (QueuedTasks(Priority::kMax) > 0) {
+    if (auto task_with_time = PopTask(Priority::kMax, thread.queue_index)) {
+      return take(*task_with_time);
+    }
   }
 
   // No kMax tasks - apply fairness between kHigh and kLow
-  bool high_has_tasks = !GetPriorityTasksQueue(Priority::kHigh).empty();
-  bool low_has_tasks = !GetPriorityTasksQueue(Priority::kLow).empty();
+  bool high_has_tasks = QueuedTasks(Priority::kHigh) > 0;
+  bool low_has_tasks = QueuedTasks(Priority::kLow) > 0;
 
   if (!high_has_tasks && !low_has_tasks) {
-    ClearWaitTimeSamples();
+    // Another worker won the race for the last tasks
+    thread.wait_times.Clear();
     return std::nullopt;  // No tasks available
   }
 
@@ -429,13 +526,17 @@ std::optional<absl::AnyInvocable<void()>> ThreadPool::TryGetNextTask() {
     }
   }
 
-  auto &selected_queue = GetPriorityTasksQueue(selected_priority);
-  auto task_with_time = std::move(selected_queue.front());
-  selected_queue.pop();
-
-  AddWaitTimeSample(task_with_time.enqueue_time);
-
-  return std::move(task_with_time.task);
+  // The other priority is only tried when another worker took the last task
+  // of the selected one in the meantime.
+  for (auto priority :
+       {selected_priority, selected_priority == Priority::kHigh
+                               ? Priority::kLow
+                               : Priority::kHigh}) {
+    if (auto task_with_time = PopTask(priority, thread.queue_index)) {
+      return take(*task_with_time);
+    }
+  }
+  return std::nullopt;
 }
 
 }  // namespace vmsdk
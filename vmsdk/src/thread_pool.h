@@ -10,9 +10,11 @@
 
 #include <pthread.h>  // NOLINT(build/c++11)
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <queue>
@@ -39,7 +41,38 @@ struct TaskWithTime {
       : task(std::move(t)), enqueue_time(std::chrono::steady_clock::now()) {}
 };
 
+// Rolling window of the most recent queue wait times seen by one worker.
+// Only the owning worker adds samples, the average can be read from any
+// thread without locking.
+class WaitTimeWindow {
+ public:
+  /// Add a sample to a window of `capacity` samples. The window restarts
+  /// empty when `generation` or `capacity` changed since the last sample.
+  void Add(double wait_time_ms, size_t capacity, uint64_t generation);
+  void Clear();
+  double Average() const { return average_.load(std::memory_order_relaxed); }
+  size_t Count() const { return count_.load(std::memory_order_relaxed); }
+  uint64_t Generation() const {
+    return generation_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::vector<double> samples_;
+  size_t index_{0};
+  std::atomic<size_t> count_{0};
+  std::atomic<double> average_{0.0};
+  std::atomic<uint64_t> generation_{0};
+};
+
 // Note google3/thread can't be used as it's not open source
+//
+// Tasks are spread over several queues, each with its own mutex, rather than
+// funneled through a single one. Workers pop from their home queue first and
+// steal from the others when it is empty, so a queue is only contended when
+// the pool is draining. The pool-wide counts of queued tasks per priority
+// keep the kMax precedence and the kHigh/kLow weighted round robin global,
+// whichever queue the tasks landed in. The pool mutex is only taken to
+// sleep, wake up idle workers and change the pool state.
 class ThreadPool {
  public:
   ThreadPool(const std::string& name, size_t num_threads,
@@ -108,6 +141,9 @@ class ThreadPool {
     }
 
     pthread_t thread_id = 0;
+    /// The task queue this worker pops from first.
+    size_t queue_index = 0;
+    WaitTimeWindow wait_times;
     std::atomic_bool shutdown_flag = false;
     /// If not null, the thread will call this callback when it exits via the
     /// shutdown_flag
@@ -117,7 +153,8 @@ class ThreadPool {
 
   absl::StatusOr<double> GetAvgCPUPercentage();
 
-  // Get recent average queue wait time in milliseconds (last N samples)
+  // Get recent average queue wait time in milliseconds (last N samples of
+  // every worker)
   absl::StatusOr<double> GetRecentQueueWaitTime();
 
   void WorkerThread(std::shared_ptr<Thread> thread)
@@ -134,40 +171,72 @@ class ThreadPool {
   void ResizeSampleQueue(size_t new_size);
 
  private:
-  /// Track wait time sample and update running average
-  void AddWaitTimeSample(std::chrono::steady_clock::time_point enqueue_time)
-      ABSL_EXCLUSIVE_LOCKS_REQUIRED(queue_mutex_);
+  static constexpr size_t kPriorityCount =
+      static_cast<size_t>(Priority::kMax) + 1;
+  /// Workers beyond this count share the task queues.
+  static constexpr size_t kMaxTaskQueues = 1024;
+
+  /// One of the task queues. Aligned so that the mutexes of neighboring
+  /// queues don't share a cache line.
+  struct alignas(64) TaskQueue {
+    absl::Mutex mutex;
+    std::array<std::queue<TaskWithTime>, kPriorityCount> tasks
+        ABSL_GUARDED_BY(mutex);
+    /// Sizes of `tasks`, to skip empty queues without locking them.
+    std::array<std::atomic<size_t>, kPriorityCount> sizes{};
+  };
 
-  /// Clear all samples when queues are empty
-  void ClearWaitTimeSamples() ABSL_EXCLUSIVE_LOCKS_REQUIRED(queue_mutex_);
-  /// Try to get the next task using fairness algorithm
-  /// Returns nullopt if no tasks available
-  std::optional<absl::AnyInvocable<void()>> TryGetNextTask()
+  /// Try to get the next task using fairness algorithm, starting with the
+  /// home queue of `thread`. Returns nullopt if no tasks available
+  std::optional<absl::AnyInvocable<void()>> TryGetNextTask(Thread& thread);
+  /// Pop the oldest task of `priority`, visiting the queues from `home`.
+  std::optional<TaskWithTime> PopTask(Priority priority, size_t home);
+  /// Pick the queue for a newly scheduled task.
+  size_t PickQueue();
+  size_t TaskQueueCount() const {
+    return task_queue_count_.load(std::memory_order_acquire);
+  }
+  /// Adds task queues until there is one per worker of a `thread_count`
+  /// workers pool.
+  void GrowTaskQueues(size_t thread_count);
+  size_t QueuedTasks(Priority priority) const {
+    return queued_tasks_[static_cast<int>(priority)].load();
+  }
+  size_t QueuedTasks() const;
+  void SetStopMode(StopMode stop_mode)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(queue_mutex_);
+  /// Mirror the stop and suspend state for workers busy with tasks.
+  void UpdateInterrupted() ABSL_EXCLUSIVE_LOCKS_REQUIRED(queue_mutex_) {
+    interrupted_.store(stop_mode_.has_value() || suspend_workers_,
+                       std::memory_order_release);
+  }
   void IncrThreadCountBy(size_t count);
   void DecrThreadCountBy(size_t count, bool sync);
 
   inline void AwaitSuspensionCleared()
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(queue_mutex_);
   inline bool QueueReady() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(queue_mutex_) {
-    for (const auto& queue : priority_tasks_) {
-      if (!queue.empty()) {
-        return true;
-      }
-    }
-    return stop_mode_.has_value() || suspend_workers_;
-  }
-  inline std::queue<TaskWithTime>& GetPriorityTasksQueue(Priority priority)
-      ABSL_EXCLUSIVE_LOCKS_REQUIRED(queue_mutex_) {
-    return priority_tasks_[static_cast<int>(priority)];
+    return QueuedTasks() > 0 || stop_mode_.has_value() || suspend_workers_;
   }
   size_t initial_thread_count_ = 0;
   ThreadSafeVector<std::shared_ptr<Thread>> threads_;
   ThreadSafeVector<std::shared_ptr<Thread>> pending_join_threads_;
   mutable absl::Mutex queue_mutex_;
   absl::CondVar condition_ ABSL_GUARDED_BY(queue_mutex_);
-  std::vector<std::queue<TaskWithTime>> priority_tasks_
-      ABSL_GUARDED_BY(queue_mutex_);
+  /// kMaxTaskQueues slots, so that the queues can be added while tasks are
+  /// scheduled and popped. Only the first `task_queue_count_` are allocated.
+  /// Queues are never removed, the tasks of a shrunk pool are still stolen.
+  std::vector<std::unique_ptr<TaskQueue>> task_queues_;
+  std::atomic<size_t> task_queue_count_{0};
+  /// Pool-wide number of queued tasks per priority, updated with the queues.
+  std::array<std::atomic<size_t>, kPriorityCount> queued_tasks_{};
+  std::atomic<size_t> next_queue_{0};
+  /// Workers waiting on `condition_`, Schedule only signals when non zero.
+  std::atomic<size_t> idle_workers_{0};
+  /// Set with `stop_mode_`, read by Schedule under the task queue mutex.
+  std::atomic<bool> stopped_{false};
+  /// Whether the pool is stopped or suspended.
+  std::atomic<bool> interrupted_{false};
   std::string name_prefix_;
   std::optional<StopMode> stop_mode_ ABSL_GUARDED_BY(queue_mutex_);
   bool started_{false};
@@ -185,14 +254,13 @@ class ThreadPool {
   std::atomic<int> pattern_length_{1};  // Length of the repeating pattern
   std::atomic<int> high_ratio_{1};  // Number of high priority tasks in pattern
 
-  // Configurable wait time sample tracking
-  size_t sample_queue_size_;
-  std::vector<double> wait_time_samples_ ABSL_GUARDED_BY(queue_mutex_);
-  size_t sample_index_ ABSL_GUARDED_BY(queue_mutex_){0};
-  size_t current_sample_count_ ABSL_GUARDED_BY(queue_mutex_){0};
-  std::atomic<double> recent_avg_wait_time_{0.0};
+  // Configurable wait time sample tracking, see WaitTimeWindow. Bumping the
+  // generation discards the samples of every worker.
+  std::atomic<size_t> sample_queue_size_;
+  std::atomic<uint64_t> sample_generation_{0};
 
   FRIEND_TEST(ThreadPoolTest, DynamicSizing);
+  FRIEND_TEST(ThreadPoolTest, ResizeAddsTaskQueues);
 };
 
 }  // namespace vmsdk
@@ -8,10 +8,15 @@
 #include "vmsdk/src/time_sliced_mrmw_mutex.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <optional>
+#include <string>
 
 #include "absl/base/optimization.h"
 #include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "vmsdk/src/utils.h"
@@ -37,6 +42,28 @@ void WriterMutexLock::SetMayProlong() {
   mutex_->IncMayProlongCount();
 }
 
+void TimeSlicedMRMWPhaseStats::Record(absl::Duration duration) {
+  ++phases;
+  time_microseconds += absl::ToInt64Microseconds(duration);
+  size_t bucket = 0;
+  while (bucket < kPhaseHistogramBounds.size() &&
+         duration >= kPhaseHistogramBounds[bucket]) {
+    ++bucket;
+  }
+  ++histogram[bucket];
+}
+
+std::string TimeSlicedMRMWPhaseStats::ToString(
+    absl::string_view prefix) const {
+  return absl::StrCat(
+      prefix, "phases=", phases.load(), ",", prefix,
+      "time_us=", time_microseconds.load(), ",", prefix, "histogram=",
+      absl::StrJoin(histogram, "|",
+                    [](std::string* out, const std::atomic<uint64_t>& count) {
+                      absl::StrAppend(out, count.load());
+                    }));
+}
+
 TimeSlicedMRMWMutex::TimeSlicedMRMWMutex(const MRMWMutexOptions& options)
     : read_quota_duration_(options.read_quota_duration),
       read_switch_grace_period_(options.read_switch_grace_period),
@@ -51,6 +78,19 @@ void TimeSlicedMRMWMutex::IncMayProlongCount() {
   ++may_prolong_count_;
 }
 
+void TimeSlicedMRMWMutex::SetTimeQuotas(absl::Duration read_quota,
+                                        absl::Duration write_quota) {
+  absl::MutexLock lock(&mutex_);
+  read_quota_duration_ = std::max(read_quota, 2 * read_switch_grace_period_);
+  write_quota_duration_ =
+      std::max(write_quota, 2 * write_switch_grace_period_);
+}
+
+absl::Duration TimeSlicedMRMWMutex::GetTimeQuota(Mode mode) const {
+  absl::MutexLock lock(&mutex_);
+  return GetTimeQuotaLocked(mode);
+}
+
 void TimeSlicedMRMWMutex::ReaderLock(bool& may_prolong,
                                      bool ignore_time_quota) {
   Lock(Mode::kLockRead, may_prolong, ignore_time_quota);
@@ -83,6 +123,7 @@ void TimeSlicedMRMWMutex::Lock(Mode target_mode, bool& may_prolong,
   }
   last_lock_acquired_.Reset();
   ++active_lock_count_;
+  ++GetMutableWaitStats(target_mode).locks;
 }
 
 void TimeSlicedMRMWMutex::Unlock(bool may_prolong, bool ignore_time_quota) {
@@ -173,6 +214,7 @@ void TimeSlicedMRMWMutex::InitSwitch() {
 }
 
 void TimeSlicedMRMWMutex::SwitchWithWait(Mode target_mode) {
+  StopWatch wait_watch;
   auto& waiters = GetWaiters(target_mode);
   ++waiters;
   auto captured_switches = switches_;
@@ -207,9 +249,48 @@ void TimeSlicedMRMWMutex::SwitchWithWait(Mode target_mode) {
     // The last target mode waiter is responsible to finalize the switch mode
     // process
     switch_wait_mode_ = std::nullopt;
+    auto& phase_stats = GetInverseMode(current_mode_) == Mode::kLockRead
+                            ? read_phase_stats_
+                            : write_phase_stats_;
+    phase_stats.Record(stop_watch_.Duration());
     stop_watch_.Reset();
     ++switches_;
+    ++switch_count_;
   }
+  GetMutableWaitStats(target_mode).wait_microseconds +=
+      absl::ToInt64Microseconds(wait_watch.Duration());
+}
+
+double TimeSliceController::Update(TimeSlicedMRMWMutex& mutex,
+                                   double read_pressure,
+                                   double write_pressure) {
+  const double previous_scale = scale_;
+  if (read_pressure > 1.0 && read_pressure > write_pressure) {
+    scale_ = std::min(scale_ * kStep, kMaxScale);
+  } else if (write_pressure > 1.0 && write_pressure > read_pressure) {
+    scale_ = std::max(scale_ / kStep, 1.0 / kMaxScale);
+  } else if (scale_ > 1.0) {
+    scale_ = std::max(scale_ / kStep, 1.0);
+  } else if (scale_ < 1.0) {
+    scale_ = std::min(scale_ * kStep, 1.0);
+  }
+  if (scale_ != previous_scale) {
+    Apply(mutex);
+  }
+  return scale_;
+}
+
+void TimeSliceController::Reset(TimeSlicedMRMWMutex& mutex) {
+  if (scale_ == 1.0) {
+    return;
+  }
+  scale_ = 1.0;
+  Apply(mutex);
+}
+
+void TimeSliceController::Apply(TimeSlicedMRMWMutex& mutex) const {
+  mutex.SetTimeQuotas(options_.read_quota_duration * scale_,
+                      options_.write_quota_duration / scale_);
 }
 
 }  // namespace vmsdk
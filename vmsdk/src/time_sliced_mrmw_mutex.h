@@ -8,10 +8,15 @@
 #ifndef VMSDK_SRC_MRMW_MUTEX_H_
 #define VMSDK_SRC_MRMW_MUTEX_H_
 
+#include <array>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <optional>
+#include <string>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "vmsdk/src/utils.h"
@@ -33,6 +38,33 @@ inline const TimeSlicedMRMWStats& GetGlobalTimeSlicedMRMWStats() {
   return global_stats;
 }
 
+// Upper bounds of the buckets of the phase duration histograms, the last
+// bucket counts the longer phases.
+inline constexpr std::array<absl::Duration, 4> kPhaseHistogramBounds = {
+    absl::Microseconds(100), absl::Milliseconds(1), absl::Milliseconds(10),
+    absl::Milliseconds(100)};
+
+// Statistics of the read or the write phases of a single mutex. A phase lasts
+// from the switch into a mode until the switch out of it.
+struct TimeSlicedMRMWPhaseStats {
+  std::atomic<uint64_t> phases{0};
+  std::atomic<uint64_t> time_microseconds{0};  // cumulative
+  std::array<std::atomic<uint64_t>, kPhaseHistogramBounds.size() + 1>
+      histogram{};
+
+  void Record(absl::Duration duration);
+  // Formatted as "<prefix>phases=<n>,<prefix>time_us=<n>,
+  // <prefix>histogram=<b0>|<b1>|...".
+  std::string ToString(absl::string_view prefix) const;
+};
+
+// Lock acquisitions of a single mutex in one mode, and the time they spent
+// waiting for the mutex to switch to that mode.
+struct TimeSlicedMRMWWaitStats {
+  std::atomic<uint64_t> locks{0};
+  std::atomic<uint64_t> wait_microseconds{0};  // cumulative
+};
+
 struct MRMWMutexOptions {
   absl::Duration read_quota_duration;
   absl::Duration read_switch_grace_period;
@@ -67,6 +99,20 @@ class ABSL_LOCKABLE TimeSlicedMRMWMutex {
   void Unlock(bool may_prolong, bool ignore_time_quota) ABSL_UNLOCK_FUNCTION();
   void IncMayProlongCount() ABSL_LOCKS_EXCLUDED(mutex_);
 
+  // Replaces the time quotas of the options, each is raised to twice the
+  // grace period of its mode if shorter. Takes effect from the next quota
+  // check.
+  void SetTimeQuotas(absl::Duration read_quota, absl::Duration write_quota)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  absl::Duration GetTimeQuota(Mode mode) const ABSL_LOCKS_EXCLUDED(mutex_);
+  uint64_t GetSwitchCount() const { return switch_count_; }
+  const TimeSlicedMRMWPhaseStats& GetPhaseStats(Mode mode) const {
+    return mode == Mode::kLockRead ? read_phase_stats_ : write_phase_stats_;
+  }
+  const TimeSlicedMRMWWaitStats& GetWaitStats(Mode mode) const {
+    return mode == Mode::kLockRead ? read_wait_stats_ : write_wait_stats_;
+  }
+
  private:
   void Lock(Mode target_mode, bool& may_prolong, bool ignore_time_quota)
       ABSL_LOCKS_EXCLUDED(mutex_);
@@ -78,11 +124,15 @@ class ABSL_LOCKABLE TimeSlicedMRMWMutex {
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
     return target_mode == Mode::kLockRead ? reader_waiters_ : writer_waiters_;
   };
+  inline TimeSlicedMRMWWaitStats& GetMutableWaitStats(Mode target_mode) {
+    return target_mode == Mode::kLockRead ? read_wait_stats_
+                                          : write_wait_stats_;
+  }
   inline absl::CondVar& GetCondVar(Mode target_mode)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
     return target_mode == Mode::kLockRead ? read_cond_var_ : write_cond_var_;
   };
-  inline const absl::Duration& GetTimeQuota(Mode target_mode) const
+  inline const absl::Duration& GetTimeQuotaLocked(Mode target_mode) const
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
     return target_mode == Mode::kLockRead ? read_quota_duration_
                                           : write_quota_duration_;
@@ -106,7 +156,7 @@ class ABSL_LOCKABLE TimeSlicedMRMWMutex {
   inline bool HasTimeQuotaExceeded() const
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
     return !switch_wait_mode_.has_value() &&
-           stop_watch_.Duration() > GetTimeQuota(current_mode_);
+           stop_watch_.Duration() > GetTimeQuotaLocked(current_mode_);
   }
   void SwitchWithWait(Mode target_mode) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
   void WaitSwitch(Mode target_mode) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
@@ -124,15 +174,49 @@ class ABSL_LOCKABLE TimeSlicedMRMWMutex {
   uint32_t writer_waiters_ ABSL_GUARDED_BY(mutex_){0};
   bool read_wait_with_timer_ ABSL_GUARDED_BY(mutex_){false};
   bool write_wait_with_timer_ ABSL_GUARDED_BY(mutex_){false};
-  const absl::Duration read_quota_duration_;
+  absl::Duration read_quota_duration_ ABSL_GUARDED_BY(mutex_);
   const absl::Duration read_switch_grace_period_;
-  const absl::Duration write_quota_duration_;
+  absl::Duration write_quota_duration_ ABSL_GUARDED_BY(mutex_);
   const absl::Duration write_switch_grace_period_;
   std::optional<Mode> switch_wait_mode_ ABSL_GUARDED_BY(mutex_);
   vmsdk::StopWatch stop_watch_ ABSL_GUARDED_BY(mutex_);
   int switches_ ABSL_GUARDED_BY(mutex_){0};
   uint32_t may_prolong_count_ ABSL_GUARDED_BY(mutex_){0};
   uint32_t ignore_time_quota_count_ ABSL_GUARDED_BY(mutex_){0};
+  std::atomic<uint64_t> switch_count_{0};
+  TimeSlicedMRMWPhaseStats read_phase_stats_;
+  TimeSlicedMRMWPhaseStats write_phase_stats_;
+  TimeSlicedMRMWWaitStats read_wait_stats_;
+  TimeSlicedMRMWWaitStats write_wait_stats_;
+};
+
+// Adapts the time quotas of a TimeSlicedMRMWMutex to the backlog of each
+// mode. Pressures are observed backlogs relative to their targets, a mode
+// above 1 is falling behind. Every update moves the quotas by kStep in favor
+// of the mode under more pressure, the read quota scaled by the returned
+// factor and the write quota by its inverse, within kMaxScale of the
+// configured quotas. Without pressure the quotas relax back to the options.
+// Not thread safe, updates are expected from a single periodic caller.
+class TimeSliceController {
+ public:
+  static constexpr double kStep = 1.25;
+  static constexpr double kMaxScale = 8.0;
+
+  explicit TimeSliceController(const MRMWMutexOptions& options)
+      : options_(options) {}
+
+  // Returns the resulting read quota scale.
+  double Update(TimeSlicedMRMWMutex& mutex, double read_pressure,
+                double write_pressure);
+  // Restores the configured quotas.
+  void Reset(TimeSlicedMRMWMutex& mutex);
+  double GetScale() const { return scale_; }
+
+ private:
+  void Apply(TimeSlicedMRMWMutex& mutex) const;
+
+  const MRMWMutexOptions options_;
+  double scale_{1.0};
 };
 
 class ABSL_SCOPED_LOCKABLE ReaderMutexLock {
@@ -502,6 +502,121 @@ TEST_F(MRMWMutexTest, TimingAccuracy) {
   }
 }
 
+TEST_F(MRMWMutexTest, PhaseStats) {
+  MRMWMutexOptions options;
+  options.read_quota_duration = absl::Milliseconds(10);
+  options.read_switch_grace_period = absl::Microseconds(100);
+  options.write_quota_duration = absl::Milliseconds(1);
+  options.write_switch_grace_period = absl::Microseconds(50);
+  TimeSlicedMRMWMutex mrmw_mutex(options);
+  { ReaderMutexLock lock(&mrmw_mutex); }
+  { WriterMutexLock lock(&mrmw_mutex); }
+  { ReaderMutexLock lock(&mrmw_mutex); }
+
+  EXPECT_EQ(mrmw_mutex.GetSwitchCount(), 2);
+  for (auto mode : {TimeSlicedMRMWMutex::Mode::kLockRead,
+                    TimeSlicedMRMWMutex::Mode::kLockWrite}) {
+    const auto& phase_stats = mrmw_mutex.GetPhaseStats(mode);
+    EXPECT_EQ(phase_stats.phases, 1);
+    uint64_t histogram_total = 0;
+    for (const auto& count : phase_stats.histogram) {
+      histogram_total += count;
+    }
+    EXPECT_EQ(histogram_total, 1);
+  }
+  EXPECT_THAT(
+      mrmw_mutex.GetPhaseStats(TimeSlicedMRMWMutex::Mode::kLockRead)
+          .ToString("read_"),
+      testing::MatchesRegex("read_phases=1,read_time_us=[0-9]+,"
+                            "read_histogram=([01]\\|){4}[01]"));
+}
+
+TEST_F(MRMWMutexTest, WaitStats) {
+  ThreadPool thread_pool("test-pool-", 1);
+  thread_pool.StartWorkers();
+  MRMWMutexOptions options;
+  options.read_quota_duration = absl::Milliseconds(10);
+  options.read_switch_grace_period = absl::Microseconds(100);
+  options.write_quota_duration = absl::Milliseconds(10);
+  options.write_switch_grace_period = absl::Microseconds(50);
+  TimeSlicedMRMWMutex mrmw_mutex(options);
+  const auto& read_stats =
+      mrmw_mutex.GetWaitStats(TimeSlicedMRMWMutex::Mode::kLockRead);
+  const auto& write_stats =
+      mrmw_mutex.GetWaitStats(TimeSlicedMRMWMutex::Mode::kLockWrite);
+
+  // A read lock in the read phase doesn't wait.
+  { ReaderMutexLock lock(&mrmw_mutex); }
+  EXPECT_EQ(read_stats.locks, 1);
+  EXPECT_EQ(read_stats.wait_microseconds, 0);
+
+  // A read lock requested during a write phase waits for its end.
+  absl::Notification read_locked;
+  {
+    WriterMutexLock lock(&mrmw_mutex);
+    thread_pool.Schedule(
+        [&mrmw_mutex, &read_locked]() {
+          ReaderMutexLock lock(&mrmw_mutex);
+          read_locked.Notify();
+        },
+        ThreadPool::Priority::kHigh);
+    absl::SleepFor(absl::Milliseconds(5));
+  }
+  read_locked.WaitForNotification();
+  EXPECT_EQ(write_stats.locks, 1);
+  EXPECT_EQ(read_stats.locks, 2);
+  EXPECT_GT(read_stats.wait_microseconds, 0);
+}
+
+TEST_F(MRMWMutexTest, TimeSliceController) {
+  MRMWMutexOptions options;
+  options.read_quota_duration = absl::Milliseconds(10);
+  options.read_switch_grace_period = absl::Microseconds(100);
+  options.write_quota_duration = absl::Microseconds(500);
+  options.write_switch_grace_period = absl::Microseconds(50);
+  TimeSlicedMRMWMutex mrmw_mutex(options);
+  TimeSliceController controller(options);
+  const auto kRead = TimeSlicedMRMWMutex::Mode::kLockRead;
+  const auto kWrite = TimeSlicedMRMWMutex::Mode::kLockWrite;
+
+  // Backlogs within their targets leave the quotas untouched.
+  EXPECT_EQ(controller.Update(mrmw_mutex, 0.5, 0.9), 1.0);
+  EXPECT_EQ(mrmw_mutex.GetTimeQuota(kRead), absl::Milliseconds(10));
+  EXPECT_EQ(mrmw_mutex.GetTimeQuota(kWrite), absl::Microseconds(500));
+
+  // Readers falling behind lengthen the read phases.
+  controller.Update(mrmw_mutex, 2.0, 1.5);
+  EXPECT_EQ(controller.Update(mrmw_mutex, 2.0, 1.5), 1.5625);
+  EXPECT_EQ(mrmw_mutex.GetTimeQuota(kRead), absl::Microseconds(15625));
+  EXPECT_EQ(mrmw_mutex.GetTimeQuota(kWrite), absl::Microseconds(320));
+  for (int i = 0; i < 20; ++i) {
+    controller.Update(mrmw_mutex, 2.0, 0.0);
+  }
+  EXPECT_EQ(controller.GetScale(), TimeSliceController::kMaxScale);
+  EXPECT_EQ(mrmw_mutex.GetTimeQuota(kRead), absl::Milliseconds(80));
+  // The write quota doesn't go below twice its grace period.
+  EXPECT_EQ(mrmw_mutex.GetTimeQuota(kWrite), absl::Microseconds(100));
+
+  // Without pressure, the quotas relax back to the options.
+  for (int i = 0; i < 20; ++i) {
+    controller.Update(mrmw_mutex, 0.0, 0.0);
+  }
+  EXPECT_EQ(controller.GetScale(), 1.0);
+  EXPECT_EQ(mrmw_mutex.GetTimeQuota(kRead), absl::Milliseconds(10));
+
+  // Writers falling behind lengthen the write phases.
+  for (int i = 0; i < 20; ++i) {
+    controller.Update(mrmw_mutex, 0.0, 3.0);
+  }
+  EXPECT_EQ(controller.GetScale(), 1.0 / TimeSliceController::kMaxScale);
+  EXPECT_EQ(mrmw_mutex.GetTimeQuota(kRead), absl::Microseconds(1250));
+  EXPECT_EQ(mrmw_mutex.GetTimeQuota(kWrite), absl::Milliseconds(4));
+
+  controller.Reset(mrmw_mutex);
+  EXPECT_EQ(controller.GetScale(), 1.0);
+  EXPECT_EQ(mrmw_mutex.GetTimeQuota(kWrite), absl::Microseconds(500));
+}
+
 }  // namespace
 
 }  // namespace vmsdk
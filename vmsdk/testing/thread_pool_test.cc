@@ -325,6 +325,55 @@ TEST_F(ThreadPoolTest, DynamicSizing) {
   EXPECT_EQ(thread_pool.pending_join_threads_.Size(), 0);
 }
 
+TEST_F(ThreadPoolTest, ResizeAddsTaskQueues) {
+  ThreadPool thread_pool("test-pool", 1);
+  thread_pool.StartWorkers();
+  EXPECT_EQ(thread_pool.TaskQueueCount(), 1);
+  thread_pool.Resize(4, true);
+  EXPECT_EQ(thread_pool.TaskQueueCount(), 4);
+  // The added workers pop from their own queues.
+  absl::BlockingCounter pending_tasks(100);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(thread_pool.Schedule(
+        [&pending_tasks] { pending_tasks.DecrementCount(); },
+        ThreadPool::Priority::kLow));
+  }
+  pending_tasks.Wait();
+  // Shrinking keeps the queues, their tasks are stolen by the remaining
+  // workers.
+  thread_pool.Resize(2, true);
+  EXPECT_EQ(thread_pool.TaskQueueCount(), 4);
+  absl::BlockingCounter remaining_tasks(100);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(thread_pool.Schedule(
+        [&remaining_tasks] { remaining_tasks.DecrementCount(); },
+        ThreadPool::Priority::kHigh));
+  }
+  remaining_tasks.Wait();
+  thread_pool.JoinWorkers();
+}
+
+TEST_P(ThreadPoolTest, StealTasksOfBusyWorker) {
+  auto priority = GetParam();
+  ThreadPool thread_pool("test-pool", 2);
+  thread_pool.StartWorkers();
+  absl::Notification nested_done;
+  absl::Notification outer_done;
+  // The nested task lands in the queue of the worker running the outer task,
+  // which waits for it, so it can only run if the other worker steals it.
+  EXPECT_TRUE(thread_pool.Schedule(
+      [&thread_pool, &nested_done, &outer_done, priority] {
+        EXPECT_TRUE(thread_pool.Schedule(
+            [&nested_done] { nested_done.Notify(); }, priority));
+        EXPECT_TRUE(
+            nested_done.WaitForNotificationWithTimeout(absl::Seconds(5)));
+        outer_done.Notify();
+      },
+      priority));
+  outer_done.WaitForNotification();
+  thread_pool.JoinWorkers();
+}
+
 namespace {
 constexpr size_t kThreadCount = 2;
 std::shared_ptr<absl::BlockingCounter> ScheduleTasks(